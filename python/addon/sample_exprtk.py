@@ -46,23 +46,17 @@ callbacks = CustomCallbacks
 def load():
     print("Loading exprtk sample addon")
 
-    # When setting the default precision or rounding through a script
-    # this also affects the native precision ( But not the output formatting precision.) and
-    # user configured rounding mode,
-    # and should therefore be reset to the original value before returning control to the native side.
-    original_precision = mpreal.mpreal.get_default_precision()
-    original_rounding = mpreal.mpreal.get_default_rounding()
+    # The default precision and rounding are part of the evaluation context of the calling thread,
+    # the context manager restores the previous values when leaving the with statement.
+    # The context is also restored by the native side when load() returns.
+    with mpreal.Context(precision=9, rounding=mpreal.RoundingMode.ROUND_AWAY_FROM_ZERO):
+        x = mpreal.mpreal(1)
+        y = mpreal.mpreal(3)
 
-    mpreal.mpreal.set_default_precision(9)
-    mpreal.mpreal.set_default_rounding(mpreal.RoundingMode.ROUND_AWAY_FROM_ZERO)
+        z = x / y
+        z.set_precision(3)
 
-    x = mpreal.mpreal(1)
-    y = mpreal.mpreal(3)
-
-    z = x / y
-    z.set_precision(3)
-
-    print("MpReal Value: " + str(z))
+        print("MpReal Value: " + str(z))
 
     global callbacks
 
@@ -90,8 +84,13 @@ def load():
 
     print("Variable: " + str(result[1].get_variable("pyVar")))
 
-    mpreal.mpreal.set_default_precision(original_precision)
-    mpreal.mpreal.set_default_rounding(original_rounding)
+    # Results of the integer backend are exact python integers, also beyond the 53 bits of a float.
+    with mpreal.Context(backend=mpreal.Backend.INTEGER):
+        big = exprtk.evaluate("2^64 + 1")
+        assert isinstance(big, int) and big == 2 ** 64 + 1
+        assert exprtk.evaluate_batch("x * x", {"x": [2 ** 40 + 1]}) == [(2 ** 40 + 1) ** 2]
+
+    print("Integer: " + str(big))
 
 
 def unload():
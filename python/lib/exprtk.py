@@ -33,7 +33,7 @@ class ScriptFunction:
 
 
 class SymbolTable:
-    def __init__(self, variables=None, constants=None, functions=None, scripts=None):
+    def __init__(self, variables=None, constants=None, functions=None, scripts=None, definitions=None):
         if variables is None:
             variables = {}
         if constants is None:
@@ -42,16 +42,20 @@ class SymbolTable:
             functions = {}
         if scripts is None:
             scripts = {}
+        if definitions is None:
+            definitions = {}
         self.variables = variables
         self.constants = constants
         self.functions = functions
         self.scripts = scripts
+        self.definitions = definitions
 
     def remove(self, name):
         self.variables.pop(name, None)
         self.constants.pop(name, None)
         self.functions.pop(name, None)
         self.scripts.pop(name, None)
+        self.definitions.pop(name, None)
 
     def get_variable_names(self):
         return self.variables.keys()
@@ -92,18 +96,63 @@ class SymbolTable:
     def set_script_noargs(self, name, callback):
         self.scripts[name] = ScriptFunction(callback, False)
 
+    def get_definition_names(self):
+        return self.definitions.keys()
 
-def evaluate(expression, symtable=None):
+    def get_definition(self, name):
+        return self.definitions[name]
+
+    # The variable is recomputed from the expression by recompute() when a symbol referenced by the expression changes.
+    def set_definition(self, name, expression):
+        self.definitions[name] = expression
+        if name not in self.variables:
+            self.variables[name] = 0
+
+
+# Limits the resources used by an evaluation, a limit of 0 disables the limit.
+# iterations is the total number of loop iterations, time is the wall clock time in milliseconds
+# and memory is the peak number of bytes allocated for numbers.
+# An evaluation which exceeds a limit raises a RuntimeError.
+class EvaluationBudget:
+    def __init__(self, iterations=0, time=0, memory=0):
+        self.iterations = iterations
+        self.time = time
+        self.memory = memory
+
+
+def evaluate(expression, symtable=None, budget=None):
     if symtable is None:
         symtable = SymbolTable()
-    ret = evaluate_with_side_effects(expression, symtable)
+    ret = evaluate_with_side_effects(expression, symtable, budget)
     return ret[0]
 
 
 # Returns a tuple with ret[0] being the result of the expression and ret[1] being the updated symbol table
 # in case the expression modifies variables.
-def evaluate_with_side_effects(expression, symtable):
-    return _exprtk.evaluate(expression, symtable)
+# Results are floats, the integer backend (See mpreal.Context) returns exact python integers.
+def evaluate_with_side_effects(expression, symtable, budget=None):
+    if budget is None:
+        budget = EvaluationBudget()
+    return _exprtk.evaluate(expression, symtable, budget.iterations, budget.time, budget.memory)
+
+
+# Returns a list with the result of the expression for each row of the bindings.
+# bindings is a dictionary which maps variable names to lists of values, all lists must have the same length.
+# Bound variables which are not defined in the symbol table are added to it.
+# The expression is compiled once for all rows.
+# If threads is not 1 the rows are split across the given number of threads, 0 uses all hardware threads.
+# Variables assigned by the expression are not written back when evaluating with multiple threads.
+def evaluate_batch(expression, bindings, symtable=None, threads=1):
+    if symtable is None:
+        symtable = SymbolTable()
+    return _exprtk.evaluate_batch(expression, symtable, bindings, threads)
+
+
+# Returns a new symbol table with the defined variables which depend on the changed names recomputed
+# in dependency order, independent variables are recomputed in parallel.
+# threads is the maximum number of threads to use, 0 uses all hardware threads.
+def recompute(symtable, changed_names, threads=0):
+    return _exprtk.recompute(symtable, list(changed_names), threads)
 
 
 def get_global_symtable():
@@ -12,6 +12,62 @@ class RoundingMode:
     ROUND_TOWARD_INFINITY_NEGATIVE = 3
     ROUND_AWAY_FROM_ZERO = 4
 
+class Backend:
+    def __init__(self):
+        pass
+
+    MPFR = 0
+    DOUBLE = 1
+    LONG_DOUBLE = 2
+    FLOAT128 = 3
+    DOUBLE_DOUBLE = 4
+    QUAD_DOUBLE = 5
+    INTEGER = 6
+    RATIONAL = 7
+    INTERVAL = 8
+
+# Temporarily changes the evaluation context of the calling thread,
+# the previous precision, rounding modes and backend are restored when leaving the with statement.
+#
+# with mpreal.Context(precision=9, rounding=mpreal.RoundingMode.ROUND_AWAY_FROM_ZERO):
+#     ...
+class Context:
+    def __init__(self, precision=None, rounding=None, formatting_precision=None, formatting_rounding=None,
+                 backend=None):
+        self.precision = precision
+        self.rounding = rounding
+        self.formatting_precision = formatting_precision
+        self.formatting_rounding = formatting_rounding
+        self.backend = backend
+        self._previous = None
+
+    def __enter__(self):
+        self._previous = (mpreal.get_default_precision(),
+                          mpreal.get_default_rounding(),
+                          mpreal.get_formatting_precision(),
+                          mpreal.get_formatting_rounding(),
+                          mpreal.get_backend())
+        if self.precision is not None:
+            mpreal.set_default_precision(self.precision)
+        if self.rounding is not None:
+            mpreal.set_default_rounding(self.rounding)
+        if self.formatting_precision is not None:
+            mpreal.set_formatting_precision(self.formatting_precision)
+        if self.formatting_rounding is not None:
+            mpreal.set_formatting_rounding(self.formatting_rounding)
+        if self.backend is not None:
+            mpreal.set_backend(self.backend)
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        mpreal.set_default_precision(self._previous[0])
+        mpreal.set_default_rounding(self._previous[1])
+        mpreal.set_formatting_precision(self._previous[2])
+        mpreal.set_formatting_rounding(self._previous[3])
+        mpreal.set_backend(self._previous[4])
+        return False
+
+
 def _get_rounding_char(mode):
     if mode == RoundingMode.ROUND_NEAREST:
         return "N"
@@ -23,6 +23,8 @@
 
 #include "pycx/interpreter.hpp"
 
+#include "math/evaluationcontext.hpp"
+
 Addon::Addon(std::string moduleName, std::string displayName, std::string description)
         : loaded(false),
           moduleName(std::move(moduleName)),
@@ -30,6 +32,8 @@ Addon::Addon(std::string moduleName, std::string displayName, std::string descri
           description(std::move(description)) {}
 
 void Addon::callFunctionNoArgs(const std::string &name) {
+    // Addons may change the evaluation context of the calling thread, the context is restored afterwards.
+    ScopedEvaluationContext scope;
     moduleLoaded = true;
     Interpreter::callFunctionNoArgs(moduleName, name);
 }
@@ -6203,6 +6203,31 @@ namespace exprtk
          const bool consequent_deletable_;
       };
 
+      class loop_runtime_check
+      {
+      public:
+
+         virtual ~loop_runtime_check()
+         {}
+
+         // Invoked before each loop iteration of the calling thread, may throw to abort the evaluation.
+         virtual void check() = 0;
+
+         static loop_runtime_check*& instance()
+         {
+            static thread_local loop_runtime_check* current = reinterpret_cast<loop_runtime_check*>(0);
+            return current;
+         }
+      };
+
+      inline void loop_iteration_check()
+      {
+         loop_runtime_check* current = loop_runtime_check::instance();
+
+         if (current)
+            current->check();
+      }
+
       #ifndef exprtk_disable_break_continue
       template <typename T>
       class break_exception
@@ -6311,6 +6336,8 @@ namespace exprtk
 
             while (is_true(condition_))
             {
+               loop_iteration_check();
+
                result = loop_body_->value();
             }
 
@@ -6363,6 +6390,8 @@ namespace exprtk
 
             do
             {
+               loop_iteration_check();
+
                result = loop_body_->value();
             }
             while (is_false(condition_));
@@ -6438,6 +6467,8 @@ namespace exprtk
             {
                while (is_true(condition_))
                {
+                  loop_iteration_check();
+
                   result = loop_body_->value();
                   incrementor_->value();
                }
@@ -6446,6 +6477,8 @@ namespace exprtk
             {
                while (is_true(condition_))
                {
+                  loop_iteration_check();
+
                   result = loop_body_->value();
                }
             }
@@ -6504,6 +6537,8 @@ namespace exprtk
 
             while (is_true(condition_))
             {
+               loop_iteration_check();
+
                try
                {
                   result = loop_body_->value();
@@ -6565,6 +6600,8 @@ namespace exprtk
 
             do
             {
+               loop_iteration_check();
+
                try
                {
                   result = loop_body_->value();
@@ -6649,6 +6686,8 @@ namespace exprtk
             {
                while (is_true(condition_))
                {
+                  loop_iteration_check();
+
                   try
                   {
                      result = loop_body_->value();
@@ -6667,6 +6706,8 @@ namespace exprtk
             {
                while (is_true(condition_))
                {
+                  loop_iteration_check();
+
                   try
                   {
                      result = loop_body_->value();
@@ -20,6 +20,10 @@
 #define EXPRTK_MPFRREAL_ADAPTOR_HPP
 
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include "mpreal.h"
 
@@ -64,19 +68,118 @@ namespace exprtk
 
         namespace constant
         {
-            static const mp_prec_t  mpfr_precision = 128;
-            static const mp_rnd_t   mpfr_round     = mpfr::mpreal::get_default_rnd();
-
-            static const mpfr::mpreal e       = mpfr::const_euler(mpfr_precision,mpfr_round);
-            static const mpfr::mpreal pi      = mpfr::const_pi   (mpfr_precision,mpfr_round);
-            static const mpfr::mpreal pi_2    = mpfr::const_pi   (mpfr_precision,mpfr_round) / mpfr::mpreal(  2.0);
-            static const mpfr::mpreal pi_4    = mpfr::const_pi   (mpfr_precision,mpfr_round) / mpfr::mpreal(  4.0);
-            static const mpfr::mpreal pi_180  = mpfr::const_pi   (mpfr_precision,mpfr_round) / mpfr::mpreal(180.0);
-            static const mpfr::mpreal _1_pi   = mpfr::mpreal(  1.0) / mpfr::const_pi(mpfr_precision,mpfr_round);
-            static const mpfr::mpreal _2_pi   = mpfr::mpreal(  2.0) / mpfr::const_pi(mpfr_precision,mpfr_round);
-            static const mpfr::mpreal _180_pi = mpfr::mpreal(180.0) / mpfr::const_pi(mpfr_precision,mpfr_round);
-            static const mpfr::mpreal log2    = mpfr::const_log2 (mpfr_precision,mpfr_round);
-            static const mpfr::mpreal sqrt2   = mpfr::sqrt(mpfr::mpreal(2.0));
+            /*
+               A mathematical constant which is computed on first use at the requested precision.
+
+               Computed values are cached per precision and shared by all threads, a request is served
+               by rounding a cached value of equal or higher precision if one exists. The cached values are
+               rounded to nearest with guard bits and carry an error of at most 2 ulp, a cached value is only
+               used if mpfr_can_round proves that rounding it yields the correctly rounded constant for the
+               requested rounding mode. Otherwise the constant is computed again at a higher precision.
+            */
+            class mpfr_constant
+            {
+            public:
+
+                typedef mpfr::mpreal (*compute_function)(mp_prec_t);
+
+                explicit mpfr_constant(compute_function compute)
+                : compute_(compute)
+                {}
+
+                inline mpfr::mpreal operator()(mp_prec_t precision = mpfr::mpreal::get_default_prec(),
+                                               mp_rnd_t  round     = mpfr::mpreal::get_default_rnd()) const
+                {
+                    mp_prec_t cache_precision = precision + guard_bits;
+
+                    {
+                        std::shared_lock<std::shared_mutex> lock(mutex_);
+                        for (cache_t::const_iterator itr = cache_.lower_bound(cache_precision); cache_.end() != itr; ++itr)
+                        {
+                            if (can_round(itr->second,precision,round))
+                                return round_to(itr->second,precision,round);
+                        }
+                        // The cached values are too close to a rounding boundary of the requested precision.
+                        if (!cache_.empty())
+                            cache_precision = std::max(cache_precision,cache_.rbegin()->first + guard_bits);
+                    }
+
+                    while (true)
+                    {
+                        // Computed without holding the lock, concurrent requests may compute the same value.
+                        const mpfr::mpreal value = compute_(cache_precision);
+
+                        {
+                            std::unique_lock<std::shared_mutex> lock(mutex_);
+                            cache_.insert(std::make_pair(cache_precision,value));
+                        }
+
+                        if (can_round(value,precision,round))
+                            return round_to(value,precision,round);
+
+                        cache_precision += std::max(guard_bits,cache_precision / 2);
+                    }
+                }
+
+            private:
+
+                typedef std::map<mp_prec_t,mpfr::mpreal> cache_t;
+
+                static constexpr mp_prec_t guard_bits = 32;
+
+                // The error of the computed values is at most 2 ulp (eg. pi / 180 rounds twice).
+                static inline bool can_round(const mpfr::mpreal& value, mp_prec_t precision, mp_rnd_t round)
+                {
+                    return mpfr_can_round(value.mpfr_srcptr(),value.get_prec() - 1,MPFR_RNDN,round,precision) != 0;
+                }
+
+                static inline mpfr::mpreal round_to(const mpfr::mpreal& value, mp_prec_t precision, mp_rnd_t round)
+                {
+                    mpfr::mpreal result;
+                    result.set_prec(precision);
+                    mpfr_set(result.mpfr_ptr(),value.mpfr_srcptr(),round);
+                    return result;
+                }
+
+                compute_function compute_;
+                mutable std::shared_mutex mutex_;
+                mutable cache_t cache_;
+            };
+
+            namespace compute
+            {
+                inline mpfr::mpreal e      (mp_prec_t p) { return mpfr::exp(mpfr::mpreal(1.0,p));               }
+                inline mpfr::mpreal pi     (mp_prec_t p) { return mpfr::const_pi(p,MPFR_RNDN);                  }
+                inline mpfr::mpreal pi_2   (mp_prec_t p) { return mpfr::const_pi(p,MPFR_RNDN) / 2;              }
+                inline mpfr::mpreal pi_4   (mp_prec_t p) { return mpfr::const_pi(p,MPFR_RNDN) / 4;              }
+                inline mpfr::mpreal pi_180 (mp_prec_t p) { return mpfr::const_pi(p,MPFR_RNDN) / 180;            }
+                inline mpfr::mpreal _1_pi  (mp_prec_t p) { return mpfr::mpreal(  1.0,p) / mpfr::const_pi(p,MPFR_RNDN); }
+                inline mpfr::mpreal _2_pi  (mp_prec_t p) { return mpfr::mpreal(  2.0,p) / mpfr::const_pi(p,MPFR_RNDN); }
+                inline mpfr::mpreal _180_pi(mp_prec_t p) { return mpfr::mpreal(180.0,p) / mpfr::const_pi(p,MPFR_RNDN); }
+                inline mpfr::mpreal log2   (mp_prec_t p) { return mpfr::const_log2(p,MPFR_RNDN);                }
+                inline mpfr::mpreal sqrt2  (mp_prec_t p) { return mpfr::sqrt(mpfr::mpreal(2.0,p));              }
+            }
+
+            #define exprtk_define_mpfr_constant(name)                                         \
+            inline mpfr::mpreal name(mp_prec_t precision = mpfr::mpreal::get_default_prec(),  \
+                                     mp_rnd_t  round     = mpfr::mpreal::get_default_rnd())   \
+            {                                                                                 \
+                static const mpfr_constant constant(compute::name);                           \
+                return constant(precision,round);                                             \
+            }
+
+            exprtk_define_mpfr_constant(e      )
+            exprtk_define_mpfr_constant(pi     )
+            exprtk_define_mpfr_constant(pi_2   )
+            exprtk_define_mpfr_constant(pi_4   )
+            exprtk_define_mpfr_constant(pi_180 )
+            exprtk_define_mpfr_constant(_1_pi  )
+            exprtk_define_mpfr_constant(_2_pi  )
+            exprtk_define_mpfr_constant(_180_pi)
+            exprtk_define_mpfr_constant(log2   )
+            exprtk_define_mpfr_constant(sqrt2  )
+
+            #undef exprtk_define_mpfr_constant
         }
 
         namespace numeric
@@ -144,16 +247,16 @@ namespace exprtk
                 template <typename T> inline T   cot_impl(const T& v, mpfrreal_type_tag) { return mpfr::cot  (v); }
                 template <typename T> inline T   sec_impl(const T& v, mpfrreal_type_tag) { return mpfr::sec  (v); }
                 template <typename T> inline T   csc_impl(const T& v, mpfrreal_type_tag) { return mpfr::csc  (v); }
-                template <typename T> inline T   r2d_impl(const T& v, mpfrreal_type_tag) { return (v  * exprtk::details::constant::_180_pi); }
-                template <typename T> inline T   d2r_impl(const T& v, mpfrreal_type_tag) { return (v  * exprtk::details::constant::pi_180 ); }
+                template <typename T> inline T   r2d_impl(const T& v, mpfrreal_type_tag) { return (v  * exprtk::details::constant::_180_pi(v.getPrecision())); }
+                template <typename T> inline T   d2r_impl(const T& v, mpfrreal_type_tag) { return (v  * exprtk::details::constant::pi_180 (v.getPrecision())); }
                 template <typename T> inline T   d2g_impl(const T& v, mpfrreal_type_tag) { return (v  * mpfr::mpreal(20.0/9.0)); }
                 template <typename T> inline T   g2d_impl(const T& v, mpfrreal_type_tag) { return (v  * mpfr::mpreal(9.0/20.0)); }
                 template <typename T> inline T  notl_impl(const T& v, mpfrreal_type_tag) { return (v != mpfr::mpreal(0) ? mpfr::mpreal(0) : mpfr::mpreal(1)); }
                 template <typename T> inline T  frac_impl(const T& v, mpfrreal_type_tag) { return mpfr::frac (v); }
                 template <typename T> inline T trunc_impl(const T& v, mpfrreal_type_tag) { return mpfr::trunc(v); }
 
-                template <typename T> inline T const_pi_impl(mpfrreal_type_tag) { return mpfr::const_pi   (1024, exprtk::details::constant::mpfr_round); }
-                template <typename T> inline T const_e_impl (mpfrreal_type_tag) { return mpfr::const_euler(1024, exprtk::details::constant::mpfr_round); }
+                template <typename T> inline T const_pi_impl(mpfrreal_type_tag) { return exprtk::details::constant::pi(); }
+                template <typename T> inline T const_e_impl (mpfrreal_type_tag) { return exprtk::details::constant::e (); }
 
                 inline bool is_true_impl (const mpfr::mpreal& v)
                 {
@@ -224,7 +327,7 @@ namespace exprtk
                 {
                     T cnd = T(0.5) * (T(1) + erf_impl(
                             mpfr::abs(v) /
-                            T(constant::sqrt2),mpfrreal_type_tag()));
+                            exprtk::details::constant::sqrt2(v.getPrecision()),mpfrreal_type_tag()));
                     return  (v < T(0)) ? (T(1) - cnd) : cnd;
                 }
 
@@ -78,6 +78,15 @@ void GeneralTab::setFormatRounding(mpfr_rnd_t rounding) {
     formatRoundingComboBox->setCurrentIndex(getIndexFromRoundingMode(rounding));
 }
 
+void GeneralTab::setAdaptivePrecision(bool adaptive) {
+    adaptivePrecisionCheckBox->setChecked(adaptive);
+}
+
+void GeneralTab::setBackend(NumericBackend backend) {
+    int index = backendComboBox->findData(backend);
+    backendComboBox->setCurrentIndex(index < 0 ? 0 : index);
+}
+
 GeneralTab::GeneralTab(QWidget *parent)
         : QWidget(parent) {
     roundingModel.setStringList({"Round to nearest",
@@ -85,6 +94,23 @@ GeneralTab::GeneralTab(QWidget *parent)
                                  "Round toward +Inf",
                                  "Round toward -Inf",
                                  "Round away from zero"});
+    backendLabel = new QLabel(this);
+    backendLabel->setText("Arithmetic Type");
+    backendLabel->setToolTip(
+            "The type used for arithmetic. The hardware types are faster but have a fixed precision and ignore the precision and rounding settings.");
+    backendComboBox = new QComboBox(this);
+    backendComboBox->addItem("Arbitrary precision (MPFR)", BACKEND_MPFR);
+    backendComboBox->addItem("Double", BACKEND_DOUBLE);
+    backendComboBox->addItem("Long Double", BACKEND_LONG_DOUBLE);
+    backendComboBox->addItem("Double-Double", BACKEND_DOUBLE_DOUBLE);
+    backendComboBox->addItem("Quad-Double", BACKEND_QUAD_DOUBLE);
+    backendComboBox->addItem("Integer (GMP)", BACKEND_INTEGER);
+    backendComboBox->addItem("Rational (GMP)", BACKEND_RATIONAL);
+    backendComboBox->addItem("Interval (MPFR)", BACKEND_INTERVAL);
+#ifdef QCALC_FLOAT128
+    backendComboBox->addItem("Quadruple (__float128)", BACKEND_FLOAT128);
+#endif
+
     precisionLabel = new QLabel(this);
     precisionLabel->setText("Precision");
     precisionLabel->setToolTip(
@@ -107,6 +133,11 @@ GeneralTab::GeneralTab(QWidget *parent)
     formatRoundingLabel->setToolTip("The rounding mode used when formatting result values to strings.");
     formatRoundingComboBox = new QComboBox(this);
 
+    adaptivePrecisionCheckBox = new QCheckBox(this);
+    adaptivePrecisionCheckBox->setText("Adaptive Precision");
+    adaptivePrecisionCheckBox->setToolTip(
+            "Evaluate with the lowest precision which yields all formatted decimal spaces correctly, the precision setting is used as the upper bound.");
+
     precisionSpinBox->setRange(1, 1000000000);
     formatPrecisionSpinBox->setRange(0, 1000000);
 
@@ -114,6 +145,11 @@ GeneralTab::GeneralTab(QWidget *parent)
 
     auto *layout = new QVBoxLayout();
 
+    layout->addWidget(backendLabel);
+    layout->addWidget(backendComboBox);
+
+    layout->addSpacing(10);
+
     layout->addWidget(precisionLabel);
     layout->addWidget(precisionSpinBox);
     layout->addWidget(roundingLabel);
@@ -126,6 +162,10 @@ GeneralTab::GeneralTab(QWidget *parent)
     layout->addWidget(formatRoundingLabel);
     layout->addWidget(formatRoundingComboBox);
 
+    layout->addSpacing(10);
+
+    layout->addWidget(adaptivePrecisionCheckBox);
+
     layout->addWidget(new QWidget(this), 1);
 
     setLayout(layout);
@@ -145,4 +185,12 @@ int GeneralTab::getFormatPrecision() {
 
 mpfr_rnd_t GeneralTab::getFormatRounding() {
     return getRoundingModeFromIndex(formatRoundingComboBox->currentIndex());
-}
\ No newline at end of file
+}
+
+bool GeneralTab::getAdaptivePrecision() {
+    return adaptivePrecisionCheckBox->isChecked();
+}
+
+NumericBackend GeneralTab::getBackend() {
+    return static_cast<NumericBackend>(backendComboBox->currentData().toInt());
+}
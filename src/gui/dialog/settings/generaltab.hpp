@@ -25,10 +25,13 @@
 #include <QLabel>
 #include <QSpinBox>
 #include <QComboBox>
+#include <QCheckBox>
 #include <QStringListModel>
 
 #include <mpfr.h>
 
+#include "math/numericbackend.hpp"
+
 class GeneralTab : public QWidget {
 Q_OBJECT
 public slots:
@@ -41,6 +44,10 @@ public slots:
 
     void setFormatRounding(mpfr_rnd_t rounding);
 
+    void setAdaptivePrecision(bool adaptive);
+
+    void setBackend(NumericBackend backend);
+
 public:
     explicit GeneralTab(QWidget *parent = nullptr);
 
@@ -52,6 +59,10 @@ public:
 
     mpfr_rnd_t getFormatRounding();
 
+    bool getAdaptivePrecision();
+
+    NumericBackend getBackend();
+
 private:
     QStringListModel roundingModel;
 
@@ -66,6 +77,11 @@ private:
 
     QLabel *formatRoundingLabel;
     QComboBox *formatRoundingComboBox;
+
+    QCheckBox *adaptivePrecisionCheckBox;
+
+    QLabel *backendLabel;
+    QComboBox *backendComboBox;
 };
 
 #endif //QCALC_GENERALTAB_HPP
@@ -129,6 +129,22 @@ mpfr_rnd_t SettingsDialog::getFormattingRoundMode() {
     return generalTab->getFormatRounding();
 }
 
+void SettingsDialog::setAdaptivePrecision(bool adaptive) {
+    generalTab->setAdaptivePrecision(adaptive);
+}
+
+bool SettingsDialog::getAdaptivePrecision() {
+    return generalTab->getAdaptivePrecision();
+}
+
+void SettingsDialog::setBackend(NumericBackend backend) {
+    generalTab->setBackend(backend);
+}
+
+NumericBackend SettingsDialog::getBackend() {
+    return generalTab->getBackend();
+}
+
 void SettingsDialog::onModuleEnableChanged(AddonItemWidget *item) {
     std::string name = item->getModuleName().toStdString();
     bool enabled = item->getModuleEnabled();
@@ -60,6 +60,14 @@ public:
 
     mpfr_rnd_t getFormattingRoundMode();
 
+    void setAdaptivePrecision(bool adaptive);
+
+    bool getAdaptivePrecision();
+
+    void setBackend(NumericBackend backend);
+
+    NumericBackend getBackend();
+
 private slots:
 
     void onModuleEnableChanged(AddonItemWidget *item);
@@ -0,0 +1,185 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "worksheetdialog.hpp"
+
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QScrollBar>
+#include <QtConcurrent/QtConcurrent>
+
+#include "math/numberformat.hpp"
+
+static const int RECOMPUTE_DELAY = 300;
+
+WorksheetDialog::WorksheetDialog(const SymbolTable &symbols, const EvaluationBudget &budget, QWidget *parent)
+        : QDialog(parent), worksheet(symbols), budget(budget), symbolTable(symbols) {
+    setModal(false);
+    setWindowTitle("Worksheet");
+    setLayout(new QVBoxLayout());
+
+    auto *documentLayout = new QHBoxLayout();
+
+    editor = new QPlainTextEdit(this);
+    editor->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    results = new QPlainTextEdit(this);
+    results->setLineWrapMode(QPlainTextEdit::NoWrap);
+    results->setReadOnly(true);
+
+    status = new QLabel(this);
+
+    documentLayout->addWidget(editor);
+    documentLayout->addWidget(results);
+
+    dynamic_cast<QVBoxLayout *>(layout())->addLayout(documentLayout);
+    layout()->addWidget(status);
+
+    timer.setSingleShot(true);
+    timer.setInterval(RECOMPUTE_DELAY);
+
+    connect(editor, SIGNAL(textChanged()), this, SLOT(onTextChanged()));
+    connect(&timer, SIGNAL(timeout()), this, SLOT(startRecompute()));
+    connect(&watcher, SIGNAL(finished()), this, SLOT(onRecomputeFinished()));
+
+    // Keep the results aligned with the lines of the editor.
+    connect(editor->verticalScrollBar(), SIGNAL(valueChanged(int)), results->verticalScrollBar(), SLOT(setValue(int)));
+}
+
+WorksheetDialog::~WorksheetDialog() {
+    token.cancel();
+    watcher.waitForFinished();
+}
+
+void WorksheetDialog::setSymbols(const SymbolTable &symbols) {
+    symbolTable = symbols;
+    symbolsModified = true;
+    timer.start();
+}
+
+void WorksheetDialog::onTextChanged() {
+    timer.start();
+}
+
+void WorksheetDialog::startRecompute() {
+    // The worksheet is modified by the worker thread, changes are applied once the running recomputation finishes.
+    if (watcher.isRunning()) {
+        recomputePending = true;
+        return;
+    }
+
+    if (symbolsModified) {
+        worksheet.setSymbolTable(symbolTable);
+        symbolsModified = false;
+    }
+
+    applyLines();
+
+    status->setText("Evaluating...");
+
+    EvaluationContext context = EvaluationContext::getCurrent();
+    EvaluationBudget b = budget;
+    CancellationToken t = token;
+    Worksheet *w = &worksheet;
+
+    watcher.setFuture(QtConcurrent::run([context, b, t, w]() {
+        ScopedEvaluationContext scope(context);
+
+        Results ret;
+        std::vector<size_t> evaluated;
+        try {
+            evaluated = w->recompute(b, t);
+        } catch (const std::exception &e) {
+            ret.emplace_back(w->size(), e.what());
+            return ret;
+        }
+
+        // Formatting large numbers is expensive and therefore also done on the worker thread.
+        for (auto index : evaluated) {
+            auto &cell = w->getCell(index);
+            if (!cell.error.empty())
+                ret.emplace_back(index, QString("Error: ") + cell.error.c_str());
+            else if (cell.expression.find_first_not_of(" \t") == std::string::npos)
+                ret.emplace_back(index, "");
+            else
+                ret.emplace_back(index, NumberFormat::toDecimal(cell.value).c_str());
+        }
+        return ret;
+    }));
+}
+
+void WorksheetDialog::onRecomputeFinished() {
+    status->clear();
+    for (auto &result : watcher.result()) {
+        if (result.first < static_cast<size_t>(values.size()))
+            values[static_cast<int>(result.first)] = result.second;
+        else
+            status->setText(result.second);
+    }
+    updateResults();
+
+    if (recomputePending) {
+        recomputePending = false;
+        timer.start();
+    }
+}
+
+void WorksheetDialog::applyLines() {
+    std::vector<std::string> newLines;
+    for (auto &line : editor->toPlainText().split('\n')) {
+        newLines.emplace_back(line.toStdString());
+    }
+
+    // Only the lines between the unchanged prefix and suffix are modified.
+    size_t prefix = 0;
+    while (prefix < lines.size() && prefix < newLines.size() && lines.at(prefix) == newLines.at(prefix)) {
+        prefix++;
+    }
+
+    size_t suffix = 0;
+    while (suffix < lines.size() - prefix
+           && suffix < newLines.size() - prefix
+           && lines.at(lines.size() - 1 - suffix) == newLines.at(newLines.size() - 1 - suffix)) {
+        suffix++;
+    }
+
+    size_t oldCount = lines.size() - prefix - suffix;
+    size_t newCount = newLines.size() - prefix - suffix;
+    size_t common = std::min(oldCount, newCount);
+
+    for (size_t i = 0; i < common; i++) {
+        worksheet.setCell(prefix + i, newLines.at(prefix + i));
+    }
+    for (size_t i = common; i < oldCount; i++) {
+        worksheet.removeCell(prefix + common);
+        values.removeAt(static_cast<int>(prefix + common));
+    }
+    for (size_t i = common; i < newCount; i++) {
+        worksheet.insertCell(prefix + i, newLines.at(prefix + i));
+        values.insert(static_cast<int>(prefix + i), "");
+    }
+
+    lines = std::move(newLines);
+}
+
+void WorksheetDialog::updateResults() {
+    int scroll = editor->verticalScrollBar()->value();
+    results->setPlainText(values.join('\n'));
+    results->verticalScrollBar()->setValue(scroll);
+}
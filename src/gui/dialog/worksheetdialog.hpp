@@ -0,0 +1,86 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_WORKSHEETDIALOG_HPP
+#define QCALC_WORKSHEETDIALOG_HPP
+
+#include <QDialog>
+#include <QPlainTextEdit>
+#include <QLabel>
+#include <QTimer>
+#include <QFutureWatcher>
+
+#include <vector>
+#include <utility>
+
+#include "math/worksheet.hpp"
+#include "math/evaluationcontext.hpp"
+
+/**
+ * The worksheet dialog edits a worksheet where each line of the document is a cell.
+ *
+ * Edits are applied to the worksheet after a short delay and only the affected cells are evaluated,
+ * the evaluation runs on a worker thread and the result of each cell is shown next to its line.
+ */
+class WorksheetDialog : public QDialog {
+Q_OBJECT
+public slots:
+
+    void setSymbols(const SymbolTable &symbols);
+
+public:
+    WorksheetDialog(const SymbolTable &symbols, const EvaluationBudget &budget, QWidget *parent);
+
+    ~WorksheetDialog() override;
+
+private slots:
+
+    void onTextChanged();
+
+    void onRecomputeFinished();
+
+    void startRecompute();
+
+private:
+    // The formatted results of the evaluated cells by cell index, an index past the last cell reports an error of the worksheet.
+    typedef std::vector<std::pair<size_t, QString>> Results;
+
+    void applyLines();
+
+    void updateResults();
+
+    Worksheet worksheet;
+    EvaluationBudget budget;
+    CancellationToken token;
+
+    QPlainTextEdit *editor;
+    QPlainTextEdit *results;
+    QLabel *status;
+
+    QTimer timer;
+    QFutureWatcher<Results> watcher;
+
+    std::vector<std::string> lines; // The lines which have been applied to the worksheet.
+    QStringList values; // The displayed result of each cell.
+    bool symbolsModified = false;
+    bool recomputePending = false; // True if the document was modified during the running recomputation.
+    SymbolTable symbolTable;
+};
+
+#endif //QCALC_WORKSHEETDIALOG_HPP
@@ -20,6 +20,7 @@
 #include "mainwindow.hpp"
 
 #include <filesystem>
+#include <algorithm>
 
 #include <QFile>
 #include <QDir>
@@ -28,6 +29,7 @@
 #include <QMenuBar>
 #include <QApplication>
 #include <QProcess>
+#include <QtConcurrent/QtConcurrent>
 
 #include "addon/addonmanager.hpp"
 
@@ -38,6 +40,7 @@
 
 #include "math/numberformat.hpp"
 #include "math/expressionparser.hpp"
+#include "math/evaluationcontext.hpp"
 
 #include "dialog/settings/settingsdialog.hpp"
 #include "dialog/symbolsdialog.hpp"
@@ -59,10 +62,42 @@ static const std::string SYMBOL_TABLE_HISTORY_FILE = "/symboltablehistory.json";
 static const int MAX_FORMATTING_PRECISION = 100000;
 static const int MAX_SYMBOL_TABLE_HISTORY = 100;
 
+/**
+ * @param table
+ * @param revision
+ * @return The names of the symbols modified since the revision, or all variables if the revision is not in the change log.
+ */
+static std::set<std::string> getChangedNames(const SymbolTable &table, unsigned long revision) {
+    const auto &changes = table.getChanges();
+    auto it = std::find_if(changes.begin(),
+                           changes.end(),
+                           [revision](const std::pair<unsigned long, std::string> &change) {
+                               return change.first == revision;
+                           });
+
+    std::set<std::string> ret;
+    if (it != changes.end()) {
+        for (it++; it != changes.end(); it++) {
+            ret.insert(it->second);
+        }
+    } else {
+        for (auto &variable : table.getVariables()) {
+            ret.insert(variable.first);
+        }
+    }
+    return ret;
+}
+
 //TODO:Feature: Completion and history navigation for input line edit with eg. up / down arrows.
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     setObjectName("MainWindow");
 
+    // Cancelled evaluations cannot be interrupted during a single long operation,
+    // a bounded pool keeps them from accumulating threads when the user cancels repeatedly.
+    // The thread is kept alive so that its engines keep the compiled expressions between evaluations.
+    evaluationPool.setMaxThreadCount(1);
+    evaluationPool.setExpiryTimeout(-1);
+
     setupLayout();
     setupMenuBar();
 
@@ -88,6 +123,8 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     connect(actionSaveAsSymbols, SIGNAL(triggered(bool)), this, SLOT(onActionSaveAsSymbolTable()));
     connect(actionEditSymbols, SIGNAL(triggered(bool)), this, SLOT(onActionEditSymbolTable()));
     connect(actionOpenTerminal, SIGNAL(triggered(bool)), this, SLOT(onActionOpenTerminal()));
+    connect(actionCancelEvaluation, SIGNAL(triggered(bool)), this, SLOT(onActionCancelEvaluation()));
+    connect(actionWorksheet, SIGNAL(triggered(bool)), this, SLOT(onActionWorksheet()));
 
     connect(input, SIGNAL(returnPressed()), this, SLOT(onInputReturnPressed()));
 
@@ -103,6 +140,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 
     updateSymbolHistoryMenu();
 
+    // Scripts invoked by an evaluation modify the copy of the evaluation thread (See startEvaluation).
     ExprtkModule::setGlobalTable(symbolTable,
                                  [this]() {
                                      onSymbolTableChanged(symbolTable);
@@ -141,9 +179,15 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     addonManager->setActiveAddons(availableAddons);
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow() {
+    onActionCancelEvaluation();
+    waitForEvaluations();
+    ExprtkModule::clearGlobalTable();
+}
 
 void MainWindow::closeEvent(QCloseEvent *event) {
+    onActionCancelEvaluation();
+    waitForEvaluations();
     saveSettings();
 }
 
@@ -161,16 +205,11 @@ void MainWindow::onAddonUnloadFail(const std::string &moduleName, const std::str
 }
 
 void MainWindow::onEvaluateExpression(const QString &expression) {
-    evaluateExpression(expression);
+    startEvaluation(expression, false);
 }
 
 void MainWindow::onInputReturnPressed() {
-    auto expr = input->text();
-    auto res = evaluateExpression(expr);
-    if (!res.isEmpty()) {
-        input->setText(res);
-        history->addContent(expr, res);
-    }
+    startEvaluation(input->text(), true);
 }
 
 void MainWindow::onSymbolTableChanged(const SymbolTable &symbolTableArg) {
@@ -178,6 +217,9 @@ void MainWindow::onSymbolTableChanged(const SymbolTable &symbolTableArg) {
     if (symbolsDialog != nullptr) {
         symbolsDialog->setSymbols(symbolTable);
     }
+    if (worksheetDialog != nullptr) {
+        worksheetDialog->setSymbols(symbolTable);
+    }
 }
 
 void MainWindow::onActionSettings() {
@@ -193,6 +235,11 @@ void MainWindow::onActionSettings() {
     dialog.setFormattingRoundMode(Serializer::deserializeRoundingMode(
             settings.value(SETTING_KEY_ROUNDING_F, SETTING_DEFAULT_ROUNDING_F).toInt()));
 
+    dialog.setBackend(static_cast<NumericBackend>(settings.value(SETTING_KEY_BACKEND, SETTING_DEFAULT_BACKEND).toInt()));
+
+    dialog.setAdaptivePrecision(
+            settings.value(SETTING_KEY_ADAPTIVE_PRECISION, SETTING_DEFAULT_ADAPTIVE_PRECISION).toInt());
+
     dialog.show();
 
     if (dialog.exec() == QDialog::Accepted) {
@@ -200,8 +247,9 @@ void MainWindow::onActionSettings() {
         settings.setValue(SETTING_KEY_ROUNDING, dialog.getRoundingMode());
         settings.setValue(SETTING_KEY_PRECISION_F, dialog.getFormattingPrecision());
         settings.setValue(SETTING_KEY_ROUNDING_F, dialog.getFormattingRoundMode());
-        mpfr::mpreal::set_default_prec(dialog.getPrecision());
-        mpfr::mpreal::set_default_rnd(dialog.getRoundingMode());
+        settings.setValue(SETTING_KEY_ADAPTIVE_PRECISION, dialog.getAdaptivePrecision());
+        settings.setValue(SETTING_KEY_BACKEND, dialog.getBackend());
+        applyEvaluationContext();
         try {
             std::set<std::string> addons = dialog.getEnabledAddons();
             std::string dataDir = Paths::getAppDataDirectory();
@@ -303,6 +351,21 @@ void MainWindow::onActionEditSymbolTable() {
     }
 }
 
+void MainWindow::onActionWorksheet() {
+    if (worksheetDialog == nullptr) {
+        worksheetDialog = new WorksheetDialog(symbolTable, getEvaluationBudget(), this);
+        worksheetDialog->setAttribute(Qt::WA_DeleteOnClose);
+        connect(worksheetDialog,
+                &QDialog::finished,
+                [this](int) {
+                    worksheetDialog = nullptr;
+                });
+        worksheetDialog->show();
+    } else {
+        worksheetDialog->activateWindow();
+    }
+}
+
 void MainWindow::onActionSymbolTableHistory() {
     importSymbolTable(dynamic_cast<QAction *>(sender())->data().toString().toStdString());
 }
@@ -323,23 +386,168 @@ void MainWindow::onHistoryTextDoubleClicked(const QString &text) {
     input->setFocus();
 }
 
-QString MainWindow::evaluateExpression(const QString &expression) {
-    try {
-        auto formatPrec = settings.value(SETTING_KEY_PRECISION_F, SETTING_DEFAULT_PRECISION_F).toInt();
-        auto formatRnd = Serializer::deserializeRoundingMode(
-                settings.value(SETTING_KEY_ROUNDING_F, SETTING_DEFAULT_ROUNDING_F).toInt());
+void MainWindow::onActionCancelEvaluation() {
+    evaluationQueue.clear();
+
+    if (evaluationWatcher == nullptr)
+        return;
+
+    // The worker stops at the next loop iteration or script call and skips the formatting and recomputation,
+    // a single long operation (eg. formatting a huge number) cannot be interrupted.
+    // The result is discarded when the worker finishes, the next evaluation waits in the pool until then.
+    evaluationToken.cancel();
+    evaluationWatcher = nullptr;
+
+    if (evaluationInteractive)
+        history->removePendingContent();
+
+    actionCancelEvaluation->setEnabled(false);
+}
+
+void MainWindow::startEvaluation(const QString &expression, bool interactive) {
+    // Requests made while evaluating are started in order once the running evaluation finishes.
+    if (evaluationWatcher != nullptr) {
+        evaluationQueue.push_back({expression, interactive});
+        return;
+    }
+
+    evaluationToken = CancellationToken();
+    evaluationExpression = expression;
+    evaluationInteractive = interactive;
+
+    if (interactive)
+        history->addPendingContent(expression);
 
-        auto v = ExpressionParser::evaluate(expression.toStdString(), symbolTable);
+    actionCancelEvaluation->setEnabled(true);
 
-        onSymbolTableChanged(symbolTable);
+    auto *watcher = new QFutureWatcher<EvaluationResult>(this);
+    evaluationWatcher = watcher;
 
-        QString ret = NumberFormat::toDecimal(v, formatPrec, formatRnd).c_str();
-        emit signalExpressionEvaluated(expression, ret);
+    connect(watcher, &QFutureWatcher<EvaluationResult>::finished, this, [this, watcher]() {
+        if (watcher == evaluationWatcher) {
+            evaluationWatcher = nullptr;
+            onEvaluationFinished(watcher->result());
+            startQueuedEvaluation();
+        }
+        watcher->deleteLater();
+    });
+
+    EvaluationContext context = EvaluationContext::getCurrent();
+    EvaluationBudget budget = getEvaluationBudget();
+    bool adaptive = settings.value(SETTING_KEY_ADAPTIVE_PRECISION, SETTING_DEFAULT_ADAPTIVE_PRECISION).toInt();
+    CancellationToken token = evaluationToken;
+    SymbolTable table = symbolTable;
+    std::shared_ptr<const DependencyGraph> graph = dependencyGraph;
+    std::string expr = expression.toStdString();
+
+    watcher->setFuture(QtConcurrent::run(&evaluationPool, [context, budget, adaptive, token, table, graph, expr]() mutable {
+        ScopedEvaluationContext scope(context);
+
+        // Scripts replace the copy of the table, which is applied by onEvaluationFinished.
+        ExprtkModule::ScopedGlobalTable globalTable(table);
+
+        auto checkCancelled = [&token]() {
+            if (token.isCancelled())
+                throw std::runtime_error("Evaluation cancelled");
+        };
+
+        EvaluationResult ret;
+        ret.startRevision = table.getRevision();
+        try {
+            // The interval backend displays only the digits which are certified by the enclosure.
+            std::string value;
+            if (context.backend == BACKEND_INTERVAL) {
+                auto enclosure = ExpressionParser::evaluateEnclosure(expr, table, budget, token);
+                checkCancelled();
+                value = NumberFormat::toDecimal(enclosure.first, enclosure.second);
+            } else {
+                auto v = adaptive
+                         ? ExpressionParser::evaluateAdaptive(expr, table, budget, token)
+                         : ExpressionParser::evaluateFast(expr, table, budget, token);
+                checkCancelled();
+                // Formatting large numbers is expensive and therefore also done on the worker thread.
+                value = NumberFormat::toDecimal(v);
+            }
+            checkCancelled();
+
+            // Recompute the defined variables which depend on the variables assigned by the expression.
+            if (!table.getDefinitions().empty()) {
+                if (graph == nullptr || graph->getVersion() != table.getVersion())
+                    graph = std::make_shared<const DependencyGraph>(table);
+                graph->recompute(table, getChangedNames(table, ret.startRevision), 0, token);
+            }
+            ret.dependencyGraph = graph;
+
+            ret.value = value.c_str();
+        } catch (const std::exception &e) {
+            ret.error = e.what();
+        }
+        ret.symbolTable = std::move(table);
         return ret;
-    } catch (const std::runtime_error &e) {
-        QMessageBox::warning(this, "Failed to evaluate expression", e.what());
+    }));
+}
+
+void MainWindow::startQueuedEvaluation() {
+    if (evaluationWatcher != nullptr || evaluationQueue.empty())
+        return;
+    EvaluationRequest request = evaluationQueue.front();
+    evaluationQueue.pop_front();
+    startEvaluation(request.expression, request.interactive);
+}
+
+void MainWindow::waitForEvaluations() {
+    // Cancelled evaluations keep running until their next check, their watchers are deleted once they finish.
+    evaluationPool.waitForDone();
+}
+
+void MainWindow::onEvaluationFinished(const EvaluationResult &result) {
+    actionCancelEvaluation->setEnabled(false);
+
+    if (!result.error.isEmpty()) {
+        if (evaluationInteractive)
+            history->removePendingContent();
+        QMessageBox::warning(this, "Failed to evaluate expression", result.error);
+        return;
     }
-    return "";
+
+    applyEvaluatedSymbols(result);
+    if (result.dependencyGraph != nullptr)
+        dependencyGraph = result.dependencyGraph;
+    onSymbolTableChanged(symbolTable);
+
+    if (evaluationInteractive) {
+        input->setText(result.value);
+        history->setPendingValue(result.value);
+    }
+
+    emit signalExpressionEvaluated(evaluationExpression, result.value);
+}
+
+void MainWindow::applyEvaluatedSymbols(const EvaluationResult &result) {
+    if (symbolTable.getRevision() == result.startRevision) {
+        symbolTable = result.symbolTable;
+        return;
+    }
+
+    // Expressions can only assign variables.
+    for (auto &name : getChangedNames(result.symbolTable, result.startRevision)) {
+        auto variable = result.symbolTable.getVariables().find(name);
+        if (variable == result.symbolTable.getVariables().end())
+            continue;
+        symbolTable.setVariable(name, variable->second, -1);
+        auto rational = result.symbolTable.getRationals().find(name);
+        if (rational != result.symbolTable.getRationals().end())
+            symbolTable.setRational(name, rational->second);
+    }
+}
+
+EvaluationBudget MainWindow::getEvaluationBudget() const {
+    int iterations = settings.value(SETTING_KEY_BUDGET_ITERATIONS, SETTING_DEFAULT_BUDGET_ITERATIONS).toInt();
+    int time = settings.value(SETTING_KEY_BUDGET_TIME, SETTING_DEFAULT_BUDGET_TIME).toInt();
+    int memory = settings.value(SETTING_KEY_BUDGET_MEMORY, SETTING_DEFAULT_BUDGET_MEMORY).toInt();
+    return EvaluationBudget(std::max(iterations, 0),
+                            std::chrono::milliseconds(std::max(time, 0)),
+                            static_cast<size_t>(std::max(memory, 0)) * 1024 * 1024);
 }
 
 void MainWindow::loadSettings() {
@@ -353,15 +561,28 @@ void MainWindow::loadSettings() {
         }
     }
 
-    mpfr::mpreal::set_default_prec(settings.value(SETTING_KEY_PRECISION, SETTING_DEFAULT_PRECISION).toInt());
-    mpfr::mpreal::set_default_rnd(Serializer::deserializeRoundingMode(
-            settings.value(SETTING_KEY_ROUNDING, SETTING_DEFAULT_ROUNDING).toInt()));
+    applyEvaluationContext();
 
     if (symbolsDialog != nullptr) {
         symbolsDialog->setSymbols(symbolTable);
     }
 }
 
+void MainWindow::applyEvaluationContext() {
+    auto backend = static_cast<NumericBackend>(settings.value(SETTING_KEY_BACKEND, SETTING_DEFAULT_BACKEND).toInt());
+#ifndef QCALC_FLOAT128
+    // The settings may have been saved by a build with __float128 support.
+    if (backend == BACKEND_FLOAT128)
+        backend = BACKEND_MPFR;
+#endif
+    EvaluationContext::setCurrent(EvaluationContext(
+            settings.value(SETTING_KEY_PRECISION, SETTING_DEFAULT_PRECISION).toInt(),
+            Serializer::deserializeRoundingMode(settings.value(SETTING_KEY_ROUNDING, SETTING_DEFAULT_ROUNDING).toInt()),
+            settings.value(SETTING_KEY_PRECISION_F, SETTING_DEFAULT_PRECISION_F).toInt(),
+            Serializer::deserializeRoundingMode(settings.value(SETTING_KEY_ROUNDING_F, SETTING_DEFAULT_ROUNDING_F).toInt()),
+            backend));
+}
+
 void MainWindow::saveSettings() {
     addonManager->setActiveAddons({}); //Unload addons
 
@@ -459,6 +680,17 @@ void MainWindow::setupMenuBar() {
     actionOpenTerminal->setObjectName("actionOpenTerminal");
     actionOpenTerminal->setShortcut(QKeySequence(Qt::CTRL + Qt::Key::Key_T));
 
+    actionCancelEvaluation = new QAction(this);
+    actionCancelEvaluation->setText("Cancel Evaluation");
+    actionCancelEvaluation->setObjectName("actionCancelEvaluation");
+    actionCancelEvaluation->setShortcut(QKeySequence(Qt::Key_Escape));
+    actionCancelEvaluation->setEnabled(false);
+
+    actionWorksheet = new QAction(this);
+    actionWorksheet->setText("Worksheet");
+    actionWorksheet->setObjectName("actionWorksheet");
+    actionWorksheet->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_W));
+
     actionSettings = new QAction(this);
     actionSettings->setText("Settings");
     actionSettings->setObjectName("actionSettings");
@@ -498,6 +730,8 @@ void MainWindow::setupMenuBar() {
     actionEditSymbols->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_E));
 
     menuTools->addAction(actionOpenTerminal);
+    menuTools->addAction(actionCancelEvaluation);
+    menuTools->addAction(actionWorksheet);
 
     menuFile->addAction(actionSettings);
     menuFile->addSeparator();
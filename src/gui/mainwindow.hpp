@@ -25,21 +25,29 @@
 #include <QTableWidget>
 #include <QSpinBox>
 #include <QComboBox>
+#include <QFutureWatcher>
+#include <QThreadPool>
 
 #include <bitset>
 #include <set>
+#include <memory>
+#include <deque>
 
 #include "addon/addonmanager.hpp"
 #include "io/settings.hpp"
 
 #include "math/symboltable.hpp"
 #include "math/numeralsystem.hpp"
+#include "math/cancellationtoken.hpp"
+#include "math/evaluationbudget.hpp"
+#include "math/dependencygraph.hpp"
 
 #include "widgets/symbolseditor.hpp"
 #include "widgets/historywidget.hpp"
 
 #include "dialog/symbolsdialog.hpp"
 #include "dialog/terminaldialog.hpp"
+#include "dialog/worksheetdialog.hpp"
 
 class MainWindow : public QMainWindow {
 Q_OBJECT
@@ -90,15 +98,63 @@ public slots:
 
     void onActionOpenTerminal();
 
+    void onActionCancelEvaluation();
+
+    void onActionWorksheet();
+
     void onHistoryTextDoubleClicked(const QString &text);
 
 private:
-    QString evaluateExpression(const QString &expression);
+    struct EvaluationResult {
+        QString value;
+        QString error;
+        SymbolTable symbolTable;
+        unsigned long startRevision = 0; // The revision of the symbol table before evaluating.
+        std::shared_ptr<const DependencyGraph> dependencyGraph;
+    };
+
+    struct EvaluationRequest {
+        QString expression;
+        bool interactive;
+    };
+
+    /**
+     * Evaluate the expression on a worker thread, the result is applied by onEvaluationFinished.
+     * If an evaluation is running the request is queued until it finishes.
+     *
+     * @param expression
+     * @param interactive If true the history and the input line are updated with the result.
+     */
+    void startEvaluation(const QString &expression, bool interactive);
+
+    void startQueuedEvaluation();
+
+    /**
+     * Block until the running, cancelled and waiting evaluations have finished.
+     */
+    void waitForEvaluations();
+
+    void onEvaluationFinished(const EvaluationResult &result);
+
+    /**
+     * Apply the variables assigned by the evaluated expression
+     * while preserving the modifications made to the symbol table during the evaluation.
+     *
+     * @param result
+     */
+    void applyEvaluatedSymbols(const EvaluationResult &result);
+
+    /**
+     * @return The evaluation budget defined in the settings, the memory limit is defined in megabytes.
+     */
+    EvaluationBudget getEvaluationBudget() const;
 
     void loadSettings();
 
     void saveSettings();
 
+    void applyEvaluationContext(); // Set the evaluation context of the gui thread from the settings.
+
     void loadSymbolTablePathHistory();
 
     void saveSymbolTablePathHistory();
@@ -128,6 +184,8 @@ private:
     QAction *actionExit{};
 
     QAction *actionOpenTerminal{};
+    QAction *actionCancelEvaluation{};
+    QAction *actionWorksheet{};
 
     QAction *actionEditSymbols{};
     QAction *actionOpenSymbols{};
@@ -138,11 +196,21 @@ private:
     QAction *actionAboutQt{};
 
     SymbolsDialog *symbolsDialog = nullptr;
+    WorksheetDialog *worksheetDialog = nullptr;
 
     SymbolTable symbolTable;
 
     Settings settings;
 
+    // Runs one evaluation at a time, evaluations started while a cancelled evaluation is still running wait for it to finish.
+    QThreadPool evaluationPool;
+    QFutureWatcher<EvaluationResult> *evaluationWatcher = nullptr; // The watcher of the running evaluation.
+    CancellationToken evaluationToken;
+    std::shared_ptr<const DependencyGraph> dependencyGraph; // Reused by evaluations while the symbol definitions do not change.
+    QString evaluationExpression;
+    bool evaluationInteractive = false;
+    std::deque<EvaluationRequest> evaluationQueue; // Requested while an evaluation is running.
+
     std::set<std::string> symbolTablePathHistory;
     std::string currentSymbolTablePath; // If the currently active symboltable was loaded from a file or saved to a file this path contains the path of the symbol table file.
 
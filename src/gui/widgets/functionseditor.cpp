@@ -25,7 +25,6 @@
 #include <QApplication>
 
 //TODO:Feature: Syntax highlighting and completion for functions editor expression edit text.
-//TODO:Feature: Notify user of syntax errors in function expressions
 FunctionsEditor::FunctionsEditor(QWidget *parent) : QWidget(parent) {
     setLayout(new QVBoxLayout());
 
@@ -46,6 +45,8 @@ FunctionsEditor::FunctionsEditor(QWidget *parent) : QWidget(parent) {
 
     expressionEdit = new QTextEdit(this);
 
+    errorLabel = new QLabel(this);
+
     list->horizontalHeader()->hide();
     list->verticalHeader()->hide();
 
@@ -75,10 +76,16 @@ FunctionsEditor::FunctionsEditor(QWidget *parent) : QWidget(parent) {
     widgetLeft->layout()->setContentsMargins(0, 0, 0, 0);
     widgetLeft->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Expanding);
 
+    auto *widgetExpression = new QWidget(this);
+    widgetExpression->setLayout(new QVBoxLayout());
+    widgetExpression->layout()->addWidget(expressionEdit);
+    widgetExpression->layout()->addWidget(errorLabel);
+    widgetExpression->layout()->setContentsMargins(0, 0, 0, 0);
+
     auto *widgetTop = new QWidget(this);
     widgetTop->setLayout(new QHBoxLayout());
     widgetTop->layout()->addWidget(widgetLeft);
-    widgetTop->layout()->addWidget(expressionEdit);
+    widgetTop->layout()->addWidget(widgetExpression);
     widgetTop->layout()->setContentsMargins(0, 0, 0, 0);
 
     layout()->addWidget(widgetTop);
@@ -89,6 +96,10 @@ FunctionsEditor::FunctionsEditor(QWidget *parent) : QWidget(parent) {
 
     argsSpinBox->setMaximum(5);
 
+    errorLabel->setWordWrap(true);
+    errorLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    errorLabel->setVisible(false);
+
     connect(addPushButton, SIGNAL(pressed()), this, SLOT(onFunctionAddPressed()));
     connect(addLineEdit, SIGNAL(returnPressed()), this, SLOT(onFunctionAddPressed()));
 
@@ -127,6 +138,8 @@ void FunctionsEditor::setFunctions(const std::map<std::string, Function> &f) {
     argsSpinBox->setEnabled(false);
     argsSpinBox->setValue(0);
 
+    errorLabel->setVisible(false);
+
     rowMapping.clear();
     list->clear();
     list->setColumnCount(1);
@@ -151,6 +164,11 @@ void FunctionsEditor::setFunctions(const std::map<std::string, Function> &f) {
     connect(argEdit4, SIGNAL(editingFinished()), this, SLOT(onFunctionArgEditingFinished()));
 }
 
+void FunctionsEditor::setFunctionErrors(const std::map<std::string, std::string> &e) {
+    errors = e;
+    applyError();
+}
+
 void FunctionsEditor::setCurrentFunction(const QString &name) {
     currentFunction = name.toStdString();
     if (rowMapping.find(currentFunction) != rowMapping.end()) {
@@ -159,6 +177,7 @@ void FunctionsEditor::setCurrentFunction(const QString &name) {
     } else {
         applyArgs({});
     }
+    applyError();
 }
 
 void FunctionsEditor::onFunctionAddPressed() {
@@ -216,6 +235,7 @@ void FunctionsEditor::onTableCellActivated(int row, int column) {
     connect(argsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(onFunctionArgsSpinBoxChanged(int)));
 
     applyArgs(func.argumentNames);
+    applyError();
 
     emit onCurrentFunctionChanged(currentFunction.c_str());
 }
@@ -286,4 +306,15 @@ void FunctionsEditor::applyArgs(const std::vector<std::string> &args) {
             argEdit0->setText(args.at(0).c_str());
             break;
     }
-}
\ No newline at end of file
+}
+
+void FunctionsEditor::applyError() {
+    auto it = functions.find(currentFunction) != functions.end() ? errors.find(currentFunction) : errors.end();
+    if (it == errors.end() || it->second.empty()) {
+        errorLabel->setVisible(false);
+        errorLabel->setText("");
+    } else {
+        errorLabel->setText(("Error: " + it->second).c_str());
+        errorLabel->setVisible(true);
+    }
+}
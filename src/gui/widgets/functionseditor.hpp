@@ -26,6 +26,7 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QTextEdit>
+#include <QLabel>
 
 #include "../../math/function.hpp"
 
@@ -38,6 +39,13 @@ public slots:
 
     void setFunctions(const std::map<std::string, Function> &functions);
 
+    /**
+     * Set the validation errors of the functions, the error of the current function is shown below its expression.
+     *
+     * @param errors The errors by function name, valid functions may be omitted.
+     */
+    void setFunctionErrors(const std::map<std::string, std::string> &errors);
+
     void setCurrentFunction(const QString &name);
 
 signals:
@@ -69,8 +77,12 @@ private slots:
 private:
     void applyArgs(const std::vector<std::string> &args);
 
+    void applyError();
+
     std::map<std::string, Function> functions;
 
+    std::map<std::string, std::string> errors;
+
     std::map<std::string, int> rowMapping;
 
     std::string currentFunction;
@@ -88,6 +100,8 @@ private:
     QLineEdit *argEdit4;
 
     QTextEdit *expressionEdit;
+
+    QLabel *errorLabel;
 };
 
 #endif //QCALC_FUNCTIONSEDITOR_HPP
@@ -51,11 +51,15 @@ public:
         layout()->addWidget(scroll);
 
         container->layout()->addItem(new QSpacerItem(0, 0, QSizePolicy::Minimum, QSizePolicy::Expanding));
+
+        pendingTimer.setInterval(PENDING_INTERVAL);
+        connect(&pendingTimer, SIGNAL(timeout()), this, SLOT(updatePendingIndicator()));
     }
 
 public slots:
 
     void clear() {
+        removePendingContent();
         for (auto *p : rows) {
             delete p;
         }
@@ -70,6 +74,59 @@ public slots:
     }
 
     void addContent(const QString &expression, const QString &value) {
+        addRow(expression, value);
+    }
+
+    /**
+     * Add a row for an expression which is being evaluated,
+     * the value of the row shows a progress indicator until it is set by setPendingValue.
+     *
+     * @param expression
+     */
+    void addPendingContent(const QString &expression) {
+        removePendingContent();
+        pendingRow = rows.size();
+        pendingLabel = addRow(expression, PENDING_TEXT);
+        pendingStep = 0;
+        pendingTimer.start();
+    }
+
+    void setPendingValue(const QString &value) {
+        if (pendingLabel == nullptr)
+            return;
+        pendingLabel->setTextElided(value);
+        pendingLabel = nullptr;
+        pendingTimer.stop();
+    }
+
+    void removePendingContent() {
+        if (pendingLabel == nullptr)
+            return;
+        delete rows.at(pendingRow);
+        rows.erase(rows.begin() + pendingRow);
+        pendingLabel = nullptr;
+        pendingTimer.stop();
+    }
+
+    void setHistoryFont(const QFont &font) {
+        historyFont = font;
+    }
+
+signals:
+
+    void onTextDoubleClicked(const QString &text);
+
+private slots:
+
+    void updatePendingIndicator() {
+        if (pendingLabel == nullptr)
+            return;
+        pendingStep = (pendingStep + 1) % 4;
+        pendingLabel->setTextElided(PENDING_TEXT + QString(".").repeated(pendingStep));
+    }
+
+private:
+    HistoryLabel *addRow(const QString &expression, const QString &value) {
         auto *row = new QWidget(container);
         auto *expressionLabel = new HistoryLabel(row);
         auto *equalsLabel = new QLabel(row);
@@ -121,22 +178,23 @@ public slots:
         scroll->verticalScrollBar()->setValue(scroll->verticalScrollBar()->maximum());
 
         rows.emplace_back(row);
-    }
 
-    void setHistoryFont(const QFont &font) {
-        historyFont = font;
+        return resultLabel;
     }
 
-signals:
+    const QString PENDING_TEXT = "Evaluating";
+    static const int PENDING_INTERVAL = 250;
 
-    void onTextDoubleClicked(const QString &text);
-
-private:
     QScrollArea *scroll;
     QWidget *container;
     std::vector<QWidget *> rows;
 
     QFont historyFont;
+
+    HistoryLabel *pendingLabel = nullptr;
+    size_t pendingRow = 0;
+    int pendingStep = 0;
+    QTimer pendingTimer;
 };
 
 #endif //QCALC_HISTORYWIDGET_HPP
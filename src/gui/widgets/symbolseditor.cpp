@@ -38,6 +38,18 @@ std::map<QString, QString> convertMap(const std::map<std::string, ArithmeticType
     return ret;
 }
 
+/**
+ * @return The errors of the function definitions which were found when the functions were set in the table.
+ */
+std::map<std::string, std::string> getFunctionErrors(const SymbolTable &symbolTable) {
+    std::map<std::string, std::string> ret;
+    for (auto &p: symbolTable.getFunctionDefinitions()) {
+        if (!p.second->getError().empty())
+            ret[p.first] = p.second->getError();
+    }
+    return ret;
+}
+
 SymbolsEditor::SymbolsEditor(QWidget *parent) : QWidget(parent) {
     setLayout(new QVBoxLayout(this));
 
@@ -111,6 +123,7 @@ void SymbolsEditor::setSymbols(const SymbolTable &symtable) {
     variablesEditor->setValues(convertMap(symbolTable.getVariables(), symbolTable.getVariableDecimals()));
     constantsEditor->setValues(convertMap(symbolTable.getConstants(), symbolTable.getConstantDecimals()));
     functionsEditor->setFunctions(symbolTable.getFunctions());
+    functionsEditor->setFunctionErrors(getFunctionErrors(symbolTable));
     functionsEditor->setCurrentFunction(currentFunction);
     scriptsEditor->setScripts(symbolTable.getScripts());
 }
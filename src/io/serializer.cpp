@@ -33,6 +33,9 @@ std::string Serializer::serializeTable(const SymbolTable &table) {
         t["name"] = p.first;
         t["value"] = p.second.toString();
         t["decimals"] = table.getVariableDecimals().at(p.first);
+        auto rational = table.getRationals().find(p.first);
+        if (rational != table.getRationals().end())
+            t["rational"] = rational->second;
         tmp.emplace_back(t);
     }
     j["variables"] = tmp;
@@ -43,6 +46,9 @@ std::string Serializer::serializeTable(const SymbolTable &table) {
         t["name"] = p.first;
         t["value"] = p.second.toString();
         t["decimals"] = table.getConstantDecimals().at(p.first);
+        auto rational = table.getRationals().find(p.first);
+        if (rational != table.getRationals().end())
+            t["rational"] = rational->second;
         tmp.emplace_back(t);
     }
     j["constants"] = tmp;
@@ -58,6 +64,15 @@ std::string Serializer::serializeTable(const SymbolTable &table) {
     j["functions"] = tmp;
     tmp.clear();
 
+    for (auto &p: table.getDefinitions()) {
+        nlohmann::json t;
+        t["name"] = p.first;
+        t["expression"] = p.second;
+        tmp.emplace_back(t);
+    }
+    j["definitions"] = tmp;
+    tmp.clear();
+
     return nlohmann::to_string(j);
 }
 
@@ -77,6 +92,11 @@ SymbolTable Serializer::deserializeTable(const std::string &str) {
         }
 
         ret.setVariable(name, value, decimals);
+
+        // The exact value of variables assigned by the rational backend.
+        if (v.find("rational") != v.end()) {
+            ret.setRational(name, v["rational"].get<std::string>());
+        }
     }
 
     tmp = j["constants"].get<std::vector<nlohmann::json>>();
@@ -91,6 +111,10 @@ SymbolTable Serializer::deserializeTable(const std::string &str) {
         }
 
         ret.setConstant(name, value, decimals);
+
+        if (v.find("rational") != v.end()) {
+            ret.setRational(name, v["rational"].get<std::string>());
+        }
     }
 
     tmp = j["functions"].get<std::vector<nlohmann::json>>();
@@ -103,6 +127,16 @@ SymbolTable Serializer::deserializeTable(const std::string &str) {
         ret.setFunction(name, f);
     }
 
+    // Tables serialized before variable definitions were introduced do not contain definitions.
+    if (j.find("definitions") != j.end()) {
+        tmp = j["definitions"].get<std::vector<nlohmann::json>>();
+        for (auto &v: tmp) {
+            std::string name = v["name"];
+            std::string expression = v["expression"];
+            ret.setDefinition(name, expression);
+        }
+    }
+
     return ret;
 }
 
@@ -19,6 +19,8 @@
 
 #include <QApplication>
 
+#include <iostream>
+
 #include "gui/mainwindow.hpp"
 
 #include "pycx/interpreter.hpp"
@@ -28,6 +30,9 @@
 
 #include "io/paths.hpp"
 
+#include "math/nativecodetest.hpp"
+#include "math/vectorcodetest.hpp"
+
 std::vector<std::string> parseArgs(int argc, char *argv[]) {
     std::vector<std::string> ret;
     ret.reserve(argc);
@@ -37,7 +42,26 @@ std::vector<std::string> parseArgs(int argc, char *argv[]) {
     return ret;
 }
 
+/**
+ * Run the differential checks of the generated code against the bytecode interpreter.
+ *
+ * @return The exit code of the application, 0 if all checks passed.
+ */
+int runSelfTest() {
+    std::vector<std::string> failures;
+    NativeCodeTest::compareWithBytecode(failures);
+    VectorCodeTest::compareWithBytecode(failures);
+    for (auto &failure : failures) {
+        std::cerr << failure << std::endl;
+    }
+    return failures.empty() ? 0 : 1;
+}
+
 int main(int argc, char *argv[]) {
+    // Runs without a display so that the checks can be run by ctest.
+    if (argc > 1 && std::string(argv[1]) == "--self-test")
+        return runSelfTest();
+
     QApplication a(argc, argv);
 
     QApplication::setOrganizationName("Xenotux");
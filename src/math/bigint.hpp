@@ -0,0 +1,547 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_BIGINT_HPP
+#define QCALC_BIGINT_HPP
+
+/**
+ * An exact integer of arbitrary size stored in a gmp mpz_t.
+ *
+ * Addition, subtraction, multiplication, powers with non negative exponents, modulus, shifts
+ * and comparisons are exact. All other results are rounded to an integer with the mpfr default rounding mode,
+ * quotients and square roots exactly, the remaining functions by evaluating them with mpfr using guard bits.
+ * Values which are not finite (eg. the result of a division by zero) are represented by NaN.
+ * Results which would exceed MAX_BITS are represented by NaN instead of being computed,
+ * gmp aborts the process on results larger than its limits.
+ */
+
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+
+#include "arithmetictype.hpp"
+#include "mpfrmemory.hpp"
+
+class BigInt {
+public:
+    // The bits added to the precision of the operands when evaluating a function using mpfr.
+    static const mpfr_prec_t GUARD_BITS = 64;
+
+    // The maximum number of bits of a computed result (512 MiB), well below the limits of gmp and mpfr.
+    static const size_t MAX_BITS = static_cast<size_t>(1) << 32;
+
+    BigInt() : nan(false) {
+        mpz_init(value);
+    }
+
+    // Non integral values are truncated like the conversions of the builtin integer types.
+
+    BigInt(double v) : nan(!std::isfinite(v)) { // NOLINT(google-explicit-constructor)
+        mpz_init(value);
+        if (!nan)
+            mpz_set_d(value, v);
+    }
+
+    BigInt(int v) : BigInt(static_cast<long>(v)) {} // NOLINT(google-explicit-constructor)
+
+    BigInt(long v) : nan(false) { // NOLINT(google-explicit-constructor)
+        mpz_init_set_si(value, v);
+    }
+
+    BigInt(long long v) : nan(false) { // NOLINT(google-explicit-constructor)
+        mpz_init(value);
+        if (v >= LONG_MIN && v <= LONG_MAX) {
+            mpz_set_si(value, static_cast<long>(v));
+        } else {
+            setUnsigned(v < 0 ? 0ULL - static_cast<unsigned long long>(v) : static_cast<unsigned long long>(v));
+            if (v < 0)
+                mpz_neg(value, value);
+        }
+    }
+
+    BigInt(unsigned int v) : BigInt(static_cast<unsigned long>(v)) {} // NOLINT(google-explicit-constructor)
+
+    BigInt(unsigned long v) : nan(false) { // NOLINT(google-explicit-constructor)
+        mpz_init_set_ui(value, v);
+    }
+
+    BigInt(unsigned long long v) : nan(false) { // NOLINT(google-explicit-constructor)
+        mpz_init(value);
+        setUnsigned(v);
+    }
+
+    /**
+     * Convert the value to an integer using the mpfr default rounding mode, NaN if it would exceed MAX_BITS.
+     *
+     * @param v
+     */
+    explicit BigInt(const ArithmeticType &v) : nan(!mpfr_number_p(v.mpfr_srcptr())) {
+        if (!nan && mpfr_regular_p(v.mpfr_srcptr()) && v.get_exp() > 0)
+            nan = !checkBits(static_cast<size_t>(v.get_exp()));
+        mpz_init(value);
+        if (!nan)
+            mpfr_get_z(value, v.mpfr_srcptr(), mpfr::mpreal::get_default_rnd());
+    }
+
+    BigInt(const BigInt &other) : nan(other.nan) {
+        mpz_init_set(value, other.value);
+    }
+
+    BigInt(BigInt &&other) noexcept: nan(other.nan) {
+        // The other value keeps a valid zero.
+        mpz_init(value);
+        mpz_swap(value, other.value);
+    }
+
+    ~BigInt() {
+        mpz_clear(value);
+    }
+
+    BigInt &operator=(const BigInt &other) {
+        mpz_set(value, other.value);
+        nan = other.nan;
+        return *this;
+    }
+
+    BigInt &operator=(BigInt &&other) noexcept {
+        mpz_swap(value, other.value);
+        nan = other.nan;
+        return *this;
+    }
+
+    static BigInt NaN() {
+        BigInt ret;
+        ret.nan = true;
+        return ret;
+    }
+
+    /**
+     * Parse the decimal integer exactly.
+     *
+     * @param str
+     * @param ret
+     * @return False if the string is not a decimal integer.
+     */
+    static bool fromString(const std::string &str, BigInt &ret) {
+        ret.nan = false;
+        return mpz_set_str(ret.value, str.c_str(), 10) == 0;
+    }
+
+    ::mpz_ptr mpz_ptr() {
+        return value;
+    }
+
+    ::mpz_srcptr mpz_srcptr() const {
+        return value;
+    }
+
+    bool isNaN() const {
+        return nan;
+    }
+
+    /**
+     * @return The number of bits of the absolute value.
+     */
+    size_t getBits() const {
+        return mpz_sizeinbase(value, 2);
+    }
+
+    /**
+     * @return The value converted exactly, the precision is at least the mpfr default precision of the calling thread.
+     */
+    ArithmeticType toArithmeticType() const {
+        if (nan)
+            return ArithmeticType().setNan();
+        ArithmeticType ret(0, std::max<mpfr_prec_t>(mpfr::mpreal::get_default_prec(),
+                                                    static_cast<mpfr_prec_t>(getBits())));
+        mpfr_set_z(ret.mpfr_ptr(), value, MPFR_RNDN);
+        return ret;
+    }
+
+    std::string toString() const {
+        if (nan)
+            return "nan";
+        std::string ret(mpz_sizeinbase(value, 10) + 2, '\0');
+        mpz_get_str(&ret[0], 10, value);
+        ret.resize(ret.find('\0'));
+        return ret;
+    }
+
+    double toDouble() const {
+        return nan ? std::numeric_limits<double>::quiet_NaN() : mpz_get_d(value);
+    }
+
+    long toLong() const {
+        return nan || !mpz_fits_slong_p(value) ? 0 : mpz_get_si(value);
+    }
+
+    long long toLLong() const {
+        if (nan)
+            return 0;
+        if (mpz_fits_slong_p(value))
+            return mpz_get_si(value);
+        return static_cast<long long>(toArithmeticType().toLLong());
+    }
+
+    explicit operator double() const {
+        return toDouble();
+    }
+
+    explicit operator int() const {
+        return static_cast<int>(toLong());
+    }
+
+    explicit operator long long() const {
+        return toLLong();
+    }
+
+    explicit operator std::size_t() const {
+        return nan || !mpz_fits_ulong_p(value) ? 0 : mpz_get_ui(value);
+    }
+
+    BigInt operator-() const {
+        BigInt ret(*this);
+        mpz_neg(ret.value, ret.value);
+        return ret;
+    }
+
+    BigInt &operator+=(const BigInt &other) {
+        return *this = *this + other;
+    }
+
+    BigInt &operator-=(const BigInt &other) {
+        return *this = *this - other;
+    }
+
+    BigInt &operator*=(const BigInt &other) {
+        return *this = *this * other;
+    }
+
+    BigInt &operator/=(const BigInt &other) {
+        return *this = *this / other;
+    }
+
+    friend BigInt operator+(const BigInt &a, const BigInt &b) {
+        return apply(mpz_add, a, b);
+    }
+
+    friend BigInt operator-(const BigInt &a, const BigInt &b) {
+        return apply(mpz_sub, a, b);
+    }
+
+    friend BigInt operator*(const BigInt &a, const BigInt &b) {
+        return apply(mpz_mul, a, b);
+    }
+
+    /**
+     * The quotient is rounded with the mpfr default rounding mode, a division by zero returns NaN.
+     */
+    friend BigInt operator/(const BigInt &a, const BigInt &b) {
+        if (a.nan || b.nan || mpz_sgn(b.value) == 0)
+            return NaN();
+        BigInt ret;
+        divide(ret.value, a.value, b.value, mpfr::mpreal::get_default_rnd());
+        return ret;
+    }
+
+    /**
+     * The remainder of the quotient truncated toward zero (Same as fmod), a division by zero returns NaN.
+     */
+    friend BigInt operator%(const BigInt &a, const BigInt &b) {
+        if (a.nan || b.nan || mpz_sgn(b.value) == 0)
+            return NaN();
+        return apply(mpz_tdiv_r, a, b);
+    }
+
+    // Comparisons with NaN are false like the comparisons of floating point values.
+
+    friend bool operator==(const BigInt &a, const BigInt &b) {
+        return !a.nan && !b.nan && mpz_cmp(a.value, b.value) == 0;
+    }
+
+    friend bool operator!=(const BigInt &a, const BigInt &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const BigInt &a, const BigInt &b) {
+        return !a.nan && !b.nan && mpz_cmp(a.value, b.value) < 0;
+    }
+
+    friend bool operator>(const BigInt &a, const BigInt &b) {
+        return !a.nan && !b.nan && mpz_cmp(a.value, b.value) > 0;
+    }
+
+    friend bool operator<=(const BigInt &a, const BigInt &b) {
+        return !a.nan && !b.nan && mpz_cmp(a.value, b.value) <= 0;
+    }
+
+    friend bool operator>=(const BigInt &a, const BigInt &b) {
+        return !a.nan && !b.nan && mpz_cmp(a.value, b.value) >= 0;
+    }
+
+    /**
+     * @return The result of the gmp function, NaN if the operand is NaN.
+     */
+    static BigInt apply(void (*function)(::mpz_ptr, ::mpz_srcptr), const BigInt &v) {
+        if (v.nan)
+            return NaN();
+        BigInt ret;
+        function(ret.value, v.value);
+        return ret;
+    }
+
+    /**
+     * @return The result of the gmp function, NaN if an operand is NaN.
+     */
+    static BigInt apply(void (*function)(::mpz_ptr, ::mpz_srcptr, ::mpz_srcptr), const BigInt &a, const BigInt &b) {
+        if (a.nan || b.nan)
+            return NaN();
+        BigInt ret;
+        function(ret.value, a.value, b.value);
+        return ret;
+    }
+
+    /**
+     * Evaluate the mpfr function with the operand converted exactly and round the result to an integer
+     * with the mpfr default rounding mode.
+     *
+     * The precision of the result covers the integral digits of the result plus GUARD_BITS.
+     *
+     * @return The rounded result, NaN if the result is not finite.
+     */
+    static BigInt apply(int (*function)(::mpfr_ptr, ::mpfr_srcptr, mpfr_rnd_t), const BigInt &v) {
+        if (v.nan)
+            return NaN();
+        const ArithmeticType x = v.toArithmeticType();
+        return evaluate([&](::mpfr_ptr ret) { function(ret, x.mpfr_srcptr(), MPFR_RNDN); }, v.getBits());
+    }
+
+    /**
+     * @return The rounded result of the mpfr function, NaN if an operand is NaN or the result is not finite.
+     */
+    static BigInt apply(int (*function)(::mpfr_ptr, ::mpfr_srcptr, ::mpfr_srcptr, mpfr_rnd_t),
+                        const BigInt &a,
+                        const BigInt &b) {
+        if (a.nan || b.nan)
+            return NaN();
+        const ArithmeticType x = a.toArithmeticType();
+        const ArithmeticType y = b.toArithmeticType();
+        return evaluate([&](::mpfr_ptr ret) { function(ret, x.mpfr_srcptr(), y.mpfr_srcptr(), MPFR_RNDN); },
+                        std::max(a.getBits(), b.getBits()));
+    }
+
+    /**
+     * Divide and round the quotient with the passed rounding mode.
+     */
+    static void divide(::mpz_ptr q, ::mpz_srcptr a, ::mpz_srcptr b, mpfr_rnd_t rounding) {
+        switch (rounding) {
+            case MPFR_RNDZ:
+                mpz_tdiv_q(q, a, b);
+                return;
+            case MPFR_RNDD:
+                mpz_fdiv_q(q, a, b);
+                return;
+            case MPFR_RNDU:
+                mpz_cdiv_q(q, a, b);
+                return;
+            default:
+                break;
+        }
+
+        mpz_t r;
+        mpz_init(r);
+        mpz_tdiv_qr(q, r, a, b);
+        if (mpz_sgn(r) != 0) {
+            bool away;
+            if (rounding == MPFR_RNDA) {
+                away = true;
+            } else {
+                // Round to nearest, ties to even.
+                mpz_mul_2exp(r, r, 1);
+                int cmp = mpz_cmpabs(r, b);
+                away = cmp > 0 || (cmp == 0 && mpz_odd_p(q));
+            }
+            if (away) {
+                if (mpz_sgn(a) == mpz_sgn(b))
+                    mpz_add_ui(q, q, 1);
+                else
+                    mpz_sub_ui(q, q, 1);
+            }
+        }
+        mpz_clear(r);
+    }
+
+    /**
+     * @return The square root rounded with the mpfr default rounding mode, NaN if the value is negative.
+     */
+    static BigInt sqrt(const BigInt &v) {
+        if (v.nan || mpz_sgn(v.value) < 0)
+            return NaN();
+
+        BigInt ret;
+        mpz_t r;
+        mpz_init(r);
+        mpz_sqrtrem(ret.value, r, v.value);
+        if (mpz_sgn(r) != 0) {
+            bool up;
+            switch (mpfr::mpreal::get_default_rnd()) {
+                case MPFR_RNDZ:
+                case MPFR_RNDD:
+                    up = false;
+                    break;
+                case MPFR_RNDU:
+                case MPFR_RNDA:
+                    up = true;
+                    break;
+                default:
+                    // The root is above q + 0.5 if the remainder v - q^2 is larger than q, ties are impossible.
+                    up = mpz_cmp(r, ret.value) > 0;
+                    break;
+            }
+            if (up)
+                mpz_add_ui(ret.value, ret.value, 1);
+        }
+        mpz_clear(r);
+        return ret;
+    }
+
+    /**
+     * @return The power, exact if the exponent is not negative. NaN if the result would exceed MAX_BITS.
+     * @throws std::runtime_error If the result would exceed the memory limit of the thread.
+     */
+    static BigInt pow(const BigInt &base, const BigInt &exponent) {
+        if (base.nan || exponent.nan)
+            return NaN();
+        if (mpz_sgn(exponent.value) < 0)
+            return apply(mpfr_pow, base, exponent);
+        if (mpz_cmpabs_ui(base.value, 1) <= 0) {
+            // The powers of 0, 1 and -1 do not grow with the exponent.
+            if (mpz_sgn(base.value) == 0)
+                return BigInt(mpz_sgn(exponent.value) == 0 ? 1 : 0);
+            return BigInt(mpz_sgn(base.value) < 0 && mpz_odd_p(exponent.value) ? -1 : 1);
+        }
+        if (!mpz_fits_ulong_p(exponent.value))
+            return NaN();
+        unsigned long e = mpz_get_ui(exponent.value);
+        size_t bits = base.getBits();
+        if (e > MAX_BITS / bits || !checkBits(bits * e))
+            return NaN();
+        BigInt ret;
+        mpz_pow_ui(ret.value, base.value, e);
+        return ret;
+    }
+
+    /**
+     * @return The value multiplied by 2 to the power of the exponent, rounded if the exponent is negative.
+     * NaN if the result would exceed MAX_BITS.
+     * @throws std::runtime_error If the result would exceed the memory limit of the thread.
+     */
+    static BigInt shift(const BigInt &v, const BigInt &exponent) {
+        if (v.nan || exponent.nan || !mpz_fits_slong_p(exponent.value))
+            return NaN();
+        if (mpz_sgn(v.value) == 0)
+            return v;
+        long e = mpz_get_si(exponent.value);
+        size_t bits = v.getBits();
+        BigInt ret;
+        if (e >= 0) {
+            if (static_cast<unsigned long>(e) > MAX_BITS || !checkBits(bits + static_cast<size_t>(e)))
+                return NaN();
+            mpz_mul_2exp(ret.value, v.value, static_cast<mp_bitcnt_t>(e));
+        } else {
+            // Every divisor larger than 4 times the value gives a quotient in (-1/4, 1/4) which rounds the same.
+            mp_bitcnt_t divisorBits = std::min<mp_bitcnt_t>(0UL - static_cast<unsigned long>(e), bits + 2);
+            BigInt divisor;
+            mpz_setbit(divisor.value, divisorBits);
+            divide(ret.value, v.value, divisor.value, mpfr::mpreal::get_default_rnd());
+        }
+        return ret;
+    }
+
+    /**
+     * Check the estimated size of a result before computing it.
+     *
+     * @param bits The estimated number of bits of the result.
+     * @return False if the result would exceed MAX_BITS.
+     * @throws std::runtime_error If the result would exceed the memory limit of the thread (See MpfrMemory::checkRequest).
+     */
+    static bool checkBits(size_t bits) {
+        if (bits > MAX_BITS)
+            return false;
+        MpfrMemory::checkRequest(bits / 8);
+        return true;
+    }
+
+private:
+    void setUnsigned(unsigned long long v) {
+        mpz_import(value, 1, 1, sizeof(v), 0, 0, &v);
+    }
+
+    template<typename F>
+    static BigInt evaluate(F function, size_t operandBits) {
+        mpfr_prec_t precision = std::max<mpfr_prec_t>(mpfr::mpreal::get_default_prec(),
+                                                      static_cast<mpfr_prec_t>(operandBits)) + GUARD_BITS;
+        ArithmeticType ret(0, precision);
+        function(ret.mpfr_ptr());
+        if (mpfr_regular_p(ret.mpfr_srcptr()) && ret.get_exp() + GUARD_BITS > precision) {
+            // The integral digits of the result exceed the precision.
+            if (!checkBits(static_cast<size_t>(ret.get_exp())))
+                return NaN();
+            ret.set_prec(ret.get_exp() + GUARD_BITS);
+            function(ret.mpfr_ptr());
+        }
+        return BigInt(ret);
+    }
+
+    mpz_t value;
+    bool nan;
+};
+
+namespace std {
+    template<>
+    class numeric_limits<BigInt> {
+    public:
+        static const bool is_specialized = true;
+        static const bool is_signed = true;
+        static const bool is_integer = true;
+        static const bool is_exact = true;
+        static const bool is_bounded = false;
+        static const bool has_infinity = false;
+        static const bool has_quiet_NaN = true;
+        static const bool has_signaling_NaN = false;
+        static const int radix = 2;
+
+        static BigInt epsilon() noexcept { return 0; }
+
+        static BigInt round_error() noexcept { return 0; }
+
+        // Exprtk defines the inf constant using infinity().
+        static BigInt infinity() noexcept { return BigInt::NaN(); }
+
+        static BigInt quiet_NaN() noexcept { return BigInt::NaN(); }
+
+        static BigInt signaling_NaN() noexcept { return BigInt::NaN(); }
+    };
+}
+
+#endif //QCALC_BIGINT_HPP
@@ -0,0 +1,722 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_BYTECODE_HPP
+#define QCALC_BYTECODE_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+#include "numericbackend.hpp"
+
+/**
+ * An expression lowered to a linear register based bytecode, evaluated by a loop over a flat instruction array.
+ *
+ * The operands of the instructions are indices into one contiguous table of operand pointers,
+ * which point to the registers of the bytecode (literals, intermediate results and local variables)
+ * or to the storage of the variables and constants of the exprtk symbol table the expression was lowered against.
+ * Intermediate registers are reused once their value has been consumed and constant subexpressions are folded.
+ *
+ * Only single statements of arithmetic are lowered: literals, variables and constants, + - * / % ^,
+ * the ordering comparisons, the built in functions with one or two arguments
+ * and ~{} blocks which declare local variables before the result (as produced by the ExpressionOptimizer).
+ * Operators have the precedence and associativity of exprtk and integer powers are expanded like exprtk does,
+ * the algebraic simplifications of exprtk (eg. x * 0 -> 0) are not applied, which only makes a difference
+ * for infinite or NaN operands.
+ *
+ * Everything else, including loops, assignments, equality comparisons and calls of user functions or scripts,
+ * is not lowered and has to be evaluated by exprtk.
+ *
+ * @tparam T The arithmetic type used by exprtk.
+ */
+template<typename T>
+class Bytecode {
+public:
+    Bytecode() = default;
+
+    // The operand table points into the registers, moving keeps the storage of the registers.
+    Bytecode(const Bytecode &other) = delete;
+
+    Bytecode &operator=(const Bytecode &other) = delete;
+
+    Bytecode(Bytecode &&other) = default;
+
+    Bytecode &operator=(Bytecode &&other) = default;
+
+    /**
+     * @param expr
+     * @param symbols The symbol table which contains the variables and constants referenced by the expression,
+     * the symbols must not be removed while the bytecode is in use.
+     * @param ret Set to the lowered expression.
+     * @param fold False to evaluate constant subexpressions with the instructions instead of folding them,
+     * so that every rounding error of the expression is made by an instruction (See BytecodeEnclosure).
+     * @return False if the expression contains constructs which cannot be lowered.
+     */
+    static bool lower(const std::string &expr, exprtk::symbol_table<T> &symbols, Bytecode &ret, bool fold = true) {
+        Lowering lowering(symbols, fold);
+        return lowering.lower(expr, ret);
+    }
+
+    bool empty() const {
+        return operands.empty();
+    }
+
+    size_t getInstructionCount() const {
+        return instructions.size();
+    }
+
+    T evaluate() {
+        T *const *slots = operands.data();
+        for (auto &instruction : instructions) {
+            *slots[instruction.target] = compute(instruction, *slots[instruction.a], *slots[instruction.b]);
+        }
+        return *slots[result];
+    }
+
+    enum OpCode : uint8_t {
+        OP_COPY,
+        OP_NEG,
+        OP_ADD,
+        OP_SUB,
+        OP_MUL,
+        OP_DIV,
+        OP_MOD,
+        OP_POW,
+        OP_IPOW,
+        OP_IPOWINV,
+        OP_LT,
+        OP_LTE,
+        OP_GT,
+        OP_GTE,
+        OP_UNARY,
+        OP_BINARY
+    };
+
+    struct Instruction {
+        OpCode op;
+        uint32_t target;
+        uint32_t a;
+        uint32_t b;
+        uint32_t extra; // The exponent of integer powers or the index of the called function.
+    };
+
+    struct UnaryFunction {
+        const char *name;
+
+        T (*function)(const T);
+    };
+
+    struct BinaryFunction {
+        const char *name;
+
+        T (*function)(const T, const T);
+    };
+
+    static const std::vector<UnaryFunction> &getUnaryFunctions() {
+        static const std::vector<UnaryFunction> functions{
+                {"abs",      &exprtk::details::numeric::abs<T>},
+                {"acos",     &exprtk::details::numeric::acos<T>},
+                {"acosh",    &exprtk::details::numeric::acosh<T>},
+                {"asin",     &exprtk::details::numeric::asin<T>},
+                {"asinh",    &exprtk::details::numeric::asinh<T>},
+                {"atan",     &exprtk::details::numeric::atan<T>},
+                {"atanh",    &exprtk::details::numeric::atanh<T>},
+                {"ceil",     &exprtk::details::numeric::ceil<T>},
+                {"cos",      &exprtk::details::numeric::cos<T>},
+                {"cosh",     &exprtk::details::numeric::cosh<T>},
+                {"cot",      &exprtk::details::numeric::cot<T>},
+                {"csc",      &exprtk::details::numeric::csc<T>},
+                {"deg2grad", &exprtk::details::numeric::d2g<T>},
+                {"deg2rad",  &exprtk::details::numeric::d2r<T>},
+                {"erf",      &exprtk::details::numeric::erf<T>},
+                {"erfc",     &exprtk::details::numeric::erfc<T>},
+                {"exp",      &exprtk::details::numeric::exp<T>},
+                {"expm1",    &exprtk::details::numeric::expm1<T>},
+                {"floor",    &exprtk::details::numeric::floor<T>},
+                {"frac",     &exprtk::details::numeric::frac<T>},
+                {"grad2deg", &exprtk::details::numeric::g2d<T>},
+                {"log",      &exprtk::details::numeric::log<T>},
+                {"log10",    &exprtk::details::numeric::log10<T>},
+                {"log1p",    &exprtk::details::numeric::log1p<T>},
+                {"log2",     &exprtk::details::numeric::log2<T>},
+                {"ncdf",     &exprtk::details::numeric::ncdf<T>},
+                {"rad2deg",  &exprtk::details::numeric::r2d<T>},
+                {"round",    &exprtk::details::numeric::round<T>},
+                {"sec",      &exprtk::details::numeric::sec<T>},
+                {"sgn",      &exprtk::details::numeric::sgn<T>},
+                {"sin",      &exprtk::details::numeric::sin<T>},
+                {"sinc",     &exprtk::details::numeric::sinc<T>},
+                {"sinh",     &exprtk::details::numeric::sinh<T>},
+                {"sqrt",     &exprtk::details::numeric::sqrt<T>},
+                {"tan",      &exprtk::details::numeric::tan<T>},
+                {"tanh",     &exprtk::details::numeric::tanh<T>},
+                {"trunc",    &exprtk::details::numeric::trunc<T>}
+        };
+        return functions;
+    }
+
+    static const std::vector<BinaryFunction> &getBinaryFunctions() {
+        static const std::vector<BinaryFunction> functions{
+                {"atan2",  &exprtk::details::numeric::atan2<T>},
+                {"hypot",  &exprtk::details::numeric::hypot<T>},
+                {"logn",   &exprtk::details::numeric::logn<T>},
+                {"root",   &exprtk::details::numeric::root<T>},
+                {"roundn", &exprtk::details::numeric::roundn<T>}
+        };
+        return functions;
+    }
+
+    const std::vector<Instruction> &getInstructions() const {
+        return instructions;
+    }
+
+    /**
+     * @return The operand table, the operands of the instructions are indices into this table.
+     */
+    const std::vector<T *> &getOperands() const {
+        return operands;
+    }
+
+    /**
+     * @return The index of the operand which holds the result after evaluating the instructions.
+     */
+    uint32_t getResult() const {
+        return result;
+    }
+
+    /**
+     * The operands with lower indices than the number of registers are registers,
+     * the remaining operands are the variables and constants of the symbol table.
+     *
+     * @return The number of registers.
+     */
+    size_t getRegisterCount() const {
+        return registers.size();
+    }
+
+    /**
+     * @return For each register the number as written in the expression if the register holds a literal
+     * which was not folded, otherwise an empty string.
+     */
+    const std::vector<std::string> &getLiterals() const {
+        return literals;
+    }
+
+private:
+    /**
+     * Same as exprtk::details::numeric::fast_exp which exprtk uses for integer powers.
+     */
+    static T power(const T &v, uint32_t p) {
+        switch (p) {
+            case 0:
+                return T(1);
+            case 1:
+                return v;
+            case 2:
+                return v * v;
+            case 3:
+                return v * v * v;
+            case 4: {
+                T v2 = v * v;
+                return v2 * v2;
+            }
+            case 5:
+                return power(v, 4) * v;
+            case 6: {
+                T v3 = power(v, 3);
+                return v3 * v3;
+            }
+            case 7:
+                return power(v, 6) * v;
+            case 8: {
+                T v4 = power(v, 4);
+                return v4 * v4;
+            }
+            case 9:
+                return power(v, 8) * v;
+            case 10: {
+                T v5 = power(v, 5);
+                return v5 * v5;
+            }
+            default: {
+                T l = T(1);
+                T b = v;
+                while (p) {
+                    if (p & 1u) {
+                        l *= b;
+                        --p;
+                    }
+                    b *= b;
+                    p >>= 1u;
+                }
+                return l;
+            }
+        }
+    }
+
+    static T compute(const Instruction &instruction, const T &x, const T &y) {
+        switch (instruction.op) {
+            case OP_COPY:
+                return x;
+            case OP_NEG:
+                return -x;
+            case OP_ADD:
+                return x + y;
+            case OP_SUB:
+                return x - y;
+            case OP_MUL:
+                return x * y;
+            case OP_DIV:
+                return x / y;
+            case OP_MOD:
+                return exprtk::details::numeric::modulus(x, y);
+            case OP_POW:
+                return exprtk::details::numeric::pow(x, y);
+            case OP_IPOW:
+                return power(x, instruction.extra);
+            case OP_IPOWINV:
+                return T(1) / power(x, instruction.extra);
+            case OP_LT:
+                return x < y ? T(1) : T(0);
+            case OP_LTE:
+                return x <= y ? T(1) : T(0);
+            case OP_GT:
+                return x > y ? T(1) : T(0);
+            case OP_GTE:
+                return x >= y ? T(1) : T(0);
+            case OP_UNARY:
+                return getUnaryFunctions()[instruction.extra].function(x);
+            case OP_BINARY:
+                return getBinaryFunctions()[instruction.extra].function(x, y);
+        }
+        return x;
+    }
+
+    /**
+     * Recursive descent parser over the exprtk tokens which emits the instructions.
+     */
+    class Lowering {
+    public:
+        Lowering(exprtk::symbol_table<T> &symbols, bool fold) : symbols(symbols), fold(fold) {}
+
+        bool lower(const std::string &expr, Bytecode &ret) {
+            exprtk::lexer::generator generator;
+            if (!generator.process(expr))
+                return false;
+            for (size_t i = 0; i < generator.size(); i++) {
+                tokens.emplace_back(generator[i]);
+            }
+
+            // Trailing statement separators do not change the value.
+            removeSeparators();
+
+            if (tokens.size() > 2
+                && isSymbol(0, "~")
+                && tokens[1].type == Token::e_lcrlbracket
+                && tokens.back().type == Token::e_rcrlbracket) {
+                tokens.pop_back();
+                removeSeparators();
+                position = 2;
+                while (isSymbol(position, "var")) {
+                    if (!parseDeclaration())
+                        return false;
+                }
+            }
+
+            Operand value;
+            if (!parseExpression(LEVEL_NONE, value) || position != tokens.size())
+                return false;
+
+            Bytecode bytecode;
+            bytecode.registers = registers;
+            bytecode.literals = literals;
+            bytecode.literals.resize(registers.size());
+            for (auto &v : bytecode.registers) {
+                bytecode.operands.emplace_back(&v);
+            }
+            for (auto *v : externals) {
+                bytecode.operands.emplace_back(v);
+            }
+            for (auto &v : instructions) {
+                bytecode.instructions.push_back({v.op, slot(v.target), slot(v.a), slot(v.b), v.extra});
+            }
+            bytecode.result = slot(value);
+            ret = std::move(bytecode);
+            return true;
+        }
+
+    private:
+        typedef exprtk::lexer::token Token;
+
+        // The precedence levels of exprtk.
+        enum Level {
+            LEVEL_NONE = 0,
+            LEVEL_COMPARISON = 5,
+            LEVEL_COMPARISON_RIGHT = 6,
+            LEVEL_ADDITION = 7,
+            LEVEL_ADDITION_RIGHT = 8,
+            LEVEL_MULTIPLICATION = 10,
+            LEVEL_MULTIPLICATION_RIGHT = 11,
+            LEVEL_POWER = 12,
+            LEVEL_UNARY_PLUS = 13
+        };
+
+        enum Kind {
+            LITERAL,
+            TEMPORARY,
+            LOCAL,
+            EXTERNAL
+        };
+
+        struct Operand {
+            Kind kind = LITERAL;
+            uint32_t index = 0;
+        };
+
+        struct PendingInstruction {
+            OpCode op;
+            Operand target;
+            Operand a;
+            Operand b;
+            uint32_t extra;
+        };
+
+        exprtk::symbol_table<T> &symbols;
+        bool fold;
+
+        std::vector<Token> tokens;
+        size_t position = 0;
+
+        std::vector<T> registers;
+        std::vector<std::string> literals; // The text of the literal registers, indexed like the registers.
+        std::vector<uint32_t> freeRegisters; // The temporary registers whose value has been consumed.
+        std::vector<T *> externals;
+        std::map<std::string, Operand> locals; // The local variables by lower case name.
+        std::vector<PendingInstruction> instructions;
+
+        uint32_t slot(const Operand &operand) const {
+            if (operand.kind == EXTERNAL)
+                return static_cast<uint32_t>(registers.size()) + operand.index;
+            return operand.index;
+        }
+
+        static std::string toLower(const std::string &str) {
+            std::string ret = str;
+            std::transform(ret.begin(), ret.end(), ret.begin(), [](unsigned char c) { return std::tolower(c); });
+            return ret;
+        }
+
+        void removeSeparators() {
+            while (!tokens.empty() && tokens.back().type == Token::e_eof)
+                tokens.pop_back();
+        }
+
+        bool isSymbol(size_t index, const char *name) const {
+            return index < tokens.size()
+                   && tokens[index].type == Token::e_symbol
+                   && exprtk::details::imatch(tokens[index].value, name);
+        }
+
+        bool isType(typename Token::token_type type) const {
+            return position < tokens.size() && tokens[position].type == type;
+        }
+
+        Operand literal(const T &value, const std::string &text = "") {
+            registers.push_back(value);
+            literals.resize(registers.size());
+            literals.back() = text;
+            return {LITERAL, static_cast<uint32_t>(registers.size() - 1)};
+        }
+
+        Operand allocate(Kind kind) {
+            if (kind == TEMPORARY && !freeRegisters.empty()) {
+                uint32_t index = freeRegisters.back();
+                freeRegisters.pop_back();
+                return {TEMPORARY, index};
+            }
+            registers.push_back(T(0));
+            return {kind, static_cast<uint32_t>(registers.size() - 1)};
+        }
+
+        void release(const Operand &operand) {
+            if (operand.kind == TEMPORARY
+                && std::find(freeRegisters.begin(), freeRegisters.end(), operand.index) == freeRegisters.end())
+                freeRegisters.push_back(operand.index);
+        }
+
+        /**
+         * Emit an instruction or fold it if all operands are literals.
+         */
+        Operand emit(OpCode op, const Operand &a, const Operand &b, uint32_t extra = 0) {
+            if (fold && a.kind == LITERAL && b.kind == LITERAL) {
+                Instruction instruction{op, 0, 0, 0, extra};
+                return literal(compute(instruction, registers.at(a.index), registers.at(b.index)));
+            }
+            release(a);
+            release(b);
+            Operand target = allocate(TEMPORARY);
+            instructions.push_back({op, target, a, b, extra});
+            return target;
+        }
+
+        bool parseDeclaration() {
+            position++;
+            if (!isType(Token::e_symbol))
+                return false;
+            std::string name = toLower(tokens[position].value);
+            if (locals.find(name) != locals.end() || symbols.symbol_exists(name))
+                return false;
+            position++;
+            if (!isType(Token::e_assign))
+                return false;
+            position++;
+
+            Operand value;
+            if (!parseExpression(LEVEL_NONE, value) || !isType(Token::e_eof))
+                return false;
+            position++;
+
+            if (value.kind == LITERAL) {
+                locals[name] = value;
+            } else {
+                Operand local = allocate(LOCAL);
+                release(value);
+                instructions.push_back({OP_COPY, local, value, value, 0});
+                locals[name] = local;
+            }
+            return true;
+        }
+
+        bool parseExpression(int precedence, Operand &ret) {
+            Operand left;
+            if (!parseBranch(left))
+                return false;
+            while (position < tokens.size()) {
+                OpCode op;
+                int leftLevel;
+                int rightLevel;
+                switch (tokens[position].type) {
+                    case Token::e_lt:
+                        op = OP_LT;
+                        leftLevel = LEVEL_COMPARISON;
+                        rightLevel = LEVEL_COMPARISON_RIGHT;
+                        break;
+                    case Token::e_lte:
+                        op = OP_LTE;
+                        leftLevel = LEVEL_COMPARISON;
+                        rightLevel = LEVEL_COMPARISON_RIGHT;
+                        break;
+                    case Token::e_gt:
+                        op = OP_GT;
+                        leftLevel = LEVEL_COMPARISON;
+                        rightLevel = LEVEL_COMPARISON_RIGHT;
+                        break;
+                    case Token::e_gte:
+                        op = OP_GTE;
+                        leftLevel = LEVEL_COMPARISON;
+                        rightLevel = LEVEL_COMPARISON_RIGHT;
+                        break;
+                    case Token::e_add:
+                        op = OP_ADD;
+                        leftLevel = LEVEL_ADDITION;
+                        rightLevel = LEVEL_ADDITION_RIGHT;
+                        break;
+                    case Token::e_sub:
+                        op = OP_SUB;
+                        leftLevel = LEVEL_ADDITION;
+                        rightLevel = LEVEL_ADDITION_RIGHT;
+                        break;
+                    case Token::e_mul:
+                        op = OP_MUL;
+                        leftLevel = LEVEL_MULTIPLICATION;
+                        rightLevel = LEVEL_MULTIPLICATION_RIGHT;
+                        break;
+                    case Token::e_div:
+                        op = OP_DIV;
+                        leftLevel = LEVEL_MULTIPLICATION;
+                        rightLevel = LEVEL_MULTIPLICATION_RIGHT;
+                        break;
+                    case Token::e_mod:
+                        op = OP_MOD;
+                        leftLevel = LEVEL_MULTIPLICATION;
+                        rightLevel = LEVEL_MULTIPLICATION_RIGHT;
+                        break;
+                    case Token::e_pow:
+                        op = OP_POW;
+                        leftLevel = LEVEL_POWER;
+                        rightLevel = LEVEL_POWER;
+                        break;
+                    default:
+                        // Closing brackets, separators and commas end the expression, anything else is not supported.
+                        ret = left;
+                        return true;
+                }
+                if (leftLevel < precedence)
+                    break;
+                position++;
+                Operand right;
+                if (!parseExpression(rightLevel, right))
+                    return false;
+                left = op == OP_POW ? emitPower(left, right) : emit(op, left, right);
+            }
+            ret = left;
+            return true;
+        }
+
+        /**
+         * Integer powers with a literal exponent are expanded into multiplications like exprtk does.
+         */
+        Operand emitPower(const Operand &base, const Operand &exponent) {
+            if ((fold && base.kind == LITERAL) || exponent.kind != LITERAL)
+                return emit(OP_POW, base, exponent);
+            const T c = registers.at(exponent.index);
+            if (!(exprtk::details::numeric::abs(c) <= T(60)) || !exprtk::details::numeric::is_integer(c))
+                return emit(OP_POW, base, exponent);
+            auto p = static_cast<uint32_t>(exprtk::details::numeric::to_int32(exprtk::details::numeric::abs(c)));
+            if (p == 0) {
+                release(base);
+                return literal(T(1));
+            }
+            return emit(c >= T(0) ? OP_IPOW : OP_IPOWINV, base, base, p);
+        }
+
+        bool parseBranch(Operand &ret) {
+            if (position >= tokens.size())
+                return false;
+            const Token &token = tokens[position];
+            switch (token.type) {
+                case Token::e_number: {
+                    T value;
+                    if (!exprtk::details::string_to_real(token.value, value))
+                        return false;
+                    position++;
+                    ret = literal(value, token.value);
+                    return true;
+                }
+                case Token::e_symbol:
+                    return parseSymbol(ret);
+                case Token::e_lbracket: {
+                    position++;
+                    if (!parseExpression(LEVEL_NONE, ret) || !isType(Token::e_rbracket))
+                        return false;
+                    position++;
+                    return true;
+                }
+                case Token::e_sub: {
+                    position++;
+                    Operand operand;
+                    if (!parseExpression(LEVEL_MULTIPLICATION_RIGHT, operand))
+                        return false;
+                    ret = emit(OP_NEG, operand, operand);
+                    return true;
+                }
+                case Token::e_add:
+                    position++;
+                    return parseExpression(LEVEL_UNARY_PLUS, ret);
+                default:
+                    return false;
+            }
+        }
+
+        bool parseArguments(std::vector<Operand> &arguments) {
+            position++;
+            if (!isType(Token::e_lbracket))
+                return false;
+            position++;
+            while (true) {
+                Operand argument;
+                if (!parseExpression(LEVEL_NONE, argument))
+                    return false;
+                arguments.push_back(argument);
+                if (isType(Token::e_rbracket)) {
+                    position++;
+                    return true;
+                }
+                if (!isType(Token::e_comma))
+                    return false;
+                position++;
+            }
+        }
+
+        bool parseSymbol(Operand &ret) {
+            std::string name = toLower(tokens[position].value);
+
+            if (position + 1 < tokens.size() && tokens[position + 1].type == Token::e_lbracket) {
+                std::vector<Operand> arguments;
+                if (!parseArguments(arguments))
+                    return false;
+                if (arguments.size() == 1) {
+                    auto &functions = getUnaryFunctions();
+                    for (size_t i = 0; i < functions.size(); i++) {
+                        if (name == functions[i].name) {
+                            ret = emit(OP_UNARY, arguments[0], arguments[0], static_cast<uint32_t>(i));
+                            return true;
+                        }
+                    }
+                } else if (arguments.size() == 2) {
+                    if (name == "pow") {
+                        ret = emitPower(arguments[0], arguments[1]);
+                        return true;
+                    } else if (name == "mod") {
+                        ret = emit(OP_MOD, arguments[0], arguments[1]);
+                        return true;
+                    }
+                    auto &functions = getBinaryFunctions();
+                    for (size_t i = 0; i < functions.size(); i++) {
+                        if (name == functions[i].name) {
+                            ret = emit(OP_BINARY, arguments[0], arguments[1], static_cast<uint32_t>(i));
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            position++;
+
+            auto local = locals.find(name);
+            if (local != locals.end()) {
+                ret = local->second;
+                return true;
+            }
+
+            auto *variable = symbols.get_variable(name);
+            if (variable == nullptr)
+                return false;
+            T *storage = &variable->ref();
+            auto it = std::find(externals.begin(), externals.end(), storage);
+            ret = {EXTERNAL, static_cast<uint32_t>(it - externals.begin())};
+            if (it == externals.end())
+                externals.push_back(storage);
+            return true;
+        }
+    };
+
+    std::vector<Instruction> instructions;
+    std::vector<T> registers;
+    std::vector<std::string> literals;
+    std::vector<T *> operands;
+    uint32_t result = 0;
+};
+
+#endif //QCALC_BYTECODE_HPP
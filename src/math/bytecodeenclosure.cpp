@@ -0,0 +1,397 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bytecodeenclosure.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+
+typedef Bytecode<double> DoubleBytecode;
+
+static const double INF = std::numeric_limits<double>::infinity();
+
+// Below this magnitude the residual of a product, quotient or square root may underflow
+// and no longer tells whether the rounded result is exact, such results are widened in both directions.
+static const double EXACT_RESIDUAL_MIN = std::ldexp(1.0, -969);
+
+struct Bounds {
+    double lower;
+    double upper;
+};
+
+/**
+ * The behaviour of a built in function which determines how its result is bounded.
+ */
+enum Shape {
+    INCREASING,
+    DECREASING,
+    LIPSCHITZ, // The absolute value of the derivative is at most 1 (sin and cos).
+    EVEN, // Decreasing below zero and increasing above zero (cosh).
+    EXACT // Increasing and computed exactly by the C library (floor, ceil and trunc).
+};
+
+struct EnclosedFunction {
+    const char *name;
+    Shape shape;
+
+    double (*function)(double);
+};
+
+static const EnclosedFunction ENCLOSED_FUNCTIONS[] = {
+        {"acos",  DECREASING, [](double v) { return std::acos(v); }},
+        {"acosh", INCREASING, [](double v) { return std::acosh(v); }},
+        {"asin",  INCREASING, [](double v) { return std::asin(v); }},
+        {"asinh", INCREASING, [](double v) { return std::asinh(v); }},
+        {"atan",  INCREASING, [](double v) { return std::atan(v); }},
+        {"atanh", INCREASING, [](double v) { return std::atanh(v); }},
+        {"ceil",  EXACT,      [](double v) { return std::ceil(v); }},
+        {"cos",   LIPSCHITZ,  [](double v) { return std::cos(v); }},
+        {"cosh",  EVEN,       [](double v) { return std::cosh(v); }},
+        {"erf",   INCREASING, [](double v) { return std::erf(v); }},
+        {"erfc",  DECREASING, [](double v) { return std::erfc(v); }},
+        {"exp",   INCREASING, [](double v) { return std::exp(v); }},
+        {"expm1", INCREASING, [](double v) { return std::expm1(v); }},
+        {"floor", EXACT,      [](double v) { return std::floor(v); }},
+        {"log",   INCREASING, [](double v) { return std::log(v); }},
+        {"log10", INCREASING, [](double v) { return std::log10(v); }},
+        {"log1p", INCREASING, [](double v) { return std::log1p(v); }},
+        {"log2",  INCREASING, [](double v) { return std::log2(v); }},
+        {"sin",   LIPSCHITZ,  [](double v) { return std::sin(v); }},
+        {"sinh",  INCREASING, [](double v) { return std::sinh(v); }},
+        {"tanh",  INCREASING, [](double v) { return std::tanh(v); }},
+        {"trunc", EXACT,      [](double v) { return std::trunc(v); }}
+};
+
+static double down(double v) {
+    return std::nextafter(v, -INF);
+}
+
+static double up(double v) {
+    return std::nextafter(v, INF);
+}
+
+static double widenDown(double v) {
+    for (int i = 0; i < BytecodeEnclosure::LIBM_ERROR_ULPS; i++) {
+        v = down(v);
+    }
+    return v;
+}
+
+static double widenUp(double v) {
+    for (int i = 0; i < BytecodeEnclosure::LIBM_ERROR_ULPS; i++) {
+        v = up(v);
+    }
+    return v;
+}
+
+/**
+ * Round the result of an operation in the passed direction.
+ *
+ * @param result The result rounded to nearest.
+ * @param error The sign of the exact value minus the result, 0 if the result is exact
+ * or NaN if the sign is not known.
+ * @param upward
+ * @return The result or its neighbour in the direction of the exact value.
+ */
+static double directed(double result, double error, bool upward) {
+    if (error == 0)
+        return result;
+    if (upward)
+        return error < 0 ? result : up(result);
+    else
+        return error > 0 ? result : down(result);
+}
+
+static double add(double a, double b, bool upward) {
+    // The error of the sum is exact (TwoSum).
+    double s = a + b;
+    double bb = s - a;
+    double error = (a - (s - bb)) + (b - bb);
+    return directed(s, error, upward);
+}
+
+static double multiply(double a, double b, bool upward) {
+    double p = a * b;
+    if (a == 0 || b == 0)
+        return p;
+    double error = std::fabs(p) < EXACT_RESIDUAL_MIN ? std::numeric_limits<double>::quiet_NaN() : std::fma(a, b, -p);
+    return directed(p, error, upward);
+}
+
+static double divide(double a, double b, bool upward) {
+    double q = a / b;
+    if (a == 0)
+        return q;
+    double error = std::numeric_limits<double>::quiet_NaN();
+    if (std::fabs(q) >= EXACT_RESIDUAL_MIN && std::fabs(a) >= EXACT_RESIDUAL_MIN) {
+        // a / b - q = (a - q * b) / b
+        double residual = std::fma(-q, b, a);
+        error = b < 0 ? -residual : residual;
+    }
+    return directed(q, error, upward);
+}
+
+static double squareRoot(double v, bool upward) {
+    double r = std::sqrt(v);
+    if (v == 0)
+        return r;
+    // sqrt(v) - r has the sign of v - r * r.
+    double error = v < EXACT_RESIDUAL_MIN ? std::numeric_limits<double>::quiet_NaN() : std::fma(-r, r, v);
+    return directed(r, error, upward);
+}
+
+static Bounds hull(double a, double b, double c, double d) {
+    return {std::min(std::min(a, b), std::min(c, d)), std::max(std::max(a, b), std::max(c, d))};
+}
+
+static Bounds multiply(const Bounds &x, const Bounds &y) {
+    return {
+            std::min(std::min(multiply(x.lower, y.lower, false), multiply(x.lower, y.upper, false)),
+                     std::min(multiply(x.upper, y.lower, false), multiply(x.upper, y.upper, false))),
+            std::max(std::max(multiply(x.lower, y.lower, true), multiply(x.lower, y.upper, true)),
+                     std::max(multiply(x.upper, y.lower, true), multiply(x.upper, y.upper, true)))
+    };
+}
+
+static bool divide(const Bounds &x, const Bounds &y, Bounds &ret) {
+    if (y.lower <= 0 && y.upper >= 0)
+        return false;
+    ret = {
+            std::min(std::min(divide(x.lower, y.lower, false), divide(x.lower, y.upper, false)),
+                     std::min(divide(x.upper, y.lower, false), divide(x.upper, y.upper, false))),
+            std::max(std::max(divide(x.lower, y.lower, true), divide(x.lower, y.upper, true)),
+                     std::max(divide(x.upper, y.lower, true), divide(x.upper, y.upper, true)))
+    };
+    return true;
+}
+
+static Bounds square(const Bounds &x) {
+    if (x.lower >= 0)
+        return {multiply(x.lower, x.lower, false), multiply(x.upper, x.upper, true)};
+    if (x.upper <= 0)
+        return {multiply(x.upper, x.upper, false), multiply(x.lower, x.lower, true)};
+    double magnitude = std::max(-x.lower, x.upper);
+    return {0, multiply(magnitude, magnitude, true)};
+}
+
+static Bounds power(Bounds x, uint32_t p) {
+    Bounds ret{1, 1};
+    while (p) {
+        if (p & 1u)
+            ret = multiply(ret, x);
+        p >>= 1u;
+        if (p)
+            x = square(x);
+    }
+    return ret;
+}
+
+/**
+ * x ^ y for x > 0 is monotonic in each argument, the extremes are at the corners.
+ */
+static bool power(const Bounds &x, const Bounds &y, Bounds &ret) {
+    if (!(x.lower > 0))
+        return false;
+    Bounds corners = hull(std::pow(x.lower, y.lower),
+                          std::pow(x.lower, y.upper),
+                          std::pow(x.upper, y.lower),
+                          std::pow(x.upper, y.upper));
+    ret = {widenDown(corners.lower), widenUp(corners.upper)};
+    return true;
+}
+
+/**
+ * @param decided True if the comparison is true for all values of the operands.
+ * @param refuted True if the comparison is false for all values of the operands.
+ */
+static bool compare(bool decided, bool refuted, Bounds &ret) {
+    if (decided) {
+        ret = {1, 1};
+        return true;
+    } else if (refuted) {
+        ret = {0, 0};
+        return true;
+    }
+    return false;
+}
+
+static bool apply(const char *name, const Bounds &x, Bounds &ret) {
+    if (std::strcmp(name, "abs") == 0) {
+        if (x.lower >= 0)
+            ret = x;
+        else if (x.upper <= 0)
+            ret = {-x.upper, -x.lower};
+        else
+            ret = {0, std::max(-x.lower, x.upper)};
+        return true;
+    } else if (std::strcmp(name, "sqrt") == 0) {
+        // Correctly rounded, the domain is checked by the caller.
+        ret = {squareRoot(x.lower, false), squareRoot(x.upper, true)};
+        return true;
+    }
+
+    for (auto &function : ENCLOSED_FUNCTIONS) {
+        if (std::strcmp(name, function.name) != 0)
+            continue;
+        switch (function.shape) {
+            case INCREASING:
+                ret = {widenDown(function.function(x.lower)), widenUp(function.function(x.upper))};
+                return true;
+            case DECREASING:
+                ret = {widenDown(function.function(x.upper)), widenUp(function.function(x.lower))};
+                return true;
+            case LIPSCHITZ: {
+                double v = function.function(x.lower);
+                double width = add(x.upper, -x.lower, true);
+                ret = {std::max(add(widenDown(v), -width, false), -1.0),
+                       std::min(add(widenUp(v), width, true), 1.0)};
+                return true;
+            }
+            case EVEN:
+                if (x.lower >= 0) {
+                    ret = {widenDown(function.function(x.lower)), widenUp(function.function(x.upper))};
+                } else if (x.upper <= 0) {
+                    ret = {widenDown(function.function(x.upper)), widenUp(function.function(x.lower))};
+                } else {
+                    ret = {1, widenUp(std::max(function.function(x.lower), function.function(x.upper)))};
+                }
+                return true;
+            case EXACT:
+                ret = {function.function(x.lower), function.function(x.upper)};
+                return true;
+        }
+    }
+
+    // Functions which are not monotonic or whose accuracy is unknown (eg. tan, sinc or ncdf).
+    return false;
+}
+
+static bool compute(const DoubleBytecode::Instruction &instruction, const Bounds &x, const Bounds &y, Bounds &ret) {
+    switch (instruction.op) {
+        case DoubleBytecode::OP_COPY:
+            ret = x;
+            return true;
+        case DoubleBytecode::OP_NEG:
+            ret = {-x.upper, -x.lower};
+            return true;
+        case DoubleBytecode::OP_ADD:
+            ret = {add(x.lower, y.lower, false), add(x.upper, y.upper, true)};
+            return true;
+        case DoubleBytecode::OP_SUB:
+            ret = {add(x.lower, -y.upper, false), add(x.upper, -y.lower, true)};
+            return true;
+        case DoubleBytecode::OP_MUL:
+            ret = multiply(x, y);
+            return true;
+        case DoubleBytecode::OP_DIV:
+            return divide(x, y, ret);
+        case DoubleBytecode::OP_POW:
+            return power(x, y, ret);
+        case DoubleBytecode::OP_IPOW:
+            ret = power(x, instruction.extra);
+            return true;
+        case DoubleBytecode::OP_IPOWINV:
+            return divide({1, 1}, power(x, instruction.extra), ret);
+        case DoubleBytecode::OP_LT:
+            return compare(x.upper < y.lower, x.lower >= y.upper, ret);
+        case DoubleBytecode::OP_LTE:
+            return compare(x.upper <= y.lower, x.lower > y.upper, ret);
+        case DoubleBytecode::OP_GT:
+            return compare(x.lower > y.upper, x.upper <= y.lower, ret);
+        case DoubleBytecode::OP_GTE:
+            return compare(x.lower >= y.upper, x.upper < y.lower, ret);
+        case DoubleBytecode::OP_UNARY:
+            return apply(DoubleBytecode::getUnaryFunctions()[instruction.extra].name, x, ret);
+        case DoubleBytecode::OP_MOD:
+        case DoubleBytecode::OP_BINARY:
+            return false;
+    }
+    return false;
+}
+
+static bool isFinite(const Bounds &bounds) {
+    return std::isfinite(bounds.lower) && std::isfinite(bounds.upper) && bounds.lower <= bounds.upper;
+}
+
+static Bounds enclose(const ArithmeticType &value) {
+    return {value.toDouble(MPFR_RNDD), value.toDouble(MPFR_RNDU)};
+}
+
+/**
+ * Enclose the number written as the passed text by rounding the text down and up.
+ */
+static bool enclose(const std::string &text, Bounds &ret) {
+    ArithmeticType value(0, std::numeric_limits<double>::digits);
+    char *end = nullptr;
+    mpfr_strtofr(value.mpfr_ptr(), text.c_str(), &end, 10, MPFR_RNDD);
+    if (end == text.c_str() || *end != '\0')
+        return false;
+    ret.lower = value.toDouble(MPFR_RNDD);
+    mpfr_strtofr(value.mpfr_ptr(), text.c_str(), &end, 10, MPFR_RNDU);
+    ret.upper = value.toDouble(MPFR_RNDU);
+    return true;
+}
+
+bool BytecodeEnclosure::enclose(const Bytecode<double> &bytecode,
+                                const std::vector<const ArithmeticType *> &externals,
+                                double &lower,
+                                double &upper) {
+    const auto &operands = bytecode.getOperands();
+    const auto &literals = bytecode.getLiterals();
+    size_t registerCount = bytecode.getRegisterCount();
+    if (operands.empty() || externals.size() != operands.size() - registerCount)
+        return false;
+
+    std::vector<Bounds> values(operands.size());
+    for (size_t i = 0; i < registerCount; i++) {
+        if (literals[i].empty()) {
+            // Intermediate results and local variables are written before they are read,
+            // the only other registers are the exact literals created by the lowering (eg. x ^ 0).
+            values[i] = {*operands[i], *operands[i]};
+            continue;
+        }
+        if (!enclose(literals[i], values[i]))
+            return false;
+    }
+    for (size_t i = registerCount; i < operands.size(); i++) {
+        if (externals[i - registerCount] == nullptr)
+            return false;
+        values[i] = enclose(*externals[i - registerCount]);
+    }
+
+    for (auto &instruction : bytecode.getInstructions()) {
+        const Bounds &x = values[instruction.a];
+        const Bounds &y = values[instruction.b];
+        if (!isFinite(x) || !isFinite(y))
+            return false;
+        Bounds result{};
+        if (!compute(instruction, x, y, result))
+            return false;
+        values[instruction.target] = result;
+    }
+
+    const Bounds &result = values[bytecode.getResult()];
+    if (!isFinite(result))
+        return false;
+    lower = result.lower;
+    upper = result.upper;
+    return true;
+}
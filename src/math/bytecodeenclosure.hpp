@@ -0,0 +1,61 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_BYTECODEENCLOSURE_HPP
+#define QCALC_BYTECODEENCLOSURE_HPP
+
+#include <vector>
+
+#include "bytecode.hpp"
+#include "arithmetictype.hpp"
+
+/**
+ * Encloses the exact value of a double precision Bytecode using interval arithmetic on doubles.
+ *
+ * The literals are enclosed by rounding their text down and up, the variables and constants by rounding
+ * their values in the symbol table down and up. Every instruction widens the bounds it computes
+ * by one ulp unless an error free transformation shows that the hardware result is exact,
+ * so exact results (eg. 2 + 2 or 3 / 4) keep bounds which are equal.
+ * The built in functions are taken from the C library which is not correctly rounded,
+ * their results are widened by a margin of LIBM_ERROR_ULPS.
+ *
+ * Instructions whose result cannot be bounded this way (eg. divisions by an interval containing zero,
+ * comparisons of overlapping intervals, non monotonic functions or functions of unknown accuracy) abort the enclosure.
+ */
+namespace BytecodeEnclosure {
+    /**
+     * The ulps by which the results of the built in functions are widened,
+     * well above the maximum errors documented by glibc for the supported functions.
+     */
+    static const int LIBM_ERROR_ULPS = 8;
+
+    /**
+     * @param bytecode The bytecode lowered without folding constants (See Bytecode::lower).
+     * @param externals For every operand which is not a register, the exact value of the variable or constant.
+     * @param lower Set to the lower bound of the value of the bytecode.
+     * @param upper Set to the upper bound of the value of the bytecode.
+     * @return False if the value could not be enclosed by finite bounds.
+     */
+    bool enclose(const Bytecode<double> &bytecode,
+                 const std::vector<const ArithmeticType *> &externals,
+                 double &lower,
+                 double &upper);
+}
+
+#endif //QCALC_BYTECODEENCLOSURE_HPP
@@ -0,0 +1,46 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_CANCELLATIONTOKEN_HPP
+#define QCALC_CANCELLATIONTOKEN_HPP
+
+#include <atomic>
+#include <memory>
+
+/**
+ * A cancellation token is shared between the thread running an evaluation and the threads which may cancel it.
+ * Copies of a token refer to the same cancellation state.
+ */
+class CancellationToken {
+public:
+    CancellationToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() {
+        cancelled->store(true);
+    }
+
+    bool isCancelled() const {
+        return cancelled->load();
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+#endif //QCALC_CANCELLATIONTOKEN_HPP
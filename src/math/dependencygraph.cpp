@@ -0,0 +1,262 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "dependencygraph.hpp"
+
+#include <thread>
+#include <exception>
+#include <algorithm>
+
+#include "expressionparser.hpp"
+#include "expressionsymbols.hpp"
+#include "evaluationcontext.hpp"
+#include "workerpool.hpp"
+
+DependencyGraph::DependencyGraph() : version(0) {}
+
+DependencyGraph::DependencyGraph(const SymbolTable &symbolTable) : version(symbolTable.getVersion()) {
+    const auto &scripts = symbolTable.getScripts();
+
+    for (auto &definition : symbolTable.getDefinitions()) {
+        auto &deps = dependencies[definition.first];
+        deps = ExpressionSymbols::getReferences(definition.second, symbolTable);
+
+        for (auto &dep : deps) {
+            dependents[dep].insert(definition.first);
+            if (scripts.find(dep) != scripts.end())
+                scriptDependents.insert(definition.first);
+        }
+    }
+
+    // Depth first search over the defined variables, a variable which is reached while it is visited is part of a cycle.
+    std::map<std::string, bool> visited; // True once all dependencies of the variable have been visited.
+    std::vector<std::pair<std::string, std::set<std::string>::const_iterator>> stack;
+    for (auto &root : dependencies) {
+        if (visited.find(root.first) != visited.end())
+            continue;
+        visited[root.first] = false;
+        stack.emplace_back(root.first, root.second.begin());
+        while (!stack.empty()) {
+            auto &top = stack.back();
+            auto &deps = dependencies.at(top.first);
+            if (top.second == deps.end()) {
+                visited[top.first] = true;
+                stack.pop_back();
+                continue;
+            }
+
+            const std::string &dep = *top.second++;
+            if (dependencies.find(dep) == dependencies.end())
+                continue;
+
+            auto it = visited.find(dep);
+            if (it == visited.end()) {
+                visited[dep] = false;
+                stack.emplace_back(dep, dependencies.at(dep).begin());
+            } else if (!it->second) {
+                throw std::runtime_error("Cyclic definition of variable " + dep);
+            }
+        }
+    }
+}
+
+unsigned long DependencyGraph::getVersion() const {
+    return version;
+}
+
+std::set<std::string> DependencyGraph::getDependencies(const std::string &name) const {
+    auto it = dependencies.find(name);
+    if (it == dependencies.end())
+        return {};
+    return it->second;
+}
+
+std::vector<std::vector<std::string>> DependencyGraph::getRecomputeOrder(const std::set<std::string> &changed) const {
+    std::set<std::string> affected;
+    std::vector<std::string> pending;
+
+    auto addDependents = [&](const std::string &name) {
+        auto it = dependents.find(name);
+        if (it == dependents.end())
+            return;
+        for (auto &dependent : it->second) {
+            if (affected.insert(dependent).second)
+                pending.emplace_back(dependent);
+        }
+    };
+
+    for (auto &name : changed) {
+        if (dependencies.find(name) != dependencies.end() && affected.insert(name).second)
+            pending.emplace_back(name);
+        addDependents(name);
+    }
+
+    while (!pending.empty()) {
+        std::string name = std::move(pending.back());
+        pending.pop_back();
+        addDependents(name);
+    }
+
+    // The level of a variable is the length of the longest path to it from a variable without affected dependencies.
+    std::map<std::string, size_t> levels;
+    std::vector<std::vector<std::string>> ret;
+    for (auto &root : affected) {
+        std::vector<std::string> stack{root};
+        while (!stack.empty()) {
+            const std::string name = stack.back();
+            if (levels.find(name) != levels.end()) {
+                stack.pop_back();
+                continue;
+            }
+
+            size_t level = 0;
+            bool resolved = true;
+            for (auto &dep : dependencies.at(name)) {
+                if (affected.find(dep) == affected.end())
+                    continue;
+                auto it = levels.find(dep);
+                if (it == levels.end()) {
+                    stack.emplace_back(dep);
+                    resolved = false;
+                } else {
+                    level = std::max(level, it->second + 1);
+                }
+            }
+
+            if (resolved) {
+                levels[name] = level;
+                if (ret.size() <= level)
+                    ret.resize(level + 1);
+                ret.at(level).emplace_back(name);
+                stack.pop_back();
+            }
+        }
+    }
+
+    return ret;
+}
+
+std::set<std::string> DependencyGraph::recompute(SymbolTable &symbolTable,
+                                                 const std::set<std::string> &changed,
+                                                 size_t threadCount,
+                                                 const CancellationToken &token) const {
+    std::set<std::string> ret;
+
+    auto levels = getRecomputeOrder(changed);
+    if (levels.empty())
+        return ret;
+
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    const EvaluationContext context = EvaluationContext::getCurrent();
+    ScopedEvaluationContext scope(context);
+
+    const auto &definitions = symbolTable.getDefinitions();
+
+    // Assignments are not written back, the definitions are evaluated using copies of the table.
+    SymbolTable table = symbolTable;
+
+    // The copies of the workers are kept for all levels and receive the recomputed values like the table,
+    // so that the persistent engines of the workers only apply the modified variables.
+    std::vector<SymbolTable> workerTables;
+
+    // A recomputation started by a worker runs serially because the workers may all be busy.
+    bool parallelAllowed = !WorkerPool::isWorker();
+
+    for (auto &level : levels) {
+        // Scripts call into the python interpreter and therefore are evaluated serially on the calling thread.
+        std::vector<std::string> serial;
+        std::vector<std::string> parallel;
+        for (auto &name : level) {
+            if (scriptDependents.find(name) != scriptDependents.end())
+                serial.emplace_back(name);
+            else
+                parallel.emplace_back(name);
+        }
+
+        size_t workerCount = parallelAllowed ? std::min(threadCount, parallel.size()) : 0;
+        if (workerCount < 2) {
+            serial.insert(serial.end(), parallel.begin(), parallel.end());
+            parallel.clear();
+            workerCount = 0;
+        }
+
+        // The values and the exact fractions of the rational backend.
+        std::vector<std::pair<ArithmeticType, std::string>> serialValues(serial.size());
+        std::vector<std::pair<ArithmeticType, std::string>> parallelValues(parallel.size());
+
+        if (workerCount > 0) {
+            if (workerTables.size() < workerCount - 1)
+                workerTables.resize(workerCount - 1, table);
+
+            std::vector<std::exception_ptr> errors(workerCount);
+            WorkerPool::getInstance().run(workerCount, [&](size_t chunk) {
+                try {
+                    EvaluationContext::setCurrent(context);
+                    SymbolTable &chunkTable = chunk == 0 ? table : workerTables.at(chunk - 1);
+                    size_t begin = parallel.size() * chunk / workerCount;
+                    size_t end = parallel.size() * (chunk + 1) / workerCount;
+                    for (size_t i = begin; i < end; i++) {
+                        auto &value = parallelValues.at(i);
+                        value.first = ExpressionParser::evaluateExact(definitions.at(parallel.at(i)),
+                                                                      chunkTable,
+                                                                      token,
+                                                                      value.second);
+                    }
+                } catch (...) {
+                    errors.at(chunk) = std::current_exception();
+                }
+            });
+
+            for (auto &error : errors) {
+                if (error)
+                    std::rethrow_exception(error);
+            }
+        }
+
+        for (size_t i = 0; i < serial.size(); i++) {
+            auto &value = serialValues.at(i);
+            value.first = ExpressionParser::evaluateExact(definitions.at(serial.at(i)), table, token, value.second);
+        }
+
+        auto apply = [&](const std::string &name, const std::pair<ArithmeticType, std::string> &value) {
+            int decimals = symbolTable.getVariableDecimals().at(name);
+            auto set = [&](SymbolTable &t) {
+                t.setVariable(name, value.first, decimals);
+                if (!value.second.empty())
+                    t.setRational(name, value.second);
+            };
+            set(symbolTable);
+            set(table);
+            for (auto &workerTable : workerTables) {
+                set(workerTable);
+            }
+            ret.insert(name);
+        };
+        for (size_t i = 0; i < serial.size(); i++) {
+            apply(serial.at(i), serialValues.at(i));
+        }
+        for (size_t i = 0; i < parallel.size(); i++) {
+            apply(parallel.at(i), parallelValues.at(i));
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,102 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_DEPENDENCYGRAPH_HPP
+#define QCALC_DEPENDENCYGRAPH_HPP
+
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "symboltable.hpp"
+#include "cancellationtoken.hpp"
+
+/**
+ * The dependency graph is a directed acyclic graph over the variable definitions of a symbol table.
+ *
+ * A defined variable depends on the symbols referenced by its definition
+ * and on the symbols referenced by the functions its definition calls.
+ * Symbol names are matched case insensitive like exprtk does.
+ *
+ * The graph reflects the definitions of the table it was built from,
+ * it has to be rebuilt when the version of the table changes.
+ */
+class DependencyGraph {
+public:
+    DependencyGraph();
+
+    /**
+     * @param symbolTable
+     * @throws std::runtime_error If the definitions are cyclic.
+     */
+    explicit DependencyGraph(const SymbolTable &symbolTable);
+
+    /**
+     * @return The version of the symbol table which the graph was built from.
+     */
+    unsigned long getVersion() const;
+
+    /**
+     * @param name
+     * @return The names of the symbols which the definition of the variable references directly or through functions.
+     */
+    std::set<std::string> getDependencies(const std::string &name) const;
+
+    /**
+     * Return the defined variables which have to be recomputed when the given symbols change.
+     *
+     * The changed symbols themselves are included if they are defined variables.
+     * The variables are grouped into levels, the variables of a level only depend on variables of previous levels
+     * and can therefore be recomputed independently of each other.
+     *
+     * @param changed The names of the changed symbols.
+     * @return The levels of variables in topological order.
+     */
+    std::vector<std::vector<std::string>> getRecomputeOrder(const std::set<std::string> &changed) const;
+
+    /**
+     * Recompute the defined variables which are affected by the changed symbols and write their values to the table.
+     *
+     * The variables of each level are evaluated in parallel by the calling thread and the persistent worker pool
+     * of the parallel evaluations, definitions which reference scripts are evaluated on the calling thread.
+     * Assignments made by the definitions to other variables are not written back to the table.
+     * With the rational backend the exact values of the recomputed variables are written to the table.
+     *
+     * @param symbolTable The table which the graph was built from.
+     * @param changed The names of the changed symbols.
+     * @param threadCount The maximum number of threads to use, 0 to use the number of hardware threads.
+     * @param token The token which cancels the recomputation.
+     *
+     * @return The names of the recomputed variables.
+     */
+    std::set<std::string> recompute(SymbolTable &symbolTable,
+                                    const std::set<std::string> &changed,
+                                    size_t threadCount = 0,
+                                    const CancellationToken &token = CancellationToken()) const;
+
+private:
+    unsigned long version;
+
+    std::map<std::string, std::set<std::string>> dependencies; // The referenced symbols of each defined variable.
+    std::map<std::string, std::set<std::string>> dependents; // The defined variables which reference each symbol.
+    std::set<std::string> scriptDependents; // The defined variables which reference scripts.
+};
+
+#endif //QCALC_DEPENDENCYGRAPH_HPP
@@ -0,0 +1,53 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_EVALUATIONBUDGET_HPP
+#define QCALC_EVALUATIONBUDGET_HPP
+
+#include <cstddef>
+#include <chrono>
+
+/**
+ * The evaluation budget limits the resources an evaluation may use, a limit of 0 disables the limit.
+ *
+ * When a limit is exceeded the evaluation is aborted with a runtime_error.
+ * The iterations are the total number of loop iterations of the evaluated expression including nested loops.
+ * The memory is the peak number of bytes allocated by mpfr on the evaluating thread during the evaluation.
+ * Operations whose estimated result exceeds the memory limit (eg. a value of the requested precision
+ * or a large integer power) abort the evaluation before they run,
+ * the remaining allocations are detected before each loop iteration and after the evaluation.
+ * The time limit is only checked before each loop iteration and after the evaluation,
+ * an evaluation without loops or spending its time in a single operation exceeds it until the operation completes.
+ */
+struct EvaluationBudget {
+    size_t iterations;
+    std::chrono::milliseconds time;
+    size_t memory;
+
+    EvaluationBudget() : iterations(0), time(0), memory(0) {}
+
+    EvaluationBudget(size_t iterations, std::chrono::milliseconds time, size_t memory)
+            : iterations(iterations), time(time), memory(memory) {}
+
+    bool isUnlimited() const {
+        return iterations == 0 && time.count() == 0 && memory == 0;
+    }
+};
+
+#endif //QCALC_EVALUATIONBUDGET_HPP
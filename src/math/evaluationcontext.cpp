@@ -0,0 +1,43 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "evaluationcontext.hpp"
+
+static thread_local EvaluationContext currentContext;
+
+const EvaluationContext &EvaluationContext::getCurrent() {
+    return currentContext;
+}
+
+void EvaluationContext::setCurrent(const EvaluationContext &context) {
+    currentContext = context;
+    mpfr::mpreal::set_default_prec(context.precision);
+    mpfr::mpreal::set_default_rnd(context.rounding);
+}
+
+ScopedEvaluationContext::ScopedEvaluationContext() : previous(EvaluationContext::getCurrent()) {}
+
+ScopedEvaluationContext::ScopedEvaluationContext(const EvaluationContext &context)
+        : previous(EvaluationContext::getCurrent()) {
+    EvaluationContext::setCurrent(context);
+}
+
+ScopedEvaluationContext::~ScopedEvaluationContext() {
+    EvaluationContext::setCurrent(previous);
+}
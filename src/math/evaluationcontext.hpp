@@ -0,0 +1,101 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_EVALUATIONCONTEXT_HPP
+#define QCALC_EVALUATIONCONTEXT_HPP
+
+#include "arithmetictype.hpp"
+#include "numericbackend.hpp"
+
+/**
+ * The evaluation context defines the precision and rounding mode used for arithmetic
+ * and the number of decimal digits and rounding mode used when formatting numbers.
+ *
+ * The backend selects the arithmetic type expressions are evaluated with,
+ * the precision and rounding mode only apply to the mpfr backend.
+ *
+ * Each thread has its own current context, which allows concurrent evaluations with different settings.
+ * Setting the current context also sets the mpfr default precision and rounding mode of the calling thread.
+ */
+struct EvaluationContext {
+    mpfr_prec_t precision;
+    mpfr_rnd_t rounding;
+    int formattingPrecision;
+    mpfr_rnd_t formattingRounding;
+    NumericBackend backend;
+
+    EvaluationContext()
+            : precision(53),
+              rounding(MPFR_RNDN),
+              formattingPrecision(15),
+              formattingRounding(MPFR_RNDN),
+              backend(BACKEND_MPFR) {}
+
+    EvaluationContext(mpfr_prec_t precision,
+                      mpfr_rnd_t rounding,
+                      int formattingPrecision,
+                      mpfr_rnd_t formattingRounding,
+                      NumericBackend backend = BACKEND_MPFR)
+            : precision(precision),
+              rounding(rounding),
+              formattingPrecision(formattingPrecision),
+              formattingRounding(formattingRounding),
+              backend(backend) {}
+
+    bool operator==(const EvaluationContext &other) const {
+        return precision == other.precision
+               && rounding == other.rounding
+               && formattingPrecision == other.formattingPrecision
+               && formattingRounding == other.formattingRounding
+               && backend == other.backend;
+    }
+
+    /**
+     * @return The context of the calling thread.
+     */
+    static const EvaluationContext &getCurrent();
+
+    /**
+     * Set the context of the calling thread.
+     *
+     * @param context
+     */
+    static void setCurrent(const EvaluationContext &context);
+};
+
+/**
+ * Restores the context of the calling thread which was current when the scope was constructed on destruction.
+ */
+class ScopedEvaluationContext {
+public:
+    ScopedEvaluationContext();
+
+    explicit ScopedEvaluationContext(const EvaluationContext &context);
+
+    ~ScopedEvaluationContext();
+
+    ScopedEvaluationContext(const ScopedEvaluationContext &other) = delete;
+
+    ScopedEvaluationContext &operator=(const ScopedEvaluationContext &other) = delete;
+
+private:
+    EvaluationContext previous;
+};
+
+#endif //QCALC_EVALUATIONCONTEXT_HPP
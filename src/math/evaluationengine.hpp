@@ -0,0 +1,1038 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_EVALUATIONENGINE_HPP
+#define QCALC_EVALUATIONENGINE_HPP
+
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+#include "numericconversion.hpp"
+#include "numericbackend.hpp"
+
+#include "symboltable.hpp"
+#include "functiondefinition.hpp"
+#include "evaluationcontext.hpp"
+#include "expressioncache.hpp"
+#include "expressionoptimizer.hpp"
+#include "bytecode.hpp"
+#include "nativecode.hpp"
+#include "bytecodeenclosure.hpp"
+#include "vectorcode.hpp"
+#include "scriptfunction.hpp"
+#include "scriptvarargfunction.hpp"
+
+/**
+ * The evaluation engine owns the exprtk state (Symbol tables, function compositor, script functions and variable storage)
+ * which is required to evaluate expressions using the symbols defined in a SymbolTable.
+ *
+ * Symbols are bound lazily, only the symbols referenced by an evaluated expression
+ * and the functions and scripts referenced by the bound functions are registered with exprtk.
+ *
+ * The state is kept between evaluations and synchronized with the symbol table by applying only the bound symbols
+ * which were modified since the last synchronization.
+ * Functions are taken from the validated function definitions of the symbol table, which are shared by all engines,
+ * each engine compiles a function into its own compositor and only compiles it again when its definition
+ * or the definition of a function or script it references changes.
+ *
+ * Expressions are passed through the ExpressionOptimizer before compiling, the inlined functions are bound
+ * so that modifying them invalidates the compiled expressions.
+ * Cached expressions which are evaluated again and expressions evaluated in batches are lowered to Bytecode
+ * if they only contain constructs the bytecode supports,
+ * the bytecode of double precision expressions is translated to NativeCode if the JIT is enabled
+ * and batches of double precision expressions are evaluated by VectorCode if the processor supports SIMD.
+ *
+ * The engine is not reentrant, an evaluation which causes another evaluation (eg. from a script) has to use a different engine.
+ *
+ * @tparam T The arithmetic type used by exprtk.
+ */
+template<typename T>
+class EvaluationEngine {
+public:
+    explicit EvaluationEngine(size_t cacheCapacity) : resolver(*this), cache(cacheCapacity) {
+        compositor.add_auxiliary_symtab(varArgScriptSymbols);
+        parser.enable_unknown_symbol_resolver(&resolver);
+    }
+
+    ~EvaluationEngine() {
+        reset();
+    }
+
+    EvaluationEngine(const EvaluationEngine &other) = delete;
+
+    EvaluationEngine &operator=(const EvaluationEngine &other) = delete;
+
+    /**
+     * Apply the modifications of the bound symbols since the last synchronization.
+     *
+     * If the engine has not been synchronized with this table or one of its copies before
+     * or the table does not contain the last synchronized revision in its change log anymore,
+     * all bound symbols are compared and only the differing symbols are applied.
+     *
+     * @param symbolTable
+     */
+    void synchronize(const SymbolTable &symbolTable) {
+        auto &context = EvaluationContext::getCurrent();
+        if (precision != context.precision || rounding != context.rounding) {
+            // Constants and the literals in compiled functions depend on the precision and rounding mode.
+            reset();
+            precision = context.precision;
+            rounding = context.rounding;
+        }
+
+        if (synchronized && symbolTable.getRevision() == revision)
+            return;
+
+        const auto &changes = symbolTable.getChanges();
+        auto it = std::lower_bound(changes.begin(),
+                                   changes.end(),
+                                   revision,
+                                   [](const std::pair<unsigned long, std::string> &change, unsigned long value) {
+                                       return change.first < value;
+                                   });
+
+        std::set<std::string> names;
+        if (synchronized && it != changes.end() && it->first == revision) {
+            for (it++; it != changes.end(); it++) {
+                names.insert(it->second);
+            }
+        } else {
+            for (auto &v : variables)
+                names.insert(v.first);
+            for (auto &v : constants)
+                names.insert(v.first);
+            for (auto &v : functions)
+                names.insert(v.first);
+            for (auto &v : scripts)
+                names.insert(v.first);
+            for (auto &v : dependents)
+                names.insert(v.first);
+        }
+
+        for (auto &name : names) {
+            if (isRequired(symbolTable, name))
+                apply(symbolTable, name);
+        }
+
+        retiredScriptFunctions.clear();
+        retiredVarArgScriptFunctions.clear();
+
+        revision = symbolTable.getRevision();
+        synchronized = true;
+    }
+
+    /**
+     * Evaluate the expression using the symbols of the symbol table.
+     *
+     * Variables which are assigned by the expression are written back to the symbol table.
+     *
+     * @param expr
+     * @param symbolTable
+     * @return The value of the expression.
+     */
+    T evaluate(const std::string &expr, SymbolTable &symbolTable) {
+        synchronize(symbolTable);
+
+        typename ExpressionCache<CompiledExpression>::Key key{normalize(expr), generation, precision, rounding};
+
+        std::unique_ptr<CompiledExpression> compiled = acquire(key, symbolTable);
+
+        T ret;
+        try {
+            ret = compiled->value();
+        } catch (...) {
+            // The aborted evaluation may have assigned variables, they are restored by the next synchronization.
+            synchronized = false;
+            throw;
+        }
+
+        writeAssignments(*compiled, symbolTable, {});
+
+        cache.put(key, std::move(compiled));
+
+        return ret;
+    }
+
+    /**
+     * Evaluate the expression if it is pure.
+     *
+     * An expression is pure if it does not assign variables and does not reference scripts or compare for equality,
+     * directly or through functions.
+     * Equality comparisons are excluded because exprtk compares with a tolerance which depends on the arithmetic type.
+     *
+     * @param expr
+     * @param symbolTable
+     * @param value Set to the value of the expression if it is pure.
+     * @return False if the expression is not pure and therefore was not evaluated.
+     */
+    bool evaluatePure(const std::string &expr, const SymbolTable &symbolTable, T &value) {
+        synchronize(symbolTable);
+
+        typename ExpressionCache<CompiledExpression>::Key key{normalize(expr), generation, precision, rounding};
+
+        std::unique_ptr<CompiledExpression> compiled = acquire(key, symbolTable);
+
+        bool pure = compiled->pure;
+        if (pure)
+            value = compiled->value();
+
+        cache.put(key, std::move(compiled));
+
+        return pure;
+    }
+
+    /**
+     * Evaluate the expression and enclose its exact value if it is pure, only supported by double precision engines.
+     *
+     * The enclosure is computed from the expression lowered to Bytecode without folding constants (See BytecodeEnclosure),
+     * the value is computed like evaluatePure (by the bytecode or the NativeCode once the expression is evaluated again).
+     *
+     * @param expr
+     * @param symbolTable
+     * @param value Set to the value of the expression if it was enclosed.
+     * @param lowerBound Set to the lower bound of the exact value of the expression if it was enclosed.
+     * @param upperBound Set to the upper bound of the exact value of the expression if it was enclosed.
+     * @return False if the expression is not pure, cannot be lowered or its value cannot be enclosed.
+     */
+    bool evaluateEnclosure(const std::string &expr,
+                           const SymbolTable &symbolTable,
+                           T &value,
+                           T &lowerBound,
+                           T &upperBound) {
+        if constexpr (std::is_same<T, double>::value) {
+            synchronize(symbolTable);
+
+            typename ExpressionCache<CompiledExpression>::Key key{normalize(expr), generation, precision, rounding};
+
+            std::unique_ptr<CompiledExpression> compiled = acquire(key, symbolTable);
+
+            bool ret = false;
+            if (compiled->pure) {
+                if (!compiled->enclosureLowered) {
+                    compiled->enclosureLowered = true;
+                    try {
+                        Bytecode<T>::lower(compiled->source, valueSymbols, compiled->enclosure, false);
+                    } catch (const std::exception &) {
+                        compiled->enclosure = Bytecode<T>();
+                    }
+                }
+                if (!compiled->enclosure.empty()) {
+                    ret = BytecodeEnclosure::enclose(compiled->enclosure,
+                                                     getExternalValues(symbolTable, compiled->enclosure),
+                                                     lowerBound,
+                                                     upperBound);
+                    if (ret)
+                        value = compiled->value();
+                }
+            }
+
+            cache.put(key, std::move(compiled));
+
+            return ret;
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * Evaluate the expression once for every row of the bindings.
+     *
+     * The expression is compiled once, for each row the bound variables are set to the values of the row
+     * before evaluating the compiled expression.
+     * The bound variables must be variables of the symbol table, their values in the symbol table are not modified.
+     * Assignments to other variables are written back to the symbol table after the last row.
+     * Double precision expressions which are lowered to bytecode are evaluated by VectorCode if available,
+     * which evaluates several rows at once.
+     *
+     * @param expr
+     * @param symbolTable
+     * @param bindings The columns of values for each bound variable, all columns must have the same size.
+     * @return The value of the expression for each row.
+     */
+    std::vector<T> evaluateBatch(const std::string &expr,
+                                 SymbolTable &symbolTable,
+                                 const std::map<std::string, std::vector<ArithmeticType>> &bindings) {
+        size_t rows = bindings.empty() ? 0 : bindings.begin()->second.size();
+        return evaluateRows(expr, symbolTable, bindings, 0, rows, &symbolTable);
+    }
+
+    /**
+     * Evaluate the expression for the rows begin to end of the bindings like evaluateBatch,
+     * the assignments are not written back.
+     *
+     * @param expr
+     * @param symbolTable
+     * @param bindings The columns of values for each bound variable, all columns must have the same size.
+     * @param begin
+     * @param end
+     * @return The value of the expression for each row of the range.
+     */
+    std::vector<T> evaluateBatch(const std::string &expr,
+                                 const SymbolTable &symbolTable,
+                                 const std::map<std::string, std::vector<ArithmeticType>> &bindings,
+                                 size_t begin,
+                                 size_t end) {
+        return evaluateRows(expr, symbolTable, bindings, begin, end, nullptr);
+    }
+
+    /**
+     * Compile the expression and bind the symbols it references without evaluating it.
+     *
+     * @param expr
+     * @param symbolTable
+     * @return True if the expression calls scripts directly or through the functions it references,
+     * scripts call into the python interpreter when evaluated.
+     */
+    bool prepare(const std::string &expr, const SymbolTable &symbolTable) {
+        synchronize(symbolTable);
+
+        typename ExpressionCache<CompiledExpression>::Key key{normalize(expr), generation, precision, rounding};
+
+        std::unique_ptr<CompiledExpression> compiled = acquire(key, symbolTable);
+        bool ret = compiled->scripts;
+        cache.put(key, std::move(compiled));
+        return ret;
+    }
+
+    ExpressionCacheStatistics getCacheStatistics() {
+        return cache.getStatistics();
+    }
+
+    void setCacheCapacity(size_t capacity) {
+        cache.setCapacity(capacity);
+    }
+
+    void clearCache() {
+        cache.clear();
+    }
+
+private:
+    /**
+     * Binds the symbols which exprtk cannot find in the registered symbol tables while compiling an expression.
+     */
+    class SymbolResolver : public exprtk::parser<T>::unknown_symbol_resolver {
+    public:
+        explicit SymbolResolver(EvaluationEngine &engine)
+                : exprtk::parser<T>::unknown_symbol_resolver(exprtk::parser<T>::unknown_symbol_resolver::e_usrmode_extended),
+                  engine(engine) {}
+
+        bool process(const std::string &unknownSymbol,
+                     exprtk::symbol_table<T> &symbolTable,
+                     std::string &errorMessage) override {
+            if (this->symbolTable == nullptr)
+                return false;
+            std::string name = this->symbolTable->findSymbol(unknownSymbol);
+            if (name.empty() || engine.isBound(name)) {
+                errorMessage = "Undefined symbol";
+                return false;
+            }
+            engine.apply(*this->symbolTable, name);
+            return engine.isBound(name);
+        }
+
+        const SymbolTable *symbolTable = nullptr;
+
+    private:
+        EvaluationEngine &engine;
+    };
+
+    struct CompiledExpression {
+        exprtk::expression<T> expression;
+        std::vector<std::string> assignments; // The names of the variables which are assigned by the expression.
+        bool pure = false;
+        bool scripts = false; // True if the expression calls scripts directly or through functions.
+        std::string source; // The optimized expression which was compiled.
+        bool lowered = false; // True if lowering to bytecode has been attempted.
+        Bytecode<T> bytecode; // Empty if the expression could not be lowered.
+        std::unique_ptr<NativeCode> native; // The translated bytecode of double precision expressions.
+        std::unique_ptr<VectorCode> vectorCode; // Created for double precision expressions evaluated in batches.
+        bool enclosureLowered = false; // True if lowering without folding constants has been attempted.
+        Bytecode<T> enclosure; // The expression lowered without folding constants, empty if it could not be lowered.
+
+        T value() {
+            if constexpr (std::is_same<T, double>::value) {
+                if (native)
+                    return native->evaluate();
+            }
+            return bytecode.empty() ? expression.value() : bytecode.evaluate();
+        }
+    };
+
+    /**
+     * Take the compiled expression from the cache or compile it.
+     *
+     * @param key The cache key, updated if compiling the expression invalidates the cache.
+     * @param symbolTable
+     * @return
+     */
+    std::unique_ptr<CompiledExpression> acquire(typename ExpressionCache<CompiledExpression>::Key &key,
+                                                const SymbolTable &symbolTable) {
+        std::unique_ptr<CompiledExpression> ret = cache.take(key);
+        if (!ret) {
+            ret = compile(key.expression, symbolTable);
+            // Binding the referenced symbols may have invalidated the cache.
+            key.symbolTableVersion = generation;
+        } else {
+            // Expressions are lowered once they are evaluated again.
+            lower(*ret);
+        }
+        return ret;
+    }
+
+    /**
+     * Lower the compiled expression to bytecode, expressions which cannot be lowered are evaluated by exprtk.
+     *
+     * @param compiled
+     */
+    void lower(CompiledExpression &compiled) {
+        if (compiled.lowered)
+            return;
+        compiled.lowered = true;
+        if (!compiled.assignments.empty())
+            return;
+        try {
+            Bytecode<T>::lower(compiled.source, valueSymbols, compiled.bytecode);
+        } catch (const std::exception &) {
+            compiled.bytecode = Bytecode<T>();
+        }
+        if constexpr (std::is_same<T, double>::value) {
+            compiled.native = NativeCode::compile(compiled.bytecode);
+        }
+    }
+
+    /**
+     * @param symbolTable
+     * @param bytecode
+     * @return For every operand of the bytecode which is not a register, the value in the symbol table of the
+     * variable or constant it refers to or nullptr if the operand is not bound by this engine.
+     */
+    std::vector<const ArithmeticType *> getExternalValues(const SymbolTable &symbolTable, const Bytecode<T> &bytecode) {
+        std::map<const T *, const ArithmeticType *> sources;
+        for (auto &variable : variables) {
+            auto it = symbolTable.getVariables().find(variable.first);
+            if (it != symbolTable.getVariables().end())
+                sources[&variable.second] = &it->second;
+        }
+        for (auto &constant : constants) {
+            auto *storage = valueSymbols.get_variable(constant.first);
+            if (storage != nullptr)
+                sources[&storage->ref()] = &constant.second;
+        }
+
+        std::vector<const ArithmeticType *> ret;
+        const auto &operands = bytecode.getOperands();
+        for (size_t i = bytecode.getRegisterCount(); i < operands.size(); i++) {
+            auto it = sources.find(operands[i]);
+            ret.emplace_back(it == sources.end() ? nullptr : it->second);
+        }
+        return ret;
+    }
+
+    /**
+     * Evaluate the rows begin to end of the bindings.
+     *
+     * @param expr
+     * @param symbolTable
+     * @param bindings
+     * @param begin
+     * @param end
+     * @param assignments The symbol table to write the assignments to or nullptr to discard the assignments.
+     * @return The value of the expression for each row of the range.
+     */
+    std::vector<T> evaluateRows(const std::string &expr,
+                                const SymbolTable &symbolTable,
+                                const std::map<std::string, std::vector<ArithmeticType>> &bindings,
+                                size_t begin,
+                                size_t end,
+                                SymbolTable *assignments) {
+        size_t size = bindings.empty() ? 0 : bindings.begin()->second.size();
+        for (auto &column : bindings) {
+            if (column.second.size() != size)
+                throw std::runtime_error("All bound columns must have the same size");
+        }
+        if (begin > end || end > size)
+            throw std::runtime_error("Invalid range of rows");
+        size_t rows = end - begin;
+
+        synchronize(symbolTable);
+
+        std::vector<std::pair<T *, const std::vector<ArithmeticType> *>> columns;
+        std::set<std::string> boundNames;
+        for (auto &column : bindings) {
+            std::string name = symbolTable.findSymbol(column.first);
+            if (symbolTable.getVariables().find(name) == symbolTable.getVariables().end())
+                throw std::runtime_error("Bound symbol " + column.first + " is not a variable of the symbol table");
+            if (variables.find(name) == variables.end())
+                apply(symbolTable, name);
+            columns.emplace_back(&variables.at(name), &column.second);
+            boundNames.insert(name);
+        }
+
+        typename ExpressionCache<CompiledExpression>::Key key{normalize(expr), generation, precision, rounding};
+
+        std::unique_ptr<CompiledExpression> compiled = acquire(key, symbolTable);
+        if (rows > 1)
+            lower(*compiled);
+
+        std::vector<T> ret;
+        if (!evaluateVector(*compiled, columns, begin, rows, ret)) {
+            ret.reserve(rows);
+            try {
+                for (size_t row = begin; row < end; row++) {
+                    for (auto &column : columns) {
+                        *column.first = NumericConversion::fromArithmeticType<T>((*column.second)[row]);
+                    }
+                    ret.emplace_back(compiled->value());
+                }
+            } catch (...) {
+                // The bound and assigned variables are restored by the next synchronization.
+                synchronized = false;
+                throw;
+            }
+        }
+
+        for (auto &name : boundNames) {
+            variables.at(name) = toValue(symbolTable, name, symbolTable.getVariables().at(name));
+        }
+
+        if (assignments != nullptr) {
+            writeAssignments(*compiled, *assignments, boundNames);
+        } else {
+            for (auto &name : compiled->assignments) {
+                variables.at(name) = toValue(symbolTable, name, symbolTable.getVariables().at(name));
+            }
+        }
+
+        cache.put(key, std::move(compiled));
+
+        return ret;
+    }
+
+    /**
+     * Evaluate the rows of a batch with the VectorCode of the lowered expression.
+     *
+     * @param compiled
+     * @param columns The storage of the bound variables and their values.
+     * @param begin The first row of the columns to evaluate.
+     * @param rows
+     * @param ret Set to the value of the expression for each row.
+     * @return False if the rows have to be evaluated one at a time.
+     */
+    bool evaluateVector(CompiledExpression &compiled,
+                        const std::vector<std::pair<T *, const std::vector<ArithmeticType> *>> &columns,
+                        size_t begin,
+                        size_t rows,
+                        std::vector<T> &ret) {
+        if constexpr (std::is_same<T, double>::value) {
+            if (rows < 2 || compiled.bytecode.empty())
+                return false;
+            if (!compiled.vectorCode) {
+                compiled.vectorCode = VectorCode::compile(compiled.bytecode);
+                if (!compiled.vectorCode)
+                    return false;
+            }
+
+            std::vector<std::vector<double>> values(columns.size());
+            std::vector<std::pair<const double *, const double *>> inputs;
+            for (size_t i = 0; i < columns.size(); i++) {
+                values[i].reserve(rows);
+                for (size_t row = begin; row < begin + rows; row++) {
+                    values[i].emplace_back(NumericConversion::fromArithmeticType<double>((*columns[i].second)[row]));
+                }
+                inputs.emplace_back(columns[i].first, values[i].data());
+            }
+            return compiled.vectorCode->evaluate(inputs, rows, ret);
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * Write the values of the variables assigned by the expression back to the symbol table.
+     *
+     * @param compiled
+     * @param symbolTable
+     * @param excluded The names of the variables which are not written back.
+     */
+    void writeAssignments(const CompiledExpression &compiled,
+                          SymbolTable &symbolTable,
+                          const std::set<std::string> &excluded) {
+        for (auto &name : compiled.assignments) {
+            if (excluded.find(name) != excluded.end())
+                continue;
+            ArithmeticType value = NumericConversion::toArithmeticType(variables.at(name));
+            if constexpr (std::is_same<T, Rational>::value) {
+                // The symbol table keeps the exact value in addition to the rounded value.
+                std::string fraction = variables.at(name).toString();
+                auto rational = symbolTable.getRationals().find(name);
+                if (rational != symbolTable.getRationals().end() && rational->second == fraction)
+                    continue;
+                symbolTable.setVariable(name, value, -1);
+                symbolTable.setRational(name, fraction);
+                continue;
+            }
+            if (symbolTable.getVariables().at(name) == value)
+                continue;
+            symbolTable.setVariable(name, value, -1);
+        }
+
+        // The only modifications since the synchronization are the assignments which are already applied.
+        revision = symbolTable.getRevision();
+    }
+
+    static std::string normalize(const std::string &expr) {
+        const char *whitespace = " \t\n\r\f\v";
+        auto begin = expr.find_first_not_of(whitespace);
+        if (begin == std::string::npos)
+            return "";
+        auto end = expr.find_last_not_of(whitespace);
+        return expr.substr(begin, end - begin + 1);
+    }
+
+    /**
+     * @param expr
+     * @return The names of all symbols which appear in the expression.
+     */
+    static std::set<std::string> getSymbolNames(const std::string &expr) {
+        std::set<std::string> ret;
+        exprtk::lexer::generator generator;
+        if (!generator.process(expr))
+            return ret;
+        for (size_t i = 0; i < generator.size(); i++) {
+            if (generator[i].type == exprtk::lexer::token::e_symbol)
+                ret.insert(generator[i].value);
+        }
+        return ret;
+    }
+
+    std::unique_ptr<CompiledExpression> compile(const std::string &expr, const SymbolTable &symbolTable) {
+        auto ret = std::make_unique<CompiledExpression>();
+
+        ret->expression.register_symbol_table(valueSymbols);
+        ret->expression.register_symbol_table(compositor.symbol_table());
+        ret->expression.register_symbol_table(varArgScriptSymbols);
+
+        parser.dec().collect_assignments() = true;
+
+        std::set<std::string> inlined;
+        std::string optimized = ExpressionOptimizer::optimize(expr, symbolTable, inlined);
+        for (auto &name : inlined) {
+            if (!isBound(name))
+                apply(symbolTable, name);
+        }
+
+        resolver.symbolTable = &symbolTable;
+        bool compiled = parser.compile(optimized, ret->expression);
+        if (!compiled && optimized != expr) {
+            // Report the errors of the expression as written.
+            optimized = expr;
+            compiled = parser.compile(optimized, ret->expression);
+        }
+        resolver.symbolTable = nullptr;
+
+        if (!compiled) {
+            // Functions which fail to compile are not defined, report their error instead of the undefined symbol.
+            std::set<std::string> visited;
+            std::vector<std::string> symbols;
+            for (auto &symbol : getSymbolNames(expr))
+                symbols.emplace_back(symbol);
+            while (!symbols.empty()) {
+                auto function = symbolTable.getFunctionDefinitions().find(symbolTable.findSymbol(symbols.back()));
+                symbols.pop_back();
+                if (function == symbolTable.getFunctionDefinitions().end() || !visited.insert(function->first).second)
+                    continue;
+                if (!function->second->getError().empty())
+                    throw std::runtime_error("Function " + function->first + ": " + function->second->getError());
+                symbols.insert(symbols.end(), function->second->getSymbols().begin(), function->second->getSymbols().end());
+            }
+            throw std::runtime_error(parser.error());
+        }
+
+        // The collected names are case normalized by exprtk.
+        std::vector<typename exprtk::parser<T>::dependent_entity_collector::symbol_t> assignments;
+        parser.dec().assignment_symbols(assignments);
+        for (auto &assignment : assignments) {
+            auto it = variableNames.find(assignment.first);
+            if (assignment.second == exprtk::parser<T>::e_st_variable && it != variableNames.end())
+                ret->assignments.emplace_back(it->second);
+        }
+
+        std::set<std::string> visited;
+        ret->pure = ret->assignments.empty() && isPure(symbolTable, optimized, visited);
+        visited.clear();
+        ret->scripts = callsScripts(symbolTable, optimized, visited);
+        ret->source = optimized;
+
+        return ret;
+    }
+
+    /**
+     * @param symbolTable
+     * @param expr
+     * @param visited The functions which have already been checked.
+     * @return True if the expression and the bound functions it references do not reference scripts
+     * and do not compare for equality.
+     */
+    bool isPure(const SymbolTable &symbolTable, const std::string &expr, std::set<std::string> &visited) const {
+        exprtk::lexer::generator generator;
+        if (!generator.process(expr))
+            return false;
+        for (size_t i = 0; i < generator.size(); i++) {
+            auto &token = generator[i];
+            if (token.type == exprtk::lexer::token::e_eq || token.type == exprtk::lexer::token::e_ne)
+                return false;
+            if (token.type != exprtk::lexer::token::e_symbol)
+                continue;
+            if (exprtk::details::imatch(token.value, "equal") || exprtk::details::imatch(token.value, "not_equal"))
+                return false;
+            std::string name = symbolTable.findSymbol(token.value);
+            if (scripts.find(name) != scripts.end())
+                return false;
+            auto function = functions.find(name);
+            if (function != functions.end()
+                && visited.insert(name).second
+                && !isPure(symbolTable, function->second->getFunction().expression, visited))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @param symbolTable
+     * @param expr
+     * @param visited The functions which have already been checked.
+     * @return True if the expression or the bound functions it references call scripts.
+     */
+    bool callsScripts(const SymbolTable &symbolTable, const std::string &expr, std::set<std::string> &visited) const {
+        exprtk::lexer::generator generator;
+        if (!generator.process(expr))
+            return true;
+        for (size_t i = 0; i < generator.size(); i++) {
+            auto &token = generator[i];
+            if (token.type != exprtk::lexer::token::e_symbol)
+                continue;
+            std::string name = symbolTable.findSymbol(token.value);
+            if (scripts.find(name) != scripts.end())
+                return true;
+            auto function = functions.find(name);
+            if (function != functions.end()
+                && visited.insert(name).second
+                && callsScripts(symbolTable, function->second->getFunction().expression, visited))
+                return true;
+        }
+        return false;
+    }
+
+    bool isBound(const std::string &name) const {
+        return variables.find(name) != variables.end()
+               || constants.find(name) != constants.end()
+               || functions.find(name) != functions.end()
+               || scripts.find(name) != scripts.end();
+    }
+
+    /**
+     * @param symbolTable
+     * @param name
+     * @return True if the symbol is bound or is a function or script referenced by a bound function.
+     */
+    bool isRequired(const SymbolTable &symbolTable, const std::string &name) const {
+        if (isBound(name))
+            return true;
+        return dependents.find(name) != dependents.end()
+               && (symbolTable.getFunctions().find(name) != symbolTable.getFunctions().end()
+                   || symbolTable.getScripts().find(name) != symbolTable.getScripts().end());
+    }
+
+    /**
+     * Bring the symbol with the given name in sync with its definition in the symbol table.
+     *
+     * @param symbolTable
+     * @param name
+     */
+    void apply(const SymbolTable &symbolTable, const std::string &name) {
+        bool dependencyChanged = functions.find(name) != functions.end()
+                                 || scripts.find(name) != scripts.end();
+
+        auto variable = symbolTable.getVariables().find(name);
+        auto constant = symbolTable.getConstants().find(name);
+        auto function = symbolTable.getFunctions().find(name);
+        auto script = symbolTable.getScripts().find(name);
+
+        if (variable != symbolTable.getVariables().end()) {
+            auto it = variables.find(name);
+            if (it != variables.end()) {
+                // Updating the value of a variable does not affect any compiled expressions.
+                it->second = toValue(symbolTable, name, variable->second);
+            } else {
+                // Adding a symbol does not affect the compiled expressions as they cannot reference it.
+                unbind(name);
+                variables[name] = toValue(symbolTable, name, variable->second);
+                valueSymbols.add_variable(name, variables.at(name));
+                variableNames.emplace(name, name);
+            }
+        } else if (constant != symbolTable.getConstants().end()) {
+            auto it = constants.find(name);
+            if (it != constants.end()
+                && it->second == constant->second
+                && symbolTable.getRationals().find(name) == symbolTable.getRationals().end())
+                return;
+            unbind(name);
+            constants[name] = constant->second;
+            valueSymbols.add_constant(name, toValue(symbolTable, name, constant->second));
+        } else if (function != symbolTable.getFunctions().end()) {
+            const auto &definition = symbolTable.getFunctionDefinitions().at(name);
+            auto it = functions.find(name);
+            if (it != functions.end() && it->second->getVersion() == definition->getVersion())
+                return;
+            if (it == functions.end())
+                unbind(name);
+            bindFunction(symbolTable, name, definition);
+            dependencyChanged = true;
+        } else if (script != symbolTable.getScripts().end()) {
+            auto it = scripts.find(name);
+            if (it != scripts.end() && it->second == script->second)
+                return;
+            unbind(name);
+            scripts[name] = script->second;
+            if (script->second.enableArguments) {
+                auto &f = varArgScriptFunctions[name];
+                f = std::make_unique<ScriptVarArgFunction<T>>(script->second.callback);
+                varArgScriptSymbols.add_function(name, *f);
+            } else {
+                auto &f = scriptFunctions[name];
+                f = std::make_unique<ScriptFunction<T>>(script->second.callback);
+                compositor.symbol_table().add_function(name, *f);
+            }
+            dependencyChanged = true;
+        } else {
+            unbind(name);
+        }
+
+        if (dependencyChanged) {
+            std::set<std::string> visited;
+            recompileDependents(name, visited);
+        }
+    }
+
+    /**
+     * @param symbolTable
+     * @param name
+     * @param value The value of the variable or constant in the symbol table.
+     * @return The value converted to T, the rational backend uses the exact value if the symbol table has one.
+     */
+    static T toValue(const SymbolTable &symbolTable, const std::string &name, const ArithmeticType &value) {
+        if constexpr (std::is_same<T, Rational>::value) {
+            auto it = symbolTable.getRationals().find(name);
+            Rational ret;
+            if (it != symbolTable.getRationals().end() && Rational::fromString(it->second, ret))
+                return ret;
+        }
+        return NumericConversion::fromArithmeticType<T>(value);
+    }
+
+    void bindFunction(const SymbolTable &symbolTable,
+                      const std::string &name,
+                      const std::shared_ptr<const FunctionDefinition> &function) {
+        if (functions.find(name) != functions.end())
+            invalidate();
+
+        removeDependencies(name);
+
+        functions[name] = function;
+
+        const std::set<std::string> &dependencies = function->getSymbols();
+
+        // Functions have to be compiled after the functions and scripts they reference.
+        for (auto &dependency : dependencies) {
+            if (functions.find(dependency) == functions.end()
+                && scripts.find(dependency) == scripts.end()
+                && (symbolTable.getFunctions().find(dependency) != symbolTable.getFunctions().end()
+                    || symbolTable.getScripts().find(dependency) != symbolTable.getScripts().end())) {
+                apply(symbolTable, dependency);
+            }
+        }
+
+        for (auto &dependency : dependencies) {
+            dependents[dependency].insert(name);
+        }
+        functionDependencies[name] = dependencies;
+
+        compileFunction(name, *function);
+    }
+
+    /**
+     * Compile the function into the compositor of this engine.
+     *
+     * Only the validation of the definition is shared with other engines, the compiled function references
+     * the symbols and the evaluation state of this engine and therefore is compiled once per engine and definition version.
+     */
+    void compileFunction(const std::string &name, const FunctionDefinition &function) {
+        typename exprtk::function_compositor<T>::function definition(name, function.getFunction().expression);
+        for (auto &argument : function.getFunction().argumentNames) {
+            definition.var(argument);
+        }
+        // Functions which fail to compile are not defined, the error is reported when an expression references them.
+        compositor.add(definition, true);
+    }
+
+    /**
+     * Recompile the functions which reference the given symbol as the compiled functions
+     * store references to the function objects of the symbol.
+     *
+     * @param name
+     * @param visited
+     */
+    void recompileDependents(const std::string &name, std::set<std::string> &visited) {
+        auto it = dependents.find(name);
+        if (it == dependents.end())
+            return;
+        std::set<std::string> names = it->second;
+        for (auto &dependent : names) {
+            auto function = functions.find(dependent);
+            if (function == functions.end() || !visited.insert(dependent).second)
+                continue;
+            invalidate();
+            compileFunction(dependent, *function->second);
+            recompileDependents(dependent, visited);
+        }
+    }
+
+    void removeDependencies(const std::string &name) {
+        auto it = functionDependencies.find(name);
+        if (it == functionDependencies.end())
+            return;
+        for (auto &dependency : it->second) {
+            auto d = dependents.find(dependency);
+            if (d == dependents.end())
+                continue;
+            d->second.erase(name);
+            if (d->second.empty())
+                dependents.erase(d);
+        }
+        functionDependencies.erase(it);
+    }
+
+    /**
+     * Remove the symbol with the given name from the exprtk state.
+     *
+     * Script function objects are retired instead of destroyed
+     * because compiled functions may reference them until they are recompiled.
+     *
+     * @param name
+     */
+    void unbind(const std::string &name) {
+        if (variables.find(name) != variables.end()) {
+            invalidate();
+            valueSymbols.remove_variable(name);
+            variables.erase(name);
+            auto it = variableNames.find(name);
+            if (it != variableNames.end() && it->second == name)
+                variableNames.erase(it);
+        } else if (constants.find(name) != constants.end()) {
+            invalidate();
+            valueSymbols.remove_variable(name);
+            constants.erase(name);
+        } else if (functions.find(name) != functions.end()) {
+            invalidate();
+            compositor.symbol_table().remove_function(name);
+            functions.erase(name);
+            removeDependencies(name);
+        } else if (scripts.find(name) != scripts.end()) {
+            invalidate();
+            auto it = scriptFunctions.find(name);
+            if (it != scriptFunctions.end()) {
+                compositor.symbol_table().remove_function(name);
+                retiredScriptFunctions.emplace_back(std::move(it->second));
+                scriptFunctions.erase(it);
+            }
+            auto vit = varArgScriptFunctions.find(name);
+            if (vit != varArgScriptFunctions.end()) {
+                retiredVarArgScriptFunctions.emplace_back(std::move(vit->second));
+                varArgScriptFunctions.erase(vit);
+                // The bundled exprtk version cannot remove vararg functions from a symbol table, use a new table instead.
+                varArgScriptSymbols = exprtk::symbol_table<T>();
+                for (auto &v : varArgScriptFunctions) {
+                    varArgScriptSymbols.add_function(v.first, *v.second);
+                }
+            }
+            scripts.erase(name);
+        }
+    }
+
+    /**
+     * Discard all cached expressions, has to be called before modifying the exprtk symbol tables
+     * because compiled expressions reference the symbol nodes.
+     */
+    void invalidate() {
+        cache.clear();
+        generation++;
+    }
+
+    void reset() {
+        invalidate();
+        compositor.clear();
+        valueSymbols.clear();
+        varArgScriptSymbols = exprtk::symbol_table<T>();
+        variables.clear();
+        variableNames.clear();
+        constants.clear();
+        functions.clear();
+        functionDependencies.clear();
+        dependents.clear();
+        scripts.clear();
+        scriptFunctions.clear();
+        varArgScriptFunctions.clear();
+        retiredScriptFunctions.clear();
+        retiredVarArgScriptFunctions.clear();
+        synchronized = false;
+    }
+
+    bool synchronized = false;
+    unsigned long revision = 0;
+    unsigned long generation = 0;
+    mpfr_prec_t precision = 0;
+    mpfr_rnd_t rounding = MPFR_RNDN;
+
+    std::map<std::string, T> variables;
+    std::map<std::string, std::string, exprtk::details::ilesscompare> variableNames; // Exprtk symbol names are case insensitive.
+    std::map<std::string, ArithmeticType> constants;
+    std::map<std::string, std::shared_ptr<const FunctionDefinition>> functions; // Shared with the symbol tables.
+    std::map<std::string, std::set<std::string>> functionDependencies; // The symbols referenced by each function.
+    std::map<std::string, std::set<std::string>> dependents; // The functions referencing each symbol.
+    std::map<std::string, Script> scripts;
+    std::map<std::string, std::unique_ptr<ScriptFunction<T>>> scriptFunctions;
+    std::map<std::string, std::unique_ptr<ScriptVarArgFunction<T>>> varArgScriptFunctions;
+    std::vector<std::unique_ptr<ScriptFunction<T>>> retiredScriptFunctions;
+    std::vector<std::unique_ptr<ScriptVarArgFunction<T>>> retiredVarArgScriptFunctions;
+
+    exprtk::symbol_table<T> valueSymbols;
+    exprtk::symbol_table<T> varArgScriptSymbols;
+    exprtk::function_compositor<T> compositor;
+    exprtk::parser<T> parser;
+    SymbolResolver resolver;
+
+    ExpressionCache<CompiledExpression> cache;
+};
+
+#endif //QCALC_EVALUATIONENGINE_HPP
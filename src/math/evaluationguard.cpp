@@ -0,0 +1,222 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "evaluationguard.hpp"
+
+#include <chrono>
+#include <atomic>
+#include <utility>
+#include <string>
+#include <stdexcept>
+
+#include "numericbackend.hpp"
+
+#include "evaluationcontext.hpp"
+#include "mpfrmemory.hpp"
+
+/**
+ * Aborts the evaluations of the calling thread at the next loop iteration once the token is cancelled.
+ */
+class CancellationCheck : public exprtk::details::loop_runtime_check {
+public:
+    /**
+     * @param token
+     * @param enclosing The cancellation check whose tokens are checked too, may be installed on a different thread.
+     */
+    CancellationCheck(CancellationToken token, const CancellationCheck *enclosing)
+            : token(std::move(token)),
+              previous(exprtk::details::loop_runtime_check::instance()),
+              previousCancellation(current()),
+              enclosing(enclosing) {
+        exprtk::details::loop_runtime_check::instance() = this;
+        current() = this;
+    }
+
+    ~CancellationCheck() override {
+        current() = previousCancellation;
+        exprtk::details::loop_runtime_check::instance() = previous;
+    }
+
+    /**
+     * @return The innermost cancellation check of the calling thread or nullptr.
+     */
+    static CancellationCheck *&current() {
+        static thread_local CancellationCheck *check = nullptr;
+        return check;
+    }
+
+    CancellationCheck(const CancellationCheck &other) = delete;
+
+    CancellationCheck &operator=(const CancellationCheck &other) = delete;
+
+    void check() override {
+        checkCancelled();
+        if (previous != nullptr)
+            previous->check();
+    }
+
+    /**
+     * Check the tokens of this and the enclosing cancellation checks without checking the budgets.
+     */
+    void checkCancelled() const {
+        if (token.isCancelled())
+            throw std::runtime_error("Evaluation cancelled");
+        if (enclosing != nullptr)
+            enclosing->checkCancelled();
+    }
+
+private:
+    CancellationToken token;
+    exprtk::details::loop_runtime_check *previous;
+    CancellationCheck *previousCancellation;
+    const CancellationCheck *enclosing;
+};
+
+/**
+ * The limits and the consumption of a budget, shared by the budget checks of the threads evaluating parts of the same evaluation.
+ */
+struct BudgetState {
+    explicit BudgetState(const EvaluationBudget &budget) : budget(budget) {
+        if (budget.time.count() > 0)
+            deadline = std::chrono::steady_clock::now() + budget.time;
+    }
+
+    const EvaluationBudget budget;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<size_t> iterations{0};
+    // The sum of the peaks of the memory allocated by each thread, an upper bound of the peak of all threads combined.
+    std::atomic<long long> memory{0};
+};
+
+/**
+ * Aborts the evaluations of the calling thread at the next loop iteration once a limit of the budget is exceeded.
+ *
+ * The time limit is enforced by comparing the clock against the deadline at loop iterations and after the evaluation.
+ * The memory limit is checked up front against the size of a value of the requested precision
+ * and by the backends against the estimated size of large results (See MpfrMemory::checkRequest),
+ * the peak of the allocated memory is checked at loop iterations and after the evaluation.
+ */
+class BudgetCheck : public exprtk::details::loop_runtime_check {
+public:
+    explicit BudgetCheck(std::shared_ptr<BudgetState> state)
+            : state(std::move(state)), previous(exprtk::details::loop_runtime_check::instance()) {
+        const EvaluationBudget &budget = this->state->budget;
+        if (budget.memory > 0) {
+            MpfrMemory::install();
+            // A single value of the requested precision has to fit into the budget.
+            if (static_cast<size_t>(EvaluationContext::getCurrent().precision / 8) > budget.memory)
+                throwMemoryExceeded();
+            MpfrMemory::resetPeak();
+            memoryStart = MpfrMemory::getAllocated();
+            memoryLimit = std::make_unique<MpfrMemory::ScopedLimit>(budget.memory, getMemoryExceededMessage());
+        }
+
+        exprtk::details::loop_runtime_check::instance() = this;
+    }
+
+    ~BudgetCheck() override {
+        exprtk::details::loop_runtime_check::instance() = previous;
+    }
+
+    BudgetCheck(const BudgetCheck &other) = delete;
+
+    BudgetCheck &operator=(const BudgetCheck &other) = delete;
+
+    void check() override {
+        if (state->budget.iterations > 0)
+            state->iterations.fetch_add(1, std::memory_order_relaxed);
+        checkLimits();
+        if (previous != nullptr)
+            previous->check();
+    }
+
+    /**
+     * Check the limits, called after the evaluation to detect limits exceeded outside of loops.
+     */
+    void checkLimits() {
+        const EvaluationBudget &budget = state->budget;
+        if (budget.iterations > 0 && state->iterations.load(std::memory_order_relaxed) > budget.iterations)
+            throw std::runtime_error("Evaluation exceeded the budget of "
+                                     + std::to_string(budget.iterations) + " loop iterations");
+        if (budget.time.count() > 0 && std::chrono::steady_clock::now() >= state->deadline)
+            throw std::runtime_error("Evaluation exceeded the time budget of "
+                                     + std::to_string(budget.time.count()) + " ms");
+        if (budget.memory > 0) {
+            long long used = MpfrMemory::getPeak() - memoryStart;
+            if (used > reportedMemory) {
+                state->memory += used - reportedMemory;
+                reportedMemory = used;
+            }
+            if (state->memory.load() > static_cast<long long>(budget.memory))
+                throwMemoryExceeded();
+        }
+    }
+
+private:
+    std::string getMemoryExceededMessage() const {
+        return "Evaluation exceeded the memory budget of " + std::to_string(state->budget.memory) + " bytes";
+    }
+
+    [[noreturn]] void throwMemoryExceeded() const {
+        throw std::runtime_error(getMemoryExceededMessage());
+    }
+
+    std::shared_ptr<BudgetState> state;
+    exprtk::details::loop_runtime_check *previous;
+
+    long long memoryStart = 0;
+    long long reportedMemory = 0;
+    std::unique_ptr<MpfrMemory::ScopedLimit> memoryLimit;
+};
+
+EvaluationGuard::EvaluationGuard(const EvaluationBudget &budget, const CancellationToken &token)
+        : EvaluationGuard(budget.isUnlimited() ? nullptr : std::make_shared<BudgetState>(budget),
+                          token,
+                          CancellationCheck::current()) {}
+
+EvaluationGuard::EvaluationGuard(std::shared_ptr<BudgetState> budgetState,
+                                 const CancellationToken &token,
+                                 const CancellationCheck *enclosing)
+        : token(token), budgetState(std::move(budgetState)) {
+    if (token.isCancelled())
+        throw std::runtime_error("Evaluation cancelled");
+    cancellationCheck = std::make_unique<CancellationCheck>(token, enclosing);
+    if (this->budgetState)
+        budgetCheck = std::make_unique<BudgetCheck>(this->budgetState);
+}
+
+// The checks are uninstalled in reverse order of installation.
+EvaluationGuard::~EvaluationGuard() {
+    budgetCheck.reset();
+    cancellationCheck.reset();
+}
+
+EvaluationGuard EvaluationGuard::share() const {
+    return EvaluationGuard(budgetState, token, cancellationCheck.get());
+}
+
+void EvaluationGuard::checkLimits() {
+    if (budgetCheck)
+        budgetCheck->checkLimits();
+}
+
+void EvaluationGuard::checkCancelled() {
+    if (CancellationCheck::current() != nullptr)
+        CancellationCheck::current()->checkCancelled();
+}
@@ -0,0 +1,99 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_EVALUATIONGUARD_HPP
+#define QCALC_EVALUATIONGUARD_HPP
+
+#include <memory>
+
+#include "evaluationbudget.hpp"
+#include "cancellationtoken.hpp"
+
+class CancellationCheck;
+
+class BudgetCheck;
+
+struct BudgetState;
+
+/**
+ * Enforces the budget and the cancellation token for the evaluations of the calling thread during the lifetime of the guard.
+ *
+ * Evaluations are aborted with a runtime_error at the next loop iteration
+ * once the token is cancelled or a limit of the budget is exceeded,
+ * operations whose estimated result exceeds the memory budget abort the evaluation before they run (See EvaluationBudget).
+ * Guards may be nested, in which case the checks of all guards apply.
+ * The threads evaluating parts of the same evaluation install shared guards (See share()).
+ *
+ * The checks only run between operations, a single long operation (eg. a function of a huge precision,
+ * a call into a python script or formatting the result) cannot be interrupted and completes before the evaluation is aborted.
+ */
+class EvaluationGuard {
+public:
+    /**
+     * @param budget
+     * @param token
+     * @throws std::runtime_error If the token is already cancelled or the budget cannot be met.
+     */
+    EvaluationGuard(const EvaluationBudget &budget, const CancellationToken &token);
+
+    ~EvaluationGuard();
+
+    EvaluationGuard(const EvaluationGuard &other) = delete;
+
+    EvaluationGuard &operator=(const EvaluationGuard &other) = delete;
+
+    /**
+     * Create a guard for the evaluations of the calling thread which shares the budget and the token of this guard.
+     *
+     * The loop iterations, the deadline and the memory of all sharing guards count against the same budget
+     * and the guard is cancelled with this guard or any guard enclosing it.
+     * The budgets of the guards enclosing this guard do not apply to the calling thread.
+     * Called by the threads which evaluate parts of an evaluation of another thread, this guard must outlive the returned guard.
+     *
+     * @return The guard which is installed on the calling thread.
+     * @throws std::runtime_error If the token is already cancelled or the budget cannot be met.
+     */
+    EvaluationGuard share() const;
+
+    /**
+     * Check the limits of the budget, called after an evaluation to detect limits exceeded outside of loops
+     * or by an evaluation which handled the error.
+     */
+    void checkLimits();
+
+    /**
+     * Check the cancellation tokens of the guards of the calling thread,
+     * called by operations which do not run inside of exprtk loops (eg. scripts).
+     *
+     * @throws std::runtime_error If the token of any guard of the calling thread is cancelled.
+     */
+    static void checkCancelled();
+
+private:
+    EvaluationGuard(std::shared_ptr<BudgetState> budgetState,
+                    const CancellationToken &token,
+                    const CancellationCheck *enclosing);
+
+    CancellationToken token;
+    std::shared_ptr<BudgetState> budgetState;
+    std::unique_ptr<CancellationCheck> cancellationCheck;
+    std::unique_ptr<BudgetCheck> budgetCheck;
+};
+
+#endif //QCALC_EVALUATIONGUARD_HPP
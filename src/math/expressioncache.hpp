@@ -0,0 +1,148 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_EXPRESSIONCACHE_HPP
+#define QCALC_EXPRESSIONCACHE_HPP
+
+#include <string>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include "../extern/mpreal.h"
+
+struct ExpressionCacheStatistics {
+    unsigned long hits = 0;
+    unsigned long misses = 0;
+    unsigned long evictions = 0;
+};
+
+/**
+ * Bounded least recently used cache of compiled expressions.
+ *
+ * Entries are removed from the cache while they are in use by a caller (take / put),
+ * this way a nested evaluation of the same expression (eg. from a script) never shares the compiled state
+ * of the outer evaluation and the lock only has to be held for the bookkeeping.
+ *
+ * @tparam T The type of the cached compiled expression.
+ */
+template<typename T>
+class ExpressionCache {
+public:
+    struct Key {
+        std::string expression;
+        unsigned long symbolTableVersion = 0;
+        mpfr_prec_t precision = 0;
+        mpfr_rnd_t rounding = MPFR_RNDN;
+
+        bool operator<(const Key &other) const {
+            return std::tie(expression, symbolTableVersion, precision, rounding)
+                   < std::tie(other.expression, other.symbolTableVersion, other.precision, other.rounding);
+        }
+    };
+
+    explicit ExpressionCache(size_t capacity) : capacity(capacity) {}
+
+    /**
+     * Remove the entry with the given key from the cache and return it.
+     *
+     * @param key
+     * @return The cached entry or nullptr if no entry with the given key exists.
+     */
+    std::unique_ptr<T> take(const Key &key) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            statistics.misses++;
+            return nullptr;
+        }
+        statistics.hits++;
+        std::unique_ptr<T> ret = std::move(it->second.value);
+        order.erase(it->second.position);
+        entries.erase(it);
+        return ret;
+    }
+
+    /**
+     * Insert the entry as the most recently used entry, evicting the least recently used entries if the capacity is exceeded.
+     * If an entry with the same key already exists the passed entry is discarded.
+     *
+     * @param key
+     * @param value
+     */
+    void put(const Key &key, std::unique_ptr<T> value) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (capacity == 0 || entries.find(key) != entries.end())
+            return;
+        order.emplace_front(key);
+        entries[key] = Entry{std::move(value), order.begin()};
+        evict();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> guard(mutex);
+        entries.clear();
+        order.clear();
+    }
+
+    void setCapacity(size_t value) {
+        std::lock_guard<std::mutex> guard(mutex);
+        capacity = value;
+        evict();
+    }
+
+    size_t getCapacity() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return capacity;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return entries.size();
+    }
+
+    ExpressionCacheStatistics getStatistics() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return statistics;
+    }
+
+private:
+    struct Entry {
+        std::unique_ptr<T> value;
+        typename std::list<Key>::iterator position;
+    };
+
+    void evict() {
+        while (entries.size() > capacity) {
+            entries.erase(order.back());
+            order.pop_back();
+            statistics.evictions++;
+        }
+    }
+
+    std::mutex mutex;
+    size_t capacity;
+    std::map<Key, Entry> entries;
+    std::list<Key> order; // Most recently used key at the front.
+    ExpressionCacheStatistics statistics;
+};
+
+#endif //QCALC_EXPRESSIONCACHE_HPP
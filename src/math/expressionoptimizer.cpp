@@ -0,0 +1,558 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "expressionoptimizer.hpp"
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include "numericbackend.hpp"
+
+// The maximum number of tokens of a function body which is inlined.
+static const size_t INLINE_TOKEN_LIMIT = 64;
+
+// Calls are not inlined anymore once the expression has grown to this number of tokens.
+static const size_t EXPANSION_TOKEN_LIMIT = 4096;
+
+// The maximum number of subexpressions which are assigned to local variables.
+static const size_t SUBEXPRESSION_LIMIT = 64;
+
+typedef exprtk::lexer::token TokenBase;
+
+struct Token {
+    TokenBase::token_type type;
+    std::string value;
+};
+
+typedef std::vector<Token> Tokens;
+
+// Symbols which declare local variables, introduce control flow or evaluate their operands conditionally.
+static const char *const CONTROL_SYMBOLS[] = {"var", "if", "else", "while", "for", "repeat", "until", "switch", "case",
+                                              "default", "return", "break", "continue", "~", "&", "|", "scand", "scor"};
+
+static Token makeSymbol(const std::string &value) {
+    return {TokenBase::e_symbol, value};
+}
+
+static Token makeOperator(TokenBase::token_type type, const std::string &value) {
+    return {type, value};
+}
+
+static bool isSymbol(const Token &token, const char *value) {
+    return token.type == TokenBase::e_symbol && exprtk::details::imatch(token.value, value);
+}
+
+/**
+ * @return False if the expression cannot be tokenized or contains string literals,
+ * which cannot be reconstructed from their tokens.
+ */
+static bool tokenize(const std::string &expr, Tokens &ret) {
+    exprtk::lexer::generator generator;
+    if (!generator.process(expr))
+        return false;
+    ret.clear();
+    for (size_t i = 0; i < generator.size(); i++) {
+        if (generator[i].type == TokenBase::e_string)
+            return false;
+        ret.push_back({generator[i].type, generator[i].value});
+    }
+    return true;
+}
+
+static std::string join(const Tokens &tokens) {
+    std::string ret;
+    for (auto &token : tokens) {
+        if (!ret.empty())
+            ret += ' ';
+        ret += token.value;
+    }
+    return ret;
+}
+
+/**
+ * @return True if the tokens are a single statement without assignments, local variables and control flow,
+ * which therefore evaluates each of its subexpressions exactly once.
+ */
+static bool isStraightLine(const Tokens &tokens) {
+    for (auto &token : tokens) {
+        switch (token.type) {
+            case TokenBase::e_eof:
+            case TokenBase::e_assign:
+            case TokenBase::e_addass:
+            case TokenBase::e_subass:
+            case TokenBase::e_mulass:
+            case TokenBase::e_divass:
+            case TokenBase::e_modass:
+            case TokenBase::e_swap:
+            case TokenBase::e_lsqrbracket:
+            case TokenBase::e_rsqrbracket:
+            case TokenBase::e_lcrlbracket:
+            case TokenBase::e_rcrlbracket:
+            case TokenBase::e_ternary:
+            case TokenBase::e_colon:
+                return false;
+            case TokenBase::e_symbol:
+                for (auto *symbol : CONTROL_SYMBOLS) {
+                    if (exprtk::details::imatch(token.value, symbol))
+                        return false;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @return The index of the bracket which closes the bracket at begin or the size of the tokens if it is not closed.
+ */
+static size_t findClosingBracket(const Tokens &tokens, size_t begin) {
+    int depth = 0;
+    for (size_t i = begin; i < tokens.size(); i++) {
+        switch (tokens[i].type) {
+            case TokenBase::e_lbracket:
+            case TokenBase::e_lsqrbracket:
+            case TokenBase::e_lcrlbracket:
+                depth++;
+                break;
+            case TokenBase::e_rbracket:
+            case TokenBase::e_rsqrbracket:
+            case TokenBase::e_rcrlbracket:
+                if (--depth == 0)
+                    return i;
+                break;
+            default:
+                break;
+        }
+    }
+    return tokens.size();
+}
+
+/**
+ * @return The comma separated arguments between begin and end.
+ */
+static std::vector<Tokens> splitArguments(const Tokens &tokens, size_t begin, size_t end) {
+    std::vector<Tokens> ret;
+    if (begin >= end)
+        return ret;
+    ret.emplace_back();
+    int depth = 0;
+    for (size_t i = begin; i < end; i++) {
+        switch (tokens[i].type) {
+            case TokenBase::e_lbracket:
+            case TokenBase::e_lsqrbracket:
+            case TokenBase::e_lcrlbracket:
+                depth++;
+                break;
+            case TokenBase::e_rbracket:
+            case TokenBase::e_rsqrbracket:
+            case TokenBase::e_rcrlbracket:
+                depth--;
+                break;
+            case TokenBase::e_comma:
+                if (depth == 0) {
+                    ret.emplace_back();
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        ret.back().push_back(tokens[i]);
+    }
+    return ret;
+}
+
+class Optimizer {
+public:
+    Optimizer(const SymbolTable &symbolTable, const Tokens &expression) : symbolTable(symbolTable) {
+        addUsedNames(expression);
+    }
+
+    /**
+     * Inline the calls of inlineable functions until no calls are left or the expansion limit is reached.
+     *
+     * @param tokens
+     * @param inlined The names of the inlined functions are added to the set.
+     * @return True if any call was inlined.
+     */
+    bool inlineFunctions(Tokens &tokens, std::set<std::string> &inlined) {
+        bool ret = false;
+        while (tokens.size() <= EXPANSION_TOKEN_LIMIT && inlinePass(tokens, inlined))
+            ret = true;
+        return ret;
+    }
+
+    /**
+     * Assign the calls of functions without side effects which appear more than once with equal arguments
+     * to local variables, the longest calls are assigned first. Other repeated subexpressions are not assigned.
+     *
+     * @param tokens
+     * @return True if any call was assigned.
+     */
+    bool eliminateCommonSubexpressions(Tokens &tokens) {
+        if (!isStraightLine(tokens))
+            return false;
+
+        // The expression followed by the definitions of the local variables, the latest definition first.
+        std::vector<Tokens> parts{tokens};
+        std::vector<std::string> names{""};
+
+        for (size_t n = 0; n < SUBEXPRESSION_LIMIT; n++) {
+            std::map<std::string, std::vector<Span>> spans;
+            for (size_t p = 0; p < parts.size(); p++) {
+                const Tokens &part = parts.at(p);
+                for (size_t i = 0; i + 1 < part.size(); i++) {
+                    if (part[i].type != TokenBase::e_symbol || part[i + 1].type != TokenBase::e_lbracket)
+                        continue;
+                    size_t end = findClosingBracket(part, i + 1);
+                    if (end == part.size())
+                        continue;
+                    Tokens call(part.begin() + i, part.begin() + end + 1);
+                    if (isPure(call))
+                        spans[join(call)].push_back({p, i, end + 1});
+                }
+            }
+
+            const std::vector<Span> *repeated = nullptr;
+            for (auto &span : spans) {
+                if (span.second.size() < 2)
+                    continue;
+                if (repeated == nullptr || span.second.front().length() > repeated->front().length())
+                    repeated = &span.second;
+            }
+            if (repeated == nullptr)
+                break;
+
+            const Span &first = repeated->front();
+            Tokens definition(parts.at(first.part).begin() + first.begin, parts.at(first.part).begin() + first.end);
+            std::string name = newName();
+
+            // The spans are ordered by part and position, replacing from the back keeps the positions valid.
+            for (auto it = repeated->rbegin(); it != repeated->rend(); it++) {
+                Tokens &part = parts.at(it->part);
+                part.erase(part.begin() + it->begin, part.begin() + it->end);
+                part.insert(part.begin() + it->begin, makeSymbol(name));
+            }
+
+            // A later definition is contained in the earlier definitions but not the other way round.
+            parts.insert(parts.begin() + 1, definition);
+            names.insert(names.begin() + 1, name);
+        }
+
+        if (parts.size() == 1)
+            return false;
+
+        Tokens ret{makeSymbol("~"), makeOperator(TokenBase::e_lcrlbracket, "{")};
+        for (size_t p = 1; p < parts.size(); p++) {
+            ret.push_back(makeSymbol("var"));
+            ret.push_back(makeSymbol(names.at(p)));
+            ret.push_back(makeOperator(TokenBase::e_assign, ":="));
+            ret.insert(ret.end(), parts.at(p).begin(), parts.at(p).end());
+            ret.push_back(makeOperator(TokenBase::e_eof, ";"));
+        }
+        ret.insert(ret.end(), parts.front().begin(), parts.front().end());
+        ret.push_back(makeOperator(TokenBase::e_rcrlbracket, "}"));
+        tokens = std::move(ret);
+        return true;
+    }
+
+private:
+    struct Span {
+        size_t part;
+        size_t begin;
+        size_t end;
+
+        size_t length() const {
+            return end - begin;
+        }
+    };
+
+    struct Body {
+        bool inlineable = false;
+        Tokens tokens; // The body with the calls of inlineable functions inlined.
+        std::set<std::string> inlined; // The functions which were inlined into the body.
+    };
+
+    const SymbolTable &symbolTable;
+
+    std::map<std::string, Body> bodies;
+    std::set<std::string> preparing;
+
+    std::set<std::string> usedNames; // The lower case symbols of the expression and the prepared bodies.
+    size_t nameCount = 0;
+
+    void addUsedNames(const Tokens &tokens) {
+        for (auto &token : tokens) {
+            if (token.type == TokenBase::e_symbol)
+                usedNames.insert(SymbolTable::toLower(token.value));
+        }
+    }
+
+    /**
+     * @return A local variable name which does not clash with any symbol of the table or the expression.
+     */
+    std::string newName() {
+        std::string ret;
+        do {
+            ret = "qcalc_local" + std::to_string(nameCount++);
+        } while (usedNames.find(ret) != usedNames.end() || !symbolTable.findSymbol(ret).empty());
+        usedNames.insert(ret);
+        return ret;
+    }
+
+    bool isFunction(const std::string &name) const {
+        return symbolTable.getFunctions().find(name) != symbolTable.getFunctions().end();
+    }
+
+    bool isScript(const std::string &name) const {
+        return symbolTable.getScripts().find(name) != symbolTable.getScripts().end();
+    }
+
+    /**
+     * @return True if the tokens are straight line and do not call scripts or functions which may call scripts.
+     */
+    bool isPure(const Tokens &tokens) const {
+        if (!isStraightLine(tokens))
+            return false;
+        for (auto &token : tokens) {
+            if (token.type != TokenBase::e_symbol)
+                continue;
+            std::string name = symbolTable.findSymbol(token.value);
+            if (isFunction(name) || isScript(name))
+                return false;
+        }
+        return true;
+    }
+
+    static size_t findParameter(const std::vector<std::string> &parameters, const Token &token) {
+        if (token.type != TokenBase::e_symbol)
+            return parameters.size();
+        for (size_t i = 0; i < parameters.size(); i++) {
+            if (exprtk::details::imatch(parameters[i], token.value))
+                return i;
+        }
+        return parameters.size();
+    }
+
+    /**
+     * The compositor compiles functions without the values of the table,
+     * functions which reference them fail to compile and must not be inlined.
+     */
+    bool isInlineable(const Function &function, const Tokens &tokens) const {
+        for (auto &token : tokens) {
+            if (token.type != TokenBase::e_symbol
+                || findParameter(function.argumentNames, token) != function.argumentNames.size())
+                continue;
+            if (isSymbol(token, "return"))
+                return false;
+            std::string name = symbolTable.findSymbol(token.value);
+            if (!name.empty() && !isFunction(name) && !isScript(name))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @return The prepared body of the function or nullptr if the function is not inlineable.
+     */
+    const Body *getBody(const std::string &name) {
+        auto it = bodies.find(name);
+        if (it != bodies.end())
+            return it->second.inlineable ? &it->second : nullptr;
+
+        // The function is recursive if it is reached again while its body is prepared.
+        if (!preparing.insert(name).second)
+            return nullptr;
+
+        Body body;
+        const Function &function = symbolTable.getFunctions().at(name);
+        if (tokenize(function.expression, body.tokens)
+            && body.tokens.size() <= INLINE_TOKEN_LIMIT
+            && isInlineable(function, body.tokens)) {
+            addUsedNames(body.tokens);
+            inlineFunctions(body.tokens, body.inlined);
+            body.inlineable = std::none_of(body.tokens.begin(), body.tokens.end(), [&](const Token &token) {
+                return token.type == TokenBase::e_symbol && symbolTable.findSymbol(token.value) == name;
+            });
+        }
+
+        preparing.erase(name);
+        it = bodies.emplace(name, std::move(body)).first;
+        return it->second.inlineable ? &it->second : nullptr;
+    }
+
+    /**
+     * @return True if the argument is a single symbol or literal which is not worth assigning to a local variable.
+     */
+    static bool isAtom(const Tokens &argument) {
+        return argument.size() == 1
+               && (argument.front().type == TokenBase::e_symbol || argument.front().type == TokenBase::e_number);
+    }
+
+    /**
+     * Replace one call of the body.
+     *
+     * If the body and the arguments are pure, the parameters which the body uses at most once
+     * or whose argument is a single symbol or literal are replaced by the arguments.
+     * The other parameters are replaced by local variables which are assigned the arguments,
+     * so that each argument is evaluated once.
+     */
+    Tokens expand(const Body &body, const std::vector<std::string> &parameters, const std::vector<Tokens> &arguments) {
+        bool pure = isStraightLine(body.tokens)
+                    && std::all_of(arguments.begin(), arguments.end(), [this](const Tokens &argument) {
+            return isPure(argument);
+        });
+
+        std::vector<bool> bound(parameters.size(), true);
+        if (pure) {
+            std::vector<size_t> uses(parameters.size(), 0);
+            for (auto &token : body.tokens) {
+                size_t parameter = findParameter(parameters, token);
+                if (parameter != parameters.size())
+                    uses[parameter]++;
+            }
+            for (size_t i = 0; i < parameters.size(); i++) {
+                bound[i] = uses[i] > 1 && !isAtom(arguments[i]);
+            }
+        }
+
+        Tokens ret;
+        if (pure && std::none_of(bound.begin(), bound.end(), [](bool b) { return b; })) {
+            ret.push_back(makeOperator(TokenBase::e_lbracket, "("));
+            appendSubstituted(ret, body.tokens, parameters, arguments);
+            ret.push_back(makeOperator(TokenBase::e_rbracket, ")"));
+            return ret;
+        }
+
+        // The lower case names of the bound parameters and local variables of the body and their names in the expansion.
+        std::map<std::string, std::string> names;
+
+        ret.push_back(makeSymbol("~"));
+        ret.push_back(makeOperator(TokenBase::e_lcrlbracket, "{"));
+        for (size_t i = 0; i < parameters.size(); i++) {
+            if (!bound[i])
+                continue;
+            std::string name = newName();
+            names[SymbolTable::toLower(parameters.at(i))] = name;
+            ret.push_back(makeSymbol("var"));
+            ret.push_back(makeSymbol(name));
+            ret.push_back(makeOperator(TokenBase::e_assign, ":="));
+            ret.push_back(makeOperator(TokenBase::e_lbracket, "("));
+            ret.insert(ret.end(), arguments.at(i).begin(), arguments.at(i).end());
+            ret.push_back(makeOperator(TokenBase::e_rbracket, ")"));
+            ret.push_back(makeOperator(TokenBase::e_eof, ";"));
+        }
+
+        // Local variables are renamed so that the expansions of the same body do not declare equal names.
+        for (size_t i = 0; i + 1 < body.tokens.size(); i++) {
+            if (isSymbol(body.tokens[i], "var") && body.tokens[i + 1].type == TokenBase::e_symbol)
+                names.emplace(SymbolTable::toLower(body.tokens[i + 1].value), newName());
+        }
+
+        for (auto &token : body.tokens) {
+            auto it = token.type == TokenBase::e_symbol ? names.find(SymbolTable::toLower(token.value)) : names.end();
+            if (it != names.end())
+                ret.push_back(makeSymbol(it->second));
+            else
+                appendSubstituted(ret, Tokens{token}, parameters, arguments);
+        }
+        ret.push_back(makeOperator(TokenBase::e_rcrlbracket, "}"));
+        return ret;
+    }
+
+    /**
+     * Append the tokens with the parameters replaced by the bracketed arguments.
+     */
+    static void appendSubstituted(Tokens &ret,
+                                  const Tokens &tokens,
+                                  const std::vector<std::string> &parameters,
+                                  const std::vector<Tokens> &arguments) {
+        for (auto &token : tokens) {
+            size_t parameter = findParameter(parameters, token);
+            if (parameter == parameters.size()) {
+                ret.push_back(token);
+                continue;
+            }
+            ret.push_back(makeOperator(TokenBase::e_lbracket, "("));
+            ret.insert(ret.end(), arguments.at(parameter).begin(), arguments.at(parameter).end());
+            ret.push_back(makeOperator(TokenBase::e_rbracket, ")"));
+        }
+    }
+
+    bool inlinePass(Tokens &tokens, std::set<std::string> &inlined) {
+        bool changed = false;
+        Tokens ret;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            const Token &token = tokens[i];
+
+            std::string name;
+            if (token.type == TokenBase::e_symbol && !(i > 0 && isSymbol(tokens[i - 1], "var")))
+                name = symbolTable.findSymbol(token.value);
+            const Body *body = isFunction(name) ? getBody(name) : nullptr;
+            if (body == nullptr) {
+                ret.push_back(token);
+                continue;
+            }
+
+            // Functions without parameters may be referenced without brackets.
+            std::vector<Tokens> arguments;
+            size_t end = i;
+            if (i + 1 < tokens.size() && tokens[i + 1].type == TokenBase::e_lbracket) {
+                end = findClosingBracket(tokens, i + 1);
+                if (end == tokens.size()) {
+                    ret.push_back(token);
+                    continue;
+                }
+                arguments = splitArguments(tokens, i + 2, end);
+            }
+
+            // Calls with the wrong number of arguments are left for exprtk to report.
+            const auto &parameters = symbolTable.getFunctions().at(name).argumentNames;
+            if (arguments.size() != parameters.size()) {
+                ret.push_back(token);
+                continue;
+            }
+
+            Tokens expansion = expand(*body, parameters, arguments);
+            ret.insert(ret.end(), expansion.begin(), expansion.end());
+            inlined.insert(name);
+            inlined.insert(body->inlined.begin(), body->inlined.end());
+            changed = true;
+            i = end;
+        }
+        tokens = std::move(ret);
+        return changed;
+    }
+};
+
+std::string ExpressionOptimizer::optimize(const std::string &expr,
+                                          const SymbolTable &symbolTable,
+                                          std::set<std::string> &inlined) {
+    Tokens tokens;
+    if (!tokenize(expr, tokens))
+        return expr;
+
+    Optimizer optimizer(symbolTable, tokens);
+    bool changed = optimizer.inlineFunctions(tokens, inlined);
+    changed = optimizer.eliminateCommonSubexpressions(tokens) || changed;
+    return changed ? join(tokens) : expr;
+}
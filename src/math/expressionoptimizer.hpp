@@ -0,0 +1,51 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_EXPRESSIONOPTIMIZER_HPP
+#define QCALC_EXPRESSIONOPTIMIZER_HPP
+
+#include <string>
+#include <set>
+
+#include "symboltable.hpp"
+
+/**
+ * Source to source optimization of expressions before they are compiled by exprtk.
+ *
+ * Calls of small non recursive functions of the symbol table are replaced by the body of the function.
+ * If the body and the arguments are pure the arguments are substituted for the parameters which the body uses once
+ * or whose argument is a single symbol or literal, the other arguments are assigned to local variables
+ * in a ~{} block like the function compositor does so that each argument is evaluated once.
+ *
+ * If the resulting expression is a single statement without assignments, local variables, control flow
+ * and calls of scripts, repeated function calls with equal arguments are assigned to local variables
+ * so that they are computed once per evaluation. Only function calls are considered,
+ * other repeated subexpressions (eg. the operands of (a + b) * (a + b)) are left to exprtk.
+ */
+namespace ExpressionOptimizer {
+    /**
+     * @param expr
+     * @param symbolTable
+     * @param inlined Set to the names of the functions of the table whose bodies were inlined.
+     * @return The optimized expression or expr if it cannot be optimized.
+     */
+    std::string optimize(const std::string &expr, const SymbolTable &symbolTable, std::set<std::string> &inlined);
+}
+
+#endif //QCALC_EXPRESSIONOPTIMIZER_HPP
@@ -19,134 +19,560 @@
 
 #include "expressionparser.hpp"
 
-#include "../extern/exprtk_mpfr_adaptor.hpp"
-#include "../extern/exprtk.hpp"
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <limits>
+#include <memory>
 
-#include "scriptfunction.hpp"
-#include "scriptvarargfunction.hpp"
+#include "numericbackend.hpp"
 
-ArithmeticType ExpressionParser::evaluate(const std::string &expr, SymbolTable &symbolTable) {
-    exprtk::parser<ArithmeticType> parser;
-    exprtk::function_compositor<ArithmeticType> compositor;
-    exprtk::symbol_table<ArithmeticType> symbols = compositor.symbol_table();
-
-    int varArgScriptCount = 0;
-    int scriptCount = 0;
-    for (auto &v : symbolTable.getScripts()) {
-        if (v.second.enableArguments)
-            varArgScriptCount++;
-        else
-            scriptCount++;
-    }
-
-    //Use vectors with fixed size to store the function objects as the symbol table itself only stores references.
-    int varArgScriptIndex = 0;
-    std::vector<ScriptVarArgFunction<ArithmeticType>> varArgScriptFunctions;
-    varArgScriptFunctions.resize(varArgScriptCount);
-
-    int scriptIndex = 0;
-    std::vector<ScriptFunction<ArithmeticType>> scriptFunctions;
-    scriptFunctions.resize(scriptCount);
-
-    for (auto &v : symbolTable.getScripts()) {
-        if (v.second.enableArguments) {
-            int index = varArgScriptIndex++;
-            assert(index < varArgScriptCount);
-            varArgScriptFunctions.at(index) = ScriptVarArgFunction<ArithmeticType>(v.second.callback);
-            symbols.add_function(v.first, varArgScriptFunctions.at(index));
-        } else {
-            int index = scriptIndex++;
-            assert(index < scriptCount);
-            scriptFunctions.at(index) = ScriptFunction<ArithmeticType>(v.second.callback);
-            symbols.add_function(v.first, scriptFunctions.at(index));
-        }
+#include "evaluationengine.hpp"
+#include "evaluationcontext.hpp"
+#include "evaluationguard.hpp"
+#include "mpfrmemory.hpp"
+#include "numberformat.hpp"
+#include "numericconversion.hpp"
+#include "workerpool.hpp"
+
+static const size_t EXPRESSION_CACHE_SIZE = 100;
+
+// The maximum number of working precisions for which adaptive evaluations keep an engine.
+static const size_t ADAPTIVE_ENGINES_SIZE = 4;
+
+// The bits added to the precision required by the formatted digits to absorb the rounding errors of the evaluation.
+static const mpfr_prec_t ADAPTIVE_GUARD_BITS = 64;
+
+// Working precisions are multiples of the limb size so that the engines are reused by consecutive evaluations.
+static const mpfr_prec_t ADAPTIVE_PRECISION_STEP = 64;
+
+/**
+ * The persistent engine of the calling thread for the arithmetic type T.
+ */
+template<typename T>
+struct ThreadEngine {
+    static thread_local EvaluationEngine<T> engine;
+    static thread_local bool active;
+};
+
+template<typename T>
+thread_local EvaluationEngine<T> ThreadEngine<T>::engine(EXPRESSION_CACHE_SIZE);
+
+template<typename T>
+thread_local bool ThreadEngine<T>::active = false;
+
+template<typename T>
+struct BackendType {
+    typedef T type;
+};
+
+// The fast path keeps its own engine so that its expressions do not displace those of the double backend.
+static thread_local EvaluationEngine<double> fastEngine(EXPRESSION_CACHE_SIZE);
+static thread_local bool fastEngineActive = false;
+
+static thread_local std::map<mpfr_prec_t, std::unique_ptr<EvaluationEngine<ArithmeticType>>> adaptiveEngines;
+static thread_local bool adaptiveEngineActive = false;
+
+/**
+ * Invoke the function with the BackendType of the backend of the current context.
+ *
+ * The mpfr backend evaluates using SmallReal if the values of the context precision are stored inline.
+ */
+template<typename F>
+static auto invokeBackend(F function) {
+    switch (EvaluationContext::getCurrent().backend) {
+        case BACKEND_MPFR:
+            if (EvaluationContext::getCurrent().precision <= SmallReal::INLINE_PRECISION)
+                return function(BackendType<SmallReal>());
+            return function(BackendType<ArithmeticType>());
+        case BACKEND_DOUBLE:
+            return function(BackendType<double>());
+        case BACKEND_LONG_DOUBLE:
+            return function(BackendType<long double>());
+#ifdef QCALC_FLOAT128
+        case BACKEND_FLOAT128:
+            return function(BackendType<__float128>());
+#endif
+        case BACKEND_DOUBLE_DOUBLE:
+            return function(BackendType<DoubleDouble>());
+        case BACKEND_QUAD_DOUBLE:
+            return function(BackendType<QuadDouble>());
+        case BACKEND_INTEGER:
+            return function(BackendType<BigInt>());
+        case BACKEND_RATIONAL:
+            return function(BackendType<Rational>());
+        case BACKEND_INTERVAL:
+            return function(BackendType<Interval>());
+        default:
+            throw std::runtime_error("The numeric backend is not available");
+    }
+}
+
+/**
+ * Invoke the function with the BackendType of every available backend.
+ */
+template<typename F>
+static void invokeBackends(F function) {
+    function(BackendType<ArithmeticType>());
+    function(BackendType<SmallReal>());
+    function(BackendType<double>());
+    function(BackendType<long double>());
+#ifdef QCALC_FLOAT128
+    function(BackendType<__float128>());
+#endif
+    function(BackendType<DoubleDouble>());
+    function(BackendType<QuadDouble>());
+    function(BackendType<BigInt>());
+    function(BackendType<Rational>());
+    function(BackendType<Interval>());
+}
+
+/**
+ * Invoke the function with the engine of the calling thread for T,
+ * a nested evaluation uses a temporary engine (See invokeEngine).
+ */
+template<typename T, typename F>
+static auto invokeThreadEngine(F function) {
+    if (ThreadEngine<T>::active) {
+        EvaluationEngine<T> nestedEngine(0);
+        return function(nestedEngine);
     }
 
-    assert(varArgScriptIndex == varArgScriptCount);
-    assert(scriptIndex == scriptCount);
-
-    for (auto &v : symbolTable.getFunctions()) {
-        switch (v.second.argumentNames.size()) {
-            case 0:
-                compositor.add(
-                        typename exprtk::function_compositor<ArithmeticType>::function(v.first, v.second.expression));
-                break;
-            case 1:
-                compositor.add(typename exprtk::function_compositor<ArithmeticType>::function(v.first,
-                                                                                              v.second.expression,
-                                                                                              v.second.argumentNames[0]));
-                break;
-            case 2:
-                compositor.add(
-                        typename exprtk::function_compositor<ArithmeticType>::function(v.first,
-                                                                                       v.second.expression,
-                                                                                       v.second.argumentNames[0],
-                                                                                       v.second.argumentNames[1]));
-                break;
-            case 3:
-                compositor.add(
-                        typename exprtk::function_compositor<ArithmeticType>::function(v.first,
-                                                                                       v.second.expression,
-                                                                                       v.second.argumentNames[0],
-                                                                                       v.second.argumentNames[1],
-                                                                                       v.second.argumentNames[2]));
-                break;
-            case 4:
-                compositor.add(
-                        typename exprtk::function_compositor<ArithmeticType>::function(v.first,
-                                                                                       v.second.expression,
-                                                                                       v.second.argumentNames[0],
-                                                                                       v.second.argumentNames[1],
-                                                                                       v.second.argumentNames[2],
-                                                                                       v.second.argumentNames[3]));
-                break;
-            case 5:
-                compositor.add(
-                        typename exprtk::function_compositor<ArithmeticType>::function(v.first,
-                                                                                       v.second.expression,
-                                                                                       v.second.argumentNames[0],
-                                                                                       v.second.argumentNames[1],
-                                                                                       v.second.argumentNames[2],
-                                                                                       v.second.argumentNames[3],
-                                                                                       v.second.argumentNames[4]));
-                break;
-            default:
-                throw std::runtime_error("Too many function argumentNames");
+    ThreadEngine<T>::active = true;
+    try {
+        auto ret = function(ThreadEngine<T>::engine);
+        ThreadEngine<T>::active = false;
+        return ret;
+    } catch (...) {
+        ThreadEngine<T>::active = false;
+        throw;
+    }
+}
+
+/**
+ * Invoke the function with the engine of the calling thread for the backend of the current context.
+ *
+ * A nested evaluation (eg. from a script function) must not modify the state of the active engine
+ * and therefore uses a temporary engine.
+ */
+template<typename F>
+static auto invokeEngine(F function) {
+    // Evaluate with the precision and rounding mode of the current context, even if the context is modified by a script.
+    ScopedEvaluationContext scope(EvaluationContext::getCurrent());
+
+    MpfrMemory::ScopedPool pool;
+
+    return invokeBackend([&](auto backend) {
+        return invokeThreadEngine<typename decltype(backend)::type>(function);
+    });
+}
+
+template<typename T>
+static std::vector<ArithmeticType> toArithmeticTypes(std::vector<T> values) {
+    if constexpr (std::is_same<T, ArithmeticType>::value) {
+        return values;
+    } else {
+        std::vector<ArithmeticType> ret;
+        ret.reserve(values.size());
+        for (auto &value : values) {
+            ret.emplace_back(NumericConversion::toArithmeticType(value));
         }
+        return ret;
     }
+}
+
+/**
+ * Evaluate the expression in hardware double precision and enclose its exact value if the expression is pure
+ * (See EvaluationEngine::evaluateEnclosure).
+ *
+ * The enclosure bounds the rounding errors of all operations including the built in functions,
+ * if both bounds format to the same string with the formatting precision of the current context
+ * every value in between does too and the displayed digits are correct.
+ * The bounds of exact results are equal and certify any formatting precision,
+ * other results can only certify about as many digits as a double holds.
+ *
+ * @return True if the value was accepted.
+ */
+static bool tryEvaluateFast(const std::string &expr, const SymbolTable &symbolTable, ArithmeticType &value) {
+    if (fastEngineActive)
+        return false;
+
+    const EvaluationContext &current = EvaluationContext::getCurrent();
+    int formattingPrecision = current.formattingPrecision;
+    mpfr_rnd_t formattingRounding = current.formattingRounding;
 
-    for (auto &constant : symbolTable.getConstants()) {
-        symbols.add_constant(constant.first, constant.second);
+    MpfrMemory::ScopedPool pool;
+
+    double point;
+    double lower;
+    double upper;
+    fastEngineActive = true;
+    try {
+        bool enclosed = fastEngine.evaluateEnclosure(expr, symbolTable, point, lower, upper);
+        fastEngineActive = false;
+        if (!enclosed)
+            return false;
+    } catch (const std::runtime_error &) {
+        // Eg. expressions which do not compile, the caller evaluates the expression again and reports the error.
+        fastEngineActive = false;
+        return false;
+    } catch (...) {
+        fastEngineActive = false;
+        throw;
     }
 
-    std::map<std::string, ArithmeticType> variables = symbolTable.getVariables();
-    for (auto &variable : variables) {
-        symbols.add_variable(variable.first, variable.second);
+    ArithmeticType lowerValue = NumericConversion::toArithmeticType(lower);
+    if (lower != upper) {
+        std::string formatted = NumberFormat::toDecimal(lowerValue, formattingPrecision, formattingRounding);
+        if (formatted != NumberFormat::toDecimal(NumericConversion::toArithmeticType(upper),
+                                                 formattingPrecision,
+                                                 formattingRounding))
+            return false;
     }
 
-    exprtk::expression<ArithmeticType> expression;
-    expression.register_symbol_table(symbols);
+    // The value computed by exprtk or the bytecode may differ from the enclosed functions of the C library.
+    value = point >= lower && point <= upper ? NumericConversion::toArithmeticType(point) : lowerValue;
+    return true;
+}
+
+/**
+ * Evaluate the expression at the passed working precision using the adaptive engine of the precision.
+ *
+ * @return False if the expression is not pure and therefore was not evaluated (See EvaluationEngine::evaluatePure).
+ */
+static bool evaluateAtPrecision(const std::string &expr,
+                                const SymbolTable &symbolTable,
+                                mpfr_prec_t precision,
+                                ArithmeticType &value) {
+    EvaluationContext context = EvaluationContext::getCurrent();
+    context.precision = precision;
+    ScopedEvaluationContext scope(context);
+
+    MpfrMemory::ScopedPool pool;
+
+    if (adaptiveEngineActive) {
+        EvaluationEngine<ArithmeticType> nestedEngine(0);
+        return nestedEngine.evaluatePure(expr, symbolTable, value);
+    }
 
-    if (parser.compile(expr, expression)) {
-        ArithmeticType ret = expression.value();
-        for (auto &v : variables) {
-            if (symbolTable.getVariables().at(v.first) == v.second)
-                continue;
-            symbolTable.setVariable(v.first, v.second, -1);
+    auto it = adaptiveEngines.find(precision);
+    if (it == adaptiveEngines.end()) {
+        if (adaptiveEngines.size() >= ADAPTIVE_ENGINES_SIZE) {
+            // The highest precisions are the least likely to be used again.
+            adaptiveEngines.erase(std::prev(adaptiveEngines.end()));
         }
+        it = adaptiveEngines.emplace(precision,
+                                     std::make_unique<EvaluationEngine<ArithmeticType>>(EXPRESSION_CACHE_SIZE)).first;
+    }
+
+    adaptiveEngineActive = true;
+    try {
+        bool ret = it->second->evaluatePure(expr, symbolTable, value);
+        adaptiveEngineActive = false;
         return ret;
-    } else {
-        throw std::runtime_error(parser.error());
+    } catch (...) {
+        adaptiveEngineActive = false;
+        throw;
     }
 }
 
-ArithmeticType ExpressionParser::evaluate(const std::string &expr) {
-    exprtk::parser<ArithmeticType> parser;
-    exprtk::expression<ArithmeticType> expression;
+static mpfr_prec_t roundPrecision(double bits) {
+    auto ret = static_cast<mpfr_prec_t>(std::ceil(bits / ADAPTIVE_PRECISION_STEP)) * ADAPTIVE_PRECISION_STEP;
+    return std::max(ret, ADAPTIVE_PRECISION_STEP);
+}
 
-    if (parser.compile(expr, expression)) {
-        return expression.value();
-    } else {
-        throw std::runtime_error(parser.error());
+/**
+ * @return The working precision required to format the value with the passed number of decimal spaces.
+ */
+static mpfr_prec_t getRequiredPrecision(const ArithmeticType &value, int decimalSpaces) {
+    double bits = decimalSpaces * std::log2(10.0) + ADAPTIVE_GUARD_BITS;
+    if (mpfr_regular_p(value.mpfr_srcptr()) && value.get_exp() > 0) {
+        // The integral digits are formatted too.
+        bits += static_cast<double>(value.get_exp());
+    }
+    return roundPrecision(bits);
+}
+
+template<typename T>
+static std::vector<ArithmeticType> evaluateBatchParallelWith(const std::string &expr,
+                                                             const SymbolTable &symbolTable,
+                                                             const std::map<std::string, std::vector<ArithmeticType>> &bindings,
+                                                             const EvaluationBudget &budget,
+                                                             const CancellationToken &token,
+                                                             size_t threadCount) {
+    size_t rows = bindings.empty() ? 0 : bindings.begin()->second.size();
+    for (auto &column : bindings) {
+        if (column.second.size() != rows)
+            throw std::runtime_error("All bound columns must have the same size");
+    }
+
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = std::min(threadCount, rows);
+
+    const EvaluationContext context = EvaluationContext::getCurrent();
+    ScopedEvaluationContext scope(context);
+
+    MpfrMemory::ScopedPool pool;
+
+    EvaluationGuard guard(budget, token);
+
+    // Scripts call into the python interpreter and therefore are evaluated serially on the calling thread,
+    // a batch started by a worker is evaluated serially too because the workers may all be busy.
+    bool serial = threadCount <= 1 || WorkerPool::isWorker() || invokeThreadEngine<T>([&](EvaluationEngine<T> &engine) {
+        return engine.prepare(expr, symbolTable);
+    });
+
+    // Assignments are not written back, the workers and the calling thread evaluate ranges of rows of the bindings.
+    std::vector<std::vector<T>> results(serial ? 1 : threadCount);
+    std::vector<std::exception_ptr> errors(results.size());
+
+    auto evaluateRange = [&](size_t i) {
+        size_t begin = rows * i / results.size();
+        size_t end = rows * (i + 1) / results.size();
+        results.at(i) = invokeThreadEngine<T>([&](EvaluationEngine<T> &engine) {
+            return engine.evaluateBatch(expr, symbolTable, bindings, begin, end);
+        });
+    };
+
+    auto task = [&](size_t i) {
+        try {
+            EvaluationContext::setCurrent(context);
+            MpfrMemory::ScopedPool taskPool;
+            if (i == 0) {
+                // The guard of the batch is installed on the calling thread.
+                evaluateRange(i);
+            } else {
+                EvaluationGuard workerGuard = guard.share();
+                evaluateRange(i);
+            }
+        } catch (...) {
+            errors.at(i) = std::current_exception();
+        }
+    };
+
+    if (serial)
+        task(0);
+    else
+        WorkerPool::getInstance().run(threadCount, task);
+
+    for (auto &error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    guard.checkLimits();
+
+    if (results.size() == 1)
+        return toArithmeticTypes(std::move(results.front()));
+
+    std::vector<T> ret;
+    ret.reserve(rows);
+    for (auto &result : results) {
+        std::move(result.begin(), result.end(), std::back_inserter(ret));
+    }
+    return toArithmeticTypes(std::move(ret));
+}
+
+ArithmeticType ExpressionParser::evaluate(const std::string &expr, SymbolTable &symbolTable) {
+    return invokeEngine([&](auto &e) {
+        return NumericConversion::toArithmeticType(e.evaluate(expr, symbolTable));
+    });
+}
+
+ArithmeticType ExpressionParser::evaluate(const std::string &expr,
+                                         SymbolTable &symbolTable,
+                                         const CancellationToken &token) {
+    return evaluate(expr, symbolTable, EvaluationBudget(), token);
+}
+
+ArithmeticType ExpressionParser::evaluate(const std::string &expr,
+                                         SymbolTable &symbolTable,
+                                         const EvaluationBudget &budget,
+                                         const CancellationToken &token) {
+    EvaluationGuard guard(budget, token);
+    auto ret = evaluate(expr, symbolTable);
+    guard.checkLimits();
+    return ret;
+}
+
+ArithmeticType ExpressionParser::evaluateExact(const std::string &expr,
+                                              SymbolTable &symbolTable,
+                                              const CancellationToken &token,
+                                              std::string &fraction) {
+    fraction.clear();
+    EvaluationGuard guard(EvaluationBudget(), token);
+    auto ret = invokeEngine([&](auto &e) {
+        auto value = e.evaluate(expr, symbolTable);
+        if constexpr (std::is_same<decltype(value), Rational>::value)
+            fraction = value.toString();
+        return NumericConversion::toArithmeticType(value);
+    });
+    guard.checkLimits();
+    return ret;
+}
+
+ArithmeticType ExpressionParser::evaluateAdaptive(const std::string &expr,
+                                                 SymbolTable &symbolTable,
+                                                 const EvaluationBudget &budget,
+                                                 const CancellationToken &token) {
+    const EvaluationContext context = EvaluationContext::getCurrent();
+    if (context.backend != BACKEND_MPFR)
+        return evaluate(expr, symbolTable, budget, token);
+
+    ScopedEvaluationContext scope(context);
+
+    EvaluationGuard guard(budget, token);
+
+    ArithmeticType fastValue;
+    if (tryEvaluateFast(expr, symbolTable, fastValue)) {
+        guard.checkLimits();
+        return fastValue;
+    }
+    // Do not repeat an evaluation which was cancelled or exceeded the budget.
+    guard.checkLimits();
+
+    int decimalSpaces = std::max(context.formattingPrecision, 0);
+    mpfr_prec_t precision = std::min(roundPrecision(decimalSpaces * std::log2(10.0) + ADAPTIVE_GUARD_BITS),
+                                     context.precision);
+
+    ArithmeticType value;
+    if (!evaluateAtPrecision(expr, symbolTable, precision, value)) {
+        // Expressions with side effects are evaluated once so that the assignments are only applied once.
+        value = evaluate(expr, symbolTable);
+        guard.checkLimits();
+        return value;
+    }
+    std::string formatted = NumberFormat::toDecimal(value, decimalSpaces, context.formattingRounding);
+
+    while (precision < context.precision) {
+        guard.checkLimits();
+
+        precision = std::min(std::max(precision * 2, getRequiredPrecision(value, decimalSpaces)),
+                             context.precision);
+
+        ArithmeticType nextValue;
+        evaluateAtPrecision(expr, symbolTable, precision, nextValue);
+        std::string nextFormatted = NumberFormat::toDecimal(nextValue, decimalSpaces, context.formattingRounding);
+
+        bool stable = nextFormatted == formatted;
+
+        value = std::move(nextValue);
+        formatted = std::move(nextFormatted);
+
+        if (stable)
+            break;
+    }
+
+    guard.checkLimits();
+
+    return value;
+}
+
+ArithmeticType ExpressionParser::evaluateFast(const std::string &expr,
+                                             SymbolTable &symbolTable,
+                                             const EvaluationBudget &budget,
+                                             const CancellationToken &token) {
+    if (EvaluationContext::getCurrent().backend != BACKEND_MPFR)
+        return evaluate(expr, symbolTable, budget, token);
+
+    ScopedEvaluationContext scope(EvaluationContext::getCurrent());
+
+    EvaluationGuard guard(budget, token);
+
+    ArithmeticType ret;
+    if (!tryEvaluateFast(expr, symbolTable, ret)) {
+        // Do not repeat an evaluation which was cancelled or exceeded the budget.
+        guard.checkLimits();
+        ret = evaluate(expr, symbolTable);
     }
-}
\ No newline at end of file
+
+    guard.checkLimits();
+    return ret;
+}
+
+std::pair<ArithmeticType, ArithmeticType> ExpressionParser::evaluateEnclosure(const std::string &expr,
+                                                                           SymbolTable &symbolTable,
+                                                                           const EvaluationBudget &budget,
+                                                                           const CancellationToken &token) {
+    EvaluationContext context = EvaluationContext::getCurrent();
+    context.backend = BACKEND_INTERVAL;
+    ScopedEvaluationContext scope(context);
+
+    EvaluationGuard guard(budget, token);
+
+    auto ret = invokeEngine([&](auto &e) {
+        auto value = e.evaluate(expr, symbolTable);
+        if constexpr (std::is_same<decltype(value), Interval>::value) {
+            return std::make_pair(value.getLower(), value.getUpper());
+        } else {
+            // Not reachable, the context selects the interval backend.
+            auto point = NumericConversion::toArithmeticType(value);
+            return std::make_pair(point, point);
+        }
+    });
+
+    guard.checkLimits();
+    return ret;
+}
+
+std::vector<ArithmeticType> ExpressionParser::evaluateBatch(const std::string &expr,
+                                                            SymbolTable &symbolTable,
+                                                            const std::map<std::string, std::vector<ArithmeticType>> &bindings) {
+    return invokeEngine([&](auto &e) {
+        return toArithmeticTypes(e.evaluateBatch(expr, symbolTable, bindings));
+    });
+}
+
+std::vector<ArithmeticType> ExpressionParser::evaluateBatchParallel(const std::string &expr,
+                                                                    const SymbolTable &symbolTable,
+                                                                    const std::map<std::string, std::vector<ArithmeticType>> &bindings,
+                                                                    const EvaluationBudget &budget,
+                                                                    const CancellationToken &token,
+                                                                    size_t threadCount) {
+    return invokeBackend([&](auto backend) {
+        return evaluateBatchParallelWith<typename decltype(backend)::type>(expr,
+                                                                           symbolTable,
+                                                                           bindings,
+                                                                           budget,
+                                                                           token,
+                                                                           threadCount);
+    });
+}
+
+ArithmeticType ExpressionParser::evaluate(const std::string &expr) {
+    ScopedEvaluationContext scope(EvaluationContext::getCurrent());
+
+    return invokeBackend([&](auto backend) {
+        typedef typename decltype(backend)::type T;
+
+        exprtk::parser<T> parser;
+        exprtk::expression<T> expression;
+
+        if (parser.compile(expr, expression)) {
+            return NumericConversion::toArithmeticType(expression.value());
+        } else {
+            throw std::runtime_error(parser.error());
+        }
+    });
+}
+
+ExpressionCacheStatistics ExpressionParser::getCacheStatistics() {
+    return invokeBackend([](auto backend) {
+        return ThreadEngine<typename decltype(backend)::type>::engine.getCacheStatistics();
+    });
+}
+
+void ExpressionParser::setCacheCapacity(size_t capacity) {
+    invokeBackends([&](auto backend) {
+        ThreadEngine<typename decltype(backend)::type>::engine.setCacheCapacity(capacity);
+    });
+}
+
+void ExpressionParser::clearCache() {
+    invokeBackends([](auto backend) {
+        ThreadEngine<typename decltype(backend)::type>::engine.clearCache();
+    });
+}
@@ -21,9 +21,15 @@
 #define QCALC_EXPRESSIONPARSER_HPP
 
 #include <string>
+#include <vector>
+#include <map>
+#include <utility>
 
 #include "symboltable.hpp"
 #include "arithmetictype.hpp"
+#include "expressioncache.hpp"
+#include "cancellationtoken.hpp"
+#include "evaluationbudget.hpp"
 
 /**
  * The expression parser evaluates expressions in string form using an optionally supplied symbol table.
@@ -33,6 +39,23 @@
  * Variables can be changed from expressions using a special syntax and these changes are stored in the passed symbol table.
  * Functions are implemented using exprtk's function_compositor.
  * Scripts are implemented as a custom exprtk function.
+ *
+ * Only the symbols referenced by the expression and the functions and scripts they depend on are registered with exprtk.
+ *
+ * Expressions are evaluated with the numeric backend, precision and rounding mode
+ * of the current evaluation context of the calling thread.
+ * Symbol values are converted to the arithmetic type of the backend and results are converted back to ArithmeticType,
+ * so a backend can be selected per session or for a single evaluation using a ScopedEvaluationContext.
+ *
+ * Each thread evaluates using a persistent evaluation engine which applies only the modified symbols
+ * of the passed symbol table and keeps a bounded least recently used cache of compiled expressions,
+ * so that reevaluating an expression with different variable values does not parse the expression again.
+ * Each backend has its own engine, the cache statistics are those of the engine of the current backend
+ * and the other cache functions operate on the engines of all backends of the calling thread.
+ *
+ * Fast evaluations keep one double precision engine per thread.
+ * Adaptive evaluations keep one engine per working precision, so that the precisions used by consecutive
+ * adaptive evaluations do not invalidate the compiled expressions of each other.
  */
 namespace ExpressionParser {
     /**
@@ -45,7 +68,196 @@ namespace ExpressionParser {
      */
     ArithmeticType evaluate(const std::string &expr, SymbolTable &symbolTable);
 
+    /**
+     * Evaluate the arithmetic expression using the defined symbol table.
+     *
+     * The evaluation is aborted with a runtime_error at the next loop iteration after the token has been cancelled.
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     * @param token The token which cancels the evaluation.
+     *
+     * @return The value of the expression.
+     */
+    ArithmeticType evaluate(const std::string &expr, SymbolTable &symbolTable, const CancellationToken &token);
+
+    /**
+     * Evaluate the arithmetic expression using the defined symbol table within the limits of the budget.
+     *
+     * The evaluation is aborted with a runtime_error when a limit of the budget is exceeded
+     * or at the next loop iteration after the token has been cancelled.
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     * @param budget The resource limits of the evaluation.
+     * @param token The token which cancels the evaluation.
+     *
+     * @return The value of the expression.
+     */
+    ArithmeticType evaluate(const std::string &expr,
+                            SymbolTable &symbolTable,
+                            const EvaluationBudget &budget,
+                            const CancellationToken &token = CancellationToken());
+
     ArithmeticType evaluate(const std::string &expr);
+
+    /**
+     * Evaluate the arithmetic expression like evaluate(expr, symbolTable, token)
+     * and return the exact value if the rational backend is selected.
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     * @param token The token which cancels the evaluation.
+     * @param fraction Set to the exact value in the form of SymbolTable::getRationals() with the rational backend,
+     * cleared otherwise.
+     *
+     * @return The value of the expression.
+     */
+    ArithmeticType evaluateExact(const std::string &expr,
+                                 SymbolTable &symbolTable,
+                                 const CancellationToken &token,
+                                 std::string &fraction);
+
+    /**
+     * Evaluate the arithmetic expression in hardware double precision if the result is correct to all digits
+     * which are displayed, otherwise evaluate it like evaluate(expr, symbolTable, budget, token).
+     *
+     * The fast evaluation is only used for expressions which do not assign variables,
+     * do not reference scripts and do not compare for equality and which can be lowered to bytecode.
+     * The exact value of the expression is enclosed by double bounds computed with outward rounding (See BytecodeEnclosure),
+     * the result is accepted if both bounds are equal or format to the same decimal string
+     * with the formatting precision of the current context.
+     * Exact results (eg. 2 + 2 or 1 / 8) are therefore accepted at any formatting precision,
+     * inexact results only if the formatting precision does not exceed the digits certified by the bounds.
+     * The returned value is the double value of the expression computed by the bytecode, which lies within the bounds.
+     *
+     * Only applies to the mpfr backend, other backends are evaluated like evaluate(expr, symbolTable, budget, token).
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     * @param budget The resource limits of the evaluation.
+     * @param token The token which cancels the evaluation.
+     *
+     * @return The value of the expression.
+     */
+    ArithmeticType evaluateFast(const std::string &expr,
+                                SymbolTable &symbolTable,
+                                const EvaluationBudget &budget = EvaluationBudget(),
+                                const CancellationToken &token = CancellationToken());
+
+    /**
+     * Evaluate the arithmetic expression with the lowest working precision which yields
+     * the value correct to all digits which are displayed.
+     *
+     * Expressions whose displayed digits are certified by the fast evaluation (See evaluateFast) are not evaluated again.
+     * Otherwise the evaluation starts at a working precision derived from the formatting precision of the current context
+     * and is repeated at doubled precisions until the values of two consecutive evaluations
+     * format to the same decimal string, the precision of the current context is the upper bound.
+     * The returned value has the working precision of the last evaluation.
+     *
+     * Only pure expressions are evaluated repeatedly (See evaluateFast), the symbol table is not copied.
+     * Expressions which assign variables, reference scripts or compare for equality are evaluated once
+     * like evaluate(expr, symbolTable, budget, token) at the precision of the current context.
+     * The budget applies to all evaluations combined.
+     *
+     * Only applies to the mpfr backend, other backends are evaluated like evaluate(expr, symbolTable, budget, token).
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     * @param budget The resource limits of the evaluation.
+     * @param token The token which cancels the evaluation.
+     *
+     * @return The value of the expression.
+     */
+    ArithmeticType evaluateAdaptive(const std::string &expr,
+                                    SymbolTable &symbolTable,
+                                    const EvaluationBudget &budget = EvaluationBudget(),
+                                    const CancellationToken &token = CancellationToken());
+
+    /**
+     * Evaluate the arithmetic expression using the interval backend regardless of the backend of the current context.
+     *
+     * The exact result of the expression lies between the returned bounds if the symbol values are taken as exact,
+     * the bounds have the precision of the current context.
+     * Comparisons of overlapping intervals cannot be decided and abort the evaluation with a runtime_error.
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     * @param budget The resource limits of the evaluation.
+     * @param token The token which cancels the evaluation.
+     *
+     * @return The lower and upper bound of the value of the expression.
+     */
+    std::pair<ArithmeticType, ArithmeticType> evaluateEnclosure(const std::string &expr,
+                                                                SymbolTable &symbolTable,
+                                                                const EvaluationBudget &budget = EvaluationBudget(),
+                                                                const CancellationToken &token = CancellationToken());
+
+    /**
+     * Evaluate the arithmetic expression for every row of the bindings, the expression is only compiled once.
+     *
+     * The bound variables must be defined in the symbol table, their values in the symbol table are not modified.
+     *
+     * With the double backend, expressions which consist only of arithmetic, comparisons and built in functions
+     * are evaluated using the AVX2 or AVX-512 instructions of the processor if available.
+     * sin, exp, log and pow are then approximated within 2 ULP of the C library, so the results may differ slightly
+     * from evaluating the expression on its own.
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     * @param bindings The values of the bound variables, each column maps a variable name to one value per row.
+     * All columns must have the same size.
+     *
+     * @return The value of the expression for each row.
+     */
+    std::vector<ArithmeticType> evaluateBatch(const std::string &expr,
+                                              SymbolTable &symbolTable,
+                                              const std::map<std::string, std::vector<ArithmeticType>> &bindings);
+
+    /**
+     * Evaluate the arithmetic expression for every row of the bindings using multiple threads.
+     *
+     * The rows are split into contiguous ranges, the calling thread and the threads of a persistent worker pool
+     * each evaluate one range using the evaluation engine of the thread, which keeps the compiled expression
+     * between calls. The symbol table and the bindings are shared read only by all threads.
+     * Assignments to variables are not written back to the symbol table.
+     *
+     * If the expression references scripts, directly or through functions, the rows are evaluated
+     * on the calling thread because scripts call into the python interpreter.
+     * The worker threads use the evaluation context of the calling thread.
+     *
+     * The budget applies to all threads combined: the loop iterations of all threads are counted together,
+     * the time is measured from the start of the batch and the memory is the sum of the peaks of the threads.
+     * The workers are cancelled by the token and by the tokens of the guards of the calling thread (See EvaluationGuard::share),
+     * the budgets of the guards of the calling thread only apply to the range evaluated by the calling thread.
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     * @param bindings The values of the bound variables, each column maps a variable name to one value per row.
+     * All columns must have the same size.
+     * @param budget The resource limits of the evaluation of all rows.
+     * @param token The token which cancels the evaluation of all rows.
+     * @param threadCount The maximum number of threads to use, 0 to use the number of hardware threads.
+     *
+     * @return The value of the expression for each row in the order of the rows.
+     */
+    std::vector<ArithmeticType> evaluateBatchParallel(const std::string &expr,
+                                                      const SymbolTable &symbolTable,
+                                                      const std::map<std::string, std::vector<ArithmeticType>> &bindings,
+                                                      const EvaluationBudget &budget = EvaluationBudget(),
+                                                      const CancellationToken &token = CancellationToken(),
+                                                      size_t threadCount = 0);
+
+    ExpressionCacheStatistics getCacheStatistics();
+
+    /**
+     * Set the maximum number of compiled expressions which are kept in the cache, a capacity of 0 disables caching.
+     *
+     * @param capacity
+     */
+    void setCacheCapacity(size_t capacity);
+
+    void clearCache();
 }
 
 #endif // QCALC_EXPRESSIONPARSER_HPP
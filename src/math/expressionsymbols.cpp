@@ -0,0 +1,124 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "expressionsymbols.hpp"
+
+#include <vector>
+
+#include "numericbackend.hpp"
+
+std::set<std::string> ExpressionSymbols::getReferences(const std::string &expr, const SymbolTable &symbolTable) {
+    std::set<std::string> ret;
+
+    const auto &functions = symbolTable.getFunctions();
+
+    // The expressions to scan and the lower case argument names which they declare.
+    std::vector<std::pair<std::string, std::set<std::string>>> pending;
+    pending.emplace_back(expr, std::set<std::string>());
+
+    std::set<std::string> visitedFunctions;
+    while (!pending.empty()) {
+        auto expression = std::move(pending.back());
+        pending.pop_back();
+
+        exprtk::lexer::generator generator;
+        if (!generator.process(expression.first))
+            continue;
+
+        for (size_t i = 0; i < generator.size(); i++) {
+            if (generator[i].type != exprtk::lexer::token::e_symbol)
+                continue;
+
+            const std::string &symbol = generator[i].value;
+            if (expression.second.find(SymbolTable::toLower(symbol)) != expression.second.end())
+                continue;
+
+            std::string name = symbolTable.findSymbol(symbol);
+            if (name.empty())
+                continue;
+
+            ret.insert(name);
+
+            auto function = functions.find(name);
+            if (function != functions.end() && visitedFunctions.insert(name).second) {
+                std::set<std::string> arguments;
+                for (auto &argument : function->second.argumentNames)
+                    arguments.insert(SymbolTable::toLower(argument));
+                pending.emplace_back(function->second.expression, arguments);
+            }
+        }
+    }
+
+    return ret;
+}
+
+std::set<std::string> ExpressionSymbols::getAssignments(const std::string &expr, const SymbolTable &symbolTable) {
+    std::set<std::string> ret;
+
+    exprtk::lexer::generator generator;
+    if (!generator.process(expr))
+        return ret;
+
+    auto &variables = symbolTable.getVariables();
+
+    auto isSymbol = [&generator](size_t i) {
+        return generator[i].type == exprtk::lexer::token::e_symbol;
+    };
+
+    auto isAssignment = [&generator](size_t i) {
+        switch (generator[i].type) {
+            case exprtk::lexer::token::e_assign:
+            case exprtk::lexer::token::e_addass:
+            case exprtk::lexer::token::e_subass:
+            case exprtk::lexer::token::e_mulass:
+            case exprtk::lexer::token::e_divass:
+            case exprtk::lexer::token::e_modass:
+                return true;
+            default:
+                return false;
+        }
+    };
+
+    auto addSymbol = [&](size_t i) {
+        std::string name = symbolTable.findSymbol(generator[i].value);
+        if (name.empty())
+            ret.insert(generator[i].value);
+        else if (variables.find(name) != variables.end())
+            ret.insert(name);
+    };
+
+    for (size_t i = 0; i + 1 < generator.size(); i++) {
+        if (!isSymbol(i))
+            continue;
+
+        bool local = i > 0 && isSymbol(i - 1) && exprtk::details::imatch(generator[i - 1].value, "var");
+        if (local)
+            continue;
+
+        if (isAssignment(i + 1)) {
+            addSymbol(i);
+        } else if (generator[i + 1].type == exprtk::lexer::token::e_swap) {
+            addSymbol(i);
+            if (i + 2 < generator.size() && isSymbol(i + 2))
+                addSymbol(i + 2);
+        }
+    }
+
+    return ret;
+}
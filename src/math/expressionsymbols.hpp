@@ -0,0 +1,52 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_EXPRESSIONSYMBOLS_HPP
+#define QCALC_EXPRESSIONSYMBOLS_HPP
+
+#include <string>
+#include <set>
+
+#include "symboltable.hpp"
+
+/**
+ * Static analysis of the symbols used by an expression without compiling it.
+ *
+ * Symbol names are matched case insensitive like exprtk does, the returned names are the names used in the table.
+ */
+namespace ExpressionSymbols {
+    /**
+     * @param expr
+     * @param symbolTable
+     * @return The names of the symbols of the table which the expression references directly or through the functions it calls.
+     */
+    std::set<std::string> getReferences(const std::string &expr, const SymbolTable &symbolTable);
+
+    /**
+     * Return the variables which the expression may assign,
+     * variables which are declared locally in the expression using var are not included.
+     *
+     * @param expr
+     * @param symbolTable
+     * @return The names of the assigned variables, assigned symbols which are not defined in the table are returned as written.
+     */
+    std::set<std::string> getAssignments(const std::string &expr, const SymbolTable &symbolTable);
+}
+
+#endif //QCALC_EXPRESSIONSYMBOLS_HPP
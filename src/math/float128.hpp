@@ -0,0 +1,166 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_FLOAT128_HPP
+#define QCALC_FLOAT128_HPP
+
+/**
+ * The conversions of the __float128 type (Provided by libquadmath).
+ *
+ * The type is only available if QCALC_FLOAT128 is defined.
+ */
+
+#ifdef QCALC_FLOAT128
+
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+#include <quadmath.h>
+
+#include "arithmetictype.hpp"
+
+namespace std {
+    template<>
+    class numeric_limits<__float128> {
+    public:
+        static const bool is_specialized = true;
+        static const bool is_signed = true;
+        static const bool is_integer = false;
+        static const bool is_exact = false;
+        static const bool has_infinity = true;
+        static const bool has_quiet_NaN = true;
+        static const bool has_signaling_NaN = true;
+        static const int digits = FLT128_MANT_DIG;
+        static const int digits10 = FLT128_DIG;
+        static const int max_digits10 = 36;
+        static const int radix = 2;
+        static const int min_exponent = FLT128_MIN_EXP;
+        static const int min_exponent10 = FLT128_MIN_10_EXP;
+        static const int max_exponent = FLT128_MAX_EXP;
+        static const int max_exponent10 = FLT128_MAX_10_EXP;
+
+        static __float128 min() noexcept { return FLT128_MIN; }
+
+        static __float128 max() noexcept { return FLT128_MAX; }
+
+        static __float128 lowest() noexcept { return -FLT128_MAX; }
+
+        static __float128 epsilon() noexcept { return FLT128_EPSILON; }
+
+        static __float128 round_error() noexcept { return 0.5; }
+
+        static __float128 infinity() noexcept { return HUGE_VALQ; }
+
+        static __float128 quiet_NaN() noexcept { return nanq(""); }
+
+        static __float128 signaling_NaN() noexcept { return nanq(""); }
+
+        static __float128 denorm_min() noexcept { return FLT128_DENORM_MIN; }
+    };
+}
+
+namespace Float128 {
+    /**
+     * Convert the value to __float128, the value is rounded to the precision of __float128 once.
+     *
+     * @param value
+     * @param rounding The rounding mode used when the value is not representable.
+     * @return
+     */
+    inline __float128 fromArithmeticType(const ArithmeticType &value, mpfr_rnd_t rounding) {
+        if (mpfr::isnan(value))
+            return nanq("");
+        if (mpfr::isinf(value))
+            return value > 0 ? HUGE_VALQ : -HUGE_VALQ;
+        if (mpfr::iszero(value))
+            return mpfr::signbit(value) ? -__float128(0) : __float128(0);
+
+        mpfr_t rounded;
+        mpfr_init2(rounded, FLT128_MANT_DIG);
+        mpfr_set(rounded, value.mpfr_srcptr(), rounding);
+
+        // The mantissa is an integer of at most 113 bits which is converted exactly using two 64 bit words.
+        mpz_t mantissa;
+        mpz_init(mantissa);
+        mpfr_exp_t exponent = mpfr_get_z_2exp(mantissa, rounded);
+        mpfr_clear(rounded);
+
+        bool negative = mpz_sgn(mantissa) < 0;
+        mpz_abs(mantissa, mantissa);
+
+        uint64_t words[2] = {0, 0};
+        mpz_export(words, nullptr, -1, sizeof(uint64_t), 0, 0, mantissa);
+        mpz_clear(mantissa);
+
+        __float128 ret = ldexpq(__float128(words[1]), 64) + __float128(words[0]);
+        if (exponent > FLT128_MAX_EXP)
+            ret = HUGE_VALQ;
+        else if (exponent < FLT128_MIN_EXP - 2 * FLT128_MANT_DIG)
+            ret = 0;
+        else
+            ret = ldexpq(ret, static_cast<int>(exponent));
+
+        return negative ? -ret : ret;
+    }
+
+    /**
+     * Convert the value to the arithmetic type exactly,
+     * the precision of the returned value is at least the precision of __float128.
+     *
+     * @param value
+     * @return
+     */
+    inline ArithmeticType toArithmeticType(__float128 value) {
+        mpfr_prec_t precision = std::max<mpfr_prec_t>(mpfr::mpreal::get_default_prec(), FLT128_MANT_DIG);
+        ArithmeticType ret(0, precision);
+
+        if (isnanq(value)) {
+            ret.setNan();
+            return ret;
+        }
+        if (isinfq(value)) {
+            ret.setInf(value > 0 ? 1 : -1);
+            return ret;
+        }
+        if (value == 0)
+            return signbitq(value) ? -ret : ret;
+
+        int exponent;
+        __float128 mantissa = ldexpq(fabsq(frexpq(value, &exponent)), FLT128_MANT_DIG);
+
+        uint64_t words[2];
+        words[1] = static_cast<uint64_t>(ldexpq(mantissa, -64));
+        words[0] = static_cast<uint64_t>(mantissa - ldexpq(__float128(words[1]), 64));
+
+        mpz_t integer;
+        mpz_init(integer);
+        mpz_import(integer, 2, -1, sizeof(uint64_t), 0, 0, words);
+        mpfr_set_z_2exp(ret.mpfr_ptr(), integer, exponent - FLT128_MANT_DIG, MPFR_RNDN);
+        mpz_clear(integer);
+
+        return value < 0 ? -ret : ret;
+    }
+}
+
+#endif // QCALC_FLOAT128
+
+#endif //QCALC_FLOAT128_HPP
@@ -0,0 +1,143 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "functiondefinition.hpp"
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include "symboltable.hpp"
+
+#include "numericbackend.hpp"
+
+// The function compositor supports at most 6 arguments.
+static const size_t MAX_ARGUMENTS = 6;
+
+static unsigned long generateVersion() {
+    static std::atomic<unsigned long> counter(0);
+    return ++counter;
+}
+
+/**
+ * Stands in for a function or script of the table while validating, it is never evaluated.
+ */
+struct StubFunction : public exprtk::ifunction<double> {
+    explicit StubFunction(size_t parameters) : exprtk::ifunction<double>(parameters) {}
+};
+
+struct StubVarArgFunction : public exprtk::ivararg_function<double> {
+};
+
+std::shared_ptr<const FunctionDefinition> FunctionDefinition::validate(const std::string &name,
+                                                                       const Function &function,
+                                                                       const SymbolTable &symbolTable,
+                                                                       unsigned long version) {
+    std::shared_ptr<FunctionDefinition> ret(new FunctionDefinition());
+    ret->version = version == 0 ? generateVersion() : version;
+    ret->function = function;
+
+    exprtk::lexer::generator generator;
+    if (!generator.process(function.expression)) {
+        ret->error = "Invalid function body";
+        return ret;
+    }
+    for (size_t i = 0; i < generator.size(); i++) {
+        if (generator[i].type == exprtk::lexer::token::e_symbol)
+            ret->symbols.insert(generator[i].value);
+    }
+    for (auto &argument : function.argumentNames) {
+        ret->symbols.erase(argument);
+    }
+    ret->symbols.erase(name);
+    for (auto &symbol : ret->symbols) {
+        ret->lowerSymbols.insert(SymbolTable::toLower(symbol));
+    }
+
+    if (function.argumentNames.size() > MAX_ARGUMENTS) {
+        ret->error = "Functions cannot have more than " + std::to_string(MAX_ARGUMENTS) + " arguments";
+        return ret;
+    }
+
+    // Compiled the same way as the function compositor does, values of the table are not visible to functions.
+    std::vector<std::unique_ptr<StubFunction>> stubs;
+    std::vector<std::unique_ptr<StubVarArgFunction>> varArgStubs;
+    exprtk::symbol_table<double> stubSymbols;
+
+    stubs.emplace_back(std::make_unique<StubFunction>(function.argumentNames.size()));
+    stubSymbols.add_function(name, *stubs.back());
+
+    for (auto &symbol : ret->symbols) {
+        std::string reference = symbolTable.findSymbol(symbol);
+        if (reference.empty() || reference == name || stubSymbols.symbol_exists(reference))
+            continue;
+        auto referencedFunction = symbolTable.getFunctions().find(reference);
+        auto referencedScript = symbolTable.getScripts().find(reference);
+        if (referencedFunction != symbolTable.getFunctions().end()) {
+            stubs.emplace_back(std::make_unique<StubFunction>(referencedFunction->second.argumentNames.size()));
+            stubSymbols.add_function(reference, *stubs.back());
+        } else if (referencedScript != symbolTable.getScripts().end()) {
+            if (referencedScript->second.enableArguments) {
+                varArgStubs.emplace_back(std::make_unique<StubVarArgFunction>());
+                stubSymbols.add_function(reference, *varArgStubs.back());
+            } else {
+                stubs.emplace_back(std::make_unique<StubFunction>(0));
+                stubSymbols.add_function(reference, *stubs.back());
+            }
+        }
+    }
+
+    std::string source;
+    for (auto &argument : function.argumentNames) {
+        source += " var " + argument + "{};\n";
+    }
+    if (!function.expression.empty() && function.expression.front() == '{' && function.expression.back() == '}')
+        source += "~" + function.expression + ";";
+    else
+        source += "~{" + function.expression + "};";
+
+    exprtk::expression<double> expression;
+    expression.register_symbol_table(stubSymbols);
+    exprtk::parser<double> parser(exprtk::parser<double>::settings_t::compile_all_opts
+                                  + exprtk::parser<double>::settings_t::e_disable_zero_return);
+    if (!parser.compile(source, expression))
+        ret->error = parser.error();
+
+    return ret;
+}
+
+unsigned long FunctionDefinition::getVersion() const {
+    return version;
+}
+
+const Function &FunctionDefinition::getFunction() const {
+    return function;
+}
+
+const std::set<std::string> &FunctionDefinition::getSymbols() const {
+    return symbols;
+}
+
+const std::string &FunctionDefinition::getError() const {
+    return error;
+}
+
+bool FunctionDefinition::references(const std::string &name) const {
+    return lowerSymbols.find(SymbolTable::toLower(name)) != lowerSymbols.end();
+}
@@ -0,0 +1,87 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_FUNCTIONDEFINITION_HPP
+#define QCALC_FUNCTIONDEFINITION_HPP
+
+#include <string>
+#include <set>
+#include <memory>
+
+#include "function.hpp"
+
+class SymbolTable;
+
+/**
+ * The immutable validation result of a function definition, created by the symbol table when the function is set.
+ *
+ * The definition is checked by compiling it against stubs of the functions and scripts of the table,
+ * nothing of the compilation is kept. Instances are shared between copies of the symbol table
+ * and are read by all evaluation engines, each engine still compiles the function into its own exprtk state
+ * because exprtk expressions carry evaluation state and cannot be shared between threads.
+ *
+ * The version identifies the definition, it only changes when the function is set again.
+ */
+class FunctionDefinition {
+public:
+    /**
+     * Validate the function against the functions and scripts of the symbol table.
+     *
+     * @param name
+     * @param function
+     * @param symbolTable
+     * @param version The version of the definition, 0 assigns a new version.
+     * @return
+     */
+    static std::shared_ptr<const FunctionDefinition> validate(const std::string &name,
+                                                              const Function &function,
+                                                              const SymbolTable &symbolTable,
+                                                              unsigned long version = 0);
+
+    unsigned long getVersion() const;
+
+    const Function &getFunction() const;
+
+    /**
+     * @return The symbols which appear in the body excluding the arguments and the function itself.
+     */
+    const std::set<std::string> &getSymbols() const;
+
+    /**
+     * @return The error of the definition or an empty string if the function is valid.
+     */
+    const std::string &getError() const;
+
+    /**
+     * @param name
+     * @return True if the body references the symbol, symbol names are case insensitive.
+     */
+    bool references(const std::string &name) const;
+
+private:
+    FunctionDefinition() = default;
+
+    unsigned long version = 0;
+    Function function;
+    std::set<std::string> symbols;
+    std::set<std::string> lowerSymbols;
+    std::string error;
+};
+
+#endif //QCALC_FUNCTIONDEFINITION_HPP
@@ -0,0 +1,584 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_INTERVAL_HPP
+#define QCALC_INTERVAL_HPP
+
+/**
+ * A closed interval with mpfr endpoints which encloses the exact value.
+ *
+ * The endpoints have the mpfr default precision, the lower endpoint is rounded toward -Inf and the upper endpoint
+ * toward +Inf, so the result of an evaluation contains the exact result of the expression
+ * for symbol values which are taken as exact.
+ * Decimal literals which are not representable in binary are enclosed by the two neighbouring values.
+ *
+ * An interval which may contain values outside of the domain of a function results in NaN,
+ * a division by an interval which contains zero results in [-Inf, +Inf].
+ *
+ * The ordering comparisons and the truth value of conditions throw a runtime_error
+ * if they cannot be decided because the intervals overlap.
+ * Equality is only true for two equal points, so that exprtk can use it when simplifying constant expressions.
+ */
+
+#include <string>
+#include <limits>
+#include <utility>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdio>
+
+#include "arithmetictype.hpp"
+
+class Interval {
+public:
+    typedef int (*Function)(mpfr_ptr, mpfr_srcptr, mpfr_rnd_t);
+
+    typedef int (*BinaryFunction)(mpfr_ptr, mpfr_srcptr, mpfr_srcptr, mpfr_rnd_t);
+
+    Interval() : Interval(0) {}
+
+    Interval(double v) : Interval(enclose(v)) {} // NOLINT(google-explicit-constructor)
+
+    Interval(long double v) : Interval(enclose(v)) {} // NOLINT(google-explicit-constructor)
+
+    Interval(int v) : Interval(enclose(v)) {} // NOLINT(google-explicit-constructor)
+
+    Interval(long v) : Interval(enclose(v)) {} // NOLINT(google-explicit-constructor)
+
+    Interval(long long v) : Interval(enclose(v)) {} // NOLINT(google-explicit-constructor)
+
+    Interval(unsigned int v) : Interval(enclose(v)) {} // NOLINT(google-explicit-constructor)
+
+    Interval(unsigned long v) : Interval(enclose(v)) {} // NOLINT(google-explicit-constructor)
+
+    Interval(unsigned long long v) : Interval(enclose(v)) {} // NOLINT(google-explicit-constructor)
+
+    /**
+     * Enclose the value in the mpfr default precision, the interval is a point if the value is representable.
+     *
+     * @param v
+     */
+    explicit Interval(const ArithmeticType &v)
+            : lower(0, mpfr::mpreal::get_default_prec()),
+              upper(0, mpfr::mpreal::get_default_prec()) {
+        mpfr_set(lower.mpfr_ptr(), v.mpfr_srcptr(), MPFR_RNDD);
+        mpfr_set(upper.mpfr_ptr(), v.mpfr_srcptr(), MPFR_RNDU);
+    }
+
+    Interval(ArithmeticType lower, ArithmeticType upper) : lower(std::move(lower)), upper(std::move(upper)) {}
+
+    static Interval NaN() {
+        ArithmeticType nan(0, mpfr::mpreal::get_default_prec());
+        mpfr_set_nan(nan.mpfr_ptr());
+        return {nan, nan};
+    }
+
+    static Interval infinity(int sign) {
+        ArithmeticType inf(0, mpfr::mpreal::get_default_prec());
+        mpfr_set_inf(inf.mpfr_ptr(), sign);
+        return {inf, inf};
+    }
+
+    /**
+     * @return [-Inf, +Inf]
+     */
+    static Interval whole() {
+        return {infinity(-1).lower, infinity(1).upper};
+    }
+
+    static Interval pi() {
+        ArithmeticType lower(0, mpfr::mpreal::get_default_prec());
+        ArithmeticType upper(0, mpfr::mpreal::get_default_prec());
+        mpfr_const_pi(lower.mpfr_ptr(), MPFR_RNDD);
+        mpfr_const_pi(upper.mpfr_ptr(), MPFR_RNDU);
+        return {lower, upper};
+    }
+
+    /**
+     * Parse a decimal literal, the interval encloses the exact value of the literal.
+     *
+     * @param str
+     * @param ret
+     * @return False if the string is not a number.
+     */
+    static bool fromString(const std::string &str, Interval &ret) {
+        ret = Interval();
+        return mpfr_set_str(ret.lower.mpfr_ptr(), str.c_str(), 10, MPFR_RNDD) == 0
+               && mpfr_set_str(ret.upper.mpfr_ptr(), str.c_str(), 10, MPFR_RNDU) == 0;
+    }
+
+    const ArithmeticType &getLower() const {
+        return lower;
+    }
+
+    const ArithmeticType &getUpper() const {
+        return upper;
+    }
+
+    bool isNaN() const {
+        return mpfr_nan_p(lower.mpfr_srcptr()) || mpfr_nan_p(upper.mpfr_srcptr());
+    }
+
+    bool isPoint() const {
+        return !isNaN() && mpfr_equal_p(lower.mpfr_srcptr(), upper.mpfr_srcptr());
+    }
+
+    bool isBounded() const {
+        return mpfr_number_p(lower.mpfr_srcptr()) && mpfr_number_p(upper.mpfr_srcptr());
+    }
+
+    bool containsZero() const {
+        return !isNaN() && mpfr_sgn(lower.mpfr_srcptr()) <= 0 && mpfr_sgn(upper.mpfr_srcptr()) >= 0;
+    }
+
+    /**
+     * @return The midpoint rounded to the mpfr default precision with the mpfr default rounding mode.
+     */
+    ArithmeticType toArithmeticType() const {
+        ArithmeticType ret(0, mpfr::mpreal::get_default_prec());
+        if (isNaN()) {
+            mpfr_set_nan(ret.mpfr_ptr());
+        } else if (isPoint()) {
+            mpfr_set(ret.mpfr_ptr(), lower.mpfr_srcptr(), mpfr::mpreal::get_default_rnd());
+        } else {
+            // Halving is exact, so the midpoint is rounded once.
+            ArithmeticType a = lower;
+            ArithmeticType b = upper;
+            mpfr_div_2ui(a.mpfr_ptr(), a.mpfr_srcptr(), 1, MPFR_RNDN);
+            mpfr_div_2ui(b.mpfr_ptr(), b.mpfr_srcptr(), 1, MPFR_RNDN);
+            mpfr_add(ret.mpfr_ptr(), a.mpfr_srcptr(), b.mpfr_srcptr(), mpfr::mpreal::get_default_rnd());
+        }
+        return ret;
+    }
+
+    /**
+     * @return The interval in the form [lower, upper].
+     */
+    std::string toString() const {
+        return "[" + lower.toString() + ", " + upper.toString() + "]";
+    }
+
+    long toLong() const {
+        return toArithmeticType().toLong();
+    }
+
+    long long toLLong() const {
+        return toArithmeticType().toLLong();
+    }
+
+    explicit operator double() const {
+        return toArithmeticType().toDouble();
+    }
+
+    explicit operator int() const {
+        return static_cast<int>(toLong());
+    }
+
+    explicit operator long long() const {
+        return toLLong();
+    }
+
+    explicit operator std::size_t() const {
+        long ret = toLong();
+        return ret < 0 ? 0 : static_cast<std::size_t>(ret);
+    }
+
+    Interval operator-() const {
+        return {-upper, -lower};
+    }
+
+    Interval &operator+=(const Interval &other) {
+        return *this = *this + other;
+    }
+
+    Interval &operator-=(const Interval &other) {
+        return *this = *this - other;
+    }
+
+    Interval &operator*=(const Interval &other) {
+        return *this = *this * other;
+    }
+
+    Interval &operator/=(const Interval &other) {
+        return *this = *this / other;
+    }
+
+    friend Interval operator+(const Interval &a, const Interval &b) {
+        return {evaluate(mpfr_add, a.lower, b.lower, MPFR_RNDD), evaluate(mpfr_add, a.upper, b.upper, MPFR_RNDU)};
+    }
+
+    friend Interval operator-(const Interval &a, const Interval &b) {
+        return {evaluate(mpfr_sub, a.lower, b.upper, MPFR_RNDD), evaluate(mpfr_sub, a.upper, b.lower, MPFR_RNDU)};
+    }
+
+    friend Interval operator*(const Interval &a, const Interval &b) {
+        return corners(multiply, a, b);
+    }
+
+    friend Interval operator/(const Interval &a, const Interval &b) {
+        if (a.isNaN() || b.isNaN() || (b.isPoint() && b.containsZero()))
+            return NaN();
+        if (b.containsZero())
+            return whole();
+        return corners(mpfr_div, a, b);
+    }
+
+    // Comparisons with NaN are false like the comparisons of floating point values.
+
+    friend bool operator==(const Interval &a, const Interval &b) {
+        return a.isPoint() && b.isPoint() && mpfr_equal_p(a.lower.mpfr_srcptr(), b.lower.mpfr_srcptr());
+    }
+
+    friend bool operator!=(const Interval &a, const Interval &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const Interval &a, const Interval &b) {
+        if (a.isNaN() || b.isNaN())
+            return false;
+        if (mpfr_less_p(a.upper.mpfr_srcptr(), b.lower.mpfr_srcptr()))
+            return true;
+        if (mpfr_greaterequal_p(a.lower.mpfr_srcptr(), b.upper.mpfr_srcptr()))
+            return false;
+        undecided();
+    }
+
+    friend bool operator<=(const Interval &a, const Interval &b) {
+        if (a.isNaN() || b.isNaN())
+            return false;
+        if (mpfr_lessequal_p(a.upper.mpfr_srcptr(), b.lower.mpfr_srcptr()))
+            return true;
+        if (mpfr_greater_p(a.lower.mpfr_srcptr(), b.upper.mpfr_srcptr()))
+            return false;
+        undecided();
+    }
+
+    friend bool operator>(const Interval &a, const Interval &b) {
+        return b < a;
+    }
+
+    friend bool operator>=(const Interval &a, const Interval &b) {
+        return b <= a;
+    }
+
+    /**
+     * @return The result of the mpfr function for the operand at the mpfr default precision with the passed rounding mode.
+     */
+    static ArithmeticType evaluate(Function function, const ArithmeticType &v, mpfr_rnd_t rounding) {
+        ArithmeticType ret(0, mpfr::mpreal::get_default_prec());
+        function(ret.mpfr_ptr(), v.mpfr_srcptr(), rounding);
+        return ret;
+    }
+
+    static ArithmeticType evaluate(BinaryFunction function,
+                                   const ArithmeticType &a,
+                                   const ArithmeticType &b,
+                                   mpfr_rnd_t rounding) {
+        ArithmeticType ret(0, mpfr::mpreal::get_default_prec());
+        function(ret.mpfr_ptr(), a.mpfr_srcptr(), b.mpfr_srcptr(), rounding);
+        return ret;
+    }
+
+    /**
+     * @return The enclosure of a non decreasing function.
+     */
+    static Interval increasing(Function function, const Interval &v) {
+        if (v.isNaN())
+            return NaN();
+        return {evaluate(function, v.lower, MPFR_RNDD), evaluate(function, v.upper, MPFR_RNDU)};
+    }
+
+    /**
+     * @return The enclosure of a non increasing function.
+     */
+    static Interval decreasing(Function function, const Interval &v) {
+        if (v.isNaN())
+            return NaN();
+        return {evaluate(function, v.upper, MPFR_RNDD), evaluate(function, v.lower, MPFR_RNDU)};
+    }
+
+    /**
+     * @return The hull of the values at the corners, which encloses the function
+     * if its extrema over the rectangle are located at the corners (eg. if it is monotonic in each argument).
+     */
+    static Interval corners(BinaryFunction function, const Interval &a, const Interval &b) {
+        if (a.isNaN() || b.isNaN())
+            return NaN();
+        const ArithmeticType *x[] = {&a.lower, &a.upper};
+        const ArithmeticType *y[] = {&b.lower, &b.upper};
+        Interval ret;
+        bool first = true;
+        for (auto *v0 : x) {
+            for (auto *v1 : y) {
+                ArithmeticType l = evaluate(function, *v0, *v1, MPFR_RNDD);
+                ArithmeticType u = evaluate(function, *v0, *v1, MPFR_RNDU);
+                if (mpfr_nan_p(l.mpfr_srcptr()) || mpfr_nan_p(u.mpfr_srcptr()))
+                    return NaN();
+                if (first || mpfr_less_p(l.mpfr_srcptr(), ret.lower.mpfr_srcptr()))
+                    ret.lower = std::move(l);
+                if (first || mpfr_greater_p(u.mpfr_srcptr(), ret.upper.mpfr_srcptr()))
+                    ret.upper = std::move(u);
+                first = false;
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * @return The hull of the two intervals.
+     */
+    static Interval hull(const Interval &a, const Interval &b) {
+        if (a.isNaN() || b.isNaN())
+            return NaN();
+        return {evaluate(mpfr_min, a.lower, b.lower, MPFR_RNDD), evaluate(mpfr_max, a.upper, b.upper, MPFR_RNDU)};
+    }
+
+    /**
+     * @return True if the interval contains an integer.
+     */
+    static bool containsInteger(const Interval &v) {
+        return !v.isNaN() && mpfr::ceil(v.lower) <= v.upper;
+    }
+
+    static Interval abs(const Interval &v) {
+        if (v.isNaN() || mpfr_sgn(v.lower.mpfr_srcptr()) >= 0)
+            return v;
+        if (mpfr_sgn(v.upper.mpfr_srcptr()) <= 0)
+            return -v;
+        return {ArithmeticType(0, mpfr::mpreal::get_default_prec()),
+                evaluate(mpfr_max, -v.lower, v.upper, MPFR_RNDU)};
+    }
+
+    /**
+     * @return The enclosure of a function which is even and non decreasing for positive values (eg. cosh).
+     */
+    static Interval even(Function function, const Interval &v) {
+        return increasing(function, abs(v));
+    }
+
+    /**
+     * Enclose a function with the period 2pi and the range [-1, 1] which is monotonic between
+     * its maxima at maximum + 2k pi and its minima at maximum + pi + 2k pi (ie. sin and cos).
+     *
+     * The locations of the extrema are enclosed too, so an extremum close to an endpoint may widen the enclosure.
+     */
+    static Interval periodic(Function function, const Interval &v, const Interval &maximum) {
+        if (v.isNaN())
+            return NaN();
+        if (!v.isBounded())
+            return {ArithmeticType(-1), ArithmeticType(1)};
+
+        Interval ret = hull(increasing(function, Interval(v.lower)), increasing(function, Interval(v.upper)));
+
+        const Interval period = Interval(2) * pi();
+        if (containsInteger((v - maximum) / period))
+            ret.upper = ArithmeticType(1);
+        if (containsInteger((v - maximum - pi()) / period))
+            ret.lower = ArithmeticType(-1);
+        return ret;
+    }
+
+    /**
+     * @return The enclosure of a function with the period pi which is monotonic between its poles at pole + k pi.
+     */
+    static Interval poles(Function function, const Interval &v, const Interval &pole, bool increases) {
+        if (v.isNaN())
+            return NaN();
+        if (!v.isBounded() || containsInteger((v - pole) / pi()))
+            return whole();
+        return increases ? increasing(function, v) : decreasing(function, v);
+    }
+
+    /**
+     * @return The value raised to the integral exponent, even powers of intervals containing zero start at zero.
+     */
+    static Interval pow(const Interval &v, long exponent) {
+        if (v.isNaN())
+            return NaN();
+        if (exponent == 0)
+            return Interval(1);
+
+        unsigned long n = exponent < 0 ? 0UL - static_cast<unsigned long>(exponent)
+                                       : static_cast<unsigned long>(exponent);
+        const Interval base = n % 2 == 0 ? abs(v) : v;
+        ArithmeticType lower(0, mpfr::mpreal::get_default_prec());
+        ArithmeticType upper(0, mpfr::mpreal::get_default_prec());
+        mpfr_pow_ui(lower.mpfr_ptr(), base.lower.mpfr_srcptr(), n, MPFR_RNDD);
+        mpfr_pow_ui(upper.mpfr_ptr(), base.upper.mpfr_srcptr(), n, MPFR_RNDU);
+        if (exponent < 0)
+            return Interval(1) / Interval(lower, upper);
+        return {lower, upper};
+    }
+
+    /**
+     * @return The base raised to the exponent, NaN if the exponent is not an integer and the base may be negative.
+     */
+    static Interval pow(const Interval &base, const Interval &exponent) {
+        if (base.isNaN() || exponent.isNaN())
+            return NaN();
+        if (exponent.isPoint()
+            && mpfr_integer_p(exponent.lower.mpfr_srcptr())
+            && mpfr_fits_slong_p(exponent.lower.mpfr_srcptr(), MPFR_RNDN))
+            return pow(base, mpfr_get_si(exponent.lower.mpfr_srcptr(), MPFR_RNDN));
+        if (mpfr_sgn(base.lower.mpfr_srcptr()) < 0)
+            return NaN();
+        // For a fixed base the power is monotonic in the exponent and for a fixed exponent in the base.
+        return corners(mpfr_pow, base, exponent);
+    }
+
+    /**
+     * @return The n-th root, NaN for even roots if the value may be negative.
+     */
+    static Interval root(const Interval &v, const Interval &n) {
+        if (v.isNaN() || n.isNaN())
+            return NaN();
+        if (!n.isPoint()
+            || !mpfr_integer_p(n.lower.mpfr_srcptr())
+            || mpfr_sgn(n.lower.mpfr_srcptr()) <= 0
+            || !mpfr_fits_ulong_p(n.lower.mpfr_srcptr(), MPFR_RNDN))
+            return pow(v, Interval(1) / n);
+        unsigned long degree = mpfr_get_ui(n.lower.mpfr_srcptr(), MPFR_RNDN);
+        if (degree % 2 == 0 && mpfr_sgn(v.lower.mpfr_srcptr()) < 0)
+            return NaN();
+        return {mpfr::root(v.lower, degree, MPFR_RNDD), mpfr::root(v.upper, degree, MPFR_RNDU)};
+    }
+
+    /**
+     * @return The remainder of the division truncated toward zero like fmod.
+     */
+    static Interval modulus(const Interval &v0, const Interval &v1) {
+        if (v0.isNaN() || v1.isNaN() || v1.containsZero())
+            return NaN();
+        const Interval quotient = increasing(mpfr_rint_trunc, v0 / v1);
+        if (quotient.isPoint())
+            return v0 - quotient * v1;
+        // The remainder has the sign of the dividend and is smaller than the divisor.
+        const ArithmeticType magnitude = abs(v1).upper;
+        const ArithmeticType zero(0, mpfr::mpreal::get_default_prec());
+        return {mpfr_sgn(v0.lower.mpfr_srcptr()) >= 0 ? zero : -magnitude,
+                mpfr_sgn(v0.upper.mpfr_srcptr()) <= 0 ? zero : magnitude};
+    }
+
+    /**
+     * @return The fractional part which has the sign of the value.
+     */
+    static Interval frac(const Interval &v) {
+        if (v.isNaN())
+            return NaN();
+        if (increasing(mpfr_rint_trunc, v).isPoint())
+            return increasing(mpfr_frac, v);
+        return {ArithmeticType(mpfr_sgn(v.lower.mpfr_srcptr()) >= 0 ? 0 : -1),
+                ArithmeticType(mpfr_sgn(v.upper.mpfr_srcptr()) <= 0 ? 0 : 1)};
+    }
+
+    /**
+     * The angle of the point is continuous if the rectangle does not contain the origin
+     * and does not cross the negative x axis, its extrema are then located at the corners.
+     */
+    static Interval atan2(const Interval &y, const Interval &x) {
+        if (y.isNaN() || x.isNaN())
+            return NaN();
+        if ((y.containsZero() && x.containsZero())
+            || (mpfr_sgn(x.lower.mpfr_srcptr()) < 0
+                && mpfr_sgn(y.lower.mpfr_srcptr()) < 0
+                && mpfr_sgn(y.upper.mpfr_srcptr()) >= 0)) {
+            const Interval p = pi();
+            return {-p.upper, p.upper};
+        }
+        return corners(mpfr_atan2, y, x);
+    }
+
+    /**
+     * @return -1, 0 or 1 or the hull of the signs of the values in the interval.
+     */
+    static Interval sgn(const Interval &v) {
+        if (v.isNaN())
+            return NaN();
+        return {ArithmeticType(mpfr_sgn(v.lower.mpfr_srcptr()) > 0 ? 1 : (mpfr_sgn(v.lower.mpfr_srcptr()) == 0 ? 0 : -1)),
+                ArithmeticType(mpfr_sgn(v.upper.mpfr_srcptr()) < 0 ? -1 : (mpfr_sgn(v.upper.mpfr_srcptr()) == 0 ? 0 : 1))};
+    }
+
+    /**
+     * @return True if the interval does not contain zero.
+     * @throws std::runtime_error If the interval contains zero and other values.
+     */
+    static bool isTrue(const Interval &v) {
+        if (v.isNaN() || !v.containsZero())
+            return true;
+        if (v.isPoint())
+            return false;
+        undecided();
+    }
+
+    [[noreturn]] static void undecided() {
+        throw std::runtime_error("The interval backend cannot decide the comparison of overlapping intervals,"
+                                 " increase the precision");
+    }
+
+private:
+    ArithmeticType lower;
+    ArithmeticType upper;
+
+    template<typename V>
+    static Interval enclose(V v) {
+        return {ArithmeticType(v, mpfr::mpreal::get_default_prec(), MPFR_RNDD),
+                ArithmeticType(v, mpfr::mpreal::get_default_prec(), MPFR_RNDU)};
+    }
+
+    /**
+     * Multiplication with zero is zero even for infinite values, so that the products of the endpoints
+     * enclose the products of the values (eg. [0, 1] * [1, +Inf] is [0, +Inf]).
+     */
+    static int multiply(mpfr_ptr rop, mpfr_srcptr a, mpfr_srcptr b, mpfr_rnd_t rounding) {
+        if (mpfr_zero_p(a) || mpfr_zero_p(b)) {
+            mpfr_set_zero(rop, 1);
+            return 0;
+        }
+        return mpfr_mul(rop, a, b, rounding);
+    }
+};
+
+namespace std {
+    template<>
+    class numeric_limits<Interval> {
+    public:
+        static const bool is_specialized = true;
+        static const bool is_signed = true;
+        static const bool is_integer = false;
+        static const bool is_exact = false;
+        static const bool has_infinity = true;
+        static const bool has_quiet_NaN = true;
+        static const bool has_signaling_NaN = true;
+        static const int radix = 2;
+        static const int min_exponent = MPFR_EMIN_DEFAULT;
+        static const int max_exponent = MPFR_EMAX_DEFAULT;
+
+        static Interval epsilon() noexcept { return Interval(numeric_limits<ArithmeticType>::epsilon()); }
+
+        static Interval round_error() noexcept { return 0.5; }
+
+        static Interval infinity() noexcept { return Interval::infinity(1); }
+
+        static Interval quiet_NaN() noexcept { return Interval::NaN(); }
+
+        static Interval signaling_NaN() noexcept { return Interval::NaN(); }
+    };
+}
+
+#endif //QCALC_INTERVAL_HPP
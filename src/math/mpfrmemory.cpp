@@ -0,0 +1,186 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "mpfrmemory.hpp"
+
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+#include <gmp.h>
+
+// Larger blocks are rare and would keep too much memory in the pool.
+static const size_t POOL_MAX_BLOCK_SIZE = 64 * 1024;
+static const size_t POOL_MAX_SIZE = 64 * 1024 * 1024;
+
+/**
+ * The freed blocks of a thread by size, the blocks are allocated by malloc with exactly the size of the key.
+ *
+ * Blocks are only reused for the same size because the functions may have been installed after gmp objects were allocated,
+ * the allocated size of a block is therefore only known from the size passed by gmp.
+ */
+struct Pool {
+    std::unordered_map<size_t, std::vector<void *>> blocks;
+    size_t size = 0;
+
+    ~Pool() {
+        release();
+    }
+
+    void release() {
+        for (auto &pair : blocks) {
+            for (auto *block : pair.second) {
+                std::free(block);
+            }
+        }
+        blocks.clear();
+        size = 0;
+    }
+};
+
+static thread_local long long allocated = 0;
+static thread_local long long peak = 0;
+
+static thread_local int poolDepth = 0;
+static thread_local Pool pool;
+
+static const long long NO_LIMIT = std::numeric_limits<long long>::max();
+
+static thread_local long long limit = NO_LIMIT;
+static thread_local const std::string *limitMessage = nullptr;
+
+static void updatePeak() {
+    if (allocated > peak)
+        peak = allocated;
+}
+
+static void *takePooled(size_t size) {
+    auto it = pool.blocks.find(size);
+    if (it == pool.blocks.end() || it->second.empty())
+        return nullptr;
+    void *ret = it->second.back();
+    it->second.pop_back();
+    pool.size -= size;
+    return ret;
+}
+
+static bool putPooled(void *ptr, size_t size) {
+    if (size > POOL_MAX_BLOCK_SIZE || pool.size + size > POOL_MAX_SIZE)
+        return false;
+    try {
+        pool.blocks[size].push_back(ptr);
+    } catch (const std::bad_alloc &) {
+        return false;
+    }
+    pool.size += size;
+    return true;
+}
+
+// The allocation functions must not throw, the exception would unwind through the c frames of gmp and mpfr.
+
+static void *allocate(size_t size) {
+    void *ret = poolDepth > 0 ? takePooled(size) : nullptr;
+    if (ret == nullptr)
+        ret = std::malloc(size);
+    if (ret == nullptr)
+        std::abort(); // Same behaviour as the default gmp allocation function.
+    allocated += static_cast<long long>(size);
+    updatePeak();
+    return ret;
+}
+
+static void *reallocate(void *ptr, size_t oldSize, size_t newSize) {
+    void *ret = std::realloc(ptr, newSize);
+    if (ret == nullptr)
+        std::abort();
+    allocated += static_cast<long long>(newSize) - static_cast<long long>(oldSize);
+    updatePeak();
+    return ret;
+}
+
+static void deallocate(void *ptr, size_t size) {
+    if (poolDepth == 0 || !putPooled(ptr, size))
+        std::free(ptr);
+    allocated -= static_cast<long long>(size);
+}
+
+void MpfrMemory::install() {
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        mp_set_memory_functions(allocate, reallocate, deallocate);
+    });
+}
+
+long long MpfrMemory::getAllocated() {
+    return allocated;
+}
+
+long long MpfrMemory::getPeak() {
+    return peak;
+}
+
+void MpfrMemory::resetPeak() {
+    peak = allocated;
+}
+
+void MpfrMemory::checkRequest(size_t bytes) {
+    if (limit == NO_LIMIT)
+        return;
+    if (bytes >= static_cast<size_t>(NO_LIMIT / 2) || allocated + static_cast<long long>(bytes) > limit)
+        throw std::runtime_error(*limitMessage);
+}
+
+MpfrMemory::ScopedPool::ScopedPool() {
+    install();
+    poolDepth++;
+}
+
+MpfrMemory::ScopedPool::~ScopedPool() {
+    if (--poolDepth == 0)
+        pool.release();
+}
+
+MpfrMemory::ScopedLimit::ScopedLimit(size_t bytes, std::string message)
+        : previousLimit(limit), previousMessage(limitMessage), message(std::move(message)) {
+    install();
+    // The allocated number of bytes of a thread is far from the range of long long.
+    long long value = bytes >= static_cast<size_t>(NO_LIMIT / 2) ? NO_LIMIT : allocated + static_cast<long long>(bytes);
+    if (value < limit) {
+        limit = value;
+        limitMessage = &this->message;
+    }
+}
+
+MpfrMemory::ScopedLimit::~ScopedLimit() {
+    limit = previousLimit;
+    limitMessage = previousMessage;
+}
+
+MpfrMemory::ScopedUnlimited::ScopedUnlimited() : previousLimit(limit) {
+    limit = NO_LIMIT;
+}
+
+MpfrMemory::ScopedUnlimited::~ScopedUnlimited() {
+    limit = previousLimit;
+}
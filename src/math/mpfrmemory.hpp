@@ -0,0 +1,130 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_MPFRMEMORY_HPP
+#define QCALC_MPFRMEMORY_HPP
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Tracks the memory allocated by gmp and mpfr for each thread.
+ *
+ * The tracking allocation functions forward to malloc, realloc and free
+ * and therefore may be installed after gmp objects have been allocated.
+ *
+ * While a ScopedPool exists on a thread, blocks freed by the thread are kept in a pool of the thread
+ * and reused by allocations of the same size instead of being returned to free.
+ */
+namespace MpfrMemory {
+    /**
+     * Install the tracking allocation functions, subsequent calls have no effect.
+     */
+    void install();
+
+    /**
+     * @return The number of bytes allocated minus the number of bytes freed by the calling thread since installation.
+     * Memory may be freed by a different thread than the one which allocated it, so the value can be negative.
+     */
+    long long getAllocated();
+
+    /**
+     * @return The peak of getAllocated() since the last call to resetPeak() on the calling thread.
+     */
+    long long getPeak();
+
+    /**
+     * Set the peak of the calling thread to the currently allocated number of bytes.
+     */
+    void resetPeak();
+
+    /**
+     * Pools the gmp and mpfr blocks freed by the calling thread during the lifetime of the scope.
+     *
+     * Evaluations allocate and free many values of the same precision, the pool avoids the malloc and free of each temporary.
+     * Scopes may be nested, the pooled blocks are freed in one step when the outermost scope of the thread is destroyed.
+     * Installs the allocation functions.
+     */
+    class ScopedPool {
+    public:
+        ScopedPool();
+
+        ~ScopedPool();
+
+        ScopedPool(const ScopedPool &other) = delete;
+
+        ScopedPool &operator=(const ScopedPool &other) = delete;
+    };
+
+    /**
+     * Check a request of the passed number of bytes against the limit of the calling thread.
+     *
+     * Called before passing operands to gmp or mpfr which allocate a result of about the passed size.
+     *
+     * @param bytes
+     * @throws std::runtime_error With the message of the limit if the request would raise getAllocated() above the limit.
+     */
+    void checkRequest(size_t bytes);
+
+    /**
+     * Limits the memory allocated by gmp and mpfr on the calling thread during the lifetime of the scope.
+     *
+     * The limit is enforced by checkRequest() before calling into gmp and mpfr
+     * and by the callers comparing getPeak() to the limit between operations.
+     * The allocation functions never refuse a request, an exception cannot unwind through gmp and mpfr
+     * without leaving their state (eg. the exponent range of mpfr) corrupted.
+     *
+     * Scopes may be nested, the lowest limit applies. Installs the allocation functions.
+     */
+    class ScopedLimit {
+    public:
+        ScopedLimit(size_t bytes, std::string message);
+
+        ~ScopedLimit();
+
+        ScopedLimit(const ScopedLimit &other) = delete;
+
+        ScopedLimit &operator=(const ScopedLimit &other) = delete;
+
+    private:
+        long long previousLimit;
+        const std::string *previousMessage;
+        std::string message;
+    };
+
+    /**
+     * Lifts the limits of the calling thread during the lifetime of the scope,
+     * for code which cannot handle the exceptions of checkRequest() (eg. python scripts).
+     */
+    class ScopedUnlimited {
+    public:
+        ScopedUnlimited();
+
+        ~ScopedUnlimited();
+
+        ScopedUnlimited(const ScopedUnlimited &other) = delete;
+
+        ScopedUnlimited &operator=(const ScopedUnlimited &other) = delete;
+
+    private:
+        long long previousLimit;
+    };
+}
+
+#endif //QCALC_MPFRMEMORY_HPP
@@ -0,0 +1,955 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_MULTIDOUBLE_HPP
+#define QCALC_MULTIDOUBLE_HPP
+
+/**
+ * The double-double and quad-double types.
+ *
+ * A value is stored as the unevaluated sum of N non overlapping doubles ordered by decreasing magnitude,
+ * which gives about 32 (N = 2) or 64 (N = 4) significant decimal digits using only hardware floating point operations.
+ * The exponent range is the range of double.
+ */
+
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+
+#include "arithmetictype.hpp"
+
+namespace MultiDoubleDetail {
+    /**
+     * Error free transformations, the rounding error of the operation is returned in err.
+     */
+
+    inline double quickTwoSum(double a, double b, double &err) {
+        // Requires |a| >= |b|
+        double s = a + b;
+        err = b - (s - a);
+        return s;
+    }
+
+    inline double twoSum(double a, double b, double &err) {
+        double s = a + b;
+        double bb = s - a;
+        err = (a - (s - bb)) + (b - bb);
+        return s;
+    }
+
+    inline double twoProd(double a, double b, double &err) {
+        double p = a * b;
+#ifdef FP_FAST_FMA
+        err = std::fma(a, b, -p);
+#else
+        // Dekker's algorithm, a software fma is much slower than splitting.
+        static const double splitter = 134217729.0; // 2^27 + 1
+        double t = splitter * a;
+        double ah = t - (t - a);
+        double al = a - ah;
+        t = splitter * b;
+        double bh = t - (t - b);
+        double bl = b - bh;
+        err = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif
+        return p;
+    }
+
+    /**
+     * Renormalize the terms into N non overlapping components.
+     *
+     * The terms have to be approximately ordered by decreasing magnitude, the array is used as scratch space.
+     *
+     * @param terms
+     * @param count
+     * @param components The N output components
+     */
+    template<int N>
+    inline void renormalize(double *terms, int count, double *components) {
+        double sum = terms[count - 1];
+        for (int i = count - 2; i >= 0; i--) {
+            double err;
+            sum = twoSum(terms[i], sum, err);
+            terms[i + 1] = err;
+        }
+
+        components[0] = sum;
+        if (!std::isfinite(sum)) {
+            for (int i = 1; i < N; i++)
+                components[i] = 0;
+            return;
+        }
+
+        int j = 0;
+        int i = 1;
+        double carry = sum;
+        for (; i < count && j < N - 1; i++) {
+            double err;
+            double s = twoSum(carry, terms[i], err);
+            if (err != 0) {
+                components[j++] = s;
+                carry = err;
+            } else {
+                carry = s;
+            }
+        }
+        // The remaining terms only affect the rounding of the last component.
+        for (; i < count; i++)
+            carry += terms[i];
+        components[j++] = carry;
+        for (; j < N; j++)
+            components[j] = 0;
+    }
+}
+
+/**
+ * An unevaluated sum of N doubles.
+ *
+ * @tparam N The number of components, 2 (double-double) or 4 (quad-double)
+ */
+template<int N>
+class MultiDouble {
+public:
+    static_assert(N >= 2, "A multi double requires at least two components");
+
+    double x[N];
+
+    MultiDouble() : x() {}
+
+    MultiDouble(double value) : x() { // NOLINT(google-explicit-constructor)
+        x[0] = value;
+    }
+
+    /**
+     * @param components At least N components, which do not have to be normalized.
+     * @param count The number of components
+     * @return
+     */
+    static MultiDouble fromComponents(const double *components, int count) {
+        double terms[4 * N];
+        std::copy(components, components + count, terms);
+        MultiDouble ret;
+        MultiDoubleDetail::renormalize<N>(terms, count, ret.x);
+        return ret;
+    }
+
+    explicit operator double() const {
+        return x[0];
+    }
+
+    explicit operator int() const {
+        return static_cast<int>(trunc(*this).toLongLong());
+    }
+
+    explicit operator long long() const {
+        return trunc(*this).toLongLong();
+    }
+
+    explicit operator std::size_t() const {
+        return static_cast<std::size_t>(trunc(*this).toLongLong());
+    }
+
+    long long toLongLong() const {
+        long long ret = 0;
+        for (int i = 0; i < N; i++)
+            ret += static_cast<long long>(x[i]);
+        return ret;
+    }
+
+    friend MultiDouble operator+(const MultiDouble &a, const MultiDouble &b) {
+        // Merge the components by decreasing magnitude.
+        double terms[2 * N];
+        int i = 0, j = 0, k = 0;
+        while (i < N && j < N) {
+            if (std::fabs(a.x[i]) >= std::fabs(b.x[j]))
+                terms[k++] = a.x[i++];
+            else
+                terms[k++] = b.x[j++];
+        }
+        while (i < N)
+            terms[k++] = a.x[i++];
+        while (j < N)
+            terms[k++] = b.x[j++];
+
+        MultiDouble ret;
+        MultiDoubleDetail::renormalize<N>(terms, 2 * N, ret.x);
+        return ret;
+    }
+
+    friend MultiDouble operator-(const MultiDouble &a, const MultiDouble &b) {
+        return a + (-b);
+    }
+
+    friend MultiDouble operator*(const MultiDouble &a, const MultiDouble &b) {
+        double p = a.x[0] * b.x[0];
+        if (!std::isfinite(p) || p == 0)
+            return p;
+
+        // The products of the order k (i + j == k) are followed by the errors of the products of the order k - 1,
+        // the products of the order N are computed without their errors.
+        double terms[N * (N + 1) + N];
+        double errors[N * (N + 1) / 2];
+        int count = 0;
+        int errorBegin = 0;
+        int errorCount = 0;
+        for (int k = 0; k < N; k++) {
+            int errorEnd = errorCount;
+            for (int i = 0; i <= k; i++) {
+                terms[count++] = MultiDoubleDetail::twoProd(a.x[i], b.x[k - i], errors[errorCount++]);
+            }
+            for (int e = errorBegin; e < errorEnd; e++) {
+                terms[count++] = errors[e];
+            }
+            errorBegin = errorEnd;
+        }
+        for (int e = errorBegin; e < errorCount; e++) {
+            terms[count++] = errors[e];
+        }
+        for (int i = 1; i < N; i++) {
+            terms[count++] = a.x[i] * b.x[N - i];
+        }
+
+        MultiDouble ret;
+        MultiDoubleDetail::renormalize<N>(terms, count, ret.x);
+        return ret;
+    }
+
+    friend MultiDouble operator*(const MultiDouble &a, double b) {
+        double p = a.x[0] * b;
+        if (!std::isfinite(p) || p == 0)
+            return p;
+
+        // The product of each component is followed by the error of the product of the previous component.
+        double terms[2 * N];
+        double errors[N];
+        int count = 0;
+        terms[count++] = MultiDoubleDetail::twoProd(a.x[0], b, errors[0]);
+        for (int i = 1; i < N; i++) {
+            terms[count++] = MultiDoubleDetail::twoProd(a.x[i], b, errors[i]);
+            terms[count++] = errors[i - 1];
+        }
+        terms[count++] = errors[N - 1];
+
+        MultiDouble ret;
+        MultiDoubleDetail::renormalize<N>(terms, 2 * N, ret.x);
+        return ret;
+    }
+
+    friend MultiDouble operator/(const MultiDouble &a, const MultiDouble &b) {
+        // Long division, each quotient digit adds the precision of a double.
+        double q[N + 1];
+        q[0] = a.x[0] / b.x[0];
+        if (!std::isfinite(q[0]) || q[0] == 0)
+            return q[0];
+
+        MultiDouble remainder = a - b * q[0];
+        for (int i = 1; i <= N; i++) {
+            q[i] = remainder.x[0] / b.x[0];
+            if (i < N)
+                remainder = remainder - b * q[i];
+        }
+
+        return fromComponents(q, N + 1);
+    }
+
+    MultiDouble operator-() const {
+        MultiDouble ret;
+        for (int i = 0; i < N; i++)
+            ret.x[i] = -x[i];
+        return ret;
+    }
+
+    MultiDouble &operator+=(const MultiDouble &other) {
+        return *this = *this + other;
+    }
+
+    MultiDouble &operator-=(const MultiDouble &other) {
+        return *this = *this - other;
+    }
+
+    MultiDouble &operator*=(const MultiDouble &other) {
+        return *this = *this * other;
+    }
+
+    MultiDouble &operator/=(const MultiDouble &other) {
+        return *this = *this / other;
+    }
+
+    friend bool operator==(const MultiDouble &a, const MultiDouble &b) {
+        for (int i = 0; i < N; i++) {
+            if (a.x[i] != b.x[i])
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const MultiDouble &a, const MultiDouble &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const MultiDouble &a, const MultiDouble &b) {
+        // The components are normalized, therefore the first differing component decides.
+        for (int i = 0; i < N; i++) {
+            if (a.x[i] != b.x[i])
+                return a.x[i] < b.x[i];
+        }
+        return false;
+    }
+
+    friend bool operator>(const MultiDouble &a, const MultiDouble &b) {
+        return b < a;
+    }
+
+    friend bool operator<=(const MultiDouble &a, const MultiDouble &b) {
+        return !std::isnan(a.x[0]) && !std::isnan(b.x[0]) && !(b < a);
+    }
+
+    friend bool operator>=(const MultiDouble &a, const MultiDouble &b) {
+        return b <= a;
+    }
+};
+
+typedef MultiDouble<2> DoubleDouble;
+typedef MultiDouble<4> QuadDouble;
+
+namespace std {
+    template<int N>
+    class numeric_limits<MultiDouble<N>> {
+    public:
+        static const bool is_specialized = true;
+        static const bool is_signed = true;
+        static const bool is_integer = false;
+        static const bool is_exact = false;
+        static const bool has_infinity = true;
+        static const bool has_quiet_NaN = true;
+        static const bool has_signaling_NaN = true;
+        static const int digits = N * DBL_MANT_DIG;
+        static const int digits10 = (N * DBL_MANT_DIG - 1) * 301 / 1000;
+        static const int max_digits10 = digits10 + 2;
+        static const int radix = 2;
+        static const int min_exponent = DBL_MIN_EXP + (N - 1) * DBL_MANT_DIG;
+        static const int min_exponent10 = DBL_MIN_10_EXP + (N - 1) * 16;
+        static const int max_exponent = DBL_MAX_EXP;
+        static const int max_exponent10 = DBL_MAX_10_EXP;
+
+        static MultiDouble<N> min() noexcept { return std::ldexp(1.0, min_exponent - 1); }
+
+        static MultiDouble<N> max() noexcept { return DBL_MAX; }
+
+        static MultiDouble<N> lowest() noexcept { return -DBL_MAX; }
+
+        static MultiDouble<N> epsilon() noexcept { return std::ldexp(1.0, 1 - digits); }
+
+        static MultiDouble<N> round_error() noexcept { return 0.5; }
+
+        static MultiDouble<N> infinity() noexcept { return std::numeric_limits<double>::infinity(); }
+
+        static MultiDouble<N> quiet_NaN() noexcept { return std::numeric_limits<double>::quiet_NaN(); }
+
+        static MultiDouble<N> signaling_NaN() noexcept { return std::numeric_limits<double>::quiet_NaN(); }
+
+        static MultiDouble<N> denorm_min() noexcept { return std::numeric_limits<double>::denorm_min(); }
+    };
+}
+
+namespace MultiDoubleDetail {
+    /**
+     * @return The precision in bits at which series and iterations terminate.
+     */
+    template<int N>
+    inline double tolerance() {
+        return std::ldexp(1.0, -N * DBL_MANT_DIG - 4);
+    }
+
+    template<int N>
+    inline MultiDouble<N> ldexp(const MultiDouble<N> &v, int exponent) {
+        MultiDouble<N> ret;
+        for (int i = 0; i < N; i++)
+            ret.x[i] = std::ldexp(v.x[i], exponent);
+        return ret;
+    }
+
+    template<int N>
+    inline MultiDouble<N> divide(const MultiDouble<N> &v, double divisor) {
+        double q[N + 1];
+        q[0] = v.x[0] / divisor;
+        if (!std::isfinite(q[0]) || q[0] == 0)
+            return q[0];
+        MultiDouble<N> remainder = v - MultiDouble<N>(divisor) * q[0];
+        for (int i = 1; i <= N; i++) {
+            q[i] = remainder.x[0] / divisor;
+            if (i < N)
+                remainder = remainder - MultiDouble<N>(divisor) * q[i];
+        }
+        return MultiDouble<N>::fromComponents(q, N + 1);
+    }
+
+    /**
+     * Convert the value to a multi double, every component is rounded to nearest except the last
+     * which is rounded with the passed rounding mode.
+     *
+     * @tparam N
+     * @param value
+     * @param rounding
+     * @return
+     */
+    template<int N>
+    inline MultiDouble<N> fromArithmeticType(const ArithmeticType &value, mpfr_rnd_t rounding) {
+        MultiDouble<N> ret;
+        ArithmeticType remainder = value;
+        for (int i = 0; i < N; i++) {
+            ret.x[i] = remainder.toDouble(i == N - 1 ? rounding : MPFR_RNDN);
+            if (!std::isfinite(ret.x[i]) || ret.x[i] == 0)
+                break;
+            // Exact, the remainder has fewer significant bits than the value.
+            mpfr_sub_d(remainder.mpfr_ptr(), remainder.mpfr_srcptr(), ret.x[i], MPFR_RNDN);
+        }
+        return ret;
+    }
+
+    /**
+     * Convert the value to the arithmetic type exactly,
+     * the precision of the returned value is at least the mpfr default precision of the calling thread.
+     *
+     * @tparam N
+     * @param value
+     * @return
+     */
+    template<int N>
+    inline ArithmeticType toArithmeticType(const MultiDouble<N> &value) {
+        mpfr_prec_t precision = std::max<mpfr_prec_t>(mpfr::mpreal::get_default_prec(), N * DBL_MANT_DIG);
+        if (std::isfinite(value.x[0]) && value.x[0] != 0) {
+            // The components may be separated by zero bits which have to be representable.
+            int last = N - 1;
+            while (value.x[last] == 0)
+                last--;
+            precision = std::max<mpfr_prec_t>(precision,
+                                              std::ilogb(value.x[0]) - std::ilogb(value.x[last]) + DBL_MANT_DIG);
+        }
+
+        ArithmeticType ret(value.x[0], precision);
+        if (!std::isfinite(value.x[0]))
+            return ret;
+        for (int i = 1; i < N; i++)
+            mpfr_add_d(ret.mpfr_ptr(), ret.mpfr_srcptr(), value.x[i], MPFR_RNDN);
+        return ret;
+    }
+
+    /**
+     * The constants are computed once by mpfr with more than the precision of the largest multi double.
+     */
+    template<int N>
+    struct Constants {
+        static constexpr mpfr_prec_t precision = 4 * DBL_MANT_DIG + 64;
+
+        static const MultiDouble<N> &pi() {
+            static const MultiDouble<N> value = fromArithmeticType<N>(mpfr::const_pi(precision), MPFR_RNDN);
+            return value;
+        }
+
+        static const MultiDouble<N> &twoPi() {
+            static const MultiDouble<N> value = ldexp(pi(), 1);
+            return value;
+        }
+
+        static const MultiDouble<N> &halfPi() {
+            static const MultiDouble<N> value = ldexp(pi(), -1);
+            return value;
+        }
+
+        static const MultiDouble<N> &e() {
+            static const MultiDouble<N> value = fromArithmeticType<N>(mpfr::exp(ArithmeticType(1, precision)),
+                                                                      MPFR_RNDN);
+            return value;
+        }
+
+        static const MultiDouble<N> &log2() {
+            static const MultiDouble<N> value = fromArithmeticType<N>(mpfr::const_log2(precision), MPFR_RNDN);
+            return value;
+        }
+
+        static const MultiDouble<N> &log10() {
+            static const MultiDouble<N> value = fromArithmeticType<N>(mpfr::log(ArithmeticType(10, precision)),
+                                                                      MPFR_RNDN);
+            return value;
+        }
+
+        static const MultiDouble<N> &sqrt2() {
+            static const MultiDouble<N> value = fromArithmeticType<N>(mpfr::sqrt(ArithmeticType(2, precision)),
+                                                                      MPFR_RNDN);
+            return value;
+        }
+
+        static const MultiDouble<N> &inverseSqrtPi() {
+            static const MultiDouble<N> value = fromArithmeticType<N>(1 / mpfr::sqrt(mpfr::const_pi(precision)),
+                                                                      MPFR_RNDN);
+            return value;
+        }
+    };
+}
+
+template<int N>
+inline MultiDouble<N> fabs(const MultiDouble<N> &v) {
+    return v.x[0] < 0 ? -v : v;
+}
+
+template<int N>
+inline MultiDouble<N> floor(const MultiDouble<N> &v) {
+    double components[N] = {};
+    for (int i = 0; i < N; i++) {
+        components[i] = std::floor(v.x[i]);
+        if (components[i] != v.x[i])
+            break;
+    }
+    return MultiDouble<N>::fromComponents(components, N);
+}
+
+template<int N>
+inline MultiDouble<N> ceil(const MultiDouble<N> &v) {
+    return -floor(-v);
+}
+
+template<int N>
+inline MultiDouble<N> trunc(const MultiDouble<N> &v) {
+    return v.x[0] < 0 ? ceil(v) : floor(v);
+}
+
+/**
+ * Round half away from zero.
+ */
+template<int N>
+inline MultiDouble<N> round(const MultiDouble<N> &v) {
+    return v.x[0] < 0 ? ceil(v - 0.5) : floor(v + 0.5);
+}
+
+template<int N>
+inline MultiDouble<N> fmod(const MultiDouble<N> &a, const MultiDouble<N> &b) {
+    return a - trunc(a / b) * b;
+}
+
+template<int N>
+inline MultiDouble<N> sqrt(const MultiDouble<N> &v) {
+    if (v.x[0] == 0 || !std::isfinite(v.x[0]))
+        return std::sqrt(v.x[0]);
+    if (v.x[0] < 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    // Newton iterations with the derivative of the double approximation, each iteration adds the precision of a double.
+    double root = std::sqrt(v.x[0]);
+    double halfInverse = 0.5 / root;
+    MultiDouble<N> ret = root;
+    for (int i = 1; i < N + 1; i++)
+        ret = ret + (v - ret * ret) * halfInverse;
+    return ret;
+}
+
+template<int N>
+inline MultiDouble<N> hypot(const MultiDouble<N> &a, const MultiDouble<N> &b) {
+    if (std::isinf(a.x[0]) || std::isinf(b.x[0]))
+        return std::numeric_limits<double>::infinity();
+    return sqrt(a * a + b * b);
+}
+
+/**
+ * Integer powers by repeated squaring.
+ */
+template<int N>
+inline MultiDouble<N> pown(const MultiDouble<N> &v, long long n) {
+    if (n == 0)
+        return 1;
+
+    unsigned long long exponent = n < 0 ? -static_cast<unsigned long long>(n) : n;
+    MultiDouble<N> base = v;
+    MultiDouble<N> ret = 1;
+    while (exponent > 0) {
+        if (exponent & 1)
+            ret = ret * base;
+        exponent >>= 1;
+        if (exponent > 0)
+            base = base * base;
+    }
+    return n < 0 ? MultiDouble<N>(1) / ret : ret;
+}
+
+/**
+ * @return exp(v) - 1 computed by the taylor series, used for small arguments.
+ */
+template<int N>
+inline MultiDouble<N> expm1Series(const MultiDouble<N> &v) {
+    const double tolerance = MultiDoubleDetail::tolerance<N>();
+    MultiDouble<N> sum = v;
+    MultiDouble<N> term = v;
+    for (int i = 2; i < 200; i++) {
+        term = MultiDoubleDetail::divide(term * v, i);
+        sum = sum + term;
+        if (std::fabs(term.x[0]) <= tolerance * std::fabs(sum.x[0]))
+            break;
+    }
+    return sum;
+}
+
+template<int N>
+inline MultiDouble<N> exp(const MultiDouble<N> &v) {
+    if (std::isnan(v.x[0]))
+        return v;
+    if (v.x[0] > 709.79)
+        return std::numeric_limits<double>::infinity();
+    if (v.x[0] < -745.2)
+        return 0;
+    if (v.x[0] == 0)
+        return 1;
+
+    // exp(v) = 2^k * exp(r)^(2^m), the scaled argument |r| <= ln(2) / 2^(m + 1) shortens the series.
+    static const int m = 10;
+    const MultiDouble<N> &log2 = MultiDoubleDetail::Constants<N>::log2();
+    double k = std::floor(v.x[0] / log2.x[0] + 0.5);
+    MultiDouble<N> r = MultiDoubleDetail::ldexp(v - log2 * k, -m);
+
+    // Squaring exp(r) - 1 instead of exp(r) avoids the cancellation of the leading one.
+    MultiDouble<N> s = expm1Series(r);
+    for (int i = 0; i < m; i++)
+        s = MultiDoubleDetail::ldexp(s, 1) + s * s;
+
+    return MultiDoubleDetail::ldexp(s + 1.0, static_cast<int>(k));
+}
+
+template<int N>
+inline MultiDouble<N> expm1(const MultiDouble<N> &v) {
+    if (std::fabs(v.x[0]) < 0.5)
+        return expm1Series(v);
+    return exp(v) - 1.0;
+}
+
+template<int N>
+inline MultiDouble<N> log(const MultiDouble<N> &v) {
+    if (std::isnan(v.x[0]))
+        return v;
+    if (v.x[0] < 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    if (v.x[0] == 0)
+        return -std::numeric_limits<double>::infinity();
+    if (std::isinf(v.x[0]))
+        return v;
+    if (v == MultiDouble<N>(1))
+        return 0;
+
+    // Newton iterations on exp, each iteration doubles the number of correct bits.
+    MultiDouble<N> ret = std::log(v.x[0]);
+    for (int bits = DBL_MANT_DIG - 4; bits < N * DBL_MANT_DIG; bits *= 2)
+        ret = ret + v * exp(-ret) - 1.0;
+    return ret;
+}
+
+template<int N>
+inline MultiDouble<N> log1p(const MultiDouble<N> &v) {
+    if (std::fabs(v.x[0]) < 0.5) {
+        // log(1 + v) = 2 * atanh(z) = 2 * sum(z^(2n + 1) / (2n + 1)) with z = v / (2 + v), |z| < 1/3
+        const double tolerance = MultiDoubleDetail::tolerance<N>();
+        MultiDouble<N> z = v / (v + 2.0);
+        MultiDouble<N> square = z * z;
+        MultiDouble<N> sum = z;
+        MultiDouble<N> power = z;
+        for (int i = 3; i < 1000; i += 2) {
+            power = power * square;
+            MultiDouble<N> term = MultiDoubleDetail::divide(power, i);
+            sum = sum + term;
+            if (std::fabs(term.x[0]) <= tolerance * std::fabs(sum.x[0]))
+                break;
+        }
+        return MultiDoubleDetail::ldexp(sum, 1);
+    }
+    MultiDouble<N> u = v + 1.0;
+    if (u == MultiDouble<N>(1))
+        return v;
+    // Compensates the rounding error of 1 + v
+    return log(u) * (v / (u - 1.0));
+}
+
+template<int N>
+inline MultiDouble<N> log10(const MultiDouble<N> &v) {
+    return log(v) / MultiDoubleDetail::Constants<N>::log10();
+}
+
+template<int N>
+inline MultiDouble<N> log2(const MultiDouble<N> &v) {
+    return log(v) / MultiDoubleDetail::Constants<N>::log2();
+}
+
+template<int N>
+inline MultiDouble<N> pow(const MultiDouble<N> &base, const MultiDouble<N> &exponent) {
+    if (exponent == trunc(exponent) && std::fabs(exponent.x[0]) < 4294967296.0)
+        return pown(base, exponent.toLongLong());
+    if (base.x[0] == 0)
+        return exponent.x[0] > 0 ? 0 : std::numeric_limits<double>::infinity();
+    if (base.x[0] < 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    return exp(exponent * log(base));
+}
+
+/**
+ * Compute the sine and cosine of the value.
+ */
+template<int N>
+inline void sincos(const MultiDouble<N> &v, MultiDouble<N> &sine, MultiDouble<N> &cosine) {
+    typedef MultiDoubleDetail::Constants<N> Constants;
+
+    if (!std::isfinite(v.x[0])) {
+        sine = cosine = std::numeric_limits<double>::quiet_NaN();
+        return;
+    }
+    if (v.x[0] == 0) {
+        sine = v;
+        cosine = 1;
+        return;
+    }
+
+    // Reduce the argument to |r| <= pi / 4 and the quadrant j.
+    MultiDouble<N> r = v - Constants::twoPi() * std::round(v.x[0] / Constants::twoPi().x[0]);
+    double j = std::round(r.x[0] / Constants::halfPi().x[0]);
+    r = r - Constants::halfPi() * j;
+
+    const double tolerance = MultiDoubleDetail::tolerance<N>();
+    MultiDouble<N> s = r;
+    MultiDouble<N> term = r;
+    MultiDouble<N> square = r * r;
+    for (int i = 3; i < 400; i += 2) {
+        term = -MultiDoubleDetail::divide(term * square, static_cast<double>(i) * (i - 1));
+        s = s + term;
+        if (std::fabs(term.x[0]) <= tolerance * std::fabs(s.x[0]))
+            break;
+    }
+    // The cosine of |r| <= pi / 4 is at least 0.7, the subtraction does not cancel.
+    MultiDouble<N> c = sqrt(MultiDouble<N>(1) - s * s);
+
+    switch (static_cast<int>(j)) {
+        case 0:
+            sine = s;
+            cosine = c;
+            break;
+        case 1:
+            sine = c;
+            cosine = -s;
+            break;
+        case -1:
+            sine = -c;
+            cosine = s;
+            break;
+        default:
+            sine = -s;
+            cosine = -c;
+            break;
+    }
+}
+
+template<int N>
+inline MultiDouble<N> sin(const MultiDouble<N> &v) {
+    MultiDouble<N> s, c;
+    sincos(v, s, c);
+    return s;
+}
+
+template<int N>
+inline MultiDouble<N> cos(const MultiDouble<N> &v) {
+    MultiDouble<N> s, c;
+    sincos(v, s, c);
+    return c;
+}
+
+template<int N>
+inline MultiDouble<N> tan(const MultiDouble<N> &v) {
+    MultiDouble<N> s, c;
+    sincos(v, s, c);
+    return s / c;
+}
+
+template<int N>
+inline MultiDouble<N> atan2(const MultiDouble<N> &y, const MultiDouble<N> &x) {
+    typedef MultiDoubleDetail::Constants<N> Constants;
+
+    if (std::isnan(x.x[0]) || std::isnan(y.x[0]))
+        return std::numeric_limits<double>::quiet_NaN();
+    if (x.x[0] == 0) {
+        if (y.x[0] == 0)
+            return 0;
+        return y.x[0] > 0 ? Constants::halfPi() : -Constants::halfPi();
+    }
+    if (y.x[0] == 0)
+        return x.x[0] > 0 ? MultiDouble<N>(0) : Constants::pi();
+    if (std::isinf(x.x[0]) || std::isinf(y.x[0]))
+        return std::atan2(y.x[0], x.x[0]);
+
+    // Newton iterations on sin or cos of the point on the unit circle, whichever is better conditioned.
+    MultiDouble<N> radius = sqrt(x * x + y * y);
+    MultiDouble<N> xx = x / radius;
+    MultiDouble<N> yy = y / radius;
+
+    MultiDouble<N> ret = std::atan2(y.x[0], x.x[0]);
+    MultiDouble<N> s, c;
+    for (int bits = DBL_MANT_DIG - 4; bits < N * DBL_MANT_DIG; bits *= 2) {
+        sincos(ret, s, c);
+        if (std::fabs(xx.x[0]) > std::fabs(yy.x[0]))
+            ret = ret + (yy - s) / c;
+        else
+            ret = ret - (xx - c) / s;
+    }
+    return ret;
+}
+
+template<int N>
+inline MultiDouble<N> atan(const MultiDouble<N> &v) {
+    return atan2(v, MultiDouble<N>(1));
+}
+
+template<int N>
+inline MultiDouble<N> asin(const MultiDouble<N> &v) {
+    MultiDouble<N> a = fabs(v);
+    if (a > MultiDouble<N>(1))
+        return std::numeric_limits<double>::quiet_NaN();
+    return atan2(v, sqrt((MultiDouble<N>(1) - v) * (v + 1.0)));
+}
+
+template<int N>
+inline MultiDouble<N> acos(const MultiDouble<N> &v) {
+    MultiDouble<N> a = fabs(v);
+    if (a > MultiDouble<N>(1))
+        return std::numeric_limits<double>::quiet_NaN();
+    return atan2(sqrt((MultiDouble<N>(1) - v) * (v + 1.0)), v);
+}
+
+template<int N>
+inline MultiDouble<N> sinh(const MultiDouble<N> &v) {
+    if (std::fabs(v.x[0]) < 0.5) {
+        // The series avoids the cancellation of exp(v) - exp(-v)
+        const double tolerance = MultiDoubleDetail::tolerance<N>();
+        MultiDouble<N> sum = v;
+        MultiDouble<N> term = v;
+        MultiDouble<N> square = v * v;
+        for (int i = 3; i < 400; i += 2) {
+            term = MultiDoubleDetail::divide(term * square, static_cast<double>(i) * (i - 1));
+            sum = sum + term;
+            if (std::fabs(term.x[0]) <= tolerance * std::fabs(sum.x[0]))
+                break;
+        }
+        return sum;
+    }
+    MultiDouble<N> e = exp(v);
+    return MultiDoubleDetail::ldexp(e - MultiDouble<N>(1) / e, -1);
+}
+
+template<int N>
+inline MultiDouble<N> cosh(const MultiDouble<N> &v) {
+    MultiDouble<N> e = exp(v);
+    return MultiDoubleDetail::ldexp(e + MultiDouble<N>(1) / e, -1);
+}
+
+template<int N>
+inline MultiDouble<N> tanh(const MultiDouble<N> &v) {
+    if (std::fabs(v.x[0]) > 150)
+        return v.x[0] > 0 ? 1 : -1;
+    MultiDouble<N> s = sinh(v);
+    return s / sqrt(s * s + 1.0);
+}
+
+template<int N>
+inline MultiDouble<N> asinh(const MultiDouble<N> &v) {
+    if (v.x[0] < 0)
+        return -asinh(-v);
+    if (std::isinf(v.x[0]))
+        return v;
+    MultiDouble<N> square = v * v;
+    return log1p(v + square / (sqrt(square + 1.0) + 1.0));
+}
+
+template<int N>
+inline MultiDouble<N> acosh(const MultiDouble<N> &v) {
+    if (v < MultiDouble<N>(1))
+        return std::numeric_limits<double>::quiet_NaN();
+    return log(v + sqrt(v * v - 1.0));
+}
+
+template<int N>
+inline MultiDouble<N> atanh(const MultiDouble<N> &v) {
+    if (fabs(v) > MultiDouble<N>(1))
+        return std::numeric_limits<double>::quiet_NaN();
+    return MultiDoubleDetail::ldexp(log1p(MultiDoubleDetail::ldexp(v, 1) / (MultiDouble<N>(1) - v)), -1);
+}
+
+template<int N>
+inline MultiDouble<N> erf(const MultiDouble<N> &v) {
+    typedef MultiDoubleDetail::Constants<N> Constants;
+
+    if (std::isnan(v.x[0]))
+        return v;
+    if (v.x[0] < 0)
+        return -erf(-v);
+    // erfc(27) is below the smallest double.
+    if (v.x[0] > 27)
+        return 1;
+    if (v.x[0] >= 3)
+        return MultiDouble<N>(1) - erfc(v);
+
+    // erf(v) = 2 / sqrt(pi) * exp(-v^2) * sum(2^n * v^(2n + 1) / (1 * 3 * ... * (2n + 1))), the terms are positive.
+    const double tolerance = MultiDoubleDetail::tolerance<N>();
+    MultiDouble<N> square = v * v;
+    MultiDouble<N> twoSquare = MultiDoubleDetail::ldexp(square, 1);
+    MultiDouble<N> sum = v;
+    MultiDouble<N> term = v;
+    for (int n = 1; n < 2000; n++) {
+        term = MultiDoubleDetail::divide(term * twoSquare, 2.0 * n + 1);
+        sum = sum + term;
+        if (std::fabs(term.x[0]) <= tolerance * std::fabs(sum.x[0]))
+            break;
+    }
+    return MultiDoubleDetail::ldexp(sum * exp(-square) * Constants::inverseSqrtPi(), 1);
+}
+
+template<int N>
+inline MultiDouble<N> erfc(const MultiDouble<N> &v) {
+    typedef MultiDoubleDetail::Constants<N> Constants;
+
+    if (std::isnan(v.x[0]))
+        return v;
+    if (v.x[0] < 3) {
+        // Loses relative precision when approaching 3, where erfc(v) is about 2e-5.
+        return MultiDouble<N>(1) - erf(v);
+    }
+    if (v.x[0] > 27)
+        return 0;
+
+    // erfc(v) = exp(-v^2) / sqrt(pi) / (v + (1/2) / (v + (2/2) / (v + (3/2) / ...))) evaluated by Lentz's method.
+    const double tolerance = MultiDoubleDetail::tolerance<N>();
+    MultiDouble<N> f = v;
+    MultiDouble<N> c = v;
+    MultiDouble<N> d = 0;
+    for (int n = 1; n < 5000; n++) {
+        double a = n / 2.0;
+        d = MultiDouble<N>(1) / (v + d * a);
+        c = v + a / c;
+        MultiDouble<N> delta = c * d;
+        f = f * delta;
+        if (std::fabs((delta - 1.0).x[0]) <= tolerance)
+            break;
+    }
+    return exp(-(v * v)) * Constants::inverseSqrtPi() / f;
+}
+
+#endif //QCALC_MULTIDOUBLE_HPP
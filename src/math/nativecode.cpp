@@ -0,0 +1,271 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "nativecode.hpp"
+
+#ifdef QCALC_JIT
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <initializer_list>
+
+#include <sys/mman.h>
+
+typedef Bytecode<double> DoubleBytecode;
+
+// The constants loaded by the generated code.
+static const double ONE = 1.0;
+static const uint64_t SIGN_MASK = 0x8000000000000000ull;
+
+// The prefix and opcode bytes of the used SSE2 instructions.
+static const uint8_t PREFIX_SD = 0xF2;
+static const uint8_t PREFIX_PD = 0x66;
+static const uint8_t OPCODE_ADD = 0x58;
+static const uint8_t OPCODE_MUL = 0x59;
+static const uint8_t OPCODE_SUB = 0x5C;
+static const uint8_t OPCODE_DIV = 0x5E;
+static const uint8_t OPCODE_MOVAPD = 0x28;
+static const uint8_t OPCODE_ANDPD = 0x54;
+static const uint8_t OPCODE_XORPD = 0x57;
+static const uint8_t OPCODE_CMPSD = 0xC2;
+
+// The predicates of cmpsd, both are false if an operand is NaN.
+static const uint8_t PREDICATE_LT = 1;
+static const uint8_t PREDICATE_LE = 2;
+
+/**
+ * Encodes the instructions, xmm registers are identified by their number (0 - 7).
+ * Memory operands are addressed absolute through rax.
+ */
+class Assembler {
+public:
+    std::vector<uint8_t> code;
+
+    void bytes(std::initializer_list<uint8_t> values) {
+        code.insert(code.end(), values);
+    }
+
+    // mov rax, imm64
+    void address(const void *value) {
+        bytes({0x48, 0xB8});
+        auto v = reinterpret_cast<uint64_t>(value);
+        for (int i = 0; i < 8; i++) {
+            code.push_back(static_cast<uint8_t>(v >> (8 * i)));
+        }
+    }
+
+    // movsd xmm, [address]
+    void load(int xmm, const void *value) {
+        address(value);
+        bytes({PREFIX_SD, 0x0F, 0x10, static_cast<uint8_t>(xmm << 3)});
+    }
+
+    // movsd [address], xmm
+    void store(const void *value, int xmm) {
+        address(value);
+        bytes({PREFIX_SD, 0x0F, 0x11, static_cast<uint8_t>(xmm << 3)});
+    }
+
+    // op xmm, xmm
+    void operation(uint8_t prefix, uint8_t opcode, int target, int source) {
+        bytes({prefix, 0x0F, opcode, static_cast<uint8_t>(0xC0 | (target << 3) | source)});
+    }
+
+    // cmpsd xmm, xmm, predicate
+    void compare(int target, int source, uint8_t predicate) {
+        operation(PREFIX_SD, OPCODE_CMPSD, target, source);
+        code.push_back(predicate);
+    }
+
+    // call through rax, the stack is kept aligned by the prologue.
+    void call(const void *function) {
+        address(function);
+        bytes({0xFF, 0xD0});
+    }
+
+    /**
+     * Raise xmm0 to the power p, same operations as Bytecode::power. Uses xmm1 and xmm3.
+     */
+    void power(uint32_t p) {
+        switch (p) {
+            case 0:
+                load(0, &ONE);
+                break;
+            case 1:
+                break;
+            case 2:
+                operation(PREFIX_SD, OPCODE_MUL, 0, 0);
+                break;
+            case 3:
+                operation(PREFIX_PD, OPCODE_MOVAPD, 1, 0);
+                operation(PREFIX_SD, OPCODE_MUL, 0, 1);
+                operation(PREFIX_SD, OPCODE_MUL, 0, 1);
+                break;
+            case 4:
+                operation(PREFIX_SD, OPCODE_MUL, 0, 0);
+                operation(PREFIX_SD, OPCODE_MUL, 0, 0);
+                break;
+            case 5:
+            case 7:
+            case 9:
+                operation(PREFIX_PD, OPCODE_MOVAPD, 3, 0);
+                power(p - 1);
+                operation(PREFIX_SD, OPCODE_MUL, 0, 3);
+                break;
+            case 6:
+            case 8:
+            case 10:
+                power(p / 2);
+                operation(PREFIX_SD, OPCODE_MUL, 0, 0);
+                break;
+            default:
+                load(1, &ONE);
+                while (p) {
+                    if (p & 1u) {
+                        operation(PREFIX_SD, OPCODE_MUL, 1, 0);
+                        --p;
+                    }
+                    operation(PREFIX_SD, OPCODE_MUL, 0, 0);
+                    p >>= 1u;
+                }
+                operation(PREFIX_PD, OPCODE_MOVAPD, 0, 1);
+                break;
+        }
+    }
+};
+
+template<typename F>
+static const void *toAddress(F function) {
+    return reinterpret_cast<const void *>(function);
+}
+
+std::unique_ptr<NativeCode> NativeCode::compile(const Bytecode<double> &bytecode) {
+    if (bytecode.empty())
+        return nullptr;
+
+    const auto &operands = bytecode.getOperands();
+
+    Assembler a;
+    a.bytes({0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8
+
+    for (auto &instruction : bytecode.getInstructions()) {
+        const double *x = operands.at(instruction.a);
+        const double *y = operands.at(instruction.b);
+        a.load(0, x);
+        switch (instruction.op) {
+            case DoubleBytecode::OP_COPY:
+                break;
+            case DoubleBytecode::OP_NEG:
+                a.load(1, &SIGN_MASK);
+                a.operation(PREFIX_PD, OPCODE_XORPD, 0, 1);
+                break;
+            case DoubleBytecode::OP_ADD:
+                a.load(1, y);
+                a.operation(PREFIX_SD, OPCODE_ADD, 0, 1);
+                break;
+            case DoubleBytecode::OP_SUB:
+                a.load(1, y);
+                a.operation(PREFIX_SD, OPCODE_SUB, 0, 1);
+                break;
+            case DoubleBytecode::OP_MUL:
+                a.load(1, y);
+                a.operation(PREFIX_SD, OPCODE_MUL, 0, 1);
+                break;
+            case DoubleBytecode::OP_DIV:
+                a.load(1, y);
+                a.operation(PREFIX_SD, OPCODE_DIV, 0, 1);
+                break;
+            case DoubleBytecode::OP_MOD:
+                a.load(1, y);
+                a.call(toAddress(&exprtk::details::numeric::modulus<double>));
+                break;
+            case DoubleBytecode::OP_POW:
+                a.load(1, y);
+                a.call(toAddress(&exprtk::details::numeric::pow<double>));
+                break;
+            case DoubleBytecode::OP_IPOW:
+                a.power(instruction.extra);
+                break;
+            case DoubleBytecode::OP_IPOWINV:
+                a.power(instruction.extra);
+                a.operation(PREFIX_PD, OPCODE_MOVAPD, 1, 0);
+                a.load(0, &ONE);
+                a.operation(PREFIX_SD, OPCODE_DIV, 0, 1);
+                break;
+            case DoubleBytecode::OP_LT:
+            case DoubleBytecode::OP_LTE:
+                a.load(1, y);
+                a.compare(0, 1, instruction.op == DoubleBytecode::OP_LT ? PREDICATE_LT : PREDICATE_LE);
+                a.load(1, &ONE);
+                a.operation(PREFIX_PD, OPCODE_ANDPD, 0, 1);
+                break;
+            case DoubleBytecode::OP_GT:
+            case DoubleBytecode::OP_GTE:
+                // x > y is evaluated as y < x.
+                a.load(1, y);
+                a.compare(1, 0, instruction.op == DoubleBytecode::OP_GT ? PREDICATE_LT : PREDICATE_LE);
+                a.operation(PREFIX_PD, OPCODE_MOVAPD, 0, 1);
+                a.load(1, &ONE);
+                a.operation(PREFIX_PD, OPCODE_ANDPD, 0, 1);
+                break;
+            case DoubleBytecode::OP_UNARY:
+                a.call(toAddress(DoubleBytecode::getUnaryFunctions().at(instruction.extra).function));
+                break;
+            case DoubleBytecode::OP_BINARY:
+                a.load(1, y);
+                a.call(toAddress(DoubleBytecode::getBinaryFunctions().at(instruction.extra).function));
+                break;
+            default:
+                return nullptr;
+        }
+        a.store(operands.at(instruction.target), 0);
+    }
+
+    a.load(0, operands.at(bytecode.getResult()));
+    a.bytes({0x48, 0x83, 0xC4, 0x08}); // add rsp, 8
+    a.bytes({0xC3}); // ret
+
+    size_t size = a.code.size();
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return nullptr;
+    std::memcpy(memory, a.code.data(), size);
+    // The pages are never writable and executable at the same time.
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<NativeCode>(new NativeCode(memory, size, reinterpret_cast<Entry>(memory)));
+}
+
+NativeCode::~NativeCode() {
+    munmap(memory, size);
+}
+
+#else
+
+std::unique_ptr<NativeCode> NativeCode::compile(const Bytecode<double> &) {
+    return nullptr;
+}
+
+NativeCode::~NativeCode() = default;
+
+#endif
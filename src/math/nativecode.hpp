@@ -0,0 +1,66 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_NATIVECODE_HPP
+#define QCALC_NATIVECODE_HPP
+
+#include <memory>
+#include <cstddef>
+
+#include "bytecode.hpp"
+
+/**
+ * x86-64 machine code translated from a double precision Bytecode, requires QCALC_JIT.
+ *
+ * Each instruction of the bytecode is translated to SSE2 scalar instructions which load the operands from
+ * and store the result to the same addresses the bytecode uses (its registers and the bound variables),
+ * built in functions are called through the same function pointers. The code therefore computes the same values
+ * as the bytecode and honors the current floating point rounding mode.
+ *
+ * The code references the storage of the bytecode and must not be used after the bytecode is destroyed.
+ */
+class NativeCode {
+public:
+    /**
+     * @param bytecode
+     * @return The translated code or nullptr if the JIT is not available on this platform.
+     */
+    static std::unique_ptr<NativeCode> compile(const Bytecode<double> &bytecode);
+
+    ~NativeCode();
+
+    NativeCode(const NativeCode &other) = delete;
+
+    NativeCode &operator=(const NativeCode &other) = delete;
+
+    double evaluate() const {
+        return entry();
+    }
+
+private:
+    typedef double (*Entry)();
+
+    NativeCode(void *memory, size_t size, Entry entry) : memory(memory), size(size), entry(entry) {}
+
+    void *memory;
+    size_t size;
+    Entry entry;
+};
+
+#endif //QCALC_NATIVECODE_HPP
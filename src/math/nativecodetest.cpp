@@ -0,0 +1,153 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "nativecodetest.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include "bytecode.hpp"
+#include "nativecode.hpp"
+
+typedef Bytecode<double> DoubleBytecode;
+
+// The largest integer exponent which the bytecode expands into multiplications.
+static const int MAX_EXPANDED_EXPONENT = 60;
+
+static const double EDGE_INPUTS[] = {
+        0.0,
+        -0.0,
+        1.0,
+        -1.0,
+        0.5,
+        2.0,
+        -3.0,
+        7.25,
+        0.1,
+        1e300,
+        -1e300,
+        1e-300,
+        std::numeric_limits<double>::min() / 2,
+        std::numeric_limits<double>::denorm_min(),
+        -std::numeric_limits<double>::denorm_min(),
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN()
+};
+
+/**
+ * @return Expressions of the variables x and y which together emit every opcode.
+ */
+static std::vector<std::string> getExpressions() {
+    std::vector<std::string> ret{
+            "~{var a := x + 1; a}", // OP_COPY
+            "-x",
+            "x + y",
+            "x - y",
+            "x * y",
+            "x / y",
+            "x % y",
+            "mod(x, y)",
+            "x ^ y",
+            "x ^ 61", // Not expanded, OP_POW
+            "x < y",
+            "x <= y",
+            "x > y",
+            "x >= y",
+            // Registers are reused once their value has been consumed.
+            "(x + y) * (x - y) / (x * y + 1) - (x / (y - 2)) ^ 2 + sin(x) * cos(y)",
+            "((((x + 1) * 2 + 3) * 4 + y) * 5) / (((y - 1) * 2 - x) * 3)",
+            "~{var a := x * y; var b := a + x; var c := b * a; c - a / b + (x < b) * (c >= y)}",
+            "-(-x - -y) * -(x ^ 3) + -(y ^ -2)"
+    };
+    for (int p = 1; p <= MAX_EXPANDED_EXPONENT; p++) {
+        ret.emplace_back("x ^ " + std::to_string(p)); // OP_IPOW
+        ret.emplace_back("x ^ -" + std::to_string(p)); // OP_IPOWINV
+    }
+    for (auto &function : DoubleBytecode::getUnaryFunctions()) {
+        ret.emplace_back(std::string(function.name) + "(x)");
+    }
+    for (auto &function : DoubleBytecode::getBinaryFunctions()) {
+        ret.emplace_back(std::string(function.name) + "(x, y)");
+    }
+    return ret;
+}
+
+static bool isIdentical(double a, double b) {
+    if (std::isnan(a) && std::isnan(b))
+        return true;
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static std::string toString(double v) {
+    std::ostringstream stream;
+    stream << std::hexfloat << v;
+    return stream.str();
+}
+
+bool NativeCodeTest::compareWithBytecode(std::vector<std::string> &failures) {
+    size_t failureCount = failures.size();
+
+    double x = 0;
+    double y = 0;
+    exprtk::symbol_table<double> symbols;
+    symbols.add_variable("x", x);
+    symbols.add_variable("y", y);
+
+    for (auto &expr : getExpressions()) {
+        DoubleBytecode bytecode;
+        if (!DoubleBytecode::lower(expr, symbols, bytecode)) {
+            failures.emplace_back("NativeCode: Failed to lower " + expr);
+            continue;
+        }
+
+        auto native = NativeCode::compile(bytecode);
+        if (!native)
+            return failures.size() == failureCount;
+
+        bool nativeFirst = false;
+        for (double a : EDGE_INPUTS) {
+            for (double b : EDGE_INPUTS) {
+                x = a;
+                y = b;
+                // Alternate the order so that neither evaluation depends on registers left by the other.
+                nativeFirst = !nativeFirst;
+                double expected;
+                double actual;
+                if (nativeFirst) {
+                    actual = native->evaluate();
+                    expected = bytecode.evaluate();
+                } else {
+                    expected = bytecode.evaluate();
+                    actual = native->evaluate();
+                }
+                if (!isIdentical(expected, actual)) {
+                    failures.emplace_back("NativeCode: " + expr
+                                          + " with x = " + toString(a) + ", y = " + toString(b)
+                                          + " returned " + toString(actual)
+                                          + " instead of " + toString(expected));
+                }
+            }
+        }
+    }
+
+    return failures.size() == failureCount;
+}
@@ -0,0 +1,45 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_NATIVECODETEST_HPP
+#define QCALC_NATIVECODETEST_HPP
+
+#include <string>
+#include <vector>
+
+/**
+ * Differential check of the NativeCode translation against the Bytecode interpreter.
+ */
+namespace NativeCodeTest {
+    /**
+     * Evaluate expressions which cover every opcode of the bytecode (including every built in function,
+     * the expanded positive and negative integer powers up to the largest expanded exponent and expressions
+     * which reuse registers) with both NativeCode::evaluate and Bytecode::evaluate
+     * for all pairs of a set of edge inputs (signed zeros, subnormals, large values, infinities and NaN).
+     *
+     * The results have to be identical bit for bit, except that any two NaNs are considered identical
+     * because the sign and payload of a NaN depend on the operand order chosen by the compiler.
+     *
+     * @param failures Appended with a description of every expression and input whose results differ.
+     * @return True if all results are identical or the JIT is not available on this platform.
+     */
+    bool compareWithBytecode(std::vector<std::string> &failures);
+}
+
+#endif //QCALC_NATIVECODETEST_HPP
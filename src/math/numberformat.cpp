@@ -20,6 +20,7 @@
 #include "numberformat.hpp"
 
 #include "fractiontest.hpp"
+#include "evaluationcontext.hpp"
 
 using namespace FractionTest;
 
@@ -39,6 +40,60 @@ std::string getRoundingFormatChar(mpfr_rnd_t mode) {
     }
 }
 
+/**
+ * Bounds of opposite sign close to zero format to "-0" and "0", which are the same value.
+ */
+static std::string stripNegativeZero(std::string s) {
+    if (!s.empty() && s.front() == '-' && s.find_first_not_of("0.", 1) == std::string::npos)
+        s.erase(0, 1);
+    return s;
+}
+
+std::string NumberFormat::toDecimal(const ArithmeticType &v) {
+    auto &context = EvaluationContext::getCurrent();
+    return toDecimal(v, context.formattingPrecision, context.formattingRounding);
+}
+
+std::string NumberFormat::toHex(const ArithmeticType &v) {
+    auto &context = EvaluationContext::getCurrent();
+    return toHex(v, context.formattingPrecision, context.formattingRounding);
+}
+
+std::string NumberFormat::toOctal(const ArithmeticType &v) {
+    auto &context = EvaluationContext::getCurrent();
+    return toOctal(v, context.formattingPrecision, context.formattingRounding);
+}
+
+std::string NumberFormat::toBinary(const ArithmeticType &v) {
+    auto &context = EvaluationContext::getCurrent();
+    return toBinary(v, context.formattingPrecision, context.formattingRounding);
+}
+
+std::string NumberFormat::toDecimal(const ArithmeticType &lower, const ArithmeticType &upper) {
+    auto &context = EvaluationContext::getCurrent();
+    return toDecimal(lower, upper, context.formattingPrecision, context.formattingRounding);
+}
+
+ArithmeticType NumberFormat::fromDecimal(const std::string &s) {
+    auto &context = EvaluationContext::getCurrent();
+    return fromDecimal(s, context.precision, context.rounding);
+}
+
+ArithmeticType NumberFormat::fromHex(const std::string &s) {
+    auto &context = EvaluationContext::getCurrent();
+    return fromHex(s, context.precision, context.rounding);
+}
+
+ArithmeticType NumberFormat::fromOctal(const std::string &s) {
+    auto &context = EvaluationContext::getCurrent();
+    return fromOctal(s, context.precision, context.rounding);
+}
+
+ArithmeticType NumberFormat::fromBinary(const std::string &s) {
+    auto &context = EvaluationContext::getCurrent();
+    return fromBinary(s, context.precision, context.rounding);
+}
+
 std::string NumberFormat::toDecimal(const ArithmeticType &v, int decimalSpaces, mpfr_rnd_t rounding) {
     std::string ret = v.toString("%."
                                  + std::to_string(decimalSpaces)
@@ -103,6 +158,21 @@ std::string NumberFormat::toBinary(const ArithmeticType &v, int decimalSpaces, m
     }
 }
 
+std::string NumberFormat::toDecimal(const ArithmeticType &lower,
+                                    const ArithmeticType &upper,
+                                    int decimalSpaces,
+                                    mpfr_rnd_t rounding) {
+    // Rounding is monotonic, if both bounds round to the same string all values in between do.
+    // Agreement at some decimal spaces does not imply agreement at fewer when rounding to nearest (eg. [0.149, 0.151]),
+    // therefore every count is tried starting with the largest.
+    for (int i = decimalSpaces; i >= 0; i--) {
+        std::string ret = stripNegativeZero(toDecimal(lower, i, rounding));
+        if (ret == stripNegativeZero(toDecimal(upper, i, rounding)))
+            return ret;
+    }
+    return "[" + toDecimal(lower, decimalSpaces, MPFR_RNDD) + ", " + toDecimal(upper, decimalSpaces, MPFR_RNDU) + "]";
+}
+
 ArithmeticType NumberFormat::fromDecimal(const std::string &s, int precision, mpfr_rnd_t rounding) {
     return mpfr::mpreal(s, precision, 10, rounding);
 }
@@ -30,7 +30,36 @@
 
 #include "arithmetictype.hpp"
 
+/**
+ * The overloads without precision and rounding arguments use the settings of the current evaluation context,
+ * the formatting precision and rounding mode when converting to a string and
+ * the arithmetic precision and rounding mode when converting from a string.
+ *
+ * The overloads which take a lower and an upper bound format an enclosure of a value (See ExpressionParser::evaluateEnclosure)
+ * with the most decimal spaces, up to the formatting precision, for which both bounds format to the same string.
+ * Every value of the enclosure formats to that string, so only certified digits are printed.
+ * If not even the integral digits agree the enclosure is printed as [lower, upper]
+ * with the bounds rounded outward.
+ */
 namespace NumberFormat {
+    std::string toDecimal(const ArithmeticType &v);
+
+    std::string toHex(const ArithmeticType &v);
+
+    std::string toOctal(const ArithmeticType &v);
+
+    std::string toBinary(const ArithmeticType &v);
+
+    std::string toDecimal(const ArithmeticType &lower, const ArithmeticType &upper);
+
+    ArithmeticType fromDecimal(const std::string &s);
+
+    ArithmeticType fromHex(const std::string &s);
+
+    ArithmeticType fromOctal(const std::string &s);
+
+    ArithmeticType fromBinary(const std::string &s);
+
     std::string toDecimal(const ArithmeticType &v, int decimalSpaces, mpfr_rnd_t rounding);
 
     std::string toHex(const ArithmeticType &v, int decimalSpaces, mpfr_rnd_t rounding);
@@ -39,6 +68,11 @@ namespace NumberFormat {
 
     std::string toBinary(const ArithmeticType &v, int decimalSpaces, mpfr_rnd_t rounding);
 
+    std::string toDecimal(const ArithmeticType &lower,
+                          const ArithmeticType &upper,
+                          int decimalSpaces,
+                          mpfr_rnd_t rounding);
+
     ArithmeticType fromDecimal(const std::string &s, int precision, mpfr_rnd_t rounding);
 
     ArithmeticType fromHex(const std::string &s, int precision, mpfr_rnd_t rounding);
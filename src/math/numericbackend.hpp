@@ -0,0 +1,1976 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_NUMERICBACKEND_HPP
+#define QCALC_NUMERICBACKEND_HPP
+
+#include "float128.hpp"
+#include "multidouble.hpp"
+#include "smallreal.hpp"
+#include "bigint.hpp"
+#include "rational.hpp"
+#include "interval.hpp"
+
+/**
+ * The arithmetic types which expressions can be evaluated with.
+ *
+ * Symbol values are stored as ArithmeticType and converted to the type of the backend when evaluating,
+ * results are converted back to ArithmeticType exactly.
+ * BACKEND_MPFR evaluates using SmallReal for precisions of at most SmallReal::INLINE_PRECISION bits.
+ * BACKEND_FLOAT128 is only available if QCALC_FLOAT128 is defined.
+ * BACKEND_DOUBLE_DOUBLE and BACKEND_QUAD_DOUBLE provide about 32 and 64 significant digits using hardware doubles.
+ * BACKEND_INTEGER evaluates using exact integers of arbitrary size (BigInt), non integral results are rounded.
+ * BACKEND_RATIONAL evaluates using exact rationals (Rational) and fails on functions with irrational results,
+ * the exact values of assigned variables are kept by the symbol table.
+ * BACKEND_INTERVAL evaluates using outward rounded intervals (Interval), results are converted to the midpoint
+ * and ExpressionParser::evaluateEnclosure returns the enclosure.
+ */
+enum NumericBackend {
+    BACKEND_MPFR,
+    BACKEND_DOUBLE,
+    BACKEND_LONG_DOUBLE,
+    BACKEND_FLOAT128,
+    BACKEND_DOUBLE_DOUBLE,
+    BACKEND_QUAD_DOUBLE,
+    BACKEND_INTEGER,
+    BACKEND_RATIONAL,
+    BACKEND_INTERVAL
+};
+
+/**
+ * The exprtk adaptors of the backend types, this header is the only place where exprtk is included.
+ *
+ * Exprtk resolves the operations on a type using overloads and specialisations which have to be declared
+ * before exprtk.hpp is included and can only be defined afterwards, so the adaptors are split into three parts:
+ * 1. The declarations of the adaptors of the backend types.
+ * 2. The mpfr adaptor which declares the adaptor of mpfr::mpreal and then includes exprtk.hpp.
+ * 3. The definitions of the adaptors of the backend types, which may use the mpfr adaptor.
+ *
+ * Sources which use exprtk have to include this header instead of exprtk.hpp or the mpfr adaptor,
+ * otherwise the adaptors are not visible to exprtk depending on the include order.
+ */
+
+#ifdef QCALC_FLOAT128
+
+// __float128
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct float128_type_tag;
+
+                template<typename T>
+                inline T const_pi_impl(float128_type_tag);
+
+                template<typename T>
+                inline T const_e_impl(float128_type_tag);
+            }
+        }
+
+        inline bool is_true(const __float128 &v);
+
+        inline bool is_false(const __float128 &v);
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   __float128 &t,
+                                   numeric::details::float128_type_tag);
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const __float128 &v,
+                                       exprtk::details::numeric::details::float128_type_tag);
+            }
+        }
+    }
+}
+
+#endif // QCALC_FLOAT128
+
+// MultiDouble
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct multidouble_type_tag;
+
+                template<typename T>
+                inline T const_pi_impl(multidouble_type_tag);
+
+                template<typename T>
+                inline T const_e_impl(multidouble_type_tag);
+            }
+        }
+
+        inline bool is_true(const DoubleDouble &v);
+
+        inline bool is_false(const DoubleDouble &v);
+
+        inline bool is_true(const QuadDouble &v);
+
+        inline bool is_false(const QuadDouble &v);
+
+        template<typename Iterator, int N>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   MultiDouble<N> &t,
+                                   numeric::details::multidouble_type_tag);
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                template<int N>
+                inline void print_type(const std::string &,
+                                       const MultiDouble<N> &v,
+                                       exprtk::details::numeric::details::multidouble_type_tag);
+            }
+        }
+    }
+}
+
+// SmallReal
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct smallreal_type_tag;
+
+                template<typename T>
+                inline T const_pi_impl(smallreal_type_tag);
+
+                template<typename T>
+                inline T const_e_impl(smallreal_type_tag);
+            }
+        }
+
+        inline bool is_true(const SmallReal &v);
+
+        inline bool is_false(const SmallReal &v);
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   SmallReal &t,
+                                   numeric::details::smallreal_type_tag);
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const SmallReal &v,
+                                       exprtk::details::numeric::details::smallreal_type_tag);
+            }
+        }
+    }
+}
+
+// BigInt
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct bigint_type_tag;
+
+                template<typename T>
+                inline T const_pi_impl(bigint_type_tag);
+
+                template<typename T>
+                inline T const_e_impl(bigint_type_tag);
+            }
+        }
+
+        inline bool is_true(const BigInt &v);
+
+        inline bool is_false(const BigInt &v);
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   BigInt &t,
+                                   numeric::details::bigint_type_tag);
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const BigInt &v,
+                                       exprtk::details::numeric::details::bigint_type_tag);
+            }
+        }
+    }
+}
+
+// Rational
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct rational_type_tag;
+
+                template<typename T>
+                inline T const_pi_impl(rational_type_tag);
+
+                template<typename T>
+                inline T const_e_impl(rational_type_tag);
+            }
+        }
+
+        inline bool is_true(const Rational &v);
+
+        inline bool is_false(const Rational &v);
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   Rational &t,
+                                   numeric::details::rational_type_tag);
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const Rational &v,
+                                       exprtk::details::numeric::details::rational_type_tag);
+            }
+        }
+    }
+}
+
+// Interval
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct interval_type_tag;
+
+                template<typename T>
+                inline T const_pi_impl(interval_type_tag);
+
+                template<typename T>
+                inline T const_e_impl(interval_type_tag);
+            }
+        }
+
+        inline bool is_true(const Interval &v);
+
+        inline bool is_false(const Interval &v);
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   Interval &t,
+                                   numeric::details::interval_type_tag);
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const Interval &v,
+                                       exprtk::details::numeric::details::interval_type_tag);
+            }
+        }
+    }
+}
+
+#include "../extern/exprtk_mpfr_adaptor.hpp"
+
+#ifdef QCALC_FLOAT128
+
+// __float128
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct float128_type_tag {
+                };
+
+                template<>
+                struct number_type<__float128> {
+                    typedef float128_type_tag type;
+                };
+
+                template<>
+                struct epsilon_type<float128_type_tag> {
+                    static inline __float128 value() {
+                        // The tolerance of equality comparisons, between the tolerances of long double and mpfr.
+                        static const __float128 epsilon = __float128(1) / __float128(1e16) / __float128(1e9);
+                        return epsilon;
+                    }
+                };
+
+                inline bool is_true_impl(const __float128 &v) {
+                    return v != 0;
+                }
+
+                inline bool is_false_impl(const __float128 &v) {
+                    return v == 0;
+                }
+
+                inline bool is_nan_impl(const __float128 &v, float128_type_tag) {
+                    return isnanq(v);
+                }
+
+                template<typename T>
+                inline int to_int32_impl(const T &v, float128_type_tag) {
+                    return static_cast<int>(v);
+                }
+
+                template<typename T>
+                inline long long to_int64_impl(const T &v, float128_type_tag) {
+                    return static_cast<long long>(v);
+                }
+
+                template<typename T> inline T abs_impl(const T &v, float128_type_tag) { return fabsq(v); }
+                template<typename T> inline T acos_impl(const T &v, float128_type_tag) { return acosq(v); }
+                template<typename T> inline T acosh_impl(const T &v, float128_type_tag) { return acoshq(v); }
+                template<typename T> inline T asin_impl(const T &v, float128_type_tag) { return asinq(v); }
+                template<typename T> inline T asinh_impl(const T &v, float128_type_tag) { return asinhq(v); }
+                template<typename T> inline T atan_impl(const T &v, float128_type_tag) { return atanq(v); }
+                template<typename T> inline T atanh_impl(const T &v, float128_type_tag) { return atanhq(v); }
+                template<typename T> inline T ceil_impl(const T &v, float128_type_tag) { return ceilq(v); }
+                template<typename T> inline T cos_impl(const T &v, float128_type_tag) { return cosq(v); }
+                template<typename T> inline T cosh_impl(const T &v, float128_type_tag) { return coshq(v); }
+                template<typename T> inline T exp_impl(const T &v, float128_type_tag) { return expq(v); }
+                template<typename T> inline T floor_impl(const T &v, float128_type_tag) { return floorq(v); }
+                template<typename T> inline T log_impl(const T &v, float128_type_tag) { return logq(v); }
+                template<typename T> inline T log10_impl(const T &v, float128_type_tag) { return log10q(v); }
+                template<typename T> inline T log2_impl(const T &v, float128_type_tag) { return log2q(v); }
+                template<typename T> inline T neg_impl(const T &v, float128_type_tag) { return -v; }
+                template<typename T> inline T pos_impl(const T &v, float128_type_tag) { return v; }
+                template<typename T> inline T sin_impl(const T &v, float128_type_tag) { return sinq(v); }
+                template<typename T> inline T sinh_impl(const T &v, float128_type_tag) { return sinhq(v); }
+                template<typename T> inline T sqrt_impl(const T &v, float128_type_tag) { return sqrtq(v); }
+                template<typename T> inline T tan_impl(const T &v, float128_type_tag) { return tanq(v); }
+                template<typename T> inline T tanh_impl(const T &v, float128_type_tag) { return tanhq(v); }
+                template<typename T> inline T cot_impl(const T &v, float128_type_tag) { return T(1) / tanq(v); }
+                template<typename T> inline T sec_impl(const T &v, float128_type_tag) { return T(1) / cosq(v); }
+                template<typename T> inline T csc_impl(const T &v, float128_type_tag) { return T(1) / sinq(v); }
+                template<typename T> inline T r2d_impl(const T &v, float128_type_tag) { return v * (T(180) / M_PIq); }
+                template<typename T> inline T d2r_impl(const T &v, float128_type_tag) { return v * (M_PIq / T(180)); }
+                template<typename T> inline T d2g_impl(const T &v, float128_type_tag) { return v * (T(20) / T(9)); }
+                template<typename T> inline T g2d_impl(const T &v, float128_type_tag) { return v * (T(9) / T(20)); }
+                template<typename T> inline T notl_impl(const T &v, float128_type_tag) { return v != T(0) ? T(0) : T(1); }
+                template<typename T> inline T frac_impl(const T &v, float128_type_tag) { return v - truncq(v); }
+                template<typename T> inline T trunc_impl(const T &v, float128_type_tag) { return truncq(v); }
+
+                template<typename T> inline T const_pi_impl(float128_type_tag) { return M_PIq; }
+                template<typename T> inline T const_e_impl(float128_type_tag) { return M_Eq; }
+
+                template<typename T>
+                inline T expm1_impl(const T &v, float128_type_tag) {
+                    return expm1q(v);
+                }
+
+                template<typename T>
+                inline T min_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return fminq(v0, v1);
+                }
+
+                template<typename T>
+                inline T max_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return fmaxq(v0, v1);
+                }
+
+                template<typename T>
+                inline T equal_impl(const T &v0, const T &v1, float128_type_tag) {
+                    const T epsilon = epsilon_type<float128_type_tag>::value();
+                    const T eps_norm = fmaxq(T(1), fmaxq(fabsq(v0), fabsq(v1))) * epsilon;
+                    return (fabsq(v0 - v1) <= eps_norm) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nequal_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return equal_impl(v0, v1, float128_type_tag()) == T(0) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T sgn_impl(const T &v, float128_type_tag) {
+                    if (v > T(0)) return T(+1);
+                    else if (v < T(0)) return T(-1);
+                    else return T(0);
+                }
+
+                template<typename T>
+                inline T log1p_impl(const T &v, float128_type_tag) {
+                    return log1pq(v);
+                }
+
+                template<typename T>
+                inline T erf_impl(const T &v, float128_type_tag) {
+                    return erfq(v);
+                }
+
+                template<typename T>
+                inline T erfc_impl(const T &v, float128_type_tag) {
+                    return erfcq(v);
+                }
+
+                template<typename T>
+                inline T ncdf_impl(const T &v, float128_type_tag) {
+                    T cnd = T(0.5) * (T(1) + erfq(fabsq(v) / M_SQRT2q));
+                    return (v < T(0)) ? (T(1) - cnd) : cnd;
+                }
+
+                template<typename T>
+                inline T modulus_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return fmodq(v0, v1);
+                }
+
+                template<typename T>
+                inline T pow_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return powq(v0, v1);
+                }
+
+                template<typename T>
+                inline T logn_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return logq(v0) / logq(v1);
+                }
+
+                template<typename T>
+                inline T sinc_impl(const T &v, float128_type_tag) {
+                    if (fabsq(v) >= epsilon_type<float128_type_tag>::value())
+                        return sinq(v) / v;
+                    else
+                        return T(1);
+                }
+
+                template<typename T>
+                inline T xor_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return (is_false_impl(v0) != is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T xnor_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return (is_true_impl(v0) == is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T round_impl(const T &v, float128_type_tag) {
+                    return roundq(v);
+                }
+
+                template<typename T>
+                inline T roundn_impl(const T &v0, const T &v1, float128_type_tag) {
+                    const T p10 = powq(T(10), floorq(v1));
+                    if (v0 < T(0))
+                        return ceilq((v0 * p10) - T(0.5)) / p10;
+                    else
+                        return floorq((v0 * p10) + T(0.5)) / p10;
+                }
+
+                template<typename T>
+                inline bool is_integer_impl(const T &v, float128_type_tag) {
+                    return truncq(v) == v;
+                }
+
+                template<typename T>
+                inline T root_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return powq(v0, T(1) / v1);
+                }
+
+                template<typename T>
+                inline T hypot_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return hypotq(v0, v1);
+                }
+
+                template<typename T>
+                inline T atan2_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return atan2q(v0, v1);
+                }
+
+                template<typename T>
+                inline T shr_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return v0 * (T(1) / powq(T(2), v1));
+                }
+
+                template<typename T>
+                inline T shl_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return v0 * powq(T(2), v1);
+                }
+
+                template<typename T>
+                inline T and_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return (is_true_impl(v0) && is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nand_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return (is_false_impl(v0) || is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T or_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return (is_true_impl(v0) || is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nor_impl(const T &v0, const T &v1, float128_type_tag) {
+                    return (is_false_impl(v0) && is_false_impl(v1)) ? T(1) : T(0);
+                }
+            }
+        }
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   __float128 &t,
+                                   numeric::details::float128_type_tag) {
+            std::string str(itr_external, end);
+            char *parsed = nullptr;
+            t = strtoflt128(str.c_str(), &parsed);
+            return parsed == str.c_str() + str.size();
+        }
+
+        inline bool is_true(const __float128 &v) { return numeric::details::is_true_impl(v); }
+
+        inline bool is_false(const __float128 &v) { return numeric::details::is_false_impl(v); }
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const __float128 &v,
+                                       exprtk::details::numeric::details::float128_type_tag) {
+                    char buffer[128];
+                    quadmath_snprintf(buffer, sizeof(buffer), "%.36Qg", v);
+                    printf("%s", buffer);
+                }
+            }
+        }
+    }
+}
+
+#endif // QCALC_FLOAT128
+
+// MultiDouble
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct multidouble_type_tag {
+                };
+
+                template<int N>
+                struct number_type<MultiDouble<N>> {
+                    typedef multidouble_type_tag type;
+                };
+
+                template<>
+                struct epsilon_type<multidouble_type_tag> {
+                    static inline double value() {
+                        // The tolerance of equality comparisons, between the tolerances of long double and mpfr.
+                        return 1e-25;
+                    }
+                };
+
+                template<int N>
+                inline bool is_true_impl(const MultiDouble<N> &v) {
+                    return v.x[0] != 0;
+                }
+
+                template<int N>
+                inline bool is_false_impl(const MultiDouble<N> &v) {
+                    return v.x[0] == 0;
+                }
+
+                template<int N>
+                inline bool is_nan_impl(const MultiDouble<N> &v, multidouble_type_tag) {
+                    return std::isnan(v.x[0]);
+                }
+
+                template<typename T>
+                inline int to_int32_impl(const T &v, multidouble_type_tag) {
+                    return static_cast<int>(v);
+                }
+
+                template<typename T>
+                inline long long to_int64_impl(const T &v, multidouble_type_tag) {
+                    return static_cast<long long>(v);
+                }
+
+                template<typename T> inline T abs_impl(const T &v, multidouble_type_tag) { return ::fabs(v); }
+                template<typename T> inline T acos_impl(const T &v, multidouble_type_tag) { return ::acos(v); }
+                template<typename T> inline T acosh_impl(const T &v, multidouble_type_tag) { return ::acosh(v); }
+                template<typename T> inline T asin_impl(const T &v, multidouble_type_tag) { return ::asin(v); }
+                template<typename T> inline T asinh_impl(const T &v, multidouble_type_tag) { return ::asinh(v); }
+                template<typename T> inline T atan_impl(const T &v, multidouble_type_tag) { return ::atan(v); }
+                template<typename T> inline T atanh_impl(const T &v, multidouble_type_tag) { return ::atanh(v); }
+                template<typename T> inline T ceil_impl(const T &v, multidouble_type_tag) { return ::ceil(v); }
+                template<typename T> inline T cos_impl(const T &v, multidouble_type_tag) { return ::cos(v); }
+                template<typename T> inline T cosh_impl(const T &v, multidouble_type_tag) { return ::cosh(v); }
+                template<typename T> inline T exp_impl(const T &v, multidouble_type_tag) { return ::exp(v); }
+                template<typename T> inline T floor_impl(const T &v, multidouble_type_tag) { return ::floor(v); }
+                template<typename T> inline T log_impl(const T &v, multidouble_type_tag) { return ::log(v); }
+                template<typename T> inline T log10_impl(const T &v, multidouble_type_tag) { return ::log10(v); }
+                template<typename T> inline T log2_impl(const T &v, multidouble_type_tag) { return ::log2(v); }
+                template<typename T> inline T neg_impl(const T &v, multidouble_type_tag) { return -v; }
+                template<typename T> inline T pos_impl(const T &v, multidouble_type_tag) { return v; }
+                template<typename T> inline T sin_impl(const T &v, multidouble_type_tag) { return ::sin(v); }
+                template<typename T> inline T sinh_impl(const T &v, multidouble_type_tag) { return ::sinh(v); }
+                template<typename T> inline T sqrt_impl(const T &v, multidouble_type_tag) { return ::sqrt(v); }
+                template<typename T> inline T tan_impl(const T &v, multidouble_type_tag) { return ::tan(v); }
+                template<typename T> inline T tanh_impl(const T &v, multidouble_type_tag) { return ::tanh(v); }
+                template<typename T> inline T cot_impl(const T &v, multidouble_type_tag) { return T(1) / ::tan(v); }
+                template<typename T> inline T sec_impl(const T &v, multidouble_type_tag) { return T(1) / ::cos(v); }
+                template<typename T> inline T csc_impl(const T &v, multidouble_type_tag) { return T(1) / ::sin(v); }
+                template<typename T> inline T r2d_impl(const T &v, multidouble_type_tag) { return v * T(180) / const_pi_impl<T>(multidouble_type_tag()); }
+                template<typename T> inline T d2r_impl(const T &v, multidouble_type_tag) { return v * const_pi_impl<T>(multidouble_type_tag()) / T(180); }
+                template<typename T> inline T d2g_impl(const T &v, multidouble_type_tag) { return v * T(20) / T(9); }
+                template<typename T> inline T g2d_impl(const T &v, multidouble_type_tag) { return v * T(9) / T(20); }
+                template<typename T> inline T notl_impl(const T &v, multidouble_type_tag) { return v != T(0) ? T(0) : T(1); }
+                template<typename T> inline T frac_impl(const T &v, multidouble_type_tag) { return v - ::trunc(v); }
+                template<typename T> inline T trunc_impl(const T &v, multidouble_type_tag) { return ::trunc(v); }
+
+                template<typename T>
+                inline T const_pi_impl(multidouble_type_tag) {
+                    return ::MultiDoubleDetail::Constants<sizeof(T) / sizeof(double)>::pi();
+                }
+
+                template<typename T>
+                inline T const_e_impl(multidouble_type_tag) {
+                    return ::MultiDoubleDetail::Constants<sizeof(T) / sizeof(double)>::e();
+                }
+
+                template<typename T>
+                inline T expm1_impl(const T &v, multidouble_type_tag) {
+                    return ::expm1(v);
+                }
+
+                template<typename T>
+                inline T min_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return v1 < v0 ? v1 : v0;
+                }
+
+                template<typename T>
+                inline T max_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return v0 < v1 ? v1 : v0;
+                }
+
+                template<typename T>
+                inline T equal_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    const T epsilon = epsilon_type<multidouble_type_tag>::value();
+                    const T eps_norm = max_impl(T(1), max_impl(::fabs(v0), ::fabs(v1), multidouble_type_tag()),
+                                                multidouble_type_tag()) * epsilon;
+                    return (::fabs(v0 - v1) <= eps_norm) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nequal_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return equal_impl(v0, v1, multidouble_type_tag()) == T(0) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T sgn_impl(const T &v, multidouble_type_tag) {
+                    if (v > T(0)) return T(+1);
+                    else if (v < T(0)) return T(-1);
+                    else return T(0);
+                }
+
+                template<typename T>
+                inline T log1p_impl(const T &v, multidouble_type_tag) {
+                    return ::log1p(v);
+                }
+
+                template<typename T>
+                inline T erf_impl(const T &v, multidouble_type_tag) {
+                    return ::erf(v);
+                }
+
+                template<typename T>
+                inline T erfc_impl(const T &v, multidouble_type_tag) {
+                    return ::erfc(v);
+                }
+
+                template<typename T>
+                inline T ncdf_impl(const T &v, multidouble_type_tag) {
+                    constexpr int n = sizeof(T) / sizeof(double);
+                    T cnd = T(0.5) * (T(1) + ::erf(::fabs(v) / ::MultiDoubleDetail::Constants<n>::sqrt2()));
+                    return (v < T(0)) ? (T(1) - cnd) : cnd;
+                }
+
+                template<typename T>
+                inline T modulus_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return ::fmod(v0, v1);
+                }
+
+                template<typename T>
+                inline T pow_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return ::pow(v0, v1);
+                }
+
+                template<typename T>
+                inline T logn_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return ::log(v0) / ::log(v1);
+                }
+
+                template<typename T>
+                inline T sinc_impl(const T &v, multidouble_type_tag) {
+                    if (::fabs(v) >= T(epsilon_type<multidouble_type_tag>::value()))
+                        return ::sin(v) / v;
+                    else
+                        return T(1);
+                }
+
+                template<typename T>
+                inline T xor_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return (is_false_impl(v0) != is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T xnor_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return (is_true_impl(v0) == is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T round_impl(const T &v, multidouble_type_tag) {
+                    return ::round(v);
+                }
+
+                template<typename T>
+                inline T roundn_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    const T p10 = ::pow(T(10), ::floor(v1));
+                    if (v0 < T(0))
+                        return ::ceil((v0 * p10) - T(0.5)) / p10;
+                    else
+                        return ::floor((v0 * p10) + T(0.5)) / p10;
+                }
+
+                template<typename T>
+                inline bool is_integer_impl(const T &v, multidouble_type_tag) {
+                    return ::trunc(v) == v;
+                }
+
+                template<typename T>
+                inline T root_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return ::pow(v0, T(1) / v1);
+                }
+
+                template<typename T>
+                inline T hypot_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return ::hypot(v0, v1);
+                }
+
+                template<typename T>
+                inline T atan2_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return ::atan2(v0, v1);
+                }
+
+                template<typename T>
+                inline T shr_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return v0 * (T(1) / ::pow(T(2), v1));
+                }
+
+                template<typename T>
+                inline T shl_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return v0 * ::pow(T(2), v1);
+                }
+
+                template<typename T>
+                inline T and_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return (is_true_impl(v0) && is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nand_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return (is_false_impl(v0) || is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T or_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return (is_true_impl(v0) || is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nor_impl(const T &v0, const T &v1, multidouble_type_tag) {
+                    return (is_false_impl(v0) && is_false_impl(v1)) ? T(1) : T(0);
+                }
+            }
+        }
+
+        template<typename Iterator, int N>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   MultiDouble<N> &t,
+                                   numeric::details::multidouble_type_tag) {
+            // Literals are parsed by mpfr with more than the precision of the type and rounded once.
+            ArithmeticType value;
+            value.set_prec(N * DBL_MANT_DIG + 64);
+            if (mpfr_set_str(value.mpfr_ptr(), std::string(itr_external, end).c_str(), 10, MPFR_RNDN) != 0)
+                return false;
+            t = ::MultiDoubleDetail::fromArithmeticType<N>(value, MPFR_RNDN);
+            return true;
+        }
+
+        inline bool is_true(const DoubleDouble &v) { return numeric::details::is_true_impl(v); }
+
+        inline bool is_false(const DoubleDouble &v) { return numeric::details::is_false_impl(v); }
+
+        inline bool is_true(const QuadDouble &v) { return numeric::details::is_true_impl(v); }
+
+        inline bool is_false(const QuadDouble &v) { return numeric::details::is_false_impl(v); }
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                template<int N>
+                inline void print_type(const std::string &,
+                                       const MultiDouble<N> &v,
+                                       exprtk::details::numeric::details::multidouble_type_tag) {
+                    printf("%s", ::MultiDoubleDetail::toArithmeticType(v)
+                            .toString(std::numeric_limits<MultiDouble<N>>::digits10).c_str());
+                }
+            }
+        }
+    }
+}
+
+// SmallReal
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct smallreal_type_tag {
+                };
+
+                template<>
+                struct number_type<SmallReal> {
+                    typedef smallreal_type_tag type;
+                };
+
+                template<>
+                struct epsilon_type<smallreal_type_tag> {
+                    static inline SmallReal value() {
+                        // The tolerance of the mpfr adaptor.
+                        return SmallReal(epsilon_type<mpfrreal_type_tag>::value());
+                    }
+                };
+
+                inline bool is_true_impl(const SmallReal &v) {
+                    return !mpfr_zero_p(v.mpfr_srcptr());
+                }
+
+                inline bool is_false_impl(const SmallReal &v) {
+                    return !is_true_impl(v);
+                }
+
+                inline bool is_nan_impl(const SmallReal &v, smallreal_type_tag) {
+                    return mpfr_nan_p(v.mpfr_srcptr());
+                }
+
+                template<typename T>
+                inline int to_int32_impl(const T &v, smallreal_type_tag) {
+                    return static_cast<int>(v.toLong());
+                }
+
+                template<typename T>
+                inline long long to_int64_impl(const T &v, smallreal_type_tag) {
+                    return v.toLLong();
+                }
+
+                template<typename T> inline T abs_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_abs, v); }
+                template<typename T> inline T acos_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_acos, v); }
+                template<typename T> inline T acosh_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_acosh, v); }
+                template<typename T> inline T asin_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_asin, v); }
+                template<typename T> inline T asinh_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_asinh, v); }
+                template<typename T> inline T atan_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_atan, v); }
+                template<typename T> inline T atanh_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_atanh, v); }
+                template<typename T> inline T ceil_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_ceil, v); }
+                template<typename T> inline T cos_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_cos, v); }
+                template<typename T> inline T cosh_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_cosh, v); }
+                template<typename T> inline T exp_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_exp, v); }
+                template<typename T> inline T floor_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_floor, v); }
+                template<typename T> inline T log_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_log, v); }
+                template<typename T> inline T log10_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_log10, v); }
+                template<typename T> inline T log2_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_log2, v); }
+                template<typename T> inline T neg_impl(const T &v, smallreal_type_tag) { return -v; }
+                template<typename T> inline T pos_impl(const T &v, smallreal_type_tag) { return v; }
+                template<typename T> inline T sin_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_sin, v); }
+                template<typename T> inline T sinh_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_sinh, v); }
+                template<typename T> inline T sqrt_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_sqrt, v); }
+                template<typename T> inline T tan_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_tan, v); }
+                template<typename T> inline T tanh_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_tanh, v); }
+                template<typename T> inline T cot_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_cot, v); }
+                template<typename T> inline T sec_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_sec, v); }
+                template<typename T> inline T csc_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_csc, v); }
+                template<typename T> inline T r2d_impl(const T &v, smallreal_type_tag) { return v * T(exprtk::details::constant::_180_pi(v.getPrecision())); }
+                template<typename T> inline T d2r_impl(const T &v, smallreal_type_tag) { return v * T(exprtk::details::constant::pi_180(v.getPrecision())); }
+                template<typename T> inline T d2g_impl(const T &v, smallreal_type_tag) { return v * T(20.0 / 9.0); }
+                template<typename T> inline T g2d_impl(const T &v, smallreal_type_tag) { return v * T(9.0 / 20.0); }
+                template<typename T> inline T notl_impl(const T &v, smallreal_type_tag) { return is_true_impl(v) ? T(0) : T(1); }
+                template<typename T> inline T frac_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_frac, v); }
+                template<typename T> inline T trunc_impl(const T &v, smallreal_type_tag) { return T::apply(mpfr_trunc, v); }
+
+                template<typename T>
+                inline T const_pi_impl(smallreal_type_tag) {
+                    return T(exprtk::details::constant::pi());
+                }
+
+                template<typename T>
+                inline T const_e_impl(smallreal_type_tag) {
+                    return T(exprtk::details::constant::e());
+                }
+
+                template<typename T>
+                inline T expm1_impl(const T &v, smallreal_type_tag) {
+                    return T::apply(mpfr_expm1, v);
+                }
+
+                template<typename T>
+                inline T min_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return T::apply(mpfr_min, v0, v1);
+                }
+
+                template<typename T>
+                inline T max_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return T::apply(mpfr_max, v0, v1);
+                }
+
+                template<typename T>
+                inline T equal_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    const T epsilon = epsilon_type<smallreal_type_tag>::value();
+                    const T eps_norm = max_impl(T(1), max_impl(abs_impl(v0, smallreal_type_tag()),
+                                                               abs_impl(v1, smallreal_type_tag()),
+                                                               smallreal_type_tag()),
+                                                smallreal_type_tag()) * epsilon;
+                    return (abs_impl(T(v0 - v1), smallreal_type_tag()) <= eps_norm) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nequal_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return equal_impl(v0, v1, smallreal_type_tag()) == T(0) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T sgn_impl(const T &v, smallreal_type_tag) {
+                    if (v > T(0)) return T(+1);
+                    else if (v < T(0)) return T(-1);
+                    else return T(0);
+                }
+
+                template<typename T>
+                inline T log1p_impl(const T &v, smallreal_type_tag) {
+                    return T::apply(mpfr_log1p, v);
+                }
+
+                template<typename T>
+                inline T erf_impl(const T &v, smallreal_type_tag) {
+                    return T::apply(mpfr_erf, v);
+                }
+
+                template<typename T>
+                inline T erfc_impl(const T &v, smallreal_type_tag) {
+                    return T::apply(mpfr_erfc, v);
+                }
+
+                template<typename T>
+                inline T ncdf_impl(const T &v, smallreal_type_tag) {
+                    const T sqrt2 = T(exprtk::details::constant::sqrt2(v.getPrecision()));
+                    T cnd = T(0.5) * (T(1) + erf_impl(T(abs_impl(v, smallreal_type_tag()) / sqrt2), smallreal_type_tag()));
+                    return (v < T(0)) ? (T(1) - cnd) : cnd;
+                }
+
+                template<typename T>
+                inline T modulus_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return T::apply(mpfr_fmod, v0, v1);
+                }
+
+                template<typename T>
+                inline T pow_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return T::apply(mpfr_pow, v0, v1);
+                }
+
+                template<typename T>
+                inline T logn_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return log_impl(v0, smallreal_type_tag()) / log_impl(v1, smallreal_type_tag());
+                }
+
+                template<typename T>
+                inline T sinc_impl(const T &v, smallreal_type_tag) {
+                    if (abs_impl(v, smallreal_type_tag()) >= epsilon_type<smallreal_type_tag>::value())
+                        return sin_impl(v, smallreal_type_tag()) / v;
+                    else
+                        return T(1);
+                }
+
+                template<typename T>
+                inline T xor_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return (is_false_impl(v0) != is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T xnor_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return (is_true_impl(v0) == is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T round_impl(const T &v, smallreal_type_tag) {
+                    return T::apply(mpfr_round, v);
+                }
+
+                template<typename T>
+                inline T roundn_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    const T p10 = pow_impl(T(10), floor_impl(v1, smallreal_type_tag()), smallreal_type_tag());
+                    if (v0 < T(0))
+                        return ceil_impl(T((v0 * p10) - T(0.5)), smallreal_type_tag()) / p10;
+                    else
+                        return floor_impl(T((v0 * p10) + T(0.5)), smallreal_type_tag()) / p10;
+                }
+
+                template<typename T>
+                inline bool is_integer_impl(const T &v, smallreal_type_tag) {
+                    return mpfr_integer_p(v.mpfr_srcptr());
+                }
+
+                template<typename T>
+                inline T root_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return pow_impl(v0, T(T(1) / v1), smallreal_type_tag());
+                }
+
+                template<typename T>
+                inline T hypot_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return T::apply(mpfr_hypot, v0, v1);
+                }
+
+                template<typename T>
+                inline T atan2_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return T::apply(mpfr_atan2, v0, v1);
+                }
+
+                template<typename T>
+                inline T shr_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return v0 * (T(1) / pow_impl(T(2), v1, smallreal_type_tag()));
+                }
+
+                template<typename T>
+                inline T shl_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return v0 * pow_impl(T(2), v1, smallreal_type_tag());
+                }
+
+                template<typename T>
+                inline T and_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return (is_true_impl(v0) && is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nand_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return (is_false_impl(v0) || is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T or_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return (is_true_impl(v0) || is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nor_impl(const T &v0, const T &v1, smallreal_type_tag) {
+                    return (is_false_impl(v0) && is_false_impl(v1)) ? T(1) : T(0);
+                }
+            }
+        }
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   SmallReal &t,
+                                   numeric::details::smallreal_type_tag) {
+            // Same as the mpfr adaptor, the literal is rounded to the default precision.
+            t = SmallReal::withPrecision(mpfr::mpreal::get_default_prec());
+            mpfr_set_str(t.mpfr_ptr(), std::string(itr_external, end).c_str(), 10, mpfr::mpreal::get_default_rnd());
+            return true;
+        }
+
+        inline bool is_true(const SmallReal &v) { return numeric::details::is_true_impl(v); }
+
+        inline bool is_false(const SmallReal &v) { return numeric::details::is_false_impl(v); }
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const SmallReal &v,
+                                       exprtk::details::numeric::details::smallreal_type_tag) {
+                    printf("%s", v.toArithmeticType().toString().c_str());
+                }
+            }
+        }
+    }
+}
+
+// BigInt
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct bigint_type_tag {
+                };
+
+                template<>
+                struct number_type<BigInt> {
+                    typedef bigint_type_tag type;
+                };
+
+                template<>
+                struct epsilon_type<bigint_type_tag> {
+                    static inline BigInt value() {
+                        // Integers compare exactly.
+                        return BigInt(0);
+                    }
+                };
+
+                inline bool is_true_impl(const BigInt &v) {
+                    return v.isNaN() || mpz_sgn(v.mpz_srcptr()) != 0;
+                }
+
+                inline bool is_false_impl(const BigInt &v) {
+                    return !is_true_impl(v);
+                }
+
+                inline bool is_nan_impl(const BigInt &v, bigint_type_tag) {
+                    return v.isNaN();
+                }
+
+                template<typename T>
+                inline int to_int32_impl(const T &v, bigint_type_tag) {
+                    return static_cast<int>(v.toLong());
+                }
+
+                template<typename T>
+                inline long long to_int64_impl(const T &v, bigint_type_tag) {
+                    return v.toLLong();
+                }
+
+                template<typename T> inline T abs_impl(const T &v, bigint_type_tag) { return T::apply(mpz_abs, v); }
+                template<typename T> inline T acos_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_acos, v); }
+                template<typename T> inline T acosh_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_acosh, v); }
+                template<typename T> inline T asin_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_asin, v); }
+                template<typename T> inline T asinh_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_asinh, v); }
+                template<typename T> inline T atan_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_atan, v); }
+                template<typename T> inline T atanh_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_atanh, v); }
+                template<typename T> inline T ceil_impl(const T &v, bigint_type_tag) { return v; }
+                template<typename T> inline T cos_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_cos, v); }
+                template<typename T> inline T cosh_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_cosh, v); }
+                template<typename T> inline T exp_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_exp, v); }
+                template<typename T> inline T floor_impl(const T &v, bigint_type_tag) { return v; }
+                template<typename T> inline T log_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_log, v); }
+                template<typename T> inline T log10_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_log10, v); }
+                template<typename T> inline T log2_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_log2, v); }
+                template<typename T> inline T neg_impl(const T &v, bigint_type_tag) { return -v; }
+                template<typename T> inline T pos_impl(const T &v, bigint_type_tag) { return v; }
+                template<typename T> inline T sin_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_sin, v); }
+                template<typename T> inline T sinh_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_sinh, v); }
+                template<typename T> inline T sqrt_impl(const T &v, bigint_type_tag) { return T::sqrt(v); }
+                template<typename T> inline T tan_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_tan, v); }
+                template<typename T> inline T tanh_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_tanh, v); }
+                template<typename T> inline T cot_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_cot, v); }
+                template<typename T> inline T sec_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_sec, v); }
+                template<typename T> inline T csc_impl(const T &v, bigint_type_tag) { return T::apply(mpfr_csc, v); }
+                template<typename T> inline T r2d_impl(const T &v, bigint_type_tag) { return T(v.toArithmeticType() * exprtk::details::constant::_180_pi(v.getBits() + T::GUARD_BITS)); }
+                template<typename T> inline T d2r_impl(const T &v, bigint_type_tag) { return T(v.toArithmeticType() * exprtk::details::constant::pi_180(v.getBits() + T::GUARD_BITS)); }
+                template<typename T> inline T d2g_impl(const T &v, bigint_type_tag) { return (v * T(20)) / T(9); }
+                template<typename T> inline T g2d_impl(const T &v, bigint_type_tag) { return (v * T(9)) / T(20); }
+                template<typename T> inline T notl_impl(const T &v, bigint_type_tag) { return is_true_impl(v) ? T(0) : T(1); }
+                template<typename T> inline T frac_impl(const T &v, bigint_type_tag) { return v.isNaN() ? v : T(0); }
+                template<typename T> inline T trunc_impl(const T &v, bigint_type_tag) { return v; }
+
+                template<typename T>
+                inline T const_pi_impl(bigint_type_tag) {
+                    return T(exprtk::details::constant::pi());
+                }
+
+                template<typename T>
+                inline T const_e_impl(bigint_type_tag) {
+                    return T(exprtk::details::constant::e());
+                }
+
+                template<typename T>
+                inline T expm1_impl(const T &v, bigint_type_tag) {
+                    return T::apply(mpfr_expm1, v);
+                }
+
+                template<typename T>
+                inline T min_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    return v1 < v0 ? v1 : v0;
+                }
+
+                template<typename T>
+                inline T max_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    return v1 > v0 ? v1 : v0;
+                }
+
+                template<typename T>
+                inline T equal_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return v0 == v1 ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nequal_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return v0 != v1 ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T sgn_impl(const T &v, bigint_type_tag) {
+                    if (v.isNaN())
+                        return v;
+                    return T(mpz_sgn(v.mpz_srcptr()));
+                }
+
+                template<typename T>
+                inline T log1p_impl(const T &v, bigint_type_tag) {
+                    return T::apply(mpfr_log1p, v);
+                }
+
+                template<typename T>
+                inline T erf_impl(const T &v, bigint_type_tag) {
+                    return T::apply(mpfr_erf, v);
+                }
+
+                template<typename T>
+                inline T erfc_impl(const T &v, bigint_type_tag) {
+                    return T::apply(mpfr_erfc, v);
+                }
+
+                template<typename T>
+                inline T ncdf_impl(const T &v, bigint_type_tag) {
+                    if (v.isNaN())
+                        return v;
+                    const ArithmeticType x = v.toArithmeticType();
+                    const mpfr_prec_t precision = std::max<mpfr_prec_t>(mpfr::mpreal::get_default_prec(), v.getBits())
+                                                  + T::GUARD_BITS;
+                    const ArithmeticType sqrt2 = exprtk::details::constant::sqrt2(precision);
+                    ArithmeticType cnd(0, precision);
+                    mpfr_div(cnd.mpfr_ptr(), mpfr::abs(x).mpfr_srcptr(), sqrt2.mpfr_srcptr(), MPFR_RNDN);
+                    mpfr_erf(cnd.mpfr_ptr(), cnd.mpfr_srcptr(), MPFR_RNDN);
+                    cnd = (cnd + 1) / 2;
+                    return T(x < 0 ? ArithmeticType(1 - cnd) : cnd);
+                }
+
+                template<typename T>
+                inline T modulus_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return v0 % v1;
+                }
+
+                template<typename T>
+                inline T pow_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return T::pow(v0, v1);
+                }
+
+                template<typename T>
+                inline T logn_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    const mpfr_prec_t precision = std::max<mpfr_prec_t>(mpfr::mpreal::get_default_prec(),
+                                                                        std::max(v0.getBits(), v1.getBits()))
+                                                  + T::GUARD_BITS;
+                    ArithmeticType x = v0.toArithmeticType();
+                    ArithmeticType b = v1.toArithmeticType();
+                    x.set_prec(precision);
+                    b.set_prec(precision);
+                    mpfr_log(x.mpfr_ptr(), x.mpfr_srcptr(), MPFR_RNDN);
+                    mpfr_log(b.mpfr_ptr(), b.mpfr_srcptr(), MPFR_RNDN);
+                    return T(x / b);
+                }
+
+                template<typename T>
+                inline T sinc_impl(const T &v, bigint_type_tag) {
+                    if (v.isNaN())
+                        return v;
+                    if (mpz_sgn(v.mpz_srcptr()) == 0)
+                        return T(1);
+                    const ArithmeticType x = v.toArithmeticType();
+                    return T(mpfr::sin(x) / x);
+                }
+
+                template<typename T>
+                inline T xor_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return (is_false_impl(v0) != is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T xnor_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return (is_true_impl(v0) == is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T round_impl(const T &v, bigint_type_tag) {
+                    return v;
+                }
+
+                template<typename T>
+                inline T roundn_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    if (mpz_sgn(v1.mpz_srcptr()) >= 0)
+                        return v0;
+                    // Half of 10^n exceeds the value if n exceeds its number of bits.
+                    if (!mpz_fits_ulong_p((-v1).mpz_srcptr()) || mpz_get_ui((-v1).mpz_srcptr()) > v0.getBits())
+                        return T(0);
+                    // Round half away from zero to a multiple of 10^-v1.
+                    T p10;
+                    mpz_ui_pow_ui(p10.mpz_ptr(), 10, mpz_get_ui((-v1).mpz_srcptr()));
+                    T ret;
+                    mpz_tdiv_q_2exp(ret.mpz_ptr(), p10.mpz_srcptr(), 1);
+                    if (v0 < T(0))
+                        mpz_sub(ret.mpz_ptr(), v0.mpz_srcptr(), ret.mpz_srcptr());
+                    else
+                        mpz_add(ret.mpz_ptr(), v0.mpz_srcptr(), ret.mpz_srcptr());
+                    mpz_tdiv_q(ret.mpz_ptr(), ret.mpz_srcptr(), p10.mpz_srcptr());
+                    return ret * p10;
+                }
+
+                template<typename T>
+                inline bool is_integer_impl(const T &v, bigint_type_tag) {
+                    return !v.isNaN();
+                }
+
+                template<typename T>
+                inline T root_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    const ArithmeticType x = v0.toArithmeticType();
+                    const ArithmeticType n = v1.toArithmeticType();
+                    const mpfr_prec_t precision = std::max<mpfr_prec_t>(mpfr::mpreal::get_default_prec(), v0.getBits())
+                                                  + T::GUARD_BITS;
+                    ArithmeticType ret(0, precision);
+                    ArithmeticType inverse(0, precision);
+                    mpfr_ui_div(inverse.mpfr_ptr(), 1, n.mpfr_srcptr(), MPFR_RNDN);
+                    mpfr_pow(ret.mpfr_ptr(), x.mpfr_srcptr(), inverse.mpfr_srcptr(), MPFR_RNDN);
+                    return T(ret);
+                }
+
+                template<typename T>
+                inline T hypot_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return T::sqrt(v0 * v0 + v1 * v1);
+                }
+
+                template<typename T>
+                inline T atan2_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return T::apply(mpfr_atan2, v0, v1);
+                }
+
+                template<typename T>
+                inline T shr_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return T::shift(v0, -v1);
+                }
+
+                template<typename T>
+                inline T shl_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return T::shift(v0, v1);
+                }
+
+                template<typename T>
+                inline T and_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return (is_true_impl(v0) && is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nand_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return (is_false_impl(v0) || is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T or_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return (is_true_impl(v0) || is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nor_impl(const T &v0, const T &v1, bigint_type_tag) {
+                    return (is_false_impl(v0) && is_false_impl(v1)) ? T(1) : T(0);
+                }
+            }
+        }
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   BigInt &t,
+                                   numeric::details::bigint_type_tag) {
+            const std::string str(itr_external, end);
+            if (BigInt::fromString(str, t))
+                return true;
+            // Literals with a fraction or exponent are rounded like the other backends before converting to an integer.
+            ArithmeticType value(0, mpfr::mpreal::get_default_prec());
+            if (mpfr_set_str(value.mpfr_ptr(), str.c_str(), 10, mpfr::mpreal::get_default_rnd()) != 0)
+                return false;
+            t = BigInt(value);
+            return true;
+        }
+
+        inline bool is_true(const BigInt &v) { return numeric::details::is_true_impl(v); }
+
+        inline bool is_false(const BigInt &v) { return numeric::details::is_false_impl(v); }
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const BigInt &v,
+                                       exprtk::details::numeric::details::bigint_type_tag) {
+                    printf("%s", v.toString().c_str());
+                }
+            }
+        }
+    }
+}
+
+// Rational
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct rational_type_tag {
+                };
+
+                template<>
+                struct number_type<Rational> {
+                    typedef rational_type_tag type;
+                };
+
+                template<>
+                struct epsilon_type<rational_type_tag> {
+                    static inline Rational value() {
+                        // Rationals compare exactly.
+                        return Rational(0);
+                    }
+                };
+
+                inline bool is_true_impl(const Rational &v) {
+                    return v.isNaN() || mpq_sgn(v.mpq_srcptr()) != 0;
+                }
+
+                inline bool is_false_impl(const Rational &v) {
+                    return !is_true_impl(v);
+                }
+
+                inline bool is_nan_impl(const Rational &v, rational_type_tag) {
+                    return v.isNaN();
+                }
+
+                template<typename T>
+                inline int to_int32_impl(const T &v, rational_type_tag) {
+                    return static_cast<int>(v.toLong());
+                }
+
+                template<typename T>
+                inline long long to_int64_impl(const T &v, rational_type_tag) {
+                    return v.toLLong();
+                }
+
+                template<typename T> inline T abs_impl(const T &v, rational_type_tag) { return v < T(0) ? -v : v; }
+                template<typename T> inline T acos_impl(const T &, rational_type_tag) { T::unsupported("acos"); }
+                template<typename T> inline T acosh_impl(const T &, rational_type_tag) { T::unsupported("acosh"); }
+                template<typename T> inline T asin_impl(const T &, rational_type_tag) { T::unsupported("asin"); }
+                template<typename T> inline T asinh_impl(const T &, rational_type_tag) { T::unsupported("asinh"); }
+                template<typename T> inline T atan_impl(const T &, rational_type_tag) { T::unsupported("atan"); }
+                template<typename T> inline T atanh_impl(const T &, rational_type_tag) { T::unsupported("atanh"); }
+                template<typename T> inline T ceil_impl(const T &v, rational_type_tag) { return T::divide(mpz_cdiv_q, v); }
+                template<typename T> inline T cos_impl(const T &, rational_type_tag) { T::unsupported("cos"); }
+                template<typename T> inline T cosh_impl(const T &, rational_type_tag) { T::unsupported("cosh"); }
+                template<typename T> inline T exp_impl(const T &, rational_type_tag) { T::unsupported("exp"); }
+                template<typename T> inline T floor_impl(const T &v, rational_type_tag) { return T::divide(mpz_fdiv_q, v); }
+                template<typename T> inline T log_impl(const T &, rational_type_tag) { T::unsupported("log"); }
+                template<typename T> inline T log10_impl(const T &, rational_type_tag) { T::unsupported("log10"); }
+                template<typename T> inline T log2_impl(const T &, rational_type_tag) { T::unsupported("log2"); }
+                template<typename T> inline T neg_impl(const T &v, rational_type_tag) { return -v; }
+                template<typename T> inline T pos_impl(const T &v, rational_type_tag) { return v; }
+                template<typename T> inline T sin_impl(const T &, rational_type_tag) { T::unsupported("sin"); }
+                template<typename T> inline T sinh_impl(const T &, rational_type_tag) { T::unsupported("sinh"); }
+                template<typename T> inline T sqrt_impl(const T &v, rational_type_tag) { return T::root(v, T(2)); }
+                template<typename T> inline T tan_impl(const T &, rational_type_tag) { T::unsupported("tan"); }
+                template<typename T> inline T tanh_impl(const T &, rational_type_tag) { T::unsupported("tanh"); }
+                template<typename T> inline T cot_impl(const T &, rational_type_tag) { T::unsupported("cot"); }
+                template<typename T> inline T sec_impl(const T &, rational_type_tag) { T::unsupported("sec"); }
+                template<typename T> inline T csc_impl(const T &, rational_type_tag) { T::unsupported("csc"); }
+                template<typename T> inline T r2d_impl(const T &, rational_type_tag) { T::unsupported("rad2deg"); }
+                template<typename T> inline T d2r_impl(const T &, rational_type_tag) { T::unsupported("deg2rad"); }
+                template<typename T> inline T d2g_impl(const T &v, rational_type_tag) { return v * T(10) / T(9); }
+                template<typename T> inline T g2d_impl(const T &v, rational_type_tag) { return v * T(9) / T(10); }
+                template<typename T> inline T notl_impl(const T &v, rational_type_tag) { return is_true_impl(v) ? T(0) : T(1); }
+                template<typename T> inline T frac_impl(const T &v, rational_type_tag) { return v - T::divide(mpz_tdiv_q, v); }
+                template<typename T> inline T trunc_impl(const T &v, rational_type_tag) { return T::divide(mpz_tdiv_q, v); }
+
+                // Not reachable from expressions, the engine does not register the exprtk constants.
+
+                template<typename T>
+                inline T const_pi_impl(rational_type_tag) {
+                    return T::NaN();
+                }
+
+                template<typename T>
+                inline T const_e_impl(rational_type_tag) {
+                    return T::NaN();
+                }
+
+                template<typename T>
+                inline T expm1_impl(const T &, rational_type_tag) {
+                    T::unsupported("expm1");
+                }
+
+                template<typename T>
+                inline T min_impl(const T &v0, const T &v1, rational_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    return v1 < v0 ? v1 : v0;
+                }
+
+                template<typename T>
+                inline T max_impl(const T &v0, const T &v1, rational_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    return v1 > v0 ? v1 : v0;
+                }
+
+                template<typename T>
+                inline T equal_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return v0 == v1 ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nequal_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return v0 != v1 ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T sgn_impl(const T &v, rational_type_tag) {
+                    if (v.isNaN())
+                        return v;
+                    return T(mpq_sgn(v.mpq_srcptr()));
+                }
+
+                template<typename T>
+                inline T log1p_impl(const T &, rational_type_tag) {
+                    T::unsupported("log1p");
+                }
+
+                template<typename T>
+                inline T erf_impl(const T &, rational_type_tag) {
+                    T::unsupported("erf");
+                }
+
+                template<typename T>
+                inline T erfc_impl(const T &, rational_type_tag) {
+                    T::unsupported("erfc");
+                }
+
+                template<typename T>
+                inline T ncdf_impl(const T &, rational_type_tag) {
+                    T::unsupported("ncdf");
+                }
+
+                template<typename T>
+                inline T modulus_impl(const T &v0, const T &v1, rational_type_tag) {
+                    // Same as fmod, the quotient is truncated toward zero.
+                    return v0 - trunc_impl(T(v0 / v1), rational_type_tag()) * v1;
+                }
+
+                template<typename T>
+                inline T pow_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return T::pow(v0, v1);
+                }
+
+                template<typename T>
+                inline T logn_impl(const T &, const T &, rational_type_tag) {
+                    T::unsupported("logn");
+                }
+
+                template<typename T>
+                inline T sinc_impl(const T &, rational_type_tag) {
+                    T::unsupported("sinc");
+                }
+
+                template<typename T>
+                inline T xor_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return (is_false_impl(v0) != is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T xnor_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return (is_true_impl(v0) == is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T round_impl(const T &v, rational_type_tag) {
+                    return T::round(v);
+                }
+
+                template<typename T>
+                inline T roundn_impl(const T &v0, const T &v1, rational_type_tag) {
+                    const T p10 = T::pow(T(10), floor_impl(v1, rational_type_tag()));
+                    return T::round(v0 * p10) / p10;
+                }
+
+                template<typename T>
+                inline bool is_integer_impl(const T &v, rational_type_tag) {
+                    return v.isInteger();
+                }
+
+                template<typename T>
+                inline T root_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return T::root(v0, v1);
+                }
+
+                template<typename T>
+                inline T hypot_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return T::root(v0 * v0 + v1 * v1, T(2));
+                }
+
+                template<typename T>
+                inline T atan2_impl(const T &, const T &, rational_type_tag) {
+                    T::unsupported("atan2");
+                }
+
+                template<typename T>
+                inline T shr_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return v0 * T::pow(T(2), -v1);
+                }
+
+                template<typename T>
+                inline T shl_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return v0 * T::pow(T(2), v1);
+                }
+
+                template<typename T>
+                inline T and_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return (is_true_impl(v0) && is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nand_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return (is_false_impl(v0) || is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T or_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return (is_true_impl(v0) || is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nor_impl(const T &v0, const T &v1, rational_type_tag) {
+                    return (is_false_impl(v0) && is_false_impl(v1)) ? T(1) : T(0);
+                }
+            }
+        }
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   Rational &t,
+                                   numeric::details::rational_type_tag) {
+            return Rational::fromDecimal(std::string(itr_external, end), t);
+        }
+
+        inline bool is_true(const Rational &v) { return numeric::details::is_true_impl(v); }
+
+        inline bool is_false(const Rational &v) { return numeric::details::is_false_impl(v); }
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const Rational &v,
+                                       exprtk::details::numeric::details::rational_type_tag) {
+                    printf("%s", v.toString().c_str());
+                }
+            }
+        }
+    }
+}
+
+// Interval
+namespace exprtk {
+    namespace details {
+        namespace numeric {
+            namespace details {
+                struct interval_type_tag {
+                };
+
+                template<>
+                struct number_type<Interval> {
+                    typedef interval_type_tag type;
+                };
+
+                template<>
+                struct epsilon_type<interval_type_tag> {
+                    static inline Interval value() {
+                        // The endpoints compare exactly.
+                        return Interval(0);
+                    }
+                };
+
+                inline bool is_true_impl(const Interval &v) {
+                    return Interval::isTrue(v);
+                }
+
+                inline bool is_false_impl(const Interval &v) {
+                    return !is_true_impl(v);
+                }
+
+                inline bool is_nan_impl(const Interval &v, interval_type_tag) {
+                    return v.isNaN();
+                }
+
+                template<typename T>
+                inline int to_int32_impl(const T &v, interval_type_tag) {
+                    return static_cast<int>(v.toLong());
+                }
+
+                template<typename T>
+                inline long long to_int64_impl(const T &v, interval_type_tag) {
+                    return v.toLLong();
+                }
+
+                template<typename T> inline T abs_impl(const T &v, interval_type_tag) { return T::abs(v); }
+                template<typename T> inline T acos_impl(const T &v, interval_type_tag) { return T::decreasing(mpfr_acos, v); }
+                template<typename T> inline T acosh_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_acosh, v); }
+                template<typename T> inline T asin_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_asin, v); }
+                template<typename T> inline T asinh_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_asinh, v); }
+                template<typename T> inline T atan_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_atan, v); }
+                template<typename T> inline T atanh_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_atanh, v); }
+                template<typename T> inline T ceil_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_rint_ceil, v); }
+                template<typename T> inline T cos_impl(const T &v, interval_type_tag) { return T::periodic(mpfr_cos, v, T(0)); }
+                template<typename T> inline T cosh_impl(const T &v, interval_type_tag) { return T::even(mpfr_cosh, v); }
+                template<typename T> inline T exp_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_exp, v); }
+                template<typename T> inline T floor_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_rint_floor, v); }
+                template<typename T> inline T log_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_log, v); }
+                template<typename T> inline T log10_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_log10, v); }
+                template<typename T> inline T log2_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_log2, v); }
+                template<typename T> inline T neg_impl(const T &v, interval_type_tag) { return -v; }
+                template<typename T> inline T pos_impl(const T &v, interval_type_tag) { return v; }
+                template<typename T> inline T sin_impl(const T &v, interval_type_tag) { return T::periodic(mpfr_sin, v, T(T::pi() / T(2))); }
+                template<typename T> inline T sinh_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_sinh, v); }
+                template<typename T> inline T sqrt_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_sqrt, v); }
+                template<typename T> inline T tan_impl(const T &v, interval_type_tag) { return T::poles(mpfr_tan, v, T(T::pi() / T(2)), true); }
+                template<typename T> inline T tanh_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_tanh, v); }
+                template<typename T> inline T cot_impl(const T &v, interval_type_tag) { return T::poles(mpfr_cot, v, T(0), false); }
+                template<typename T> inline T sec_impl(const T &v, interval_type_tag) { return T(1) / cos_impl(v, interval_type_tag()); }
+                template<typename T> inline T csc_impl(const T &v, interval_type_tag) { return T(1) / sin_impl(v, interval_type_tag()); }
+                template<typename T> inline T r2d_impl(const T &v, interval_type_tag) { return v * T(180) / T::pi(); }
+                template<typename T> inline T d2r_impl(const T &v, interval_type_tag) { return v * T::pi() / T(180); }
+                template<typename T> inline T d2g_impl(const T &v, interval_type_tag) { return v * T(10) / T(9); }
+                template<typename T> inline T g2d_impl(const T &v, interval_type_tag) { return v * T(9) / T(10); }
+                template<typename T> inline T notl_impl(const T &v, interval_type_tag) { return is_true_impl(v) ? T(0) : T(1); }
+                template<typename T> inline T frac_impl(const T &v, interval_type_tag) { return T::frac(v); }
+                template<typename T> inline T trunc_impl(const T &v, interval_type_tag) { return T::increasing(mpfr_rint_trunc, v); }
+
+                template<typename T>
+                inline T const_pi_impl(interval_type_tag) {
+                    return T::pi();
+                }
+
+                template<typename T>
+                inline T const_e_impl(interval_type_tag) {
+                    return T::increasing(mpfr_exp, T(1));
+                }
+
+                template<typename T>
+                inline T expm1_impl(const T &v, interval_type_tag) {
+                    return T::increasing(mpfr_expm1, v);
+                }
+
+                template<typename T>
+                inline T min_impl(const T &v0, const T &v1, interval_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    return T(T::evaluate(mpfr_min, v0.getLower(), v1.getLower(), MPFR_RNDD),
+                             T::evaluate(mpfr_min, v0.getUpper(), v1.getUpper(), MPFR_RNDU));
+                }
+
+                template<typename T>
+                inline T max_impl(const T &v0, const T &v1, interval_type_tag) {
+                    if (v0.isNaN() || v1.isNaN())
+                        return T::NaN();
+                    return T(T::evaluate(mpfr_max, v0.getLower(), v1.getLower(), MPFR_RNDD),
+                             T::evaluate(mpfr_max, v0.getUpper(), v1.getUpper(), MPFR_RNDU));
+                }
+
+                template<typename T>
+                inline T equal_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return v0 == v1 ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nequal_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return v0 != v1 ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T sgn_impl(const T &v, interval_type_tag) {
+                    return T::sgn(v);
+                }
+
+                template<typename T>
+                inline T log1p_impl(const T &v, interval_type_tag) {
+                    return T::increasing(mpfr_log1p, v);
+                }
+
+                template<typename T>
+                inline T erf_impl(const T &v, interval_type_tag) {
+                    return T::increasing(mpfr_erf, v);
+                }
+
+                template<typename T>
+                inline T erfc_impl(const T &v, interval_type_tag) {
+                    return T::decreasing(mpfr_erfc, v);
+                }
+
+                template<typename T>
+                inline T ncdf_impl(const T &v, interval_type_tag) {
+                    const T sqrt2 = T::increasing(mpfr_sqrt, T(2));
+                    return T(0.5) * (T(1) + erf_impl(T(v / sqrt2), interval_type_tag()));
+                }
+
+                template<typename T>
+                inline T modulus_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return T::modulus(v0, v1);
+                }
+
+                template<typename T>
+                inline T pow_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return T::pow(v0, v1);
+                }
+
+                template<typename T>
+                inline T logn_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return log_impl(v0, interval_type_tag()) / log_impl(v1, interval_type_tag());
+                }
+
+                template<typename T>
+                inline T sinc_impl(const T &v, interval_type_tag) {
+                    if (v.containsZero())
+                        return T(ArithmeticType(-1), ArithmeticType(1));
+                    return sin_impl(v, interval_type_tag()) / v;
+                }
+
+                template<typename T>
+                inline T xor_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return (is_false_impl(v0) != is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T xnor_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return (is_true_impl(v0) == is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T round_impl(const T &v, interval_type_tag) {
+                    return T::increasing(mpfr_rint_round, v);
+                }
+
+                template<typename T>
+                inline T roundn_impl(const T &v0, const T &v1, interval_type_tag) {
+                    const T p10 = T::pow(T(10), floor_impl(v1, interval_type_tag()));
+                    return round_impl(T(v0 * p10), interval_type_tag()) / p10;
+                }
+
+                template<typename T>
+                inline bool is_integer_impl(const T &v, interval_type_tag) {
+                    return v.isPoint() && mpfr_integer_p(v.getLower().mpfr_srcptr());
+                }
+
+                template<typename T>
+                inline T root_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return T::root(v0, v1);
+                }
+
+                template<typename T>
+                inline T hypot_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return T::corners(mpfr_hypot, T::abs(v0), T::abs(v1));
+                }
+
+                template<typename T>
+                inline T atan2_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return T::atan2(v0, v1);
+                }
+
+                template<typename T>
+                inline T shr_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return v0 * T::pow(T(2), -v1);
+                }
+
+                template<typename T>
+                inline T shl_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return v0 * T::pow(T(2), v1);
+                }
+
+                template<typename T>
+                inline T and_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return (is_true_impl(v0) && is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nand_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return (is_false_impl(v0) || is_false_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T or_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return (is_true_impl(v0) || is_true_impl(v1)) ? T(1) : T(0);
+                }
+
+                template<typename T>
+                inline T nor_impl(const T &v0, const T &v1, interval_type_tag) {
+                    return (is_false_impl(v0) && is_false_impl(v1)) ? T(1) : T(0);
+                }
+            }
+        }
+
+        template<typename Iterator>
+        inline bool string_to_real(Iterator &itr_external,
+                                   const Iterator end,
+                                   Interval &t,
+                                   numeric::details::interval_type_tag) {
+            return Interval::fromString(std::string(itr_external, end), t);
+        }
+
+        inline bool is_true(const Interval &v) { return numeric::details::is_true_impl(v); }
+
+        inline bool is_false(const Interval &v) { return numeric::details::is_false_impl(v); }
+    }
+
+    namespace rtl {
+        namespace io {
+            namespace details {
+                inline void print_type(const std::string &,
+                                       const Interval &v,
+                                       exprtk::details::numeric::details::interval_type_tag) {
+                    printf("%s", v.toString().c_str());
+                }
+            }
+        }
+    }
+}
+
+#endif //QCALC_NUMERICBACKEND_HPP
@@ -0,0 +1,104 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_NUMERICCONVERSION_HPP
+#define QCALC_NUMERICCONVERSION_HPP
+
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#include "float128.hpp"
+#include "multidouble.hpp"
+#include "smallreal.hpp"
+#include "bigint.hpp"
+#include "rational.hpp"
+#include "interval.hpp"
+
+#include "arithmetictype.hpp"
+
+/**
+ * Conversions between ArithmeticType and the arithmetic types of the numeric backends.
+ */
+namespace NumericConversion {
+    /**
+     * @tparam T
+     * @param value
+     * @return The value rounded to T with the mpfr default rounding mode of the calling thread.
+     */
+    template<typename T>
+    T fromArithmeticType(const ArithmeticType &value) {
+        if constexpr (std::is_same<T, ArithmeticType>::value) {
+            return value;
+        } else if constexpr (std::is_same<T, SmallReal>::value) {
+            return SmallReal(value);
+        } else if constexpr (std::is_same<T, BigInt>::value
+                             || std::is_same<T, Rational>::value
+                             || std::is_same<T, Interval>::value) {
+            return T(value);
+        } else if constexpr (std::is_same<T, double>::value) {
+            return value.toDouble(mpfr::mpreal::get_default_rnd());
+        } else if constexpr (std::is_same<T, long double>::value) {
+            return value.toLDouble(mpfr::mpreal::get_default_rnd());
+        } else if constexpr (std::is_same<T, DoubleDouble>::value || std::is_same<T, QuadDouble>::value) {
+            return MultiDoubleDetail::fromArithmeticType<sizeof(T) / sizeof(double)>(value,
+                                                                                   mpfr::mpreal::get_default_rnd());
+        } else {
+#ifdef QCALC_FLOAT128
+            static_assert(std::is_same<T, __float128>::value, "Unsupported arithmetic type");
+            return Float128::fromArithmeticType(value, mpfr::mpreal::get_default_rnd());
+#else
+            static_assert(!std::is_same<T, T>::value, "Unsupported arithmetic type");
+#endif
+        }
+    }
+
+    /**
+     * @tparam T
+     * @param value
+     * @return The value converted exactly, the precision is at least the mpfr default precision of the calling thread.
+     * Rationals are rounded to the default precision with the default rounding mode,
+     * intervals are converted to their midpoint.
+     */
+    template<typename T>
+    ArithmeticType toArithmeticType(const T &value) {
+        if constexpr (std::is_same<T, ArithmeticType>::value) {
+            return value;
+        } else if constexpr (std::is_same<T, SmallReal>::value
+                             || std::is_same<T, BigInt>::value
+                             || std::is_same<T, Rational>::value
+                             || std::is_same<T, Interval>::value) {
+            return value.toArithmeticType();
+        } else if constexpr (std::is_same<T, double>::value || std::is_same<T, long double>::value) {
+            return ArithmeticType(value, std::max<mpfr_prec_t>(mpfr::mpreal::get_default_prec(),
+                                                               std::numeric_limits<T>::digits));
+        } else if constexpr (std::is_same<T, DoubleDouble>::value || std::is_same<T, QuadDouble>::value) {
+            return MultiDoubleDetail::toArithmeticType(value);
+        } else {
+#ifdef QCALC_FLOAT128
+            static_assert(std::is_same<T, __float128>::value, "Unsupported arithmetic type");
+            return Float128::toArithmeticType(value);
+#else
+            static_assert(!std::is_same<T, T>::value, "Unsupported arithmetic type");
+#endif
+        }
+    }
+}
+
+#endif //QCALC_NUMERICCONVERSION_HPP
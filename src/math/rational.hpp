@@ -0,0 +1,496 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_RATIONAL_HPP
+#define QCALC_RATIONAL_HPP
+
+/**
+ * An exact rational number stored in a gmp mpq_t.
+ *
+ * The arithmetic operations, powers with integral exponents, rounding and comparisons are exact,
+ * decimal literals are parsed exactly (0.1 is 1/10).
+ * Functions whose result is not rational in general (eg. sin, log, pow with a fractional exponent)
+ * throw a runtime_error instead of rounding, square roots and roots are supported if the result is rational.
+ * A division by zero results in NaN.
+ * Results which would exceed MAX_BITS are represented by NaN instead of being computed,
+ * gmp aborts the process on results larger than its limits.
+ */
+
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdio>
+
+#include "arithmetictype.hpp"
+#include "mpfrmemory.hpp"
+
+class Rational {
+public:
+    // The maximum number of bits of a computed numerator or denominator (512 MiB), well below the limits of gmp.
+    static const size_t MAX_BITS = static_cast<size_t>(1) << 32;
+
+    Rational() : nan(false) {
+        mpq_init(value);
+    }
+
+    Rational(double v) : nan(!std::isfinite(v)) { // NOLINT(google-explicit-constructor)
+        mpq_init(value);
+        if (!nan)
+            mpq_set_d(value, v);
+    }
+
+    Rational(int v) : Rational(static_cast<long>(v)) {} // NOLINT(google-explicit-constructor)
+
+    Rational(long v) : nan(false) { // NOLINT(google-explicit-constructor)
+        mpq_init(value);
+        mpq_set_si(value, v, 1);
+    }
+
+    Rational(long long v) : nan(false) { // NOLINT(google-explicit-constructor)
+        mpq_init(value);
+        if (v >= LONG_MIN && v <= LONG_MAX) {
+            mpq_set_si(value, static_cast<long>(v), 1);
+        } else {
+            unsigned long long abs = v < 0 ? 0ULL - static_cast<unsigned long long>(v)
+                                           : static_cast<unsigned long long>(v);
+            mpz_import(mpq_numref(value), 1, 1, sizeof(abs), 0, 0, &abs);
+            if (v < 0)
+                mpq_neg(value, value);
+        }
+    }
+
+    Rational(unsigned int v) : Rational(static_cast<unsigned long>(v)) {} // NOLINT(google-explicit-constructor)
+
+    Rational(unsigned long v) : nan(false) { // NOLINT(google-explicit-constructor)
+        mpq_init(value);
+        mpq_set_ui(value, v, 1);
+    }
+
+    Rational(unsigned long long v) : nan(false) { // NOLINT(google-explicit-constructor)
+        mpq_init(value);
+        mpz_import(mpq_numref(value), 1, 1, sizeof(v), 0, 0, &v);
+    }
+
+    /**
+     * Convert the value exactly, every finite binary floating point value is a rational.
+     * NaN if the numerator or denominator would exceed MAX_BITS.
+     *
+     * @param v
+     */
+    explicit Rational(const ArithmeticType &v) : nan(!mpfr_number_p(v.mpfr_srcptr())) {
+        mpq_init(value);
+        if (nan || mpfr_zero_p(v.mpfr_srcptr()))
+            return;
+        mpfr_exp_t e = v.get_exp();
+        if (static_cast<size_t>(e < 0 ? 0UL - static_cast<unsigned long>(e) : static_cast<unsigned long>(e))
+            + static_cast<size_t>(v.get_prec()) > MAX_BITS) {
+            nan = true;
+            return;
+        }
+        mpfr_exp_t exponent = mpfr_get_z_2exp(mpq_numref(value), v.mpfr_srcptr());
+        if (exponent >= 0)
+            mpz_mul_2exp(mpq_numref(value), mpq_numref(value), static_cast<mp_bitcnt_t>(exponent));
+        else
+            mpz_mul_2exp(mpq_denref(value), mpq_denref(value), static_cast<mp_bitcnt_t>(-exponent));
+        mpq_canonicalize(value);
+    }
+
+    Rational(const Rational &other) : nan(other.nan) {
+        mpq_init(value);
+        mpq_set(value, other.value);
+    }
+
+    Rational(Rational &&other) noexcept: nan(other.nan) {
+        // The other value keeps a valid zero.
+        mpq_init(value);
+        mpq_swap(value, other.value);
+    }
+
+    ~Rational() {
+        mpq_clear(value);
+    }
+
+    Rational &operator=(const Rational &other) {
+        mpq_set(value, other.value);
+        nan = other.nan;
+        return *this;
+    }
+
+    Rational &operator=(Rational &&other) noexcept {
+        mpq_swap(value, other.value);
+        nan = other.nan;
+        return *this;
+    }
+
+    static Rational NaN() {
+        Rational ret;
+        ret.nan = true;
+        return ret;
+    }
+
+    /**
+     * Parse a fraction in the form returned by toString().
+     *
+     * @param str
+     * @param ret
+     * @return False if the string is not a fraction of decimal integers with a non zero denominator.
+     */
+    static bool fromString(const std::string &str, Rational &ret) {
+        if (str == "nan") {
+            ret = NaN();
+            return true;
+        }
+        ret.nan = false;
+        if (mpq_set_str(ret.value, str.c_str(), 10) != 0 || mpz_sgn(mpq_denref(ret.value)) == 0) {
+            mpq_set_ui(ret.value, 0, 1);
+            return false;
+        }
+        mpq_canonicalize(ret.value);
+        return true;
+    }
+
+    /**
+     * Parse a decimal literal with an optional fraction and exponent (eg. 1.25e-3) exactly.
+     * A literal whose power of ten would exceed MAX_BITS is parsed as NaN.
+     *
+     * @param str
+     * @param ret
+     * @return False if the string is not a decimal literal.
+     */
+    static bool fromDecimal(const std::string &str, Rational &ret) {
+        auto e = str.find_first_of("eE");
+        std::string mantissa = str.substr(0, e);
+        long exponent = 0;
+        if (e != std::string::npos) {
+            std::string exponentStr = str.substr(e + 1);
+            if (exponentStr.empty())
+                return false;
+            try {
+                size_t end;
+                exponent = std::stol(exponentStr, &end);
+                if (end != exponentStr.size())
+                    return false;
+            } catch (const std::exception &) {
+                return false;
+            }
+            // Larger exponents exceed MAX_BITS anyway, the clamp keeps the fraction digits from overflowing the exponent.
+            exponent = std::max(std::min(exponent, static_cast<long>(MAX_BITS)), -static_cast<long>(MAX_BITS));
+        }
+
+        auto point = mantissa.find('.');
+        if (point != std::string::npos) {
+            exponent -= static_cast<long>(mantissa.size() - point - 1);
+            mantissa.erase(point, 1);
+        }
+        if (mantissa.empty()
+            || mantissa.find_first_not_of("0123456789") != std::string::npos
+            || mpz_set_str(mpq_numref(ret.value), mantissa.c_str(), 10) != 0)
+            return false;
+
+        ret.nan = false;
+        mpz_set_ui(mpq_denref(ret.value), 1);
+        if (exponent != 0 && mpz_sgn(mpq_numref(ret.value)) != 0) {
+            unsigned long magnitude = exponent < 0 ? 0UL - static_cast<unsigned long>(exponent)
+                                                   : static_cast<unsigned long>(exponent);
+            // 10^n has less than 4n bits.
+            if (magnitude > MAX_BITS / 4) {
+                ret = NaN();
+                return true;
+            }
+            mpz_t scale;
+            mpz_init(scale);
+            mpz_ui_pow_ui(scale, 10, magnitude);
+            if (exponent > 0)
+                mpz_mul(mpq_numref(ret.value), mpq_numref(ret.value), scale);
+            else
+                mpz_set(mpq_denref(ret.value), scale);
+            mpz_clear(scale);
+        }
+        mpq_canonicalize(ret.value);
+        return true;
+    }
+
+    ::mpq_ptr mpq_ptr() {
+        return value;
+    }
+
+    ::mpq_srcptr mpq_srcptr() const {
+        return value;
+    }
+
+    bool isNaN() const {
+        return nan;
+    }
+
+    bool isInteger() const {
+        return !nan && mpz_cmp_ui(mpq_denref(value), 1) == 0;
+    }
+
+    /**
+     * @return The value rounded to the mpfr default precision with the mpfr default rounding mode.
+     */
+    ArithmeticType toArithmeticType() const {
+        if (nan)
+            return ArithmeticType().setNan();
+        ArithmeticType ret(0, mpfr::mpreal::get_default_prec());
+        mpfr_set_q(ret.mpfr_ptr(), value, mpfr::mpreal::get_default_rnd());
+        return ret;
+    }
+
+    /**
+     * @return The fraction in canonical form as "numerator/denominator" or "numerator" if the value is an integer.
+     */
+    std::string toString() const {
+        if (nan)
+            return "nan";
+        std::string ret(mpz_sizeinbase(mpq_numref(value), 10) + mpz_sizeinbase(mpq_denref(value), 10) + 3, '\0');
+        mpq_get_str(&ret[0], 10, value);
+        ret.resize(ret.find('\0'));
+        return ret;
+    }
+
+    double toDouble() const {
+        return nan ? std::numeric_limits<double>::quiet_NaN() : mpq_get_d(value);
+    }
+
+    long toLong() const {
+        if (nan)
+            return 0;
+        mpz_t z;
+        mpz_init(z);
+        mpz_tdiv_q(z, mpq_numref(value), mpq_denref(value));
+        long ret = mpz_fits_slong_p(z) ? mpz_get_si(z) : 0;
+        mpz_clear(z);
+        return ret;
+    }
+
+    long long toLLong() const {
+        return nan ? 0 : toArithmeticType().toLLong();
+    }
+
+    explicit operator double() const {
+        return toDouble();
+    }
+
+    explicit operator int() const {
+        return static_cast<int>(toLong());
+    }
+
+    explicit operator long long() const {
+        return toLLong();
+    }
+
+    explicit operator std::size_t() const {
+        long ret = toLong();
+        return ret < 0 ? 0 : static_cast<std::size_t>(ret);
+    }
+
+    Rational operator-() const {
+        Rational ret(*this);
+        mpq_neg(ret.value, ret.value);
+        return ret;
+    }
+
+    Rational &operator+=(const Rational &other) {
+        return *this = *this + other;
+    }
+
+    Rational &operator-=(const Rational &other) {
+        return *this = *this - other;
+    }
+
+    Rational &operator*=(const Rational &other) {
+        return *this = *this * other;
+    }
+
+    Rational &operator/=(const Rational &other) {
+        return *this = *this / other;
+    }
+
+    friend Rational operator+(const Rational &a, const Rational &b) {
+        return apply(mpq_add, a, b);
+    }
+
+    friend Rational operator-(const Rational &a, const Rational &b) {
+        return apply(mpq_sub, a, b);
+    }
+
+    friend Rational operator*(const Rational &a, const Rational &b) {
+        return apply(mpq_mul, a, b);
+    }
+
+    friend Rational operator/(const Rational &a, const Rational &b) {
+        if (b.nan || mpq_sgn(b.value) == 0)
+            return NaN();
+        return apply(mpq_div, a, b);
+    }
+
+    // Comparisons with NaN are false like the comparisons of floating point values.
+
+    friend bool operator==(const Rational &a, const Rational &b) {
+        return !a.nan && !b.nan && mpq_equal(a.value, b.value) != 0;
+    }
+
+    friend bool operator!=(const Rational &a, const Rational &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const Rational &a, const Rational &b) {
+        return !a.nan && !b.nan && mpq_cmp(a.value, b.value) < 0;
+    }
+
+    friend bool operator>(const Rational &a, const Rational &b) {
+        return !a.nan && !b.nan && mpq_cmp(a.value, b.value) > 0;
+    }
+
+    friend bool operator<=(const Rational &a, const Rational &b) {
+        return !a.nan && !b.nan && mpq_cmp(a.value, b.value) <= 0;
+    }
+
+    friend bool operator>=(const Rational &a, const Rational &b) {
+        return !a.nan && !b.nan && mpq_cmp(a.value, b.value) >= 0;
+    }
+
+    /**
+     * @return The result of the gmp function, NaN if an operand is NaN.
+     */
+    static Rational apply(void (*function)(::mpq_ptr, ::mpq_srcptr, ::mpq_srcptr), const Rational &a, const Rational &b) {
+        if (a.nan || b.nan)
+            return NaN();
+        Rational ret;
+        function(ret.value, a.value, b.value);
+        return ret;
+    }
+
+    /**
+     * @return The integer obtained by dividing the numerator by the denominator with the gmp division function.
+     */
+    static Rational divide(void (*function)(::mpz_ptr, ::mpz_srcptr, ::mpz_srcptr), const Rational &v) {
+        if (v.nan)
+            return NaN();
+        Rational ret;
+        function(mpq_numref(ret.value), mpq_numref(v.value), mpq_denref(v.value));
+        return ret;
+    }
+
+    /**
+     * @return The value rounded to the nearest integer, halfway cases are rounded away from zero like mpfr_round.
+     */
+    static Rational round(const Rational &v) {
+        if (v.nan)
+            return NaN();
+        Rational half(0.5);
+        return mpq_sgn(v.value) < 0 ? divide(mpz_cdiv_q, v - half) : divide(mpz_fdiv_q, v + half);
+    }
+
+    /**
+     * @return The value raised to the integral exponent, NaN if the result would exceed MAX_BITS.
+     * @throws std::runtime_error If the exponent is not an integer or the result would exceed the memory limit of the thread.
+     */
+    static Rational pow(const Rational &base, const Rational &exponent) {
+        if (base.nan || exponent.nan)
+            return NaN();
+        if (!exponent.isInteger())
+            unsupported("pow with a fractional exponent");
+        int exponentSign = mpq_sgn(exponent.value);
+        if (exponentSign < 0 && mpq_sgn(base.value) == 0)
+            return NaN();
+        if (base.isInteger() && mpz_cmpabs_ui(mpq_numref(base.value), 1) <= 0) {
+            // The powers of 0, 1 and -1 do not grow with the exponent.
+            if (mpq_sgn(base.value) == 0)
+                return Rational(exponentSign == 0 ? 1 : 0);
+            return Rational(mpq_sgn(base.value) < 0 && mpz_odd_p(mpq_numref(exponent.value)) ? -1 : 1);
+        }
+        if (!mpz_fits_slong_p(mpq_numref(exponent.value)))
+            return NaN();
+        long e = mpz_get_si(mpq_numref(exponent.value));
+        unsigned long n = e < 0 ? 0UL - static_cast<unsigned long>(e) : static_cast<unsigned long>(e);
+        size_t bits = std::max(mpz_sizeinbase(mpq_numref(base.value), 2), mpz_sizeinbase(mpq_denref(base.value), 2));
+        if (n > MAX_BITS / bits)
+            return NaN();
+        MpfrMemory::checkRequest(bits * n / 4);
+        Rational ret;
+        mpz_pow_ui(mpq_numref(ret.value), mpq_numref(base.value), n);
+        mpz_pow_ui(mpq_denref(ret.value), mpq_denref(base.value), n);
+        if (e < 0)
+            mpq_inv(ret.value, ret.value);
+        return ret;
+    }
+
+    /**
+     * @return The n-th root if it is rational, NaN for even roots of negative values.
+     * @throws std::runtime_error If n is not a positive integer or the root is irrational.
+     */
+    static Rational root(const Rational &v, const Rational &n) {
+        if (v.nan || n.nan)
+            return NaN();
+        if (!n.isInteger() || mpq_sgn(n.value) <= 0 || !mpz_fits_ulong_p(mpq_numref(n.value)))
+            unsupported("root with a non integral degree");
+        unsigned long degree = mpz_get_ui(mpq_numref(n.value));
+        if (mpq_sgn(v.value) < 0 && degree % 2 == 0)
+            return NaN();
+        Rational ret;
+        if (mpz_root(mpq_numref(ret.value), mpq_numref(v.value), degree) == 0
+            || mpz_root(mpq_denref(ret.value), mpq_denref(v.value), degree) == 0)
+            unsupported("root of a value which is not a perfect power");
+        return ret;
+    }
+
+    [[noreturn]] static void unsupported(const std::string &function) {
+        throw std::runtime_error("The rational backend does not support " + function);
+    }
+
+private:
+    mpq_t value;
+    bool nan;
+};
+
+namespace std {
+    template<>
+    class numeric_limits<Rational> {
+    public:
+        static const bool is_specialized = true;
+        static const bool is_signed = true;
+        static const bool is_integer = false;
+        static const bool is_exact = true;
+        static const bool is_bounded = false;
+        static const bool has_infinity = false;
+        static const bool has_quiet_NaN = true;
+        static const bool has_signaling_NaN = false;
+        static const int radix = 2;
+
+        static Rational epsilon() noexcept { return 0; }
+
+        static Rational round_error() noexcept { return 0; }
+
+        // Exprtk defines the inf constant using infinity().
+        static Rational infinity() noexcept { return Rational::NaN(); }
+
+        static Rational quiet_NaN() noexcept { return Rational::NaN(); }
+
+        static Rational signaling_NaN() noexcept { return Rational::NaN(); }
+    };
+}
+
+#endif //QCALC_RATIONAL_HPP
@@ -22,7 +22,8 @@
 
 #include <string>
 
-#include "../extern/exprtk.hpp"
+#include "numericconversion.hpp"
+#include "numericbackend.hpp"
 
 #include "scripthandler.hpp"
 
@@ -43,7 +44,7 @@ struct ScriptFunction : public exprtk::ifunction<T> {
             : exprtk::ifunction<T>(0), callback(callback) {}
 
     inline T operator()() {
-        return ScriptHandler::run(callback, {});
+        return NumericConversion::fromArithmeticType<T>(ScriptHandler::run(callback, {}));
     }
 
 private:
@@ -23,11 +23,27 @@
 #include "pycx/types/pympreal.hpp"
 #include "pycx/interpreter.hpp"
 
+#include "evaluationcontext.hpp"
+#include "evaluationguard.hpp"
+#include "mpfrmemory.hpp"
+
 ArithmeticType ScriptHandler::run(PyObject *c, const std::vector<ArithmeticType> &a) {
     if (c == NULL) {
         throw std::runtime_error("Null callback in script handler");
     }
 
+    // The python call itself cannot be interrupted, a cancelled evaluation does not start or continue after it.
+    EvaluationGuard::checkCancelled();
+
+    // Modifications of the context by the script do not affect the running evaluation.
+    ScopedEvaluationContext scope;
+
+    // The python interpreter cannot handle the exceptions of the memory limit of the evaluation.
+    MpfrMemory::ScopedUnlimited unlimited;
+
+    // Scripts may be invoked from an evaluation thread.
+    Interpreter::Lock lock;
+
     PyObject *args = PyTuple_New(a.size());
     for (size_t i = 0; i < a.size(); i++) {
         auto &v = a.at(i);
@@ -49,7 +65,7 @@ ArithmeticType ScriptHandler::run(PyObject *c, const std::vector<ArithmeticType>
     } else if (PyFloat_Check(pyRet)) {
         ret = PyFloat_AsDouble(pyRet);
     } else if (PyLong_Check(pyRet)) {
-        ret = PyLong_AsDouble(pyRet);
+        ret = PyLong_AsMpReal(pyRet);
     }
 
     if (PyErr_Occurred() != NULL) {
@@ -58,5 +74,7 @@ ArithmeticType ScriptHandler::run(PyObject *c, const std::vector<ArithmeticType>
 
     Py_DECREF(pyRet);
 
+    EvaluationGuard::checkCancelled();
+
     return ret;
 }
\ No newline at end of file
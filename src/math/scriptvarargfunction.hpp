@@ -22,8 +22,10 @@
 
 #include <string>
 #include <cassert>
+#include <type_traits>
 
-#include "../extern/exprtk.hpp"
+#include "numericconversion.hpp"
+#include "numericbackend.hpp"
 
 #include "scripthandler.hpp"
 
@@ -42,7 +44,16 @@ public:
             : callback(callback) {}
 
     inline T operator()(const std::vector<T> &args) {
-        return ScriptHandler::run(callback, args);
+        if constexpr (std::is_same<T, ArithmeticType>::value) {
+            return ScriptHandler::run(callback, args);
+        } else {
+            std::vector<ArithmeticType> arguments;
+            arguments.reserve(args.size());
+            for (auto &arg : args) {
+                arguments.emplace_back(NumericConversion::toArithmeticType(arg));
+            }
+            return NumericConversion::fromArithmeticType<T>(ScriptHandler::run(callback, arguments));
+        }
     }
 
 private:
@@ -0,0 +1,362 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_SMALLREAL_HPP
+#define QCALC_SMALLREAL_HPP
+
+/**
+ * An mpfr value type with the semantics of mpreal which stores the limbs of small precisions inline.
+ *
+ * Values with a precision of at most SmallReal::INLINE_PRECISION bits are initialized using the mpfr custom interface
+ * on a buffer inside the object and therefore do not allocate, larger precisions allocate the limbs using mpfr_init2.
+ */
+
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cstdio>
+
+#include "arithmetictype.hpp"
+
+class SmallReal {
+public:
+    static const mpfr_prec_t INLINE_PRECISION = 256;
+
+    SmallReal() {
+        init(mpfr::mpreal::get_default_prec());
+        mpfr_set_zero(value, 1);
+    }
+
+    // Like mpreal the values are rounded to the default precision with the default rounding mode.
+
+    SmallReal(double v) { // NOLINT(google-explicit-constructor)
+        init(mpfr::mpreal::get_default_prec());
+        mpfr_set_d(value, v, mpfr::mpreal::get_default_rnd());
+    }
+
+    SmallReal(long double v) { // NOLINT(google-explicit-constructor)
+        init(mpfr::mpreal::get_default_prec());
+        mpfr_set_ld(value, v, mpfr::mpreal::get_default_rnd());
+    }
+
+    SmallReal(int v) : SmallReal(static_cast<long>(v)) {} // NOLINT(google-explicit-constructor)
+
+    SmallReal(long v) { // NOLINT(google-explicit-constructor)
+        init(mpfr::mpreal::get_default_prec());
+        mpfr_set_si(value, v, mpfr::mpreal::get_default_rnd());
+    }
+
+    SmallReal(long long v) { // NOLINT(google-explicit-constructor)
+        init(mpfr::mpreal::get_default_prec());
+        mpfr_set_sj(value, v, mpfr::mpreal::get_default_rnd());
+    }
+
+    SmallReal(unsigned int v) : SmallReal(static_cast<unsigned long>(v)) {} // NOLINT(google-explicit-constructor)
+
+    SmallReal(unsigned long v) { // NOLINT(google-explicit-constructor)
+        init(mpfr::mpreal::get_default_prec());
+        mpfr_set_ui(value, v, mpfr::mpreal::get_default_rnd());
+    }
+
+    SmallReal(unsigned long long v) { // NOLINT(google-explicit-constructor)
+        init(mpfr::mpreal::get_default_prec());
+        mpfr_set_uj(value, v, mpfr::mpreal::get_default_rnd());
+    }
+
+    /**
+     * Convert the value exactly, the precision is the precision of the value.
+     *
+     * @param v
+     */
+    explicit SmallReal(const ArithmeticType &v) {
+        init(v.getPrecision());
+        mpfr_set(value, v.mpfr_srcptr(), MPFR_RNDN);
+    }
+
+    SmallReal(const SmallReal &other) {
+        init(other.getPrecision());
+        mpfr_set(value, other.value, MPFR_RNDN);
+    }
+
+    SmallReal(SmallReal &&other) noexcept {
+        if (other.isInline()) {
+            init(other.getPrecision());
+            mpfr_set(value, other.value, MPFR_RNDN);
+        } else {
+            // Take the allocated limbs and leave the other value as an inline zero.
+            value[0] = other.value[0];
+            other.init(MPFR_PREC_MIN);
+            mpfr_set_zero(other.value, 1);
+        }
+    }
+
+    ~SmallReal() {
+        if (!isInline())
+            mpfr_clear(value);
+    }
+
+    /**
+     * Like mpreal the value takes the precision of the assigned value.
+     */
+    SmallReal &operator=(const SmallReal &other) {
+        if (this != &other) {
+            setPrecision(other.getPrecision());
+            mpfr_set(value, other.value, MPFR_RNDN);
+        }
+        return *this;
+    }
+
+    SmallReal &operator=(SmallReal &&other) noexcept {
+        if (this == &other)
+            return *this;
+        if (other.isInline()) {
+            setPrecision(other.getPrecision());
+            mpfr_set(value, other.value, MPFR_RNDN);
+        } else {
+            if (!isInline())
+                mpfr_clear(value);
+            value[0] = other.value[0];
+            other.init(MPFR_PREC_MIN);
+            mpfr_set_zero(other.value, 1);
+        }
+        return *this;
+    }
+
+    /**
+     * @param precision
+     * @return A NaN with the given precision.
+     */
+    static SmallReal withPrecision(mpfr_prec_t precision) {
+        return SmallReal(precision, PrecisionTag());
+    }
+
+    ::mpfr_ptr mpfr_ptr() {
+        return value;
+    }
+
+    ::mpfr_srcptr mpfr_srcptr() const {
+        return value;
+    }
+
+    mpfr_prec_t getPrecision() const {
+        return mpfr_get_prec(value);
+    }
+
+    ArithmeticType toArithmeticType() const {
+        ArithmeticType ret(0, getPrecision());
+        mpfr_set(ret.mpfr_ptr(), value, MPFR_RNDN);
+        return ret;
+    }
+
+    double toDouble() const {
+        return mpfr_get_d(value, mpfr::mpreal::get_default_rnd());
+    }
+
+    long toLong() const {
+        return mpfr_get_si(value, MPFR_RNDZ);
+    }
+
+    long long toLLong() const {
+        return mpfr_get_sj(value, MPFR_RNDZ);
+    }
+
+    explicit operator double() const {
+        return toDouble();
+    }
+
+    explicit operator int() const {
+        return static_cast<int>(toLong());
+    }
+
+    explicit operator long long() const {
+        return toLLong();
+    }
+
+    explicit operator std::size_t() const {
+        return mpfr_get_uj(value, MPFR_RNDZ);
+    }
+
+    bool isInline() const {
+        return mpfr_custom_get_significand(value) == limbs;
+    }
+
+    SmallReal operator-() const {
+        SmallReal ret = withPrecision(getPrecision());
+        mpfr_neg(ret.value, value, mpfr::mpreal::get_default_rnd());
+        return ret;
+    }
+
+    SmallReal &operator+=(const SmallReal &other) {
+        return *this = *this + other;
+    }
+
+    SmallReal &operator-=(const SmallReal &other) {
+        return *this = *this - other;
+    }
+
+    SmallReal &operator*=(const SmallReal &other) {
+        return *this = *this * other;
+    }
+
+    SmallReal &operator/=(const SmallReal &other) {
+        return *this = *this / other;
+    }
+
+    // Like mpreal the result has the larger precision of the operands.
+
+    friend SmallReal operator+(const SmallReal &a, const SmallReal &b) {
+        return apply(mpfr_add, a, b);
+    }
+
+    friend SmallReal operator-(const SmallReal &a, const SmallReal &b) {
+        return apply(mpfr_sub, a, b);
+    }
+
+    friend SmallReal operator*(const SmallReal &a, const SmallReal &b) {
+        return apply(mpfr_mul, a, b);
+    }
+
+    friend SmallReal operator/(const SmallReal &a, const SmallReal &b) {
+        return apply(mpfr_div, a, b);
+    }
+
+    friend bool operator==(const SmallReal &a, const SmallReal &b) {
+        return mpfr_equal_p(a.value, b.value) != 0;
+    }
+
+    friend bool operator!=(const SmallReal &a, const SmallReal &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const SmallReal &a, const SmallReal &b) {
+        return mpfr_less_p(a.value, b.value) != 0;
+    }
+
+    friend bool operator>(const SmallReal &a, const SmallReal &b) {
+        return mpfr_greater_p(a.value, b.value) != 0;
+    }
+
+    friend bool operator<=(const SmallReal &a, const SmallReal &b) {
+        return mpfr_lessequal_p(a.value, b.value) != 0;
+    }
+
+    friend bool operator>=(const SmallReal &a, const SmallReal &b) {
+        return mpfr_greaterequal_p(a.value, b.value) != 0;
+    }
+
+    /**
+     * @return The result of the mpfr function with the precision of the operand, rounded with the default rounding mode.
+     */
+    static SmallReal apply(int (*function)(::mpfr_ptr, ::mpfr_srcptr, mpfr_rnd_t), const SmallReal &v) {
+        SmallReal ret = withPrecision(v.getPrecision());
+        function(ret.value, v.value, mpfr::mpreal::get_default_rnd());
+        return ret;
+    }
+
+    /**
+     * @return The result of the mpfr function with the larger precision of the operands, rounded with the default rounding mode.
+     */
+    static SmallReal apply(int (*function)(::mpfr_ptr, ::mpfr_srcptr, ::mpfr_srcptr, mpfr_rnd_t),
+                           const SmallReal &a,
+                           const SmallReal &b) {
+        SmallReal ret = withPrecision(std::max(a.getPrecision(), b.getPrecision()));
+        function(ret.value, a.value, b.value, mpfr::mpreal::get_default_rnd());
+        return ret;
+    }
+
+    /**
+     * @return The result of the mpfr rounding function (ceil, floor, round, trunc) with the precision of the operand.
+     */
+    static SmallReal apply(int (*function)(::mpfr_ptr, ::mpfr_srcptr), const SmallReal &v) {
+        SmallReal ret = withPrecision(v.getPrecision());
+        function(ret.value, v.value);
+        return ret;
+    }
+
+private:
+    struct PrecisionTag {
+    };
+
+    static const int INLINE_LIMBS = (INLINE_PRECISION + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+
+    SmallReal(mpfr_prec_t precision, PrecisionTag) {
+        init(precision);
+    }
+
+    /**
+     * Initialize the uninitialized value with the given precision, the value is NaN.
+     */
+    void init(mpfr_prec_t precision) {
+        if (precision <= INLINE_PRECISION) {
+            mpfr_custom_init(limbs, precision);
+            mpfr_custom_init_set(value, MPFR_NAN_KIND, 0, precision, limbs);
+        } else {
+            mpfr_init2(value, precision);
+        }
+    }
+
+    /**
+     * Change the precision of the value, the value is NaN afterwards if the precision changed.
+     */
+    void setPrecision(mpfr_prec_t precision) {
+        if (precision == getPrecision())
+            return;
+        if (isInline() && precision <= INLINE_PRECISION) {
+            init(precision);
+        } else if (!isInline() && precision > INLINE_PRECISION) {
+            mpfr_set_prec(value, precision);
+        } else {
+            if (!isInline())
+                mpfr_clear(value);
+            init(precision);
+        }
+    }
+
+    mpfr_t value;
+    mp_limb_t limbs[INLINE_LIMBS];
+};
+
+namespace std {
+    template<>
+    class numeric_limits<SmallReal> {
+    public:
+        static const bool is_specialized = true;
+        static const bool is_signed = true;
+        static const bool is_integer = false;
+        static const bool is_exact = false;
+        static const bool has_infinity = true;
+        static const bool has_quiet_NaN = true;
+        static const bool has_signaling_NaN = true;
+        static const int radix = 2;
+        static const int min_exponent = MPFR_EMIN_DEFAULT;
+        static const int max_exponent = MPFR_EMAX_DEFAULT;
+
+        static SmallReal epsilon() noexcept { return SmallReal(numeric_limits<ArithmeticType>::epsilon()); }
+
+        static SmallReal round_error() noexcept { return 0.5; }
+
+        static SmallReal infinity() noexcept { return SmallReal(numeric_limits<ArithmeticType>::infinity()); }
+
+        static SmallReal quiet_NaN() noexcept { return SmallReal(numeric_limits<ArithmeticType>::quiet_NaN()); }
+
+        static SmallReal signaling_NaN() noexcept { return quiet_NaN(); }
+    };
+}
+
+#endif //QCALC_SMALLREAL_HPP
@@ -19,7 +19,20 @@
 
 #include "symboltable.hpp"
 
-SymbolTable::SymbolTable() = default;
+#include <atomic>
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+static const size_t MAX_CHANGES = 1000;
+
+// Versions and revisions are drawn from the same counter which makes them unique across all table instances.
+static unsigned long generateVersion() {
+    static std::atomic<unsigned long> counter(0);
+    return ++counter;
+}
+
+SymbolTable::SymbolTable() : version(generateVersion()), revision(generateVersion()) {}
 
 const std::map<std::string, ArithmeticType> &SymbolTable::getVariables() const {
     return variables;
@@ -37,26 +50,60 @@ const std::map<std::string, Script> &SymbolTable::getScripts() const {
     return scripts;
 }
 
+const std::map<std::string, std::shared_ptr<const FunctionDefinition>> &SymbolTable::getFunctionDefinitions() const {
+    return functionDefinitions;
+}
+
+const std::map<std::string, std::string> &SymbolTable::getDefinitions() const {
+    return definitions;
+}
+
+const std::map<std::string, std::string> &SymbolTable::getRationals() const {
+    return rationals;
+}
+
 void SymbolTable::setVariable(const std::string &name, ArithmeticType value, int decimals) {
     if (name.empty())
         throw std::runtime_error("Symbol name cannot be empty.");
 
+    bool added = variables.find(name) == variables.end();
+    if (added)
+        version = generateVersion();
+
+    bool callable = added && hasCallable(name);
+
     constants.erase(name);
     functions.erase(name);
+    removeFunctionDefinition(name);
     scripts.erase(name);
+    rationals.erase(name);
     variables[name] = value;
     vDecimals[name] = decimals;
+    addName(name);
+    if (callable)
+        validateDependents(name);
+    recordChange(name);
 }
 
 void SymbolTable::setConstant(const std::string &name, ArithmeticType value, int decimals) {
     if (name.empty())
         throw std::runtime_error("Symbol name cannot be empty.");
 
+    bool callable = hasCallable(name);
+
     variables.erase(name);
     functions.erase(name);
+    removeFunctionDefinition(name);
     scripts.erase(name);
+    definitions.erase(name);
+    rationals.erase(name);
     constants[name] = value;
+    version = generateVersion();
     cDecimals[name] = decimals;
+    addName(name);
+    if (callable)
+        validateDependents(name);
+    recordChange(name);
 }
 
 void SymbolTable::setFunction(const std::string &name, const Function &value) {
@@ -66,7 +113,14 @@ void SymbolTable::setFunction(const std::string &name, const Function &value) {
     variables.erase(name);
     constants.erase(name);
     scripts.erase(name);
+    definitions.erase(name);
+    rationals.erase(name);
     functions[name] = value;
+    addName(name);
+    setFunctionDefinition(name, FunctionDefinition::validate(name, value, *this));
+    version = generateVersion();
+    validateDependents(name);
+    recordChange(name);
 }
 
 void SymbolTable::setScript(const std::string &name, const Script &value) {
@@ -76,7 +130,73 @@ void SymbolTable::setScript(const std::string &name, const Script &value) {
     variables.erase(name);
     constants.erase(name);
     functions.erase(name);
+    removeFunctionDefinition(name);
+    definitions.erase(name);
+    rationals.erase(name);
     scripts[name] = value;
+    addName(name);
+    version = generateVersion();
+    validateDependents(name);
+    recordChange(name);
+}
+
+void SymbolTable::setDefinition(const std::string &name, const std::string &expression) {
+    if (name.empty())
+        throw std::runtime_error("Symbol name cannot be empty.");
+
+    if (variables.find(name) == variables.end())
+        setVariable(name, 0, -1);
+
+    definitions[name] = expression;
+    version = generateVersion();
+    recordChange(name);
+}
+
+void SymbolTable::removeDefinition(const std::string &name) {
+    if (definitions.erase(name) == 0)
+        return;
+    version = generateVersion();
+    recordChange(name);
+}
+
+void SymbolTable::setRational(const std::string &name, const std::string &fraction) {
+    if (variables.find(name) == variables.end() && constants.find(name) == constants.end())
+        throw std::runtime_error("Symbol " + name + " is not a variable or constant.");
+
+    // Constants are compiled into expressions.
+    if (constants.find(name) != constants.end())
+        version = generateVersion();
+
+    rationals[name] = fraction;
+    recordChange(name);
+}
+
+std::string SymbolTable::findSymbol(const std::string &name) const {
+    auto it = lowerNames.find(toLower(name));
+    if (it == lowerNames.end())
+        return "";
+    const std::set<std::string> &names = it->second;
+    if (names.find(name) != names.end())
+        return name;
+    for (auto &v : names) {
+        if (variables.find(v) != variables.end())
+            return v;
+    }
+    for (auto &v : names) {
+        if (constants.find(v) != constants.end())
+            return v;
+    }
+    for (auto &v : names) {
+        if (functions.find(v) != functions.end())
+            return v;
+    }
+    return *names.begin();
+}
+
+std::string SymbolTable::toLower(const std::string &name) {
+    std::string ret = name;
+    std::transform(ret.begin(), ret.end(), ret.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ret;
 }
 
 bool SymbolTable::hasVariable(const std::string &name) {
@@ -95,16 +215,30 @@ bool SymbolTable::hasScript(const std::string &name) {
     return scripts.find(name) != scripts.end();
 }
 
+bool SymbolTable::hasDefinition(const std::string &name) const {
+    return definitions.find(name) != definitions.end();
+}
+
 void SymbolTable::remove(const std::string &name) {
     if (name.empty())
         throw std::runtime_error("Symbol name cannot be empty.");
 
+    bool callable = hasCallable(name);
+
     variables.erase(name);
     constants.erase(name);
     functions.erase(name);
+    removeFunctionDefinition(name);
     scripts.erase(name);
+    definitions.erase(name);
+    rationals.erase(name);
     vDecimals.erase(name);
     cDecimals.erase(name);
+    removeName(name);
+    version = generateVersion();
+    if (callable || hasCallable(name))
+        validateDependents(name);
+    recordChange(name);
 }
 
 const std::map<std::string, int> &SymbolTable::getVariableDecimals() const {
@@ -114,3 +248,84 @@ const std::map<std::string, int> &SymbolTable::getVariableDecimals() const {
 const std::map<std::string, int> &SymbolTable::getConstantDecimals() const {
     return cDecimals;
 }
+
+unsigned long SymbolTable::getVersion() const {
+    return version;
+}
+
+unsigned long SymbolTable::getRevision() const {
+    return revision;
+}
+
+const std::deque<std::pair<unsigned long, std::string>> &SymbolTable::getChanges() const {
+    return changes;
+}
+
+void SymbolTable::recordChange(const std::string &name) {
+    revision = generateVersion();
+    changes.emplace_back(revision, name);
+    if (changes.size() > MAX_CHANGES)
+        changes.pop_front();
+}
+
+bool SymbolTable::hasCallable(const std::string &name) const {
+    auto it = lowerNames.find(toLower(name));
+    if (it == lowerNames.end())
+        return false;
+    for (auto &v : it->second) {
+        if (functions.find(v) != functions.end() || scripts.find(v) != scripts.end())
+            return true;
+    }
+    return false;
+}
+
+void SymbolTable::addName(const std::string &name) {
+    lowerNames[toLower(name)].insert(name);
+}
+
+void SymbolTable::removeName(const std::string &name) {
+    auto it = lowerNames.find(toLower(name));
+    if (it == lowerNames.end())
+        return;
+    it->second.erase(name);
+    if (it->second.empty())
+        lowerNames.erase(it);
+}
+
+void SymbolTable::setFunctionDefinition(const std::string &name, std::shared_ptr<const FunctionDefinition> definition) {
+    removeFunctionDefinition(name);
+    for (auto &symbol : definition->getSymbols()) {
+        functionReferences[toLower(symbol)].insert(name);
+    }
+    functionDefinitions[name] = std::move(definition);
+}
+
+void SymbolTable::removeFunctionDefinition(const std::string &name) {
+    auto it = functionDefinitions.find(name);
+    if (it == functionDefinitions.end())
+        return;
+    for (auto &symbol : it->second->getSymbols()) {
+        auto references = functionReferences.find(toLower(symbol));
+        if (references == functionReferences.end())
+            continue;
+        references->second.erase(name);
+        if (references->second.empty())
+            functionReferences.erase(references);
+    }
+    functionDefinitions.erase(it);
+}
+
+// Definitions only depend on the functions and scripts of the table, the functions referencing the symbol
+// are validated again as the symbol may have been defined, removed or changed its arguments.
+// The symbols of a definition only depend on the function, validating again does not modify the references.
+void SymbolTable::validateDependents(const std::string &name) {
+    auto it = functionReferences.find(toLower(name));
+    if (it == functionReferences.end())
+        return;
+    for (auto &function : it->second) {
+        if (function == name)
+            continue;
+        auto &definition = functionDefinitions.at(function);
+        definition = FunctionDefinition::validate(function, functions.at(function), *this, definition->getVersion());
+    }
+}
@@ -21,9 +21,13 @@
 #define QCALC_SYMBOLTABLE_HPP
 
 #include <map>
+#include <set>
+#include <deque>
 #include <string>
+#include <memory>
 
 #include "function.hpp"
+#include "functiondefinition.hpp"
 #include "script.hpp"
 #include "arithmetictype.hpp"
 
@@ -35,6 +39,21 @@
  *
  * Only one symbol type per name may exist.
  * When setting a symbol of an existing name with different type the original symbol is deleted.
+ *
+ * Every table carries a version which changes whenever the set of symbols or the definition of
+ * a constant, function, script or variable changes. Updating the value of an existing variable does not change the version,
+ * which allows compiled expressions to be reused as long as the version stays the same.
+ *
+ * A variable or constant can additionally carry its exact value as a rational, which is kept until the symbol is set again.
+ *
+ * A variable can optionally carry a defining expression, the value of such a variable is recomputed
+ * from its definition by the DependencyGraph whenever one of the symbols referenced by the definition changes.
+ *
+ * Function definitions are validated when they are set, the validated definitions are shared by the copies of the table
+ * and validated again when a function or script they reference is set or removed.
+ *
+ * Additionally every modification creates a new revision and is recorded in a bounded change log,
+ * which allows users that mirror the table (eg. the evaluation engine) to apply only the symbols which changed.
  */
 class SymbolTable {
 public:
@@ -56,6 +75,22 @@ public:
 
     const std::map<std::string, Script> &getScripts() const;
 
+    /**
+     * @return The validated definitions of the functions, which contain the errors of the functions.
+     */
+    const std::map<std::string, std::shared_ptr<const FunctionDefinition>> &getFunctionDefinitions() const;
+
+    /**
+     * @return The defining expressions of the variables which have a definition.
+     */
+    const std::map<std::string, std::string> &getDefinitions() const;
+
+    /**
+     * @return The exact values of the variables and constants which hold a rational,
+     * as a canonical fraction in the form "numerator/denominator" or "numerator".
+     */
+    const std::map<std::string, std::string> &getRationals() const;
+
     void setVariable(const std::string &name, ArithmeticType value, int decimals);
 
     void setConstant(const std::string &name, ArithmeticType value, int decimals);
@@ -64,6 +99,45 @@ public:
 
     void setScript(const std::string &name, const Script &value);
 
+    /**
+     * Set the defining expression of a variable, the variable is created with a value of 0 if it does not exist.
+     *
+     * Setting the value of the variable does not remove the definition,
+     * the value is overwritten by the next recomputation of the variable.
+     *
+     * @param name
+     * @param expression
+     */
+    void setDefinition(const std::string &name, const std::string &expression);
+
+    void removeDefinition(const std::string &name);
+
+    /**
+     * Set the exact value of an existing variable or constant.
+     *
+     * The value of the symbol is not modified and should be the fraction rounded to the precision of the value.
+     * Setting the symbol removes the rational.
+     *
+     * @param name
+     * @param fraction A canonical fraction in the form "numerator/denominator" or "numerator".
+     */
+    void setRational(const std::string &name, const std::string &fraction);
+
+    /**
+     * Symbol names are case insensitive in expressions, an exact match is preferred.
+     * Of multiple case insensitive matches variables are preferred over constants, functions and scripts.
+     *
+     * @param name
+     * @return The name of the symbol in the table or an empty string if the table does not contain the symbol.
+     */
+    std::string findSymbol(const std::string &name) const;
+
+    /**
+     * @param name
+     * @return The name in lower case, the key under which symbol names are compared case insensitive.
+     */
+    static std::string toLower(const std::string &name);
+
     bool hasVariable(const std::string &name);
 
     bool hasConstant(const std::string &name);
@@ -72,21 +146,85 @@ public:
 
     bool hasScript(const std::string &name);
 
+    bool hasDefinition(const std::string &name) const;
+
     void remove(const std::string &name);
 
     const std::map<std::string, int> &getVariableDecimals() const;
 
     const std::map<std::string, int> &getConstantDecimals() const;
 
+    /**
+     * The returned value is unique across all symbol table instances for a given set of symbol definitions,
+     * copies share the version of the original until either one is modified.
+     *
+     * @return The current version of the symbol definitions in this table.
+     */
+    unsigned long getVersion() const;
+
+    /**
+     * The returned value is unique across all symbol table instances,
+     * copies share the revision of the original until either one is modified.
+     *
+     * @return The revision of the current state of this table.
+     */
+    unsigned long getRevision() const;
+
+    /**
+     * Returns the most recent modifications ordered by revision,
+     * each entry contains the revision created by the modification and the name of the modified symbol.
+     *
+     * Only a limited number of modifications is retained,
+     * users which cannot find their last known revision in the log have to compare the whole table.
+     *
+     * @return The recent modifications of this table.
+     */
+    const std::deque<std::pair<unsigned long, std::string>> &getChanges() const;
+
 private:
+    void recordChange(const std::string &name);
+
+    void addName(const std::string &name);
+
+    void removeName(const std::string &name);
+
+    /**
+     * @param name
+     * @return True if a function or script matches the name case insensitively.
+     */
+    bool hasCallable(const std::string &name) const;
+
+    /**
+     * Set the definition of the function and index the symbols it references.
+     */
+    void setFunctionDefinition(const std::string &name, std::shared_ptr<const FunctionDefinition> definition);
+
+    void removeFunctionDefinition(const std::string &name);
+
+    /**
+     * Validate the definitions of the functions which reference the symbol again.
+     */
+    void validateDependents(const std::string &name);
+
     std::map<std::string, ArithmeticType> variables;
     std::map<std::string, ArithmeticType> constants;
     std::map<std::string, Function> functions;
     std::map<std::string, Script> scripts;
+    std::map<std::string, std::shared_ptr<const FunctionDefinition>> functionDefinitions;
+    std::map<std::string, std::string> definitions;
+    std::map<std::string, std::string> rationals;
+
+    std::map<std::string, std::set<std::string>> lowerNames; // The names of all symbols by their lower case name.
+    std::map<std::string, std::set<std::string>> functionReferences; // The functions referencing each lower case symbol name.
 
     //The number of decimal spaces that the user has entered when defining each variable or constant.
     std::map<std::string, int> vDecimals;
     std::map<std::string, int> cDecimals;
+
+    unsigned long version;
+
+    unsigned long revision;
+    std::deque<std::pair<unsigned long, std::string>> changes;
 };
 
 #endif //QCALC_SYMBOLTABLE_HPP
@@ -0,0 +1,188 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "vectorcode.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <cfenv>
+
+// The number of rows evaluated per instruction, the lanes of all operands of a block stay in the cache.
+static const size_t BLOCK_SIZE = 256;
+
+static const VectorKernels *selectKernels() {
+#ifdef QCALC_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return &getAvx512Kernels();
+    if (__builtin_cpu_supports("avx2"))
+        return &getAvx2Kernels();
+#endif
+    return nullptr;
+}
+
+/**
+ * @return The kernels of the best instruction set supported by the processor or nullptr.
+ */
+static const VectorKernels *getKernels() {
+    static const VectorKernels *kernels = selectKernels();
+    return kernels;
+}
+
+std::unique_ptr<VectorCode> VectorCode::compile(const Bytecode<double> &bytecode) {
+    const VectorKernels *kernels = getKernels();
+    if (kernels == nullptr || bytecode.empty())
+        return nullptr;
+
+    std::unique_ptr<VectorCode> ret(new VectorCode(*kernels));
+    ret->instructions = bytecode.getInstructions();
+    ret->operands = bytecode.getOperands();
+    ret->result = bytecode.getResult();
+    ret->written.resize(ret->operands.size(), false);
+    for (auto &instruction : ret->instructions) {
+        ret->written.at(instruction.target) = true;
+
+        VectorKernels::Unary unary = nullptr;
+        if (instruction.op == DoubleBytecode::OP_UNARY) {
+            const char *name = DoubleBytecode::getUnaryFunctions().at(instruction.extra).name;
+            if (std::strcmp(name, "sin") == 0)
+                unary = kernels->sin;
+            else if (std::strcmp(name, "exp") == 0)
+                unary = kernels->exp;
+            else if (std::strcmp(name, "log") == 0)
+                unary = kernels->log;
+        }
+        ret->unaryKernels.emplace_back(unary);
+    }
+    return ret;
+}
+
+bool VectorCode::evaluate(const std::vector<std::pair<const double *, const double *>> &columns,
+                          size_t rows,
+                          std::vector<double> &ret) const {
+    if (std::fegetround() != FE_TONEAREST)
+        return false;
+
+    std::vector<double> lanes(operands.size() * BLOCK_SIZE);
+
+    std::vector<const double *> inputs(operands.size(), nullptr);
+    for (auto &column : columns) {
+        auto it = std::find(operands.begin(), operands.end(), column.first);
+        if (it != operands.end())
+            inputs.at(it - operands.begin()) = column.second;
+    }
+
+    // Literals and the variables which are not bound have the same value in every row.
+    for (size_t i = 0; i < operands.size(); i++) {
+        if (inputs[i] == nullptr && !written[i])
+            std::fill_n(lanes.data() + i * BLOCK_SIZE, BLOCK_SIZE, *operands[i]);
+    }
+
+    ret.resize(rows);
+    for (size_t begin = 0; begin < rows; begin += BLOCK_SIZE) {
+        size_t count = std::min(BLOCK_SIZE, rows - begin);
+        // The lanes after the last row of a partial block keep the values of the previous block.
+        size_t size = (count + kernels.width - 1) / kernels.width * kernels.width;
+
+        for (size_t i = 0; i < operands.size(); i++) {
+            if (inputs[i] != nullptr)
+                std::memcpy(lanes.data() + i * BLOCK_SIZE, inputs[i] + begin, count * sizeof(double));
+        }
+
+        for (size_t i = 0; i < instructions.size(); i++) {
+            execute(i, lanes.data(), size);
+        }
+
+        std::memcpy(ret.data() + begin, lanes.data() + result * BLOCK_SIZE, count * sizeof(double));
+    }
+    return true;
+}
+
+void VectorCode::execute(size_t index, double *lanes, size_t size) const {
+    const DoubleBytecode::Instruction &instruction = instructions[index];
+    double *target = lanes + instruction.target * BLOCK_SIZE;
+    const double *x = lanes + instruction.a * BLOCK_SIZE;
+    const double *y = lanes + instruction.b * BLOCK_SIZE;
+    switch (instruction.op) {
+        case DoubleBytecode::OP_COPY:
+            if (target != x)
+                std::memcpy(target, x, size * sizeof(double));
+            break;
+        case DoubleBytecode::OP_NEG:
+            kernels.negate(target, x, size);
+            break;
+        case DoubleBytecode::OP_ADD:
+            kernels.add(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_SUB:
+            kernels.subtract(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_MUL:
+            kernels.multiply(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_DIV:
+            kernels.divide(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_MOD:
+            for (size_t i = 0; i < size; i++) {
+                target[i] = exprtk::details::numeric::modulus(x[i], y[i]);
+            }
+            break;
+        case DoubleBytecode::OP_POW:
+            kernels.pow(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_IPOW:
+            kernels.power(target, x, size, instruction.extra);
+            break;
+        case DoubleBytecode::OP_IPOWINV:
+            kernels.inversePower(target, x, size, instruction.extra);
+            break;
+        case DoubleBytecode::OP_LT:
+            kernels.less(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_LTE:
+            kernels.lessEqual(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_GT:
+            kernels.greater(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_GTE:
+            kernels.greaterEqual(target, x, y, size);
+            break;
+        case DoubleBytecode::OP_UNARY: {
+            VectorKernels::Unary kernel = unaryKernels[index];
+            if (kernel != nullptr) {
+                kernel(target, x, size);
+            } else {
+                auto function = DoubleBytecode::getUnaryFunctions()[instruction.extra].function;
+                for (size_t i = 0; i < size; i++) {
+                    target[i] = function(x[i]);
+                }
+            }
+            break;
+        }
+        case DoubleBytecode::OP_BINARY: {
+            auto function = DoubleBytecode::getBinaryFunctions()[instruction.extra].function;
+            for (size_t i = 0; i < size; i++) {
+                target[i] = function(x[i], y[i]);
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_VECTORCODE_HPP
+#define QCALC_VECTORCODE_HPP
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+#include "bytecode.hpp"
+#include "vectorkernels.hpp"
+
+/**
+ * Evaluates a double precision Bytecode for many values of its variables using the SIMD kernels
+ * of the best instruction set the processor supports, requires QCALC_SIMD.
+ *
+ * The rows are evaluated in blocks, each instruction is applied to all rows of a block before the next instruction
+ * so that the kernels process one vector of rows at a time.
+ * Operations without a kernel (the modulus and the other built in functions) are applied to each row
+ * using the same functions as the bytecode.
+ *
+ * sin, exp, log and pow may differ from the bytecode by the bounds documented in VectorKernels,
+ * all other operations compute the same values as the bytecode.
+ *
+ * The code references the storage of the bytecode and must not be used after the bytecode is destroyed.
+ */
+class VectorCode {
+public:
+    /**
+     * @param bytecode
+     * @return The vector code or nullptr if the processor does not support any of the instruction sets.
+     */
+    static std::unique_ptr<VectorCode> compile(const Bytecode<double> &bytecode);
+
+    VectorCode(const VectorCode &other) = delete;
+
+    VectorCode &operator=(const VectorCode &other) = delete;
+
+    /**
+     * Evaluate the bytecode for every row of the columns.
+     *
+     * @param columns Pairs of the storage of a variable referenced by the bytecode and its value for each row,
+     * the variables which are not bound keep their current value for all rows.
+     * @param rows
+     * @param ret Set to the value of the bytecode for each row.
+     * @return False if the current rounding mode is not round to nearest which the kernels require.
+     */
+    bool evaluate(const std::vector<std::pair<const double *, const double *>> &columns,
+                  size_t rows,
+                  std::vector<double> &ret) const;
+
+private:
+    typedef Bytecode<double> DoubleBytecode;
+
+    explicit VectorCode(const VectorKernels &kernels) : kernels(kernels) {}
+
+    /**
+     * Apply the instruction to the first size rows of the lanes, which hold one block of rows per operand.
+     */
+    void execute(size_t index, double *lanes, size_t size) const;
+
+    const VectorKernels &kernels;
+    std::vector<DoubleBytecode::Instruction> instructions;
+    std::vector<VectorKernels::Unary> unaryKernels; // The kernel of the unary function of each instruction or nullptr.
+    std::vector<double *> operands;
+    std::vector<bool> written; // True for the operands which are the target of an instruction.
+    uint32_t result = 0;
+};
+
+#endif //QCALC_VECTORCODE_HPP
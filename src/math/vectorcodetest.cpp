@@ -0,0 +1,217 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "vectorcodetest.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#include "bytecode.hpp"
+#include "vectorcode.hpp"
+
+typedef Bytecode<double> DoubleBytecode;
+
+// The bounds documented in VectorKernels.
+static const uint64_t LOG_MAX_ULPS = 1;
+static const uint64_t SIN_EXP_POW_MAX_ULPS = 2;
+
+// Counts around the vector widths and the block size of VectorCode.
+static const size_t ROW_COUNTS[] = {1, 2, 3, 5, 7, 9, 15, 17, 255, 257, 300};
+
+struct TestCase {
+    const char *expression;
+    uint64_t maxUlps;
+};
+
+static const TestCase TEST_CASES[] = {
+        {"-x",                                 0},
+        {"x + y",                              0},
+        {"x - y",                              0},
+        {"x * y",                              0},
+        {"x / y",                              0},
+        {"x % y",                              0},
+        {"x < y",                              0},
+        {"x <= y",                             0},
+        {"x > y",                              0},
+        {"x >= y",                             0},
+        {"x ^ 2",                              0},
+        {"x ^ 7",                              0},
+        {"x ^ 13",                             0},
+        {"x ^ -3",                             0},
+        {"x ^ -60",                            0},
+        // Functions without a kernel are applied row by row with the functions of the bytecode.
+        {"cos(x)",                             0},
+        {"atan2(x, y)",                        0},
+        {"~{var a := x * y; a - x / (a + 1)}", 0},
+        {"log(x)",                             LOG_MAX_ULPS},
+        {"sin(x)",                             SIN_EXP_POW_MAX_ULPS},
+        {"exp(x)",                             SIN_EXP_POW_MAX_ULPS},
+        {"x ^ y",                              SIN_EXP_POW_MAX_ULPS}
+};
+
+static std::vector<double> getEdgeInputs() {
+    const double pi = 3.14159265358979323846;
+    std::vector<double> ret{
+            0.0,
+            -0.0,
+            std::numeric_limits<double>::denorm_min(),
+            -std::numeric_limits<double>::denorm_min(),
+            std::numeric_limits<double>::min() / 3,
+            std::numeric_limits<double>::min(),
+            1.0,
+            -1.0,
+            std::nextafter(1.0, 2.0),
+            std::nextafter(1.0, 0.0),
+            0.5,
+            2.0,
+            -3.0,
+            0.1,
+            10.0,
+            -708.5,
+            709.5,
+            -745.0,
+            710.0,
+            0x1p28,
+            0x1p28 + 1,
+            1e10,
+            1e300,
+            -1e300,
+            std::numeric_limits<double>::max(),
+            std::numeric_limits<double>::infinity(),
+            -std::numeric_limits<double>::infinity(),
+            std::numeric_limits<double>::quiet_NaN()
+    };
+    // The arguments of sin close to non zero multiples of pi, where the reduction loses precision.
+    for (double k : {0.5, 1.0, 2.0, 3.0, 10.0, 100.0, 1000.0, 1e5}) {
+        double v = k * pi;
+        ret.emplace_back(v);
+        ret.emplace_back(std::nextafter(v, 0.0));
+        ret.emplace_back(std::nextafter(v, v * 2));
+        ret.emplace_back(-v);
+    }
+    return ret;
+}
+
+/**
+ * @return The number of representable doubles between the values, 0 for two NaNs.
+ */
+static uint64_t getUlpDistance(double a, double b) {
+    if (std::isnan(a) || std::isnan(b))
+        return std::isnan(a) && std::isnan(b) ? 0 : std::numeric_limits<uint64_t>::max();
+    int64_t ia;
+    int64_t ib;
+    std::memcpy(&ia, &a, sizeof(double));
+    std::memcpy(&ib, &b, sizeof(double));
+    // Map the bits of negative values so that the integers are ordered like the values, both zeros map to 0.
+    if (ia < 0)
+        ia = std::numeric_limits<int64_t>::min() - ia;
+    if (ib < 0)
+        ib = std::numeric_limits<int64_t>::min() - ib;
+    return ia > ib ? static_cast<uint64_t>(ia) - static_cast<uint64_t>(ib)
+                   : static_cast<uint64_t>(ib) - static_cast<uint64_t>(ia);
+}
+
+static std::string toString(double v) {
+    std::ostringstream stream;
+    stream << std::hexfloat << v;
+    return stream.str();
+}
+
+/**
+ * Compare the rows of the columns, appends at most one failure per expression and row count.
+ */
+static void compareRows(const TestCase &testCase,
+                        DoubleBytecode &bytecode,
+                        const VectorCode &vectorCode,
+                        double &x,
+                        double &y,
+                        const std::vector<double> &xs,
+                        const std::vector<double> &ys,
+                        std::vector<std::string> &failures) {
+    std::vector<double> actual;
+    if (!vectorCode.evaluate({{&x, xs.data()}, {&y, ys.data()}}, xs.size(), actual)) {
+        failures.emplace_back("VectorCode: Failed to evaluate " + std::string(testCase.expression));
+        return;
+    }
+    for (size_t row = 0; row < xs.size(); row++) {
+        x = xs[row];
+        y = ys[row];
+        double expected = bytecode.evaluate();
+        if (getUlpDistance(expected, actual.at(row)) > testCase.maxUlps) {
+            failures.emplace_back("VectorCode: " + std::string(testCase.expression)
+                                  + " with x = " + toString(xs[row]) + ", y = " + toString(ys[row])
+                                  + " in row " + std::to_string(row) + " of " + std::to_string(xs.size())
+                                  + " returned " + toString(actual.at(row))
+                                  + " instead of " + toString(expected));
+            return;
+        }
+    }
+}
+
+bool VectorCodeTest::compareWithBytecode(std::vector<std::string> &failures) {
+    size_t failureCount = failures.size();
+
+    double x = 0;
+    double y = 0;
+    exprtk::symbol_table<double> symbols;
+    symbols.add_variable("x", x);
+    symbols.add_variable("y", y);
+
+    std::vector<double> inputs = getEdgeInputs();
+
+    for (auto &testCase : TEST_CASES) {
+        DoubleBytecode bytecode;
+        if (!DoubleBytecode::lower(testCase.expression, symbols, bytecode)) {
+            failures.emplace_back("VectorCode: Failed to lower " + std::string(testCase.expression));
+            continue;
+        }
+
+        auto vectorCode = VectorCode::compile(bytecode);
+        if (!vectorCode)
+            return failures.size() == failureCount;
+
+        // Every pair of inputs.
+        std::vector<double> xs;
+        std::vector<double> ys;
+        for (double a : inputs) {
+            for (double b : inputs) {
+                xs.emplace_back(a);
+                ys.emplace_back(b);
+            }
+        }
+        compareRows(testCase, bytecode, *vectorCode, x, y, xs, ys, failures);
+
+        // Partial vectors and blocks, the lanes after the last row hold the values of the previous evaluation.
+        for (size_t rows : ROW_COUNTS) {
+            xs.clear();
+            ys.clear();
+            for (size_t row = 0; row < rows; row++) {
+                xs.emplace_back(inputs[(row * 5 + rows) % inputs.size()]);
+                ys.emplace_back(inputs[(row * 7 + 3) % inputs.size()]);
+            }
+            compareRows(testCase, bytecode, *vectorCode, x, y, xs, ys, failures);
+        }
+    }
+
+    return failures.size() == failureCount;
+}
@@ -0,0 +1,44 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_VECTORCODETEST_HPP
+#define QCALC_VECTORCODETEST_HPP
+
+#include <string>
+#include <vector>
+
+/**
+ * Differential check of the VectorCode evaluation against the Bytecode interpreter.
+ */
+namespace VectorCodeTest {
+    /**
+     * Evaluate expressions with VectorCode::evaluate and with Bytecode::evaluate row by row
+     * over edge inputs (signed zeros, subnormals, infinities, NaN, the limits of exp, arguments of sin near multiples of pi
+     * and very large values) and row counts which are not a multiple of the vector width or of the block size.
+     *
+     * sin, exp, log and pow have to be within the ULP bounds documented in VectorKernels,
+     * all other operations have to be identical bit for bit, except that any two NaNs are considered identical.
+     *
+     * @param failures Appended with a description of every expression and input whose results differ.
+     * @return True if all results are within the bounds or the processor does not support the kernels.
+     */
+    bool compareWithBytecode(std::vector<std::string> &failures);
+}
+
+#endif //QCALC_VECTORCODETEST_HPP
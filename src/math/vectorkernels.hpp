@@ -0,0 +1,79 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_VECTORKERNELS_HPP
+#define QCALC_VECTORKERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The SIMD kernels of one instruction set, each kernel applies one operation to arrays of doubles.
+ *
+ * The size of the arrays passed to a kernel must be a multiple of the width, the result may alias the arguments.
+ *
+ * The arithmetic operations, the comparisons and the integer powers compute the same values as the scalar operations
+ * of the Bytecode. sin, exp, log and pow are evaluated by polynomial approximations which require the round to nearest mode,
+ * compared to the C library log is at most 1 ULP and sin, exp and pow are at most 2 ULP off.
+ * Arguments outside of the ranges of the approximations (eg. subnormal, non finite or very large arguments
+ * and arguments of sin close to a non zero multiple of pi) are passed to the C library.
+ */
+struct VectorKernels {
+    typedef void (*Unary)(double *ret, const double *x, size_t size);
+
+    typedef void (*Binary)(double *ret, const double *x, const double *y, size_t size);
+
+    typedef void (*Power)(double *ret, const double *x, size_t size, uint32_t exponent);
+
+    const char *name;
+    size_t width;
+
+    Unary negate;
+    Binary add;
+    Binary subtract;
+    Binary multiply;
+    Binary divide;
+    Binary less;
+    Binary lessEqual;
+    Binary greater;
+    Binary greaterEqual;
+    Power power;
+    Power inversePower;
+
+    Unary sin;
+    Unary exp;
+    Unary log;
+    Binary pow;
+};
+
+#ifdef QCALC_SIMD
+
+/**
+ * Only available if the processor supports AVX2.
+ */
+const VectorKernels &getAvx2Kernels();
+
+/**
+ * Only available if the processor supports AVX-512F.
+ */
+const VectorKernels &getAvx512Kernels();
+
+#endif
+
+#endif //QCALC_VECTORKERNELS_HPP
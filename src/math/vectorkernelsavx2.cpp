@@ -0,0 +1,34 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "vectorkernels.hpp"
+
+#ifdef QCALC_SIMD
+
+// This file is compiled with the AVX2 flags, see CMakeLists.txt.
+#define QCALC_VECTOR_WIDTH 4
+
+#include "vectorkernelsimpl.hpp"
+
+const VectorKernels &getAvx2Kernels() {
+    static const VectorKernels kernels = createKernels("AVX2");
+    return kernels;
+}
+
+#endif
@@ -0,0 +1,513 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_VECTORKERNELSIMPL_HPP
+#define QCALC_VECTORKERNELSIMPL_HPP
+
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <cstdint>
+
+#include "vectorkernels.hpp"
+
+#ifndef QCALC_VECTOR_WIDTH
+#error "QCALC_VECTOR_WIDTH has to be defined before including vectorkernelsimpl.hpp"
+#endif
+
+/**
+ * The kernels for vectors of QCALC_VECTOR_WIDTH doubles, written with the vector extensions of GCC and Clang.
+ *
+ * Included by one translation unit per instruction set which is compiled with the flags of the instruction set.
+ * Everything is defined in an anonymous namespace so that the linker never substitutes the code
+ * compiled for one instruction set for the code of another one.
+ *
+ * The approximations of sin and exp are the ones of the Cephes library,
+ * log is evaluated as a double double so that pow can be computed as exp(y * log(x)) without losing precision.
+ */
+namespace {
+    const size_t WIDTH = QCALC_VECTOR_WIDTH;
+
+    typedef double Vector __attribute__((vector_size(QCALC_VECTOR_WIDTH * sizeof(double))));
+    typedef int64_t Integer __attribute__((vector_size(QCALC_VECTOR_WIDTH * sizeof(int64_t))));
+
+    // Adding 2^52 + 2^51 to a value below 2^51 rounds it to an integer which is stored in the low bits of the mantissa.
+    const double ROUND_MAGIC = 6755399441055744.0;
+
+    const int64_t SIGN_BIT = INT64_MIN;
+    const int64_t MANTISSA_BITS = 0x000FFFFFFFFFFFFFll;
+    const int64_t EXPONENT_ONE = 0x3FF0000000000000ll;
+
+    const double LOG2E = 1.44269504088896340736;
+    const double LN2_HI = 6.93147180559945286227e-01;
+    const double LN2_LO = 2.31904681384629955842e-17;
+    const double SQRT2 = 1.41421356237309504880;
+    const double TWO_THIRDS_HI = 6.66666666666666629659e-01;
+    const double TWO_THIRDS_LO = 3.70074341541718826215e-17;
+
+    // Cephes exp, the results within the range are normal numbers.
+    const double EXP_MIN = -708.0;
+    const double EXP_MAX = 709.0;
+    const double EXP_C1 = 6.93145751953125e-1;
+    const double EXP_C2 = 1.42860682030941723212e-6;
+    const double EXP_P[] = {1.26177193074810590878e-4,
+                            3.02994407707441961300e-2,
+                            9.99999999999999999910e-1};
+    const double EXP_Q[] = {3.00198505138664455042e-6,
+                            2.52448340349684104192e-3,
+                            2.27265548208155028766e-1,
+                            2.00000000000000000009e0};
+
+    // The coefficients 1 / (2k + 1) of the series of atanh for k = 12 to 2.
+    const double LOG_TAIL[] = {1.0 / 25, 1.0 / 23, 1.0 / 21, 1.0 / 19, 1.0 / 17, 1.0 / 15,
+                               1.0 / 13, 1.0 / 11, 1.0 / 9, 1.0 / 7, 1.0 / 5};
+
+    // pow with larger exponents is passed to the C library, the split of the exponent would overflow.
+    const double POW_MAX_EXPONENT = 0x1p900;
+
+    // Cephes sin, the reduction by pi / 4 is exact up to SIN_MAX.
+    const double SIN_MAX = 0x1p28;
+    const double SIN_FOUR_OVER_PI = 1.27323954473516268615;
+    const double SIN_DP1 = 7.85398125648498535156e-1;
+    const double SIN_DP2 = 3.77489470793079817668e-8;
+    const double SIN_DP3 = 2.69515142907905952645e-15;
+    // Reduced arguments below this fraction of the multiple of pi / 4 are not precise enough.
+    const double SIN_MIN_REDUCED = 0x1p-40;
+    const double SIN_S[] = {1.58962301576546568060e-10,
+                            -2.50507477628578072866e-8,
+                            2.75573136213857245213e-6,
+                            -1.98412698295895385996e-4,
+                            8.33333333332211858878e-3,
+                            -1.66666666666666307295e-1};
+    const double SIN_C[] = {-1.13585365213876817300e-11,
+                            2.08757008419747316778e-9,
+                            -2.75573141792967388112e-7,
+                            2.48015872888517045348e-5,
+                            -1.38888888888730564116e-3,
+                            4.16666666666665929218e-2};
+
+    inline Vector load(const double *values) {
+        Vector ret;
+        std::memcpy(&ret, values, sizeof(ret));
+        return ret;
+    }
+
+    inline void store(double *values, Vector v) {
+        std::memcpy(values, &v, sizeof(v));
+    }
+
+    inline Vector broadcast(double value) {
+        Vector ret;
+        for (size_t i = 0; i < WIDTH; i++) {
+            ret[i] = value;
+        }
+        return ret;
+    }
+
+    // Casts between vectors of the same size reinterpret the bits.
+    inline Integer toBits(Vector v) {
+        return (Integer) v;
+    }
+
+    inline Vector fromBits(Integer v) {
+        return (Vector) v;
+    }
+
+    inline Vector select(Integer mask, Vector a, Vector b) {
+        return fromBits((toBits(a) & mask) | (toBits(b) & ~mask));
+    }
+
+    inline bool all(Integer mask) {
+        for (size_t i = 0; i < WIDTH; i++) {
+            if (mask[i] == 0)
+                return false;
+        }
+        return true;
+    }
+
+    inline Vector abs(Vector v) {
+        return fromBits(toBits(v) & ~SIGN_BIT);
+    }
+
+    // Requires |v| < 2^51.
+    inline Vector roundToInteger(Vector v) {
+        return (v + ROUND_MAGIC) - ROUND_MAGIC;
+    }
+
+    inline Vector floor(Vector v) {
+        Vector ret = roundToInteger(v);
+        return ret - select(ret > v, broadcast(1.0), broadcast(0.0));
+    }
+
+    // Requires an integral v with |v| < 2^51.
+    inline Integer toInteger(Vector v) {
+        return toBits(v + ROUND_MAGIC) - toBits(broadcast(ROUND_MAGIC));
+    }
+
+    // Requires |v| < 2^51.
+    inline Vector toVector(Integer v) {
+        return fromBits(v + toBits(broadcast(ROUND_MAGIC))) - ROUND_MAGIC;
+    }
+
+    // 2^n for -1022 <= n <= 1023.
+    inline Vector exp2(Integer n) {
+        return fromBits((n + 1023) << 52);
+    }
+
+    template<size_t N>
+    inline Vector polynomial(Vector x, const double (&coefficients)[N]) {
+        Vector ret = broadcast(coefficients[0]);
+        for (size_t i = 1; i < N; i++) {
+            ret = ret * x + coefficients[i];
+        }
+        return ret;
+    }
+
+    /**
+     * Error free transformations, the same as in MultiDouble.
+     */
+
+    inline Vector quickTwoSum(Vector a, Vector b, Vector &err) {
+        // Requires |a| >= |b|
+        Vector s = a + b;
+        err = b - (s - a);
+        return s;
+    }
+
+    inline Vector twoSum(Vector a, Vector b, Vector &err) {
+        Vector s = a + b;
+        Vector bb = s - a;
+        err = (a - (s - bb)) + (b - bb);
+        return s;
+    }
+
+    inline Vector twoProd(Vector a, Vector b, Vector &err) {
+        const double splitter = 134217729.0; // 2^27 + 1
+        Vector p = a * b;
+        Vector t = splitter * a;
+        Vector ah = t - (t - a);
+        Vector al = a - ah;
+        t = splitter * b;
+        Vector bh = t - (t - b);
+        Vector bl = b - bh;
+        err = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+        return p;
+    }
+
+    /**
+     * Evaluate the function for the lanes which are not valid.
+     */
+    template<typename F>
+    inline Vector fallback(Vector ret, Integer valid, Vector x, F function) {
+        if (!all(valid)) {
+            for (size_t i = 0; i < WIDTH; i++) {
+                if (valid[i] == 0)
+                    ret[i] = function(x[i]);
+            }
+        }
+        return ret;
+    }
+
+    template<typename F>
+    inline Vector fallback(Vector ret, Integer valid, Vector x, Vector y, F function) {
+        if (!all(valid)) {
+            for (size_t i = 0; i < WIDTH; i++) {
+                if (valid[i] == 0)
+                    ret[i] = function(x[i], y[i]);
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * exp(hi + lo) for hi in [EXP_MIN, EXP_MAX] and |lo| much smaller than the unit in the last place of hi.
+     */
+    inline Vector expCore(Vector hi, Vector lo) {
+        Vector n = roundToInteger(hi * LOG2E);
+        Vector r = hi - n * EXP_C1;
+        r = r - n * EXP_C2;
+        r = r + lo;
+
+        // exp(r) = 1 + 2r P(r^2) / (Q(r^2) - r P(r^2))
+        Vector rr = r * r;
+        Vector p = r * polynomial(rr, EXP_P);
+        Vector ret = 1.0 + 2.0 * (p / (polynomial(rr, EXP_Q) - p));
+
+        return ret * exp2(toInteger(n));
+    }
+
+    /**
+     * log(x) as the double double hi + lo for normal positive x.
+     */
+    inline Vector logCore(Vector x, Vector &lo) {
+        // x = m 2^e with sqrt(2) / 2 < m <= sqrt(2)
+        Integer bits = toBits(x);
+        Integer e = ((bits >> 52) & 0x7FF) - 1023;
+        Vector m = fromBits((bits & MANTISSA_BITS) | EXPONENT_ONE);
+        Integer large = m > SQRT2;
+        m = select(large, m * 0.5, m);
+        e = e - large;
+
+        // log(m) = 2 atanh(s) = 2 (s + s^3 / 3 + s^5 / 5 + ...) with s = (m - 1) / (m + 1)
+        Vector dErr;
+        Vector d = twoSum(m, broadcast(1.0), dErr);
+        Vector n = m - 1.0;
+        Vector s = n / d;
+        Vector pErr;
+        Vector p = twoProd(s, d, pErr);
+        Vector sErr = (((n - p) - pErr) - s * dErr) / d;
+
+        Vector s2Err;
+        Vector s2 = twoProd(s, s, s2Err);
+        s2Err += 2.0 * s * sErr;
+        Vector s3Err;
+        Vector s3 = twoProd(s2, s, s3Err);
+        s3Err += s2 * sErr + s2Err * s;
+
+        Vector tErr;
+        Vector t = twoProd(s3, broadcast(TWO_THIRDS_HI), tErr);
+        tErr += s3 * TWO_THIRDS_LO + s3Err * TWO_THIRDS_HI;
+
+        Vector tail = 2.0 * s3 * s2 * polynomial(s2, LOG_TAIL);
+
+        Vector fe = toVector(e);
+        Vector eErr;
+        Vector el = twoProd(fe, broadcast(LN2_HI), eErr);
+        eErr += fe * LN2_LO;
+
+        Vector err;
+        Vector sum = twoSum(el, 2.0 * s, err);
+        err += eErr + 2.0 * sErr;
+        Vector sumErr;
+        sum = twoSum(sum, t, sumErr);
+        err += sumErr + tErr + tail;
+
+        return quickTwoSum(sum, err, lo);
+    }
+
+    void negateKernel(double *ret, const double *x, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, -load(x + i));
+        }
+    }
+
+    void addKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, load(x + i) + load(y + i));
+        }
+    }
+
+    void subtractKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, load(x + i) - load(y + i));
+        }
+    }
+
+    void multiplyKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, load(x + i) * load(y + i));
+        }
+    }
+
+    void divideKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, load(x + i) / load(y + i));
+        }
+    }
+
+    // The comparisons are false if an operand is NaN.
+
+    void lessKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, fromBits((load(x + i) < load(y + i)) & toBits(broadcast(1.0))));
+        }
+    }
+
+    void lessEqualKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, fromBits((load(x + i) <= load(y + i)) & toBits(broadcast(1.0))));
+        }
+    }
+
+    void greaterKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, fromBits((load(x + i) > load(y + i)) & toBits(broadcast(1.0))));
+        }
+    }
+
+    void greaterEqualKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, fromBits((load(x + i) >= load(y + i)) & toBits(broadcast(1.0))));
+        }
+    }
+
+    /**
+     * Same multiplications as Bytecode::power.
+     */
+    inline Vector power(Vector v, uint32_t p) {
+        switch (p) {
+            case 0:
+                return broadcast(1.0);
+            case 1:
+                return v;
+            case 2:
+                return v * v;
+            case 3:
+                return v * v * v;
+            case 4: {
+                Vector v2 = v * v;
+                return v2 * v2;
+            }
+            case 5:
+                return power(v, 4) * v;
+            case 6: {
+                Vector v3 = power(v, 3);
+                return v3 * v3;
+            }
+            case 7:
+                return power(v, 6) * v;
+            case 8: {
+                Vector v4 = power(v, 4);
+                return v4 * v4;
+            }
+            case 9:
+                return power(v, 8) * v;
+            case 10: {
+                Vector v5 = power(v, 5);
+                return v5 * v5;
+            }
+            default: {
+                Vector l = broadcast(1.0);
+                Vector b = v;
+                while (p) {
+                    if (p & 1u) {
+                        l *= b;
+                        --p;
+                    }
+                    b *= b;
+                    p >>= 1u;
+                }
+                return l;
+            }
+        }
+    }
+
+    void powerKernel(double *ret, const double *x, size_t size, uint32_t exponent) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, power(load(x + i), exponent));
+        }
+    }
+
+    void inversePowerKernel(double *ret, const double *x, size_t size, uint32_t exponent) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            store(ret + i, 1.0 / power(load(x + i), exponent));
+        }
+    }
+
+    void sinKernel(double *ret, const double *x, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            Vector v = load(x + i);
+            Integer sign = toBits(v) & SIGN_BIT;
+            Vector a = abs(v);
+
+            // The octant j of the argument, odd octants are mapped to the next even one.
+            Vector y = floor(a * SIN_FOUR_OVER_PI);
+            Integer j = toInteger(y);
+            Integer odd = j & 1;
+            j = (j + odd) & 7;
+            y = y + toVector(odd);
+            Integer reflect = j > 3;
+            sign ^= reflect & SIGN_BIT;
+            j -= reflect & 4;
+
+            // Extended precision reduction by pi / 4.
+            Vector z = ((a - y * SIN_DP1) - y * SIN_DP2) - y * SIN_DP3;
+            Vector zz = z * z;
+            Vector s = z + z * (zz * polynomial(zz, SIN_S));
+            Vector c = 1.0 - 0.5 * zz + zz * zz * polynomial(zz, SIN_C);
+            Vector r = fromBits(toBits(select((j == 1) | (j == 2), c, s)) ^ sign);
+
+            Integer valid = (a <= SIN_MAX) & (abs(z) >= y * SIN_MIN_REDUCED);
+            store(ret + i, fallback(r, valid, v, [](double value) { return std::sin(value); }));
+        }
+    }
+
+    void expKernel(double *ret, const double *x, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            Vector v = load(x + i);
+            Integer valid = (v >= EXP_MIN) & (v <= EXP_MAX);
+            Vector r = expCore(select(valid, v, broadcast(0.0)), broadcast(0.0));
+            store(ret + i, fallback(r, valid, v, [](double value) { return std::exp(value); }));
+        }
+    }
+
+    void logKernel(double *ret, const double *x, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            Vector v = load(x + i);
+            Integer valid = (v >= DBL_MIN) & (v <= DBL_MAX);
+            Vector lo;
+            Vector r = logCore(select(valid, v, broadcast(1.0)), lo);
+            store(ret + i, fallback(r, valid, v, [](double value) { return std::log(value); }));
+        }
+    }
+
+    void powKernel(double *ret, const double *x, const double *y, size_t size) {
+        for (size_t i = 0; i < size; i += WIDTH) {
+            Vector v = load(x + i);
+            Vector w = load(y + i);
+            Integer valid = (v >= DBL_MIN) & (v <= DBL_MAX) & (abs(w) <= POW_MAX_EXPONENT);
+            w = select(valid, w, broadcast(0.0));
+
+            // x^y = exp(y log(x)), the product is computed as a double double.
+            Vector logLo;
+            Vector logHi = logCore(select(valid, v, broadcast(1.0)), logLo);
+            Vector productErr;
+            Vector product = twoProd(w, logHi, productErr);
+            productErr += w * logLo;
+            Vector lo;
+            Vector hi = quickTwoSum(product, productErr, lo);
+
+            valid &= (hi >= EXP_MIN) & (hi <= EXP_MAX);
+            Vector r = expCore(select(valid, hi, broadcast(0.0)), select(valid, lo, broadcast(0.0)));
+            store(ret + i, fallback(r, valid, v, load(y + i), [](double a, double b) { return std::pow(a, b); }));
+        }
+    }
+
+    VectorKernels createKernels(const char *name) {
+        return {name,
+                WIDTH,
+                &negateKernel,
+                &addKernel,
+                &subtractKernel,
+                &multiplyKernel,
+                &divideKernel,
+                &lessKernel,
+                &lessEqualKernel,
+                &greaterKernel,
+                &greaterEqualKernel,
+                &powerKernel,
+                &inversePowerKernel,
+                &sinKernel,
+                &expKernel,
+                &logKernel,
+                &powKernel};
+    }
+}
+
+#endif //QCALC_VECTORKERNELSIMPL_HPP
@@ -0,0 +1,78 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "workerpool.hpp"
+
+static thread_local bool worker = false;
+
+WorkerPool &WorkerPool::getInstance() {
+    static WorkerPool pool;
+    return pool;
+}
+
+bool WorkerPool::isWorker() {
+    return worker;
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::run(size_t count, const std::function<void(size_t)> &task) {
+    Batch batch{&task, count - 1};
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        while (threads.size() < count - 1) {
+            threads.emplace_back([this]() { work(); });
+        }
+        for (size_t i = 1; i < count; i++) {
+            queue.emplace_back(&batch, i);
+        }
+    }
+    wakeup.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&batch]() { return batch.remaining == 0; });
+}
+
+void WorkerPool::work() {
+    worker = true;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeup.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty())
+            return;
+        std::pair<Batch *, size_t> item = queue.front();
+        queue.pop_front();
+        lock.unlock();
+        (*item.first->task)(item.second);
+        lock.lock();
+        if (--item.first->remaining == 0)
+            finished.notify_all();
+    }
+}
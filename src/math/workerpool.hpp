@@ -0,0 +1,83 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_WORKERPOOL_HPP
+#define QCALC_WORKERPOOL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <utility>
+
+/**
+ * Persistent worker threads for the parallel evaluations (eg. batches and recomputations of definitions).
+ *
+ * The threads are started when they are first needed and live until the program exits,
+ * so that their thread local engines keep the compiled expressions between parallel evaluations.
+ */
+class WorkerPool {
+public:
+    static WorkerPool &getInstance();
+
+    /**
+     * @return True if the calling thread is a worker of the pool.
+     * Parallel evaluations started by a worker should run serially because the workers may all be busy.
+     */
+    static bool isWorker();
+
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &other) = delete;
+
+    WorkerPool &operator=(const WorkerPool &other) = delete;
+
+    /**
+     * Invoke the task with the indices 1 to count - 1 on the workers and with the index 0 on the calling thread
+     * and wait until all invocations returned.
+     *
+     * The task must not throw.
+     *
+     * @param count
+     * @param task
+     */
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+private:
+    struct Batch {
+        const std::function<void(size_t)> *task;
+        size_t remaining;
+    };
+
+    WorkerPool() = default;
+
+    void work();
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable finished;
+    std::deque<std::pair<Batch *, size_t>> queue;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+};
+
+#endif //QCALC_WORKERPOOL_HPP
@@ -0,0 +1,233 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "worksheet.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+
+#include "evaluationengine.hpp"
+#include "evaluationcontext.hpp"
+#include "evaluationguard.hpp"
+#include "expressionsymbols.hpp"
+
+// The minimum number of compiled expressions kept by the engine, the capacity grows with the number of cells.
+static const size_t MIN_CACHE_CAPACITY = 10;
+
+static bool isBlank(const std::string &expression) {
+    return expression.find_first_not_of(" \t\n\r\f\v") == std::string::npos;
+}
+
+Worksheet::Worksheet(const SymbolTable &symbolTable)
+        : symbolTable(symbolTable),
+          table(symbolTable),
+          engine(std::make_unique<EvaluationEngine<ArithmeticType>>(MIN_CACHE_CAPACITY)) {}
+
+Worksheet::~Worksheet() = default;
+
+size_t Worksheet::size() const {
+    return cells.size();
+}
+
+const Worksheet::Cell &Worksheet::getCell(size_t index) const {
+    return cells.at(index).cell;
+}
+
+void Worksheet::insertCell(size_t index, const std::string &expression) {
+    if (index > cells.size())
+        throw std::runtime_error("Invalid cell index");
+    CellState state;
+    state.cell.expression = expression;
+    cells.insert(cells.begin() + index, std::move(state));
+}
+
+void Worksheet::appendCell(const std::string &expression) {
+    insertCell(cells.size(), expression);
+}
+
+void Worksheet::setCell(size_t index, const std::string &expression) {
+    auto &state = cells.at(index);
+    if (state.cell.expression == expression)
+        return;
+    state.cell.expression = expression;
+    state.modified = true;
+}
+
+void Worksheet::removeCell(size_t index) {
+    CellState removed = std::move(cells.at(index));
+    cells.erase(cells.begin() + index);
+
+    // The cells which read the variables assigned by the removed cell now see the values of the preceding cells.
+    for (size_t i = index; i < cells.size(); i++) {
+        auto &state = cells.at(i);
+        for (auto &output : removed.outputs) {
+            if (state.reads.find(output.first) != state.reads.end()) {
+                state.modified = true;
+                break;
+            }
+        }
+    }
+}
+
+void Worksheet::setSymbolTable(const SymbolTable &symbolTableArg) {
+    symbolTable = symbolTableArg;
+    table = symbolTableArg;
+    for (auto &state : cells) {
+        state.modified = true;
+    }
+}
+
+const SymbolTable &Worksheet::getSymbolTable() const {
+    return table;
+}
+
+std::vector<size_t> Worksheet::recompute(const EvaluationBudget &budget, const CancellationToken &token) {
+    // Evaluate with the precision and rounding mode of the current context, even if the context is modified by a script.
+    ScopedEvaluationContext scope(EvaluationContext::getCurrent());
+
+    EvaluationGuard guard(budget, token);
+
+    engine->setCacheCapacity(std::max(cells.size(), MIN_CACHE_CAPACITY));
+
+    std::vector<size_t> ret;
+
+    // The variables whose value as seen by the current cell differs from the previous recomputation.
+    std::set<std::string> changed;
+
+    // The values assigned by the preceding cells.
+    std::map<std::string, ArithmeticType> values;
+
+    auto setValue = [this](const std::string &name, const ArithmeticType &value) {
+        auto it = table.getVariables().find(name);
+        if (it != table.getVariables().end() && it->second != value)
+            table.setVariable(name, value, table.getVariableDecimals().at(name));
+    };
+
+    // Leave the table in the state after the last cell.
+    auto finish = [&]() {
+        for (auto &variable : table.getVariables()) {
+            auto it = values.find(variable.first);
+            setValue(variable.first, it == values.end() ? getInitialValue(variable.first) : it->second);
+        }
+    };
+
+    for (size_t i = 0; i < cells.size(); i++) {
+        auto &state = cells.at(i);
+
+        bool affected = state.modified;
+        for (auto it = state.reads.begin(); !affected && it != state.reads.end(); it++) {
+            affected = changed.find(*it) != changed.end();
+        }
+
+        if (affected) {
+            auto previous = std::move(state.outputs);
+            state.outputs.clear();
+
+            try {
+                evaluateCell(state, values);
+                guard.checkLimits();
+                if (token.isCancelled())
+                    throw std::runtime_error("Evaluation cancelled");
+            } catch (...) {
+                // The changes of this recomputation are lost, the remaining cells have to be evaluated again.
+                for (size_t n = i; n < cells.size(); n++) {
+                    cells.at(n).modified = true;
+                }
+                finish();
+                throw;
+            }
+
+            ret.emplace_back(i);
+
+            for (auto &output : state.outputs) {
+                auto it = previous.find(output.first);
+                if (it == previous.end() || it->second != output.second)
+                    changed.insert(output.first);
+                else
+                    changed.erase(output.first);
+            }
+            for (auto &output : previous) {
+                if (state.outputs.find(output.first) == state.outputs.end())
+                    changed.insert(output.first);
+            }
+        } else {
+            for (auto &output : state.outputs) {
+                changed.erase(output.first);
+            }
+        }
+
+        for (auto &output : state.outputs) {
+            values[output.first] = output.second;
+        }
+    }
+
+    finish();
+
+    return ret;
+}
+
+ArithmeticType Worksheet::getInitialValue(const std::string &name) const {
+    auto it = symbolTable.getVariables().find(name);
+    if (it == symbolTable.getVariables().end())
+        return 0;
+    return it->second;
+}
+
+void Worksheet::evaluateCell(CellState &state, const std::map<std::string, ArithmeticType> &values) {
+    state.modified = false;
+    state.cell.value = 0;
+    state.cell.error.clear();
+
+    if (isBlank(state.cell.expression)) {
+        state.reads.clear();
+        state.writes.clear();
+        return;
+    }
+
+    state.writes = ExpressionSymbols::getAssignments(state.cell.expression, table);
+    for (auto &name : state.writes) {
+        if (!table.hasVariable(name))
+            table.setVariable(name, 0, -1);
+    }
+
+    state.reads.clear();
+    for (auto &name : ExpressionSymbols::getReferences(state.cell.expression, table)) {
+        if (table.hasVariable(name))
+            state.reads.insert(name);
+    }
+
+    // Restore the values of the used variables as assigned by the preceding cells.
+    for (auto &name : state.reads) {
+        auto it = values.find(name);
+        ArithmeticType value = it == values.end() ? getInitialValue(name) : it->second;
+        if (table.getVariables().at(name) != value)
+            table.setVariable(name, value, table.getVariableDecimals().at(name));
+    }
+
+    try {
+        state.cell.value = engine->evaluate(state.cell.expression, table);
+    } catch (const std::exception &e) {
+        state.cell.error = e.what();
+        return;
+    }
+
+    for (auto &name : state.writes) {
+        state.outputs[name] = table.getVariables().at(name);
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_WORKSHEET_HPP
+#define QCALC_WORKSHEET_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+
+#include "symboltable.hpp"
+#include "arithmetictype.hpp"
+#include "evaluationbudget.hpp"
+#include "cancellationtoken.hpp"
+
+template<typename T>
+class EvaluationEngine;
+
+/**
+ * A worksheet is a document of ordered cells, each cell contains an expression which may assign variables.
+ *
+ * The cells are evaluated in order, each cell sees the variables of the symbol table
+ * with the values assigned by the preceding cells.
+ * Variables which are assigned by a cell but are not defined in the symbol table are defined by the worksheet.
+ *
+ * Modifying a cell only marks it as modified, recompute() evaluates the modified cells
+ * and the cells which read a variable whose value has changed as a result.
+ * The other cells keep their results, the compiled expressions are kept by the evaluation engine of the worksheet.
+ *
+ * A worksheet is not thread safe but may be used from different threads one at a time.
+ */
+class Worksheet {
+public:
+    struct Cell {
+        std::string expression;
+        ArithmeticType value;
+        std::string error; // The error message if the evaluation of the cell failed, otherwise empty.
+    };
+
+    explicit Worksheet(const SymbolTable &symbolTable = SymbolTable());
+
+    ~Worksheet();
+
+    Worksheet(const Worksheet &other) = delete;
+
+    Worksheet &operator=(const Worksheet &other) = delete;
+
+    size_t size() const;
+
+    const Cell &getCell(size_t index) const;
+
+    void insertCell(size_t index, const std::string &expression);
+
+    void appendCell(const std::string &expression);
+
+    /**
+     * Set the expression of the cell, the cell is not marked as modified if the expression does not change.
+     *
+     * @param index
+     * @param expression
+     */
+    void setCell(size_t index, const std::string &expression);
+
+    void removeCell(size_t index);
+
+    /**
+     * Set the symbol table which the first cell is evaluated with, all cells are marked as modified.
+     *
+     * @param symbolTable
+     */
+    void setSymbolTable(const SymbolTable &symbolTable);
+
+    /**
+     * @return The symbol table with the values assigned by all cells, valid after recompute().
+     */
+    const SymbolTable &getSymbolTable() const;
+
+    /**
+     * Evaluate the modified cells and the cells affected by them.
+     *
+     * The budget applies to the recomputation as a whole.
+     * If a cell fails to evaluate its error is stored and the values of its assigned variables are left unchanged.
+     *
+     * @param budget
+     * @param token The token which cancels the recomputation, cancelled cells remain modified.
+     * @return The indices of the evaluated cells.
+     */
+    std::vector<size_t> recompute(const EvaluationBudget &budget = EvaluationBudget(),
+                                  const CancellationToken &token = CancellationToken());
+
+private:
+    struct CellState {
+        Cell cell;
+        bool modified = true;
+        std::set<std::string> reads; // The variables referenced by the expression.
+        std::set<std::string> writes; // The variables assigned by the expression.
+        std::map<std::string, ArithmeticType> outputs; // The values of the assigned variables after the evaluation.
+    };
+
+    ArithmeticType getInitialValue(const std::string &name) const;
+
+    /**
+     * @param state
+     * @param values The values assigned by the preceding cells.
+     */
+    void evaluateCell(CellState &state, const std::map<std::string, ArithmeticType> &values);
+
+    SymbolTable symbolTable; // The symbol table which the first cell is evaluated with.
+    SymbolTable table; // The symbol table which the cells are evaluated with.
+    std::vector<CellState> cells;
+    std::unique_ptr<EvaluationEngine<ArithmeticType>> engine;
+};
+
+#endif //QCALC_WORKSHEET_HPP
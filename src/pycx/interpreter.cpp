@@ -24,26 +24,41 @@
 #include "pycx/modules/exprtkmodule.hpp"
 
 static bool pyInitialized = false;
+static PyThreadState *mainThreadState = nullptr;
+
+Interpreter::Lock::Lock() : state(PyGILState_Ensure()) {}
+
+Interpreter::Lock::~Lock() {
+    PyGILState_Release(static_cast<PyGILState_STATE>(state));
+}
 
 void Interpreter::initialize() {
-    if (!pyInitialized)
+    if (!pyInitialized) {
         Py_Initialize();
+        mainThreadState = PyEval_SaveThread();
+    }
     pyInitialized = true;
 }
 
 void Interpreter::finalize() {
-    if (pyInitialized)
+    if (pyInitialized) {
+        PyEval_RestoreThread(mainThreadState);
         Py_Finalize();
+    }
     pyInitialized = false;
 }
 
 void Interpreter::setModuleDirs(const std::vector<std::string> &moduleDirectories) {
+    Lock lock;
+
     PyObject *sys_path = PySys_GetObject("path");
     //PyList_Remove ??!!
     throw std::runtime_error("Not implemented");
 }
 
 std::vector<std::string> Interpreter::getModuleDirs() {
+    Lock lock;
+
     PyObject *sys_path = PySys_GetObject("path");
     Py_ssize_t size = PyList_Size(sys_path);
 
@@ -57,11 +72,15 @@ std::vector<std::string> Interpreter::getModuleDirs() {
 }
 
 void Interpreter::addModuleDir(const std::string &dir) {
+    Lock lock;
+
     PyObject *sys_path = PySys_GetObject("path");
     PyList_Append(sys_path, PyUnicode_FromString(dir.c_str()));
 }
 
 int Interpreter::runInteractiveLoop() {
+    Lock lock;
+
     SymbolTable table;
 
     auto ret = PyRun_InteractiveLoop(stdin, "stdin");
@@ -72,6 +91,8 @@ int Interpreter::runInteractiveLoop() {
 std::string Interpreter::runString(const std::string &expression,
                                    Interpreter::ParseStyle style,
                                    const std::string &context) {
+    Lock lock;
+
     PyObject *n = PyUnicode_FromString(context.c_str());
     PyObject *m = PyImport_GetModule(n);
 
@@ -126,6 +147,8 @@ std::string Interpreter::runString(const std::string &expression,
 }
 
 void Interpreter::callFunctionNoArgs(const std::string &m, const std::string &f) {
+    Lock lock;
+
     PyObject *mod = PyImport_ImportModule(m.c_str());
     if (mod == NULL) {
         throw std::runtime_error(getError());
@@ -159,6 +182,8 @@ void Interpreter::callFunctionNoArgs(const std::string &m, const std::string &f)
 }
 
 void Interpreter::reloadModule(const std::string &module) {
+    Lock lock;
+
     PyObject *mod = PyImport_ImportModule(module.c_str());
     if (mod == NULL) {
         throw std::runtime_error(getError());
@@ -172,6 +197,8 @@ void Interpreter::reloadModule(const std::string &module) {
 }
 
 std::string Interpreter::getError() {
+    Lock lock;
+
     PyObject *pType, *pValue, *pTraceback;
     PyErr_Fetch(&pType, &pValue, &pTraceback);
 
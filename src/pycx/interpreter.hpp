@@ -31,6 +31,30 @@ namespace Interpreter {
         FUNC_TYPE_INPUT
     };
 
+    /**
+     * Acquires the global interpreter lock for the calling thread during the lifetime of the object.
+     *
+     * The python api may only be used while holding the lock,
+     * which allows scripts to be invoked from other threads than the thread which initialized the interpreter.
+     * The lock is recursive.
+     */
+    class Lock {
+    public:
+        Lock();
+
+        ~Lock();
+
+        Lock(const Lock &other) = delete;
+
+        Lock &operator=(const Lock &other) = delete;
+
+    private:
+        int state;
+    };
+
+    /**
+     * Initialize the interpreter, the global interpreter lock is released after initialization.
+     */
     void initialize();
 
     void finalize();
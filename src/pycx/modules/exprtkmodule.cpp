@@ -20,11 +20,16 @@
 #include "exprtkmodule.hpp"
 
 #include <utility>
+#include <algorithm>
+#include <thread>
 
 #include "pycx/include.hpp"
 #include "pycx/symboltableutil.hpp"
+#include "pycx/types/pympreal.hpp"
 
 #include "math/expressionparser.hpp"
+#include "math/dependencygraph.hpp"
+#include "math/evaluationcontext.hpp"
 
 #include "modulecommon.hpp"
 
@@ -32,17 +37,47 @@
 
 static SymbolTable *symbolTable = nullptr;
 static std::function<void()> symbolTableCallback;
+static std::thread::id symbolTableThread; // The thread which owns the global table.
+
+static thread_local SymbolTable *scopedTable = nullptr; // See ExprtkModule::ScopedGlobalTable
+
+/**
+ * @return The global table of the calling thread, nullptr if the thread cannot access a global table.
+ */
+static SymbolTable *getGlobalTable() {
+    if (scopedTable != nullptr)
+        return scopedTable;
+    if (symbolTable != nullptr && std::this_thread::get_id() == symbolTableThread)
+        return symbolTable;
+    return nullptr;
+}
+
+/**
+ * Results of the integer backend are converted to exact python integers, other results to floats.
+ */
+static PyObject *convertResult(const ArithmeticType &value) {
+    if (EvaluationContext::getCurrent().backend == BACKEND_INTEGER && mpfr_number_p(value.mpfr_srcptr()))
+        return PyLong_FromMpReal(value);
+    return PyFloat_FromDouble(value.toDouble());
+}
 
 PyObject *evaluate(PyObject *self, PyObject *args) {
     MODULE_FUNC_TRY
 
         PyObject *pyExpression;
         PyObject *pySymTable;
+        Py_ssize_t iterations = 0;
+        Py_ssize_t time = 0;
+        Py_ssize_t memory = 0;
 
-        if (!PyArg_ParseTuple(args, "OO:", &pyExpression, &pySymTable)) {
+        if (!PyArg_ParseTuple(args, "OO|nnn:", &pyExpression, &pySymTable, &iterations, &time, &memory)) {
             return NULL;
         }
 
+        if (iterations < 0 || time < 0 || memory < 0) {
+            throw std::runtime_error("Budget limits must not be negative");
+        }
+
         const char *expression = PyUnicode_AsUTF8(pyExpression);
         if (expression == NULL) {
             return NULL;
@@ -50,11 +85,19 @@ PyObject *evaluate(PyObject *self, PyObject *args) {
 
         SymbolTable symTable = SymbolTableUtil::Convert(pySymTable);
 
-        ArithmeticType value = ExpressionParser::evaluate(expression, symTable);
+        EvaluationBudget budget(iterations, std::chrono::milliseconds(time), memory);
+
+        ArithmeticType value;
+        try {
+            value = ExpressionParser::evaluate(expression, symTable, budget);
+        } catch (...) {
+            SymbolTableUtil::Cleanup(symTable);
+            throw;
+        }
 
         PyObject *ret = PyTuple_New(2);
 
-        PyTuple_SetItem(ret, 0, PyFloat_FromDouble(value.toDouble()));
+        PyTuple_SetItem(ret, 0, convertResult(value));
         PyTuple_SetItem(ret, 1, SymbolTableUtil::New(symTable));
 
         SymbolTableUtil::Cleanup(symTable);
@@ -64,11 +107,165 @@ PyObject *evaluate(PyObject *self, PyObject *args) {
     MODULE_FUNC_CATCH
 }
 
+static std::map<std::string, std::vector<ArithmeticType>> convertBindings(PyObject *pyBindings) {
+    if (!PyDict_Check(pyBindings)) {
+        throw std::runtime_error("Bindings must be a dictionary");
+    }
+
+    std::map<std::string, std::vector<ArithmeticType>> ret;
+
+    PyObject *key;
+    PyObject *value;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(pyBindings, &pos, &key, &value)) {
+        if (!PyUnicode_Check(key)) {
+            throw std::runtime_error("Binding key must be unicode string");
+        }
+
+        const char *k = PyUnicode_AsUTF8(key);
+        if (k == NULL) {
+            throw std::runtime_error("Failed to convert binding key");
+        }
+
+        PyObject *sequence = PySequence_Fast(value, "Binding value must be a sequence");
+        if (sequence == NULL) {
+            PyErr_Clear();
+            throw std::runtime_error("Binding value must be a sequence");
+        }
+
+        auto &column = ret[k];
+        Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+        column.reserve(size);
+        for (Py_ssize_t i = 0; i < size; i++) {
+            PyObject *item = PySequence_Fast_GET_ITEM(sequence, i);
+            if (PyMpReal_Check(item)) {
+                column.emplace_back(PyMpReal_AsMpReal(item));
+            } else if (PyFloat_Check(item)) {
+                column.emplace_back(PyFloat_AsDouble(item));
+            } else if (PyLong_Check(item)) {
+                column.emplace_back(PyLong_AsMpReal(item));
+            } else {
+                Py_DECREF(sequence);
+                throw std::runtime_error("Binding values must be float or long");
+            }
+        }
+
+        Py_DECREF(sequence);
+    }
+
+    return ret;
+}
+
+PyObject *evaluate_batch(PyObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+
+        PyObject *pyExpression;
+        PyObject *pySymTable;
+        PyObject *pyBindings;
+        Py_ssize_t threadCount = 1;
+
+        if (!PyArg_ParseTuple(args, "OOO|n:", &pyExpression, &pySymTable, &pyBindings, &threadCount)) {
+            return NULL;
+        }
+
+        const char *expression = PyUnicode_AsUTF8(pyExpression);
+        if (expression == NULL) {
+            return NULL;
+        }
+
+        auto bindings = convertBindings(pyBindings);
+
+        SymbolTable symTable = SymbolTableUtil::Convert(pySymTable);
+        for (auto &column : bindings) {
+            if (!symTable.hasVariable(column.first)
+                && !symTable.hasConstant(column.first)
+                && !symTable.hasFunction(column.first)
+                && !symTable.hasScript(column.first)) {
+                symTable.setVariable(column.first, 0, -1);
+            }
+        }
+
+        std::vector<ArithmeticType> values;
+        try {
+            if (threadCount == 1)
+                values = ExpressionParser::evaluateBatch(expression, symTable, bindings);
+            else
+                values = ExpressionParser::evaluateBatchParallel(expression,
+                                                                 symTable,
+                                                                 bindings,
+                                                                 EvaluationBudget(),
+                                                                 CancellationToken(),
+                                                                 std::max<Py_ssize_t>(threadCount, 0));
+        } catch (...) {
+            SymbolTableUtil::Cleanup(symTable);
+            throw;
+        }
+
+        SymbolTableUtil::Cleanup(symTable);
+
+        PyObject *ret = PyList_New(values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            PyList_SetItem(ret, i, convertResult(values[i]));
+        }
+
+        return ret;
+
+    MODULE_FUNC_CATCH
+}
+
+PyObject *recompute(PyObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+
+        PyObject *pySymTable;
+        PyObject *pyNames;
+        Py_ssize_t threadCount = 0;
+
+        if (!PyArg_ParseTuple(args, "OO|n:", &pySymTable, &pyNames, &threadCount)) {
+            return NULL;
+        }
+
+        PyObject *sequence = PySequence_Fast(pyNames, "Changed names must be a sequence");
+        if (sequence == NULL) {
+            return NULL;
+        }
+
+        std::set<std::string> names;
+        Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+        for (Py_ssize_t i = 0; i < size; i++) {
+            const char *name = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(sequence, i));
+            if (name == NULL) {
+                Py_DECREF(sequence);
+                return NULL;
+            }
+            names.insert(name);
+        }
+        Py_DECREF(sequence);
+
+        SymbolTable symTable = SymbolTableUtil::Convert(pySymTable);
+
+        try {
+            DependencyGraph(symTable).recompute(symTable, names, std::max<Py_ssize_t>(threadCount, 0));
+        } catch (...) {
+            SymbolTableUtil::Cleanup(symTable);
+            throw;
+        }
+
+        PyObject *ret = SymbolTableUtil::New(symTable);
+
+        SymbolTableUtil::Cleanup(symTable);
+
+        return ret;
+
+    MODULE_FUNC_CATCH
+}
+
 PyObject *get_global_symtable(PyObject *self, PyObject *args) {
-    if (symbolTable == nullptr)
-        return nullptr;
-    else
-        return SymbolTableUtil::New(*symbolTable);
+    SymbolTable *table = getGlobalTable();
+    if (table == nullptr) {
+        PyErr_SetString(PyExc_RuntimeError, "The global symbol table is not accessible from this thread");
+        return NULL;
+    }
+    return SymbolTableUtil::New(*table);
 }
 
 PyObject *set_global_symtable(PyObject *self, PyObject *args) {
@@ -76,10 +273,15 @@ PyObject *set_global_symtable(PyObject *self, PyObject *args) {
     if (!PyArg_ParseTuple(args, "O:", &pysym)) {
         return NULL;
     }
-    SymbolTable &t = *symbolTable;
-    t = SymbolTableUtil::Convert(pysym);
+    SymbolTable *table = getGlobalTable();
+    if (table == nullptr) {
+        PyErr_SetString(PyExc_RuntimeError, "The global symbol table is not accessible from this thread");
+        return NULL;
+    }
+    *table = SymbolTableUtil::Convert(pysym);
 
-    if (symbolTableCallback)
+    // The owner of a scoped table applies it after the scope.
+    if (table == symbolTable && symbolTableCallback)
         symbolTableCallback();
 
     return PyLong_FromLong(0);
@@ -87,6 +289,8 @@ PyObject *set_global_symtable(PyObject *self, PyObject *args) {
 
 static PyMethodDef MethodDef[] = {
         {"evaluate",            evaluate,            METH_VARARGS, "."},
+        {"evaluate_batch",      evaluate_batch,      METH_VARARGS, "."},
+        {"recompute",           recompute,           METH_VARARGS, "."},
         {"get_global_symtable", get_global_symtable, METH_NOARGS,  "."},
         {"set_global_symtable", set_global_symtable, METH_VARARGS, "."},
         {NULL, NULL, 0, NULL}
@@ -118,4 +322,18 @@ void ExprtkModule::initialize() {
 void ExprtkModule::setGlobalTable(SymbolTable &globalTable, std::function<void()> tableChangeCallback) {
     symbolTable = &globalTable;
     symbolTableCallback = std::move(tableChangeCallback);
+    symbolTableThread = std::this_thread::get_id();
+}
+
+void ExprtkModule::clearGlobalTable() {
+    symbolTable = nullptr;
+    symbolTableCallback = nullptr;
+}
+
+ExprtkModule::ScopedGlobalTable::ScopedGlobalTable(SymbolTable &table) : previous(scopedTable) {
+    scopedTable = &table;
+}
+
+ExprtkModule::ScopedGlobalTable::~ScopedGlobalTable() {
+    scopedTable = previous;
 }
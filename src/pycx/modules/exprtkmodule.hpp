@@ -34,7 +34,42 @@ namespace ExprtkModule {
      */
     void initialize();
 
+    /**
+     * Set the global table of the python module.
+     *
+     * The table is only accessible from the calling thread,
+     * scripts on other threads access the table of their ScopedGlobalTable or fail.
+     *
+     * @param globalTable
+     * @param tableChangeCallback Invoked on the calling thread after a script replaced the table.
+     */
     void setGlobalTable(SymbolTable &globalTable, std::function<void()> tableChangeCallback);
+
+    /**
+     * Remove the global table, called before the table is destroyed.
+     */
+    void clearGlobalTable();
+
+    /**
+     * Redirects the global table of the python module on the calling thread to the passed table
+     * during the lifetime of the scope.
+     *
+     * Evaluation threads evaluate a copy of the global table which is applied by the owner after the evaluation,
+     * scripts invoked by the evaluation read and replace the copy instead of the table of the owning thread.
+     */
+    class ScopedGlobalTable {
+    public:
+        explicit ScopedGlobalTable(SymbolTable &table);
+
+        ~ScopedGlobalTable();
+
+        ScopedGlobalTable(const ScopedGlobalTable &other) = delete;
+
+        ScopedGlobalTable &operator=(const ScopedGlobalTable &other) = delete;
+
+    private:
+        SymbolTable *previous;
+    };
 }
 
 #endif //QCALC_EXPRTKMODULE_HPP
@@ -107,6 +107,14 @@ PyObject *SymbolTableUtil::New(const SymbolTable &table) {
     }
     Py_DECREF(vars);
 
+    vars = PyObject_GetAttrString(symInstance, "definitions");
+    for (auto &var : table.getDefinitions()) {
+        PyObject *o = PyUnicode_FromString(var.second.c_str());
+        PyDict_SetItemString(vars, var.first.c_str(), o);
+        Py_DECREF(o);
+    }
+    Py_DECREF(vars);
+
     Py_DECREF(symModule);
 
     return symInstance;
@@ -421,6 +429,37 @@ SymbolTable SymbolTableUtil::Convert(PyObject *o) {
 
     Py_DECREF(attr);
 
+    // The definitions are optional to support symbol table objects created before definitions were introduced.
+    if (PyObject_HasAttrString(o, "definitions")) {
+        attr = PyObject_GetAttrString(o, "definitions");
+        if (!PyDict_Check(attr)) {
+            Py_DECREF(attr);
+            throw std::runtime_error("definitions attribute must be a dictionary");
+        }
+
+        PyObject *key;
+        PyObject *value;
+        Py_ssize_t pos = 0;
+        while (PyDict_Next(attr, &pos, &key, &value)) {
+            if (!PyUnicode_Check(key) || !PyUnicode_Check(value)) {
+                Py_DECREF(attr);
+                throw std::runtime_error("Definition key and value must be unicode strings");
+            }
+
+            const char *k = PyUnicode_AsUTF8(key);
+            const char *expr = PyUnicode_AsUTF8(value);
+            if (k == NULL || expr == NULL) {
+                //Should never happen, just in case we will steal the error indicator and throw.
+                Py_DECREF(attr);
+                throw std::runtime_error(Interpreter::getError());
+            }
+
+            ret.setDefinition(k, expr);
+        }
+
+        Py_DECREF(attr);
+    }
+
     return ret;
 }
 
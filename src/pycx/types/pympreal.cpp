@@ -25,6 +25,7 @@
 #include "extern/mpreal.h"
 
 #include "math/numberformat.hpp"
+#include "math/evaluationcontext.hpp"
 
 typedef struct {
     PyObject_HEAD
@@ -81,6 +82,18 @@ PyObject *mpreal_set_default_rounding(PyMpRealObject *self, PyObject *args);
 
 PyObject *mpreal_get_default_rounding(PyMpRealObject *self, PyObject *args);
 
+PyObject *mpreal_set_formatting_precision(PyMpRealObject *self, PyObject *args);
+
+PyObject *mpreal_get_formatting_precision(PyMpRealObject *self, PyObject *args);
+
+PyObject *mpreal_set_formatting_rounding(PyMpRealObject *self, PyObject *args);
+
+PyObject *mpreal_get_formatting_rounding(PyMpRealObject *self, PyObject *args);
+
+PyObject *mpreal_set_backend(PyMpRealObject *self, PyObject *args);
+
+PyObject *mpreal_get_backend(PyMpRealObject *self, PyObject *args);
+
 PyObject *mpreal_is_integer(PyMpRealObject *self, PyObject *args);
 
 PyObject *mpreal_to_string(PyMpRealObject *self, PyObject *args);
@@ -93,6 +106,12 @@ static PyMethodDef mpreal_methods[] = {
         {"get_default_precision", (PyCFunction) mpreal_get_default_precision, METH_NOARGS  | METH_STATIC},
         {"set_default_rounding",  (PyCFunction) mpreal_set_default_rounding,  METH_VARARGS | METH_STATIC},
         {"get_default_rounding",  (PyCFunction) mpreal_get_default_rounding,  METH_NOARGS  | METH_STATIC},
+        {"set_formatting_precision", (PyCFunction) mpreal_set_formatting_precision, METH_VARARGS | METH_STATIC},
+        {"get_formatting_precision", (PyCFunction) mpreal_get_formatting_precision, METH_NOARGS  | METH_STATIC},
+        {"set_formatting_rounding",  (PyCFunction) mpreal_set_formatting_rounding,  METH_VARARGS | METH_STATIC},
+        {"get_formatting_rounding",  (PyCFunction) mpreal_get_formatting_rounding,  METH_NOARGS  | METH_STATIC},
+        {"set_backend",              (PyCFunction) mpreal_set_backend,              METH_VARARGS | METH_STATIC},
+        {"get_backend",              (PyCFunction) mpreal_get_backend,              METH_NOARGS  | METH_STATIC},
         {"is_integer",            (PyCFunction) mpreal_is_integer,            METH_NOARGS},
         {"to_string",             (PyCFunction) mpreal_to_string,             METH_VARARGS},
         {NULL, NULL}           /* sentinel */
@@ -199,6 +218,53 @@ mpfr::mpreal PyMpReal_AsMpReal(PyObject *op) {
     }
 }
 
+PyObject *PyLong_FromMpReal(const mpfr::mpreal &val) {
+    //Truncate like int(float) and pass the digits to python exactly, python integers have variable length.
+    mpz_t z;
+    mpz_init(z);
+    mpfr_get_z(z, val.mpfr_srcptr(), MPFR_RNDZ);
+    std::string str(mpz_sizeinbase(z, 16) + 2, '\0');
+    mpz_get_str(&str[0], 16, z);
+    mpz_clear(z);
+
+    return PyLong_FromString(str.c_str(), NULL, 16);
+}
+
+mpfr::mpreal PyLong_AsMpReal(PyObject *op) {
+    if (op == NULL || !PyLong_Check(op)) {
+        PyErr_BadArgument();
+        return -1;
+    }
+
+    PyObject *bitLength = PyObject_CallMethod(op, "bit_length", NULL);
+    if (bitLength == NULL) {
+        return -1;
+    }
+    long bits = PyLong_AsLong(bitLength);
+    Py_DECREF(bitLength);
+    if (PyErr_Occurred()) {
+        return -1;
+    }
+
+    //The hexadecimal representation is computed in linear time by python and is parsed exactly by mpfr.
+    PyObject *hex = PyNumber_ToBase(op, 16);
+    if (hex == NULL) {
+        return -1;
+    }
+
+    mpfr::mpreal ret(0, std::max<mpfr_prec_t>(EvaluationContext::getCurrent().precision, bits));
+    const char *str = PyUnicode_AsUTF8(hex);
+    if (str == NULL || mpfr_set_str(ret.mpfr_ptr(), str, 0, MPFR_RNDN) != 0) {
+        Py_DECREF(hex);
+        if (!PyErr_Occurred())
+            PyErr_BadArgument();
+        return -1;
+    }
+    Py_DECREF(hex);
+
+    return ret;
+}
+
 bool PyMpReal_Check(PyObject *op) {
     return PyObject_TypeCheck(op, &PyMpReal_Type);
 }
@@ -357,13 +423,15 @@ PyObject *mpreal_int(PyObject *v) {
 
     const mpfr::mpreal &vmp = *((PyMpRealObject *) v)->mpreal;
 
-    PyObject *unicode = PyUnicode_FromString(vmp.toString().c_str());
-
-    //Use PyLong_FromUnicodeObject to make use of variable length integer feature of python.
-    PyObject *ret = PyLong_FromUnicodeObject(unicode, 10);
+    if (mpfr_nan_p(vmp.mpfr_srcptr())) {
+        PyErr_SetString(PyExc_ValueError, "cannot convert mpreal NaN to integer");
+        return NULL;
+    } else if (mpfr_inf_p(vmp.mpfr_srcptr())) {
+        PyErr_SetString(PyExc_OverflowError, "cannot convert mpreal infinity to integer");
+        return NULL;
+    }
 
-    Py_DECREF(unicode);
-    return ret;
+    return PyLong_FromMpReal(vmp);
 }
 
 PyObject *mpreal_str(PyObject *self) {
@@ -374,7 +442,7 @@ PyObject *mpreal_str(PyObject *self) {
     const mpfr::mpreal &v = *((PyMpRealObject *) self)->mpreal;
     return PyUnicode_FromString(NumberFormat::toDecimal(v,
                                                         mpfr::bits2digits(v.getPrecision()),
-                                                        mpfr::mpreal::get_default_rnd()).c_str());
+                                                        EvaluationContext::getCurrent().formattingRounding).c_str());
 }
 
 PyObject *mpreal_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
@@ -397,7 +465,10 @@ int mpreal_init(PyObject *self, PyObject *args, PyObject *kwds) {
         } else if (PyFloat_Check(arg0)) {
             ((PyMpRealObject *) self)->mpreal = new mpfr::mpreal(PyFloat_AsDouble(arg0));
         } else if (PyLong_Check(arg0)) {
-            ((PyMpRealObject *) self)->mpreal = new mpfr::mpreal(PyLong_AsLong(arg0));
+            mpfr::mpreal value = PyLong_AsMpReal(arg0);
+            if (PyErr_Occurred())
+                return -1;
+            ((PyMpRealObject *) self)->mpreal = new mpfr::mpreal(value);
         } else if (PyUnicode_Check(arg0)) {
             int base = 10;
             if (arg1 != NULL && PyLong_Check(arg1)) {
@@ -424,7 +495,7 @@ int mpreal_init(PyObject *self, PyObject *args, PyObject *kwds) {
                 PyErr_SetString(PyExc_ValueError, ("could not convert string to mpreal: '" + argStr + "'").c_str());
                 return -1;
             } else {
-                ((PyMpRealObject *) self)->mpreal = new mpfr::mpreal(argStr, mpfr::mpreal::get_default_prec(), base);
+                ((PyMpRealObject *) self)->mpreal = new mpfr::mpreal(argStr, EvaluationContext::getCurrent().precision, base);
             }
         } else {
             PyErr_BadArgument();
@@ -460,12 +531,18 @@ PyObject *mpreal_set_default_precision(PyMpRealObject *self, PyObject *args) {
     if (!PyArg_ParseTuple(args, "i:", &precision)) {
         return NULL;
     }
-    mpfr::mpreal::set_default_prec(precision);
+    if (precision < MPFR_PREC_MIN || precision > MPFR_PREC_MAX) {
+        PyErr_BadArgument();
+        return NULL;
+    }
+    EvaluationContext context = EvaluationContext::getCurrent();
+    context.precision = precision;
+    EvaluationContext::setCurrent(context);
     return PyLong_FromLong(0);
 }
 
 PyObject *mpreal_get_default_precision(PyMpRealObject *self, PyObject *args) {
-    return PyLong_FromLong(mpfr::mpreal::get_default_prec());
+    return PyLong_FromLong(EvaluationContext::getCurrent().precision);
 }
 
 PyObject *mpreal_set_default_rounding(PyMpRealObject *self, PyObject *args) {
@@ -478,9 +555,12 @@ PyObject *mpreal_set_default_rounding(PyMpRealObject *self, PyObject *args) {
         case (int) MPFR_RNDZ:
         case (int) MPFR_RNDU:
         case (int) MPFR_RNDD:
-        case (int) MPFR_RNDA:
-            mpfr::mpreal::set_default_rnd((mpfr_rnd_t) rounding);
+        case (int) MPFR_RNDA: {
+            EvaluationContext context = EvaluationContext::getCurrent();
+            context.rounding = (mpfr_rnd_t) rounding;
+            EvaluationContext::setCurrent(context);
             return PyLong_FromLong(0);
+        }
         default:
             PyErr_BadArgument();
             return NULL;
@@ -488,7 +568,77 @@ PyObject *mpreal_set_default_rounding(PyMpRealObject *self, PyObject *args) {
 }
 
 PyObject *mpreal_get_default_rounding(PyMpRealObject *self, PyObject *args) {
-    return PyLong_FromLong(mpfr::mpreal::get_default_rnd());
+    return PyLong_FromLong(EvaluationContext::getCurrent().rounding);
+}
+
+PyObject *mpreal_set_formatting_precision(PyMpRealObject *self, PyObject *args) {
+    int precision;
+    if (!PyArg_ParseTuple(args, "i:", &precision)) {
+        return NULL;
+    }
+    if (precision < 0) {
+        PyErr_BadArgument();
+        return NULL;
+    }
+    EvaluationContext context = EvaluationContext::getCurrent();
+    context.formattingPrecision = precision;
+    EvaluationContext::setCurrent(context);
+    return PyLong_FromLong(0);
+}
+
+PyObject *mpreal_get_formatting_precision(PyMpRealObject *self, PyObject *args) {
+    return PyLong_FromLong(EvaluationContext::getCurrent().formattingPrecision);
+}
+
+PyObject *mpreal_set_formatting_rounding(PyMpRealObject *self, PyObject *args) {
+    int rounding;
+    if (!PyArg_ParseTuple(args, "i:", &rounding)) {
+        return NULL;
+    }
+    switch (rounding) {
+        case (int) MPFR_RNDN:
+        case (int) MPFR_RNDZ:
+        case (int) MPFR_RNDU:
+        case (int) MPFR_RNDD:
+        case (int) MPFR_RNDA: {
+            EvaluationContext context = EvaluationContext::getCurrent();
+            context.formattingRounding = (mpfr_rnd_t) rounding;
+            EvaluationContext::setCurrent(context);
+            return PyLong_FromLong(0);
+        }
+        default:
+            PyErr_BadArgument();
+            return NULL;
+    }
+}
+
+PyObject *mpreal_get_formatting_rounding(PyMpRealObject *self, PyObject *args) {
+    return PyLong_FromLong(EvaluationContext::getCurrent().formattingRounding);
+}
+
+PyObject *mpreal_set_backend(PyMpRealObject *self, PyObject *args) {
+    int backend;
+    if (!PyArg_ParseTuple(args, "i:", &backend)) {
+        return NULL;
+    }
+    if (backend < BACKEND_MPFR || backend > BACKEND_INTERVAL) {
+        PyErr_BadArgument();
+        return NULL;
+    }
+#ifndef QCALC_FLOAT128
+    if (backend == BACKEND_FLOAT128) {
+        PyErr_BadArgument();
+        return NULL;
+    }
+#endif
+    EvaluationContext context = EvaluationContext::getCurrent();
+    context.backend = (NumericBackend) backend;
+    EvaluationContext::setCurrent(context);
+    return PyLong_FromLong(0);
+}
+
+PyObject *mpreal_get_backend(PyMpRealObject *self, PyObject *args) {
+    return PyLong_FromLong(EvaluationContext::getCurrent().backend);
 }
 
 PyObject *mpreal_is_integer(PyMpRealObject *self, PyObject *args) {
@@ -33,6 +33,16 @@ PyObject *PyMpReal_FromMpReal(const mpfr::mpreal &val);
 
 mpfr::mpreal PyMpReal_AsMpReal(PyObject *op);
 
+/**
+ * Convert the python integer exactly, the precision is at least the precision of the current evaluation context.
+ */
+mpfr::mpreal PyLong_AsMpReal(PyObject *op);
+
+/**
+ * Convert the integral part of the value exactly, the value is truncated like int(float) and must be finite.
+ */
+PyObject *PyLong_FromMpReal(const mpfr::mpreal &val);
+
 bool PyMpReal_Check(PyObject *op);
 
 #endif //QCALC_PYMPREAL_HPP
@@ -32,7 +32,23 @@ const int SETTING_DEFAULT_PRECISION_F = 100;
 const char *const SETTING_KEY_ROUNDING_F = "_qcalc_rounding_format";
 const int SETTING_DEFAULT_ROUNDING_F = 0;
 
+const char *const SETTING_KEY_BACKEND = "_qcalc_backend";
+const int SETTING_DEFAULT_BACKEND = 0;
+
+const char *const SETTING_KEY_ADAPTIVE_PRECISION = "_qcalc_adaptive_precision";
+const int SETTING_DEFAULT_ADAPTIVE_PRECISION = false;
+
 const char *const SETTING_KEY_SAVE_SYM_HISTORY = "_qcalc_save_sym_hist";
 const int SETTING_DEFAULT_SAVE_SYM_HISTORY = true;
 
+// Evaluation budgets, 0 disables the limit.
+const char *const SETTING_KEY_BUDGET_ITERATIONS = "_qcalc_budget_iterations";
+const int SETTING_DEFAULT_BUDGET_ITERATIONS = 0;
+
+const char *const SETTING_KEY_BUDGET_TIME = "_qcalc_budget_time_ms";
+const int SETTING_DEFAULT_BUDGET_TIME = 0;
+
+const char *const SETTING_KEY_BUDGET_MEMORY = "_qcalc_budget_memory_mb";
+const int SETTING_DEFAULT_BUDGET_MEMORY = 0;
+
 #endif //QCALC_SETTINGCONSTANTS_HPP